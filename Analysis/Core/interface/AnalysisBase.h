@@ -4,11 +4,17 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
+#include "UserCode/ICHiggsTauTau/interface/EventInfo.hh"
 #include "boost/function.hpp"
 #include "boost/bind.hpp"
 
+namespace fwlite {
+  class TFileService;
+}
+
 namespace ic {
 
 	class AnalysisBase {
@@ -22,6 +28,12 @@ namespace ic {
     unsigned events_processed_;
     std::vector<ic::ModuleBase *> modules_;
     std::vector<double> weighted_yields_;
+    // Named module sequences that are run, one after another, on
+    // each event that passes the common sequence in modules_
+    std::vector<std::string> variation_names_;
+    std::vector<std::vector<ic::ModuleBase *> > variation_modules_;
+    std::vector<std::vector<double> > variation_yields_;
+    std::map<std::string, fwlite::TFileService *> variation_fs_;
     ic::TreeEvent event_;
     bool notify_on_fail_;
     bool notify_evt_on_fail_;
@@ -49,6 +61,33 @@ namespace ic {
 
 
     void AddModule(ic::ModuleBase *module_ptr);
+
+    //! Add a module to the sequence of the named variation
+    /*! Modules added with #AddModule(ic::ModuleBase*) form a common
+        sequence that is run once per event. If any variations have been
+        defined, each event that passes the common sequence is then given
+        to the module sequence of every variation in turn, in the order in
+        which the variations were first declared. Before each variation
+        after the first the event is reset to the state it had at the end
+        of the common sequence, so in-place modifications made by one
+        variation (e.g. an EnergyShifter) are not seen by the next one.
+        A typical use is a nominal sequence plus tau energy scale up/down
+        sequences, each writing to its own #VariationFileService, produced
+        from a single read of the input. When skimming, each event accepted
+        by the whole sequence of a variation is also written to the skim
+        file of that variation, in the variation's subfolder of the skim
+        path.
+    */
+    void AddModule(std::string const& variation, ic::ModuleBase *module_ptr);
+
+    //! An output file for the modules of the named variation
+    /*! The file has the name of \a output_file, in a subfolder of its
+        folder named after the variation, which is created if needed.  The
+        file is owned by the analysis and is written and closed after the
+        PostAnalysis step of #RunAnalysis.
+    */
+    fwlite::TFileService * VariationFileService(std::string const& variation,
+                                                std::string const& output_file);
     inline std::string analysis_name() { return analysis_name_; }
     inline std::string tree_path() { return tree_path_; }
     inline std::string tree_name() { return tree_name_; }
@@ -63,6 +102,17 @@ namespace ic {
     void SetTTreeCaching(bool const& value);
     void StopOnFileFailure(bool const& value);
     void RetryFileAfterFailure(unsigned pause_in_seconds, unsigned retry_attempts);
+
+  private:
+    // Runs the modules in seq on the current event, returns false if a
+    // module stopped the processing of the event
+    bool RunSequence(std::vector<ic::ModuleBase *> & seq,
+                     std::vector<double> & yields,
+                     EventInfo const* eventInfo,
+                     TTree *tree_ptr,
+                     TTree *outtree,
+                     unsigned evt,
+                     bool do_skim);
  };
 }
 
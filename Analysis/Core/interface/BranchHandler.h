@@ -19,6 +19,7 @@ namespace ic {
     class BranchHandler : public BranchHandlerBase{
       private:
         T* ptr_;
+        T saved_;
 
       public:
         BranchHandler(){
@@ -42,6 +43,15 @@ namespace ic {
         T* & GetPtr(){
           return ptr_;
         }
+        // The copy is assigned back into the existing object rather than
+        // replacing it, so pointers already handed out to the event (e.g. the
+        // elements of a std::vector<T>) stay valid.
+        void SaveState(){
+          if (ptr_) saved_ = *ptr_;
+        }
+        void RestoreState(){
+          if (ptr_) *ptr_ = saved_;
+        }
 
         virtual ~BranchHandler() {
           delete ptr_;
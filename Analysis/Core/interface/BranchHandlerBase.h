@@ -17,6 +17,10 @@ namespace ic {
 
     public:
       virtual void SetAddress() = 0;
+      //! Keep a copy of the object currently read from the branch
+      virtual void SaveState() = 0;
+      //! Copy the object saved by SaveState() back into the branch buffer
+      virtual void RestoreState() = 0;
       void GetEntry(unsigned i){
         branch_ptr_->GetEntry(i);
       }
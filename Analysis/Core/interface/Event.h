@@ -11,7 +11,22 @@ namespace ic {
   class Event {
 
   private:
-    std::map<std::string, boost::any> products_;
+    // Assigns the value held by the second argument to the object held
+    // by the first, which must hold the same type
+    typedef void (*Assigner)(boost::any &, boost::any const&);
+
+    template <class T>
+    static void AssignProduct(boost::any & product, boost::any const& value) {
+      boost::any_cast<T &>(product) = boost::any_cast<T const&>(value);
+    }
+
+    struct Product {
+      boost::any value;
+      Assigner assign;
+    };
+
+    std::map<std::string, Product> products_;
+    std::map<std::string, Product> saved_products_;
 
   public:
     Event();
@@ -25,14 +40,18 @@ namespace ic {
         << std::endl;
         return 1;
       } else {
-        products_[name] = product;
+        Product & prod = products_[name];
+        prod.value = product;
+        prod.assign = &Event::AssignProduct<T>;
         return 0;
       }
     }
 
     template <class T>
     unsigned int ForceAdd(std::string name, T const& product) {
-      products_[name] = product;
+      Product & prod = products_[name];
+      prod.value = product;
+      prod.assign = &Event::AssignProduct<T>;
       return 0;
     }
     
@@ -40,7 +59,7 @@ namespace ic {
     template <class T>
     T & Get(std::string const& name) {
       if (Exists(name)) {
-        return boost::any_cast<T &>(products_[name]);
+        return boost::any_cast<T &>(products_[name].value);
       } else {
         std::cerr << "Error: Attempt to get product with name \"" 
         << name << "\" failed, no product with this name  exists."
@@ -50,10 +69,33 @@ namespace ic {
       }
     }
 
+    //! The product \a name if it exists and holds a T, otherwise NULL
+    template <class T>
+    T * GetIf(std::string const& name) {
+      std::map<std::string, Product>::iterator it = products_.find(name);
+      return it == products_.end() ? NULL : boost::any_cast<T>(&(it->second.value));
+    }
+
     void List();
 
     void Clear();
 
+    //! Store a copy of the current set of products
+    /*! Used when the same event is passed through several module
+        sequences, e.g. when processing systematic variations in one pass.
+        The saved state is put back in place by #Restore.
+    */
+    virtual void Snapshot();
+
+    //! Put the products back to the state saved by #Snapshot
+    /*! Products added since the snapshot are removed.  The saved value of
+        every other product is assigned back into the existing object, so
+        pointers to a product (e.g. one added as both "X" and a pointer to
+        it) stay valid.  A product removed since the snapshot, or replaced
+        with one of a different type, is added again as a new copy.
+    */
+    virtual void Restore();
+
     unsigned int Remove(std::string const& name);
 
     bool Exists(std::string const& name);
@@ -4,9 +4,11 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <algorithm>
 
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/Event.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/BranchHandler.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/ShiftedView.h"
 #include "boost/function.hpp"
 #include "boost/bind.hpp"
 #include "TTree.h"
@@ -23,12 +25,23 @@ namespace ic {
 
 
     std::vector<boost::function<void (unsigned)> > auto_add_funcs_;
+    // Handlers whose branch has been read for the current event, and
+    // the subset of these saved by the last call to Snapshot()
+    std::vector<BranchHandlerBase*> loaded_;
+    std::vector<BranchHandlerBase*> saved_;
     TTree *tree_;
     unsigned event_;
 
+    void MarkLoaded(BranchHandlerBase *handler) {
+      if (std::find(loaded_.begin(), loaded_.end(), handler) == loaded_.end()) {
+        loaded_.push_back(handler);
+      }
+    }
+
     template <class T>
     void Copy(std::string const& branch_name, std::string const& prod_name, unsigned event) {
       handlers_[branch_name]->GetEntry(event);
+      MarkLoaded(handlers_[branch_name]);
       T* ptr = (dynamic_cast<BranchHandler<T>* >(handlers_[branch_name]))->GetPtr();
       Add(prod_name, ptr);
     }
@@ -36,6 +49,7 @@ namespace ic {
     template <class T>
     void CopyPtrVec(std::string const& branch_name, std::string const& prod_name, unsigned event) {
       handlers_[branch_name]->GetEntry(event);
+      MarkLoaded(handlers_[branch_name]);
       std::vector<T> *ptr = (dynamic_cast<BranchHandler<std::vector<T> >* >(handlers_[branch_name]))->GetPtr();
       std::vector<T *> temp_vec(ptr->size(), NULL);
       for (unsigned i = 0; i < ptr->size(); ++i) {
@@ -47,6 +61,7 @@ namespace ic {
     template <class T>
     void CopyIDMap(std::string const& branch_name, std::string const& prod_name, unsigned event) {
       handlers_[branch_name]->GetEntry(event);
+      MarkLoaded(handlers_[branch_name]);
       std::vector<T> *ptr = (dynamic_cast<BranchHandler<std::vector<T> >* >(handlers_[branch_name]))->GetPtr();
       std::map<std::size_t, T *> temp_map;
       for (unsigned i = 0; i < ptr->size(); ++i) {
@@ -149,10 +164,22 @@ namespace ic {
       }
     }
 
+    //! As GetPtr, for a collection
+    /*! A ShiftedView<T> added under \a name is replaced on the first
+        request by a vector of copies of its objects, so that modules can
+        read a view like any other collection.  The view, which owns the
+        copies, is kept as "<name>:view".
+    */
     template <class T>
     std::vector<T*> & GetPtrVec(std::string const& name, std::string branch_name = "") {
       //1. If the product already exists in the event, return it
       if (Exists(name)) {
+        ShiftedView<T> * view = GetIf<ShiftedView<T> >(name);
+        if (view) {
+          std::vector<T*> copies = view->Copies();
+          ForceAdd(name + ":view", *view);
+          ForceAdd(name, copies);
+        }
         return Event::Get<std::vector<T*> >(name);
       } else { //2. No - is a function cached for the product?
         if (cached_funcs_.count(name)) {
@@ -204,6 +231,15 @@ namespace ic {
 
     void SetTree(TTree *tree); 
 
+    //! Save the products and the contents of all branches read so far
+    /*! Branches first read after the snapshot do not need to be saved:
+        once #Restore has removed their products they will simply be read
+        again from the tree on the next request.
+    */
+    virtual void Snapshot();
+
+    virtual void Restore();
+
 
 
   
@@ -1,6 +1,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/AnalysisBase.h"
 #include "UserCode/ICHiggsTauTau/interface/EventInfo.hh"
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 
 #include <stdio.h>
 #include <thread>
@@ -8,6 +9,8 @@
 #include "TTree.h"
 #include "boost/format.hpp"
 #include "TTreeCache.h"
+#include "boost/filesystem.hpp"
+#include "PhysicsTools/FWLite/interface/TFileService.h"
 
 namespace ic {
 
@@ -42,6 +45,72 @@ namespace ic {
     modules_.push_back(module_ptr);
   }
 
+  void AnalysisBase::AddModule(std::string const& variation, ic::ModuleBase *module_ptr) {
+    std::vector<std::string>::const_iterator it = 
+      std::find(variation_names_.begin(), variation_names_.end(), variation);
+    if (it == variation_names_.end()) {
+      variation_names_.push_back(variation);
+      variation_modules_.push_back(std::vector<ic::ModuleBase *>());
+      it = variation_names_.end() - 1;
+    }
+    variation_modules_[it - variation_names_.begin()].push_back(module_ptr);
+  }
+
+  fwlite::TFileService * AnalysisBase::VariationFileService(std::string const& variation,
+                                                           std::string const& output_file) {
+    std::map<std::string, fwlite::TFileService *>::const_iterator it = variation_fs_.find(variation);
+    if (it != variation_fs_.end()) return it->second;
+    boost::filesystem::path nominal(output_file);
+    boost::filesystem::path folder = nominal.parent_path() / variation;
+    boost::filesystem::create_directories(folder);
+    std::string path = (folder / nominal.filename()).string();
+    std::cout << "Info in <ic::AnalysisBase>: Output of variation " << variation << " is written to " << path << std::endl;
+    fwlite::TFileService *fs = new fwlite::TFileService(path.c_str());
+    variation_fs_[variation] = fs;
+    return fs;
+  }
+
+  bool AnalysisBase::RunSequence(std::vector<ic::ModuleBase *> & seq,
+                                 std::vector<double> & yields,
+                                 EventInfo const* eventInfo,
+                                 TTree *tree_ptr,
+                                 TTree *outtree,
+                                 unsigned evt,
+                                 bool do_skim) {
+    bool passed = true;
+    for (unsigned module = 0; module < seq.size(); ++module) {
+      int status = seq[module]->Execute(&event_);
+      if (!PostModule(status)) {
+        if (notify_on_fail_) {
+          unsigned evt = eventInfo->event();
+          unsigned run = eventInfo->run();
+          if (notify_run_event_.find(std::make_pair(run,evt)) != notify_run_event_.end()) {
+          std::cout << "Run " << run << ", event " << evt << " rejected by module: " << seq[module]->ModuleName() << std::endl;
+          }
+        }
+        if (notify_evt_on_fail_) {
+          unsigned run = eventInfo->run();
+          unsigned evt = eventInfo->event();
+          if (notify_event_.find(evt) != notify_event_.end()) {
+          std::cout << "Run " << run << ", event " << evt << " rejected by module: " << seq[module]->ModuleName() << std::endl;
+          }
+        }
+        if (status == 1) {
+          passed = false;
+          break;
+        }
+      }
+      if (status == 0) seq[module]->IncreaseProcessedCount();
+      if (status == 0) yields[module] += eventInfo->total_weight();
+
+      if (do_skim && int(module) == skim_after_module_) {
+        tree_ptr->GetEntry(evt);
+        outtree->Fill();
+      }
+    }
+    return passed;
+  }
+
   void AnalysisBase::DoEventSetup() {
   }
 
@@ -58,11 +127,20 @@ namespace ic {
     TFile *file_ptr = NULL;
     TTree *tree_ptr = NULL;
     weighted_yields_.resize(modules_.size());
+    variation_yields_.resize(variation_modules_.size());
+    for (unsigned i = 0; i < variation_modules_.size(); ++i) {
+      variation_yields_[i].resize(variation_modules_[i].size());
+    }
     bool do_skim = (skim_path_ != "");
     if (do_skim) {
       std::cout << "Info in <ic::AnalysisBase>: Skimming mode enabled" << std::endl;
       if (skim_after_module_ < 0) skim_after_module_ = modules_.size() - 1;
     }
+    if (variation_modules_.size() > 0) {
+      std::cout << "Info in <ic::AnalysisBase>: Processing " << variation_modules_.size() << " variations in one pass:";
+      for (unsigned i = 0; i < variation_names_.size(); ++i) std::cout << " " << variation_names_[i];
+      std::cout << std::endl;
+    }
     if (ttree_caching_) std::cout << "Info in <ic::AnalysisBase>: TTree caching enabled" << std::endl;
   
     if (print_module_list_) {
@@ -72,12 +150,21 @@ namespace ic {
       for (unsigned i = 0; i < modules_.size(); ++i) {
         std::cout << modules_[i]->ModuleName() << std::endl;
       }
+      for (unsigned i = 0; i < variation_modules_.size(); ++i) {
+        std::cout << "[" << variation_names_[i] << "]" << std::endl;
+        for (unsigned j = 0; j < variation_modules_[i].size(); ++j) {
+          std::cout << variation_modules_[i][j]->ModuleName() << std::endl;
+        }
+      }
     }
     //std::for_each(modules_.begin(), modules_.end(), boost::bind(&ModuleBase::PrintInfo,_1));
     std::cout << "-------------------------------------" << std::endl;
     std::cout << "Pre-Analysis Module Output" << std::endl;
     std::cout << "-------------------------------------" << std::endl;
     std::for_each(modules_.begin(), modules_.end(), boost::bind(&ModuleBase::PreAnalysis,_1));
+    for (unsigned i = 0; i < variation_modules_.size(); ++i) {
+      std::for_each(variation_modules_[i].begin(), variation_modules_[i].end(), boost::bind(&ModuleBase::PreAnalysis,_1));
+    }
     std::cout << "-------------------------------------" << std::endl;
     std::cout << "Beginning Main Analysis Sequence" << std::endl;
     std::cout << "-------------------------------------" << std::endl;
@@ -132,17 +219,33 @@ namespace ic {
         std::cout << "-- " << input_file_paths_[file] << std::endl;
         TFile *outf = NULL;
         TTree *outtree = NULL;
+        std::vector<TFile *> var_outf(variation_modules_.size(), NULL);
+        std::vector<TTree *> var_outtree(variation_modules_.size(), NULL);
         if (do_skim) {
-          outf  = new TFile((skim_path_+out_name).c_str(), "RECREATE");
-          if (!outf->IsOpen()) {
-            std::cerr << "Error: Could not open output skim file for writing, an exception will be thrown" << std::endl;
-            throw;
+          for (unsigned var = 0; var <= variation_modules_.size(); ++var) {
+            std::string skim_folder = skim_path_;
+            if (var > 0) {
+              skim_folder = skim_path_ + variation_names_[var - 1] + "/";
+              boost::filesystem::create_directories(skim_folder);
+            }
+            TFile *f = new TFile((skim_folder+out_name).c_str(), "RECREATE");
+            if (!f->IsOpen()) {
+              std::cerr << "Error: Could not open output skim file for writing, an exception will be thrown" << std::endl;
+              throw;
+            }
+            f->cd();
+            gDirectory->mkdir(tree_path_.c_str());
+            gDirectory->cd(tree_path_.c_str());
+            TTree *t = tree_ptr->CloneTree(0);
+            std::cout << "----> " << skim_folder+out_name << std::endl;
+            if (var == 0) {
+              outf = f;
+              outtree = t;
+            } else {
+              var_outf[var - 1] = f;
+              var_outtree[var - 1] = t;
+            }
           }
-          outf->cd();
-          gDirectory->mkdir(tree_path_.c_str());
-          gDirectory->cd(tree_path_.c_str());
-          outtree = tree_ptr->CloneTree(0);
-          std::cout << "----> " << skim_path_+out_name << std::endl;
         }
 
         if (ttree_caching_) {
@@ -158,31 +261,18 @@ namespace ic {
           event_.SetEvent(evt);
           EventInfo const* eventInfo = event_.GetPtr<EventInfo>("eventInfo");
 
-          for (unsigned module = 0; module < modules_.size(); ++module) {
-            int status = modules_[module]->Execute(&event_);
-            if (!PostModule(status)) {
-              if (notify_on_fail_) {
-                unsigned evt = eventInfo->event();
-                unsigned run = eventInfo->run();
-                if (notify_run_event_.find(std::make_pair(run,evt)) != notify_run_event_.end()) {
-                std::cout << "Run " << run << ", event " << evt << " rejected by module: " << modules_[module]->ModuleName() << std::endl;
-                }
-              }
-              if (notify_evt_on_fail_) {
-                unsigned run = eventInfo->run();
-                unsigned evt = eventInfo->event();
-                if (notify_event_.find(evt) != notify_event_.end()) {
-                std::cout << "Run " << run << ", event " << evt << " rejected by module: " << modules_[module]->ModuleName() << std::endl;
-                }
+          bool passed = RunSequence(modules_, weighted_yields_, eventInfo, tree_ptr, outtree, evt, do_skim);
+          if (passed && variation_modules_.size() > 0) {
+            event_.Snapshot();
+            for (unsigned var = 0; var < variation_modules_.size(); ++var) {
+              if (var > 0) event_.Restore();
+              bool var_passed = RunSequence(variation_modules_[var], variation_yields_[var], eventInfo, tree_ptr, outtree, evt, false);
+              // Re-reading the entry overwrites in-place changes, but the
+              // next variation starts from a Restore anyway
+              if (do_skim && var_passed) {
+                tree_ptr->GetEntry(evt);
+                var_outtree[var]->Fill();
               }
-              if (status == 1) break;
-            }
-            if (status == 0) modules_[module]->IncreaseProcessedCount();
-            if (status == 0) weighted_yields_[module] += eventInfo->total_weight();
-
-            if (do_skim && module == skim_after_module_) {
-              tree_ptr->GetEntry(evt);
-              outtree->Fill();
             }
           }
           ++events_processed_;
@@ -198,6 +288,12 @@ namespace ic {
           if (outtree) outtree->Write();
           if (outf) outf->Close();
           delete outf;
+          for (unsigned var = 0; var < var_outf.size(); ++var) {
+            var_outf[var]->cd();
+            var_outtree[var]->Write();
+            var_outf[var]->Close();
+            delete var_outf[var];
+          }
         }
     }
     std::cout << "Processing Complete: " << events_processed_ << " events were processed." << std::endl;
@@ -207,7 +303,20 @@ namespace ic {
     for (unsigned i = 0; i < modules_.size(); ++i) {
       std::cout << boost::format("%-40s %-20s %-20s\n") % modules_[i]->ModuleName() % modules_[i]->EventsProcessed() % weighted_yields_[i];
     }
+    for (unsigned i = 0; i < variation_modules_.size(); ++i) {
+      std::cout << "[" << variation_names_[i] << "]" << std::endl;
+      for (unsigned j = 0; j < variation_modules_[i].size(); ++j) {
+        std::cout << boost::format("%-40s %-20s %-20s\n") % variation_modules_[i][j]->ModuleName() 
+          % variation_modules_[i][j]->EventsProcessed() % variation_yields_[i][j];
+      }
+    }
     std::for_each(modules_.begin(), modules_.end(), boost::bind(&ModuleBase::PostAnalysis,_1));
+    for (unsigned i = 0; i < variation_modules_.size(); ++i) {
+      std::for_each(variation_modules_[i].begin(), variation_modules_[i].end(), boost::bind(&ModuleBase::PostAnalysis,_1));
+    }
+    std::map<std::string, fwlite::TFileService *>::iterator fs_it;
+    for (fs_it = variation_fs_.begin(); fs_it != variation_fs_.end(); ++fs_it) delete fs_it->second;
+    variation_fs_.clear();
    return 0; 
   }
 
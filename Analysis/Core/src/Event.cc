@@ -24,10 +24,10 @@ namespace ic {
   }
 
   void Event::List() {
-    std::map<std::string, boost::any>::const_iterator it;
+    std::map<std::string, Product>::const_iterator it;
     for (it = products_.begin(); it != products_.end(); ++it) {
       int status;
-      std::string realname = abi::__cxa_demangle(it->second.type().name(), 0, 0, &status);
+      std::string realname = abi::__cxa_demangle(it->second.value.type().name(), 0, 0, &status);
       std::cout << boost::format("%-30s %-30s\n") % it->first % realname;
     }
   }
@@ -36,6 +36,32 @@ namespace ic {
     products_.clear();
   }
 
+  void Event::Snapshot() {
+    saved_products_ = products_;
+  }
+
+  void Event::Restore() {
+    std::map<std::string, Product>::iterator it = products_.begin();
+    std::map<std::string, Product>::const_iterator saved = saved_products_.begin();
+    // Both maps are sorted by name, so walk them together
+    while (it != products_.end() || saved != saved_products_.end()) {
+      if (saved == saved_products_.end() || (it != products_.end() && it->first < saved->first)) {
+        products_.erase(it++);
+      } else if (it == products_.end() || saved->first < it->first) {
+        products_.insert(it, *saved);
+        ++saved;
+      } else {
+        if (it->second.value.type() == saved->second.value.type()) {
+          saved->second.assign(it->second.value, saved->second.value);
+        } else {
+          it->second = saved->second;
+        }
+        ++it;
+        ++saved;
+      }
+    }
+  }
+
   unsigned int Event::Remove(std::string const& name) {
     if (!Exists(name)) {
       return 1;
@@ -15,6 +15,8 @@ namespace ic {
   void TreeEvent::SetEvent(unsigned event) {
     event_ = event;
     Clear();
+    loaded_.clear();
+    saved_.clear();
     for (unsigned i = 0; i < auto_add_funcs_.size(); ++i) {
       auto_add_funcs_[i](event);
     }
@@ -25,5 +27,19 @@ namespace ic {
     handlers_.clear();
     cached_funcs_.clear();
     auto_add_funcs_.clear();
+    loaded_.clear();
+    saved_.clear();
+  }
+
+  void TreeEvent::Snapshot() {
+    Event::Snapshot();
+    saved_ = loaded_;
+    for (unsigned i = 0; i < saved_.size(); ++i) saved_[i]->SaveState();
+  }
+
+  void TreeEvent::Restore() {
+    Event::Restore();
+    for (unsigned i = 0; i < saved_.size(); ++i) saved_[i]->RestoreState();
+    loaded_ = saved_;
   }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TriggerTable.h"
 #include <string>
 #include <fstream>
 
@@ -22,6 +23,7 @@ class HinvDataTriggerFilter : public ModuleBase {
 
   unsigned counter1_;
   unsigned counter2_;
+  TriggerTable table_;
 
 
  public:
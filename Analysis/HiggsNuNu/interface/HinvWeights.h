@@ -5,6 +5,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BTagWeight.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsNuNu/interface/HinvConfig.h"
 #include <string>
 #include "PhysicsTools/FWLite/interface/TFileService.h"
@@ -36,6 +37,10 @@ class HinvWeights : public ModuleBase {
   TH1F *hist_trigSF_METHLT;
   TH1F *hist_trigSF_MjjHLT;
   TH1F *hist_trigSF_JetHLT;
+  BinnedTable trigSF_METL1_;
+  BinnedTable trigSF_METHLT_;
+  BinnedTable trigSF_MjjHLT_;
+  BinnedTable trigSF_JetHLT_;
 
   TH1F *tighteleweight;
   TH1F *tightmuweight;
@@ -2,8 +2,11 @@
 #define ICHiggsTauTau_HiggsNuNu_JetMETModifier_h
 
 #include "UserCode/ICHiggsTauTau/interface/EventInfo.hh"
+#include "UserCode/ICHiggsTauTau/interface/PFJet.hh"
+#include "UserCode/ICHiggsTauTau/interface/GenJet.hh"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsNuNu/interface/JetSmearer.h"
 #include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
 #include "CondFormats/JetMETObjects/interface/JetCorrectionUncertainty.h"
 #include <cmath>
@@ -41,6 +44,13 @@ namespace ic {
     CLASS_MEMBER(JetMETModifier, bool, doaltmatch)
     CLASS_MEMBER(JetMETModifier, bool, dojerdebug)
     CLASS_MEMBER(JetMETModifier, std::string, jesuncfile)
+    // Book and fill the JES, Smear and ResMeasurement histograms
+    CLASS_MEMBER(JetMETModifier, bool, dodiagnostics)
+    // Further variations, e.g. "jesup" or "jerworse", produced in the same
+    // pass from the unmodified jets and added to the event as a collection
+    // of PFJet copies named input_label_variation and a Met named
+    // met_label_variation
+    CLASS_MEMBER(JetMETModifier, std::vector<std::string>, variations)
     TH2F* JEScorrfac;
     TH1F* JESmetdiff;
     TH1F* JESjetphidiff;
@@ -65,7 +75,14 @@ namespace ic {
     TH1F* runmetjetgenjetptratio;
     TH1F* icjetgenjetptratio;
 
+    JetSmearer smearer_;
+    JetSmearer::Variation variation_;
+    std::vector<JetSmearer::Variation> extra_variations_;
+    JetSmearer::Jets jets_;
+    std::vector<int> gen_index_;
+
     std::string pts[70];
+    std::vector<double> pt_edges_;
     TH1F* recogenjetptratio[5][70]; //BINNED JET 
     TGraphErrors* res[5]; 
     TF1* resfunc[5];
@@ -78,6 +95,9 @@ namespace ic {
     virtual int Execute(TreeEvent *event);
     virtual int PostAnalysis();
     virtual void PrintInfo();
+
+  private:
+    void FillDiagnostics(std::vector<GenJet *> const& genvec);
   };
   
 	  
@@ -0,0 +1,115 @@
+#ifndef ICHiggsTauTau_HiggsNuNu_JetSmearer_h
+#define ICHiggsTauTau_HiggsNuNu_JetSmearer_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
+
+class TF1;
+class JetCorrectionUncertainty;
+
+namespace ic {
+
+class EventInfo;
+
+//! Jet energy resolution smearing and JES/JER variations for a whole jet collection
+/*!
+  The jets are given as columns (see Jets) and every requested variation
+  is produced in the same pass over them: for each jet a pt and energy
+  scale factor, and for each variation the MET px and py after the change
+  in the jets is propagated.
+
+  Jets with a generator-level match are smeared with the data/MC
+  resolution ratio of their |eta| bin, either on pt (the JetMET twiki
+  method) or on Et as in the runMETUncertainties tool.  Jets without a
+  match are optionally smeared with a Gaussian of width
+  sqrt(c^2 - 1) * sigma_MC(pt), using one standard normal number per jet
+  from the CounterRandom stream (event, jet id, "jer").  The same number
+  is shared by all variations, so the result for one jet doesn't depend
+  on the other jets or on which variations are requested.
+
+  The JES variations are applied on top of the smearing of jes_base(),
+  kCentral by default, with the uncertainty evaluated at the smeared pt.
+*/
+class JetSmearer {
+ public:
+  enum Variation { kCentral, kJERBetter, kJERWorse, kJESUp, kJESDown, kNVariations };
+
+  //! The jet collection, one entry per jet in each column
+  struct Jets {
+    std::vector<double> px;
+    std::vector<double> py;
+    std::vector<double> pt;
+    std::vector<double> eta;
+    std::vector<double> energy;
+    std::vector<double> uncorrected_energy;
+    //! Negative for jets without a generator-level match
+    std::vector<double> gen_pt;
+    std::vector<double> gen_energy;
+    std::vector<std::size_t> id;
+
+    void clear();
+    inline std::size_t size() const { return pt.size(); }
+  };
+
+  JetSmearer();
+
+  //! "central", "jerbetter", "jerworse", "jesup" or "jesdown"
+  static std::string const& Name(Variation var);
+  //! Returns false if \a name isn't one of the names above
+  static bool FromName(std::string const& name, Variation * var);
+
+  //! The data/MC resolution ratio for |eta| bin \a eta_bin, 0 <= eta_bin < 5
+  static double JERFactor(Variation var, int eta_bin);
+  //! 0-4 for |eta| < 0.5, 1.1, 1.7, 2.3 and 5.0, and -1 beyond
+  static int EtaBin(double eta);
+
+  //! Apply resolution smearing at all.  If false only the JES
+  //! variations change the jets
+  inline void set_smear(bool smear) { smear_ = smear; }
+  //! Smear matched jets on Et instead of pt
+  inline void set_et_smear(bool et_smear) { et_smear_ = et_smear; }
+  //! Smear unmatched jets with a Gaussian
+  inline void set_gaus(bool gaus) { gaus_ = gaus; }
+  //! The MC resolution sigma(pt)/pt in \a eta_bin, needed with set_gaus
+  void set_resolution(int eta_bin, TF1 const* resolution);
+  inline void set_jes_uncertainty(JetCorrectionUncertainty * jes) { jes_ = jes; }
+  inline void set_jes_base(Variation base) { jes_base_ = base; }
+  inline Variation jes_base() const { return jes_base_; }
+
+  //! Produce \a var in every Run
+  void Request(Variation var);
+  inline bool requested(Variation var) const { return requested_[var]; }
+
+  //! Smear \a jets and propagate to the MET (\a met_px, \a met_py)
+  void Run(EventInfo const* info, Jets const& jets, double met_px, double met_py);
+
+  //! The scale factor of each jet for a requested variation
+  inline std::vector<double> const& scale(Variation var) const { return scale_[var]; }
+  inline double met_px(Variation var) const { return met_px_[var]; }
+  inline double met_py(Variation var) const { return met_py_[var]; }
+  //! The relative JES uncertainty of each jet, if kJESUp or kJESDown was requested
+  inline std::vector<double> const& jes_uncertainty(Variation var) const { return jes_unc_[var]; }
+
+ private:
+  double Smear(Jets const& jets, std::size_t i, int eta_bin, double jer_factor, double gaus) const;
+
+  bool smear_;
+  bool et_smear_;
+  bool gaus_;
+  TF1 const* resolution_[5];
+  JetCorrectionUncertainty * jes_;
+  Variation jes_base_;
+  bool requested_[kNVariations];
+
+  CounterRandom random_;
+  std::vector<double> scale_[kNVariations];
+  std::vector<double> jes_unc_[kNVariations];
+  double met_px_[kNVariations];
+  double met_py_[kNVariations];
+};
+
+}
+
+#endif
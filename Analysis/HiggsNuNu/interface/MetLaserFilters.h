@@ -6,55 +6,29 @@
 #include "UserCode/ICHiggsTauTau/interface/Candidate.hh"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsNuNu/interface/HinvPrint.h"
 
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/EventList.h"
+
 #include <string>
-#include <boost/algorithm/string.hpp>
-#include <set>
-#include "boost/functional/hash.hpp"
+#include <vector>
+#include <memory>
 
 namespace ic {
 
-  std::istream & operator>>(std::istream & is, RunLumiEvent & evt){
-    std::string lLine;
-    is>>lLine;
-    std::vector<std::string> lVec;
-    boost::split(lVec, lLine, boost::is_any_of(":"));
-    if (lLine.size()< 6) return is;
-    if (lVec.size() != 3) {
-      std::cout << "---- Error reading laser filter file! String is: " << lLine << ", expect run:lumiBlock:event. Quitting..." << std::endl;
-      throw;
-    }
-    else {
-      std::istringstream(lVec[0])>>evt.run; 
-      std::istringstream(lVec[1])>>evt.lumi;
-      std::istringstream(lVec[2])>>evt.evt;
-    } 
-    return is; 
-  }
-
-  typedef std::set <RunLumiEvent> evtsArray;
-
-  std::istream & operator>>(std::istream & is, evtsArray & evtSet){
-
-    RunLumiEvent temp; 
-    while(1){
-      is>>temp; 
-      if(is.eof()){
-	break; 
-      }
-      evtSet.insert(temp);
-    }
-    return is; 
-  }
- 
   class MetLaserFilters : public ModuleBase {
   private:
     std::string hcal_input_name_;
     std::string ecal_input_name_;
     bool doFilters_;
+    std::string cache_dir_;
     
-    evtsArray badEvts_;
+    // The bad event lists, and which of their events have already been
+    // vetoed: each listed event is only vetoed the first time it is seen
+    std::shared_ptr<EventList> hcal_list_;
+    std::shared_ptr<EventList> ecal_list_;
+    std::vector<bool> hcal_vetoed_;
+    std::vector<bool> ecal_vetoed_;
 
-    bool extractEvents(std::string inputfile);
+    bool extractEvents(std::string inputfile, std::shared_ptr<EventList> & list);
 
   public:
     MetLaserFilters(std::string const& name, 
@@ -63,6 +37,14 @@ namespace ic {
 		    bool doFilters);
     virtual ~MetLaserFilters();
 
+    //! Keep binary copies of the lists in \a cache_dir, which are mapped
+    //! rather than parsed by later jobs.  By default the lists are read
+    //! into memory and nothing is written
+    inline MetLaserFilters & set_cache_dir(std::string const& cache_dir) {
+      cache_dir_ = cache_dir;
+      return *this;
+    }
+
     virtual int PreAnalysis();
     virtual int Execute(TreeEvent *event);
     virtual int PostAnalysis();
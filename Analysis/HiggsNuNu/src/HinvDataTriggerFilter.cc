@@ -32,6 +32,8 @@ namespace ic {
     std::cout << "Require match to HLT object: " << is_data_ << std::endl;
     std::cout << "Trigger path : " << trigger_path_ << std::endl;
     std::cout << "Trigger object label : " << trig_obj_label_ << std::endl;
+    table_ = TriggerTable();
+    table_.AddPath(0, TriggerTable::kMaxRun, trigger_path_);
     return 0;
   }
 
@@ -47,11 +49,7 @@ namespace ic {
       EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
       unsigned run = eventInfo->run();
  
-      for (unsigned i = 0; i < triggerPathPtrVec.size(); ++i) {
-	std::string name = triggerPathPtrVec[i]->name();
-	triggerPathPtrVec[i]->prescale();
-	if (name.find(trigger_path_) != name.npos) path_found = true; 
-      }
+      path_found = table_.Match(run, triggerPathPtrVec) & TriggerTable::kPath;
 
       //if ( (objs.size()== 0) && path_found ) counter1_++;
       //if ( (objs.size() > 0) && !path_found ) counter2_++;
@@ -152,6 +152,10 @@ namespace ic {//namespace
       }
       std::cout	<< std::endl;
     }
+    trigSF_METL1_  = BinnedTable(hist_trigSF_METL1);
+    trigSF_METHLT_ = BinnedTable(hist_trigSF_METHLT);
+    trigSF_MjjHLT_ = BinnedTable(hist_trigSF_MjjHLT);
+    trigSF_JetHLT_ = BinnedTable(hist_trigSF_JetHLT);
 
     if(!do_idiso_err_){
       fillVector("data/scale_factors/ele_tight_id.txt",eTight_idisoSF_);
@@ -251,27 +255,16 @@ namespace ic {//namespace
     Met const* metHLT = event->GetPtr<Met>(input_met_);
     Met const* metL1 = event->GetPtr<Met>("metNoMuons");
     
-    double lValue = metL1->pt();
-    double lMax = hist_trigSF_METL1->GetXaxis()->GetBinCenter(hist_trigSF_METL1->GetNbinsX());
-    double lMin = hist_trigSF_METL1->GetXaxis()->GetBinCenter(1);
-    if (lValue > lMax)  lValue = lMax;
-    if (lValue < lMin)  lValue = lMin;
-    int lBin = hist_trigSF_METL1->GetXaxis()->FindFixBin(lValue);
-    double metl1 = hist_trigSF_METL1->GetBinContent(lBin);
+    // Values outside the histograms take the first or last bin
+    double metl1 = trigSF_METL1_.GetValue(trigSF_METL1_.FindBinClamped(metL1->pt()));
     if (do_trg_weights_) eventInfo->set_weight("trig_metL1",metl1);
     else eventInfo->set_weight("!trig_metL1",metl1);
-    //std::cout << " -- MET L1 " << lValue << " " << metl1 << std::endl;
-
-    lValue = metHLT->pt();
-    lMax = hist_trigSF_METHLT->GetXaxis()->GetBinCenter(hist_trigSF_METHLT->GetNbinsX());
-    lMin = hist_trigSF_METHLT->GetXaxis()->GetBinCenter(1);
-    if (lValue > lMax)  lValue = lMax;
-    if (lValue < lMin)  lValue = lMin;
-    lBin = hist_trigSF_METHLT->GetXaxis()->FindFixBin(lValue);
-    double methlt = hist_trigSF_METHLT->GetBinContent(lBin);
+    //std::cout << " -- MET L1 " << metL1->pt() << " " << metl1 << std::endl;
+
+    double methlt = trigSF_METHLT_.GetValue(trigSF_METHLT_.FindBinClamped(metHLT->pt()));
     if (do_trg_weights_) eventInfo->set_weight("trig_metHLT",methlt);
     else eventInfo->set_weight("!trig_metHLT",methlt);
-    //std::cout << " -- MET HLT " << lValue << " " << methlt << std::endl;
+    //std::cout << " -- MET HLT " << metHLT->pt() << " " << methlt << std::endl;
 
     double mjjhlt = 1.0;
     double jet1hlt = 1.0;
@@ -286,36 +279,20 @@ namespace ic {//namespace
       Candidate const* jet1 = dijet->GetCandidate("jet1");
       Candidate const* jet2 = dijet->GetCandidate("jet2");
       
-      lValue = dijet->M();
-      lMax = hist_trigSF_MjjHLT->GetXaxis()->GetBinCenter(hist_trigSF_MjjHLT->GetNbinsX());
-      lMin = hist_trigSF_MjjHLT->GetXaxis()->GetBinCenter(1);
-      if (lValue > lMax)  lValue = lMax;
-      if (lValue < lMin)  lValue = lMin;
-      lBin = hist_trigSF_MjjHLT->GetXaxis()->FindFixBin(lValue);
-      mjjhlt = hist_trigSF_MjjHLT->GetBinContent(lBin);
+      mjjhlt = trigSF_MjjHLT_.GetValue(trigSF_MjjHLT_.FindBinClamped(dijet->M()));
       if (do_trg_weights_) eventInfo->set_weight("trig_mjjHLT",mjjhlt);
       else eventInfo->set_weight("!trig_mjjHLT",mjjhlt);
-      //std::cout << " -- Mjj HLT " << lValue << " " << mjjhlt << std::endl;
+      //std::cout << " -- Mjj HLT " << dijet->M() << " " << mjjhlt << std::endl;
       
-      lMax = hist_trigSF_JetHLT->GetXaxis()->GetBinCenter(hist_trigSF_JetHLT->GetNbinsX());
-      lMin = hist_trigSF_JetHLT->GetXaxis()->GetBinCenter(1);
-      lValue = jet1->pt();
-      if (lValue < lMin)  lValue = lMin;
-      if (lValue > lMax)  lValue = lMax;
-      lBin = hist_trigSF_JetHLT->GetXaxis()->FindFixBin(lValue);
-      jet1hlt = hist_trigSF_JetHLT->GetBinContent(lBin);
+      jet1hlt = trigSF_JetHLT_.GetValue(trigSF_JetHLT_.FindBinClamped(jet1->pt()));
       if (do_trg_weights_) eventInfo->set_weight("trig_jet1HLT",jet1hlt);
       else eventInfo->set_weight("!trig_jet1HLT",jet1hlt);
-      //std::cout << " -- Jet1 HLT " << lValue << " " << jet1hlt << std::endl;
+      //std::cout << " -- Jet1 HLT " << jet1->pt() << " " << jet1hlt << std::endl;
       
-      lValue = jet2->pt();
-      if (lValue > lMax)  lValue = lMax;
-      if (lValue < lMin)  lValue = lMin;
-      lBin = hist_trigSF_JetHLT->GetXaxis()->FindFixBin(lValue);
-      jet2hlt = hist_trigSF_JetHLT->GetBinContent(lBin);
+      jet2hlt = trigSF_JetHLT_.GetValue(trigSF_JetHLT_.FindBinClamped(jet2->pt()));
       if (do_trg_weights_) eventInfo->set_weight("trig_jet2HLT",jet2hlt);
       else eventInfo->set_weight("!trig_jet2HLT",jet2hlt);
-      //std::cout << " -- Jet2 HLT " << lValue << " " << jet2hlt << std::endl;
+      //std::cout << " -- Jet2 HLT " << jet2->pt() << " " << jet2hlt << std::endl;
 
       //weight *= (ele_trg * tau_trg);
       //event->Add("trigweight_1", ele_trg);
@@ -5,7 +5,6 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnPairs.h"
 #include <utility>
 #include <algorithm>
-#include "TRandom3.h"
 #include <sstream>
 #include <string>
 #include <iostream>
@@ -25,6 +24,7 @@ namespace ic {
     doetsmear_=false;
     doaltmatch_=false;
     dojerdebug_=false;
+    dodiagnostics_=false;
   }
 
   JetMETModifier::~JetMETModifier() {
@@ -79,36 +79,29 @@ namespace ic {
     total = new JetCorrectionUncertainty(*(new JetCorrectorParameters(jesuncfile_)));
     
     std::cout<<"Got parameters successfully"<<std::endl;
-    TFileDirectory const& dir = fs_->mkdir("JES");
-    TFileDirectory const& dir2 = fs_->mkdir("Smear");
-    TFileDirectory const& dir3 = fs_->mkdir("RunMetComparison");
-    TFileDirectory const& dir4 = fs_->mkdir("ResMeasurement");
-    std::cout<<"Made plot dir"<<std::endl;
-    JEScorrfac = dir.make<TH2F>("JEScorrfac","JEScorrfac",1000,0.,1000.,1000,-0.3,0.3);
-    JESmetdiff = dir.make<TH1F>("JESmetdiff","JESmetdiff",1000,-10.,10.);
-    JESjetphidiff = dir.make<TH1F>("JESjetphidiff","JESjetphidiff",1000,-10.,10.);
-    JESjetetadiff = dir.make<TH1F>("JESjetetadiff","JESjetetadiff",1000,-10.,10.);
-    JESisordersame = dir.make<TH1F>("JESisordersame","JESisordersame",40,-10.,10.);
-    Smearptdiff = dir2.make<TH1F>("Smearptdiff","Smearptdiff",2000,-10.,10.);
-    Smear50miss = dir2.make<TH1F>("Smear50miss","Smear50miss",20,-10.,10.);
-    Smearjetgenjetptdiff = dir2.make<TH1F>("Smearjetgenjetptdiff","Smearjetgenjetptdiff",600,-30.,30.);
-    Smeargenmindr = dir2.make<TH1F>("Smeargenmindr","Smeargenmindr",1000,0.,10.);
-    Smearjetgenjetptratio = dir2.make<TH1F>("Smearjetgenjetptratio","Smearjetgenjetptratio",100,0.,10.);
-    Smearjetgenjetptratioetabin = dir2.make<TH2F>("Smearjetgenjetptratioetabin","Smearjetgenjetptratioetabin",100,0.,10.,100,-5.,5.);
-    
-    //Runmetunccomparisons
-    icjetrunmetjetptdiff = dir3.make<TH1F>("icjetrunmetjetptdiff","icjetrunmetjetptdiff",600,-30.,30.);
-    icjetrunmetjetptratio = dir3.make<TH1F>("icjetrunmetjetptratio","icjetrunmetjetptratio",10100,0.,10.1);
-    icjetnosmearptratio = dir3.make<TH1F>("icjetnosmearptratio","icjetnosmearptratio",10100,0.,10.1);
-    runmetjetnosmearptratio = dir3.make<TH1F>("runmetjetnosmearptratio","runmetjetnosmearptratio",10100,0.,10.1);
-    runmetjetgenjetptratio = dir3.make<TH1F>("runmetjetgenjetptratio","runmetjetgenjetptratio",10100,0.,10.1);
-    icjetgenjetptratio = dir3.make<TH1F>("icjetgenjetptratio","icjetgenjetptratio",10100,0.,10.1);
-    icjetpt = dir3.make<TH1F>("icjetpt","icjetpt",10000,0.,1000.);
-    runmetjetpt = dir3.make<TH1F>("runmetjetpt","runmetjetpt",10000,0.,1000.);
-    nojerjetpt = dir3.make<TH1F>("nojerjetpt","nojerjetpt",10000,0.,1000.);
-    matchedicjetpt = dir3.make<TH1F>("matchedicjetpt","matchedicjetpt",10000,0.,1000.);
-    matchedrunmetjetpt = dir3.make<TH1F>("matchedrunmetjetpt","matchedrunmetjetpt",10000,0.,1000.);
-    matchednojerjetpt = dir3.make<TH1F>("matchednojerjetpt","matchednojerjetpt",10000,0.,1000.);
+
+    //Set up the smearing for the configured variation and any extra ones
+    JetSmearer::Variation jer_variation = JetSmearer::kCentral;
+    if(dojersyst_) jer_variation = jerbetterorworse_ ? JetSmearer::kJERBetter : JetSmearer::kJERWorse;
+    if(dojessyst_) variation_ = jesupordown_ ? JetSmearer::kJESUp : JetSmearer::kJESDown;
+    else variation_ = jer_variation;
+    smearer_.set_smear(dosmear_);
+    smearer_.set_et_smear(doetsmear_);
+    smearer_.set_gaus(dogaus_);
+    smearer_.set_jes_uncertainty(total);
+    smearer_.set_jes_base(jer_variation);
+    smearer_.Request(variation_);
+    extra_variations_.clear();
+    for(unsigned i=0;i<variations_.size();i++){
+      JetSmearer::Variation var;
+      if(!JetSmearer::FromName(variations_[i],&var)){
+	std::cerr << "Error in <ic::JetMETModifier>: Unknown variation " << variations_[i] << ", an exception will be thrown" << std::endl;
+	throw;
+      }
+      std::cout<<"Also doing "<<variations_[i]<<" as ["<<input_label_<<"_"<<variations_[i]<<"] and ["<<met_label_<<"_"<<variations_[i]<<"]"<<std::endl;
+      smearer_.Request(var);
+      extra_variations_.push_back(var);
+    }
 
     //Jet resolution measurements
     int npts = 70;
@@ -118,7 +111,8 @@ namespace ic {
     //std::string etas[10]={"0p0-0p5","0p5-1p0","1p0-1p5","1p5-2p0","2p0-2p5","2p5-3p0","3p0-3p5","3p5-4p0","4p0-4p5","4p5-9p9"};
     //std::string pts[13]={"0-20","20-40","40-60","60-80","80-100","100-120","120-140","140-160","160-180","180-200","200-250","250-300","300-inf"};
 
-    //Set pts
+    //Set pts and the bin edges, the last bin ends at 999999
+    pt_edges_.clear();
     for(int i=0;i<60;i++){
       std::ostringstream convert;
       convert << i;
@@ -127,6 +121,7 @@ namespace ic {
       convert2 << (i+1);
       std::string binhigh=convert2.str();
       pts[i]=(binlow+"-"+binhigh);
+      pt_edges_.push_back(i);
     } 
     for(int i=60;i<67;i++){
       std::ostringstream convert;
@@ -136,21 +131,62 @@ namespace ic {
       convert2 << ((i-59)*20)+60;
       std::string binhigh=convert2.str();
       pts[i]=(binlow+"-"+binhigh);
+      pt_edges_.push_back(((i-60)*20)+60);
     }
     pts[67]="200-250";
     pts[68]="250-300";
     pts[69]="300-inf";
+    pt_edges_.push_back(200.);
+    pt_edges_.push_back(250.);
+    pt_edges_.push_back(300.);
+    pt_edges_.push_back(999999.);
 
-    for(int i =0;i<netas;i++){
-      for(int j=0;j<npts;j++){
-	recogenjetptratio[i][j] = dir4.make<TH1F>(("recogenjetptratio_"+etas[i]+"_"+pts[j]).c_str(),("recogenjetptratio_"+etas[i]+"_"+pts[j]).c_str(),300,0.,3.);
+    if(dodiagnostics_){
+      TFileDirectory const& dir = fs_->mkdir("JES");
+      TFileDirectory const& dir2 = fs_->mkdir("Smear");
+      TFileDirectory const& dir4 = fs_->mkdir("ResMeasurement");
+      std::cout<<"Made plot dir"<<std::endl;
+      JEScorrfac = dir.make<TH2F>("JEScorrfac","JEScorrfac",1000,0.,1000.,1000,-0.3,0.3);
+      JESmetdiff = dir.make<TH1F>("JESmetdiff","JESmetdiff",1000,-10.,10.);
+      JESjetphidiff = dir.make<TH1F>("JESjetphidiff","JESjetphidiff",1000,-10.,10.);
+      JESjetetadiff = dir.make<TH1F>("JESjetetadiff","JESjetetadiff",1000,-10.,10.);
+      JESisordersame = dir.make<TH1F>("JESisordersame","JESisordersame",40,-10.,10.);
+      Smearptdiff = dir2.make<TH1F>("Smearptdiff","Smearptdiff",2000,-10.,10.);
+      Smear50miss = dir2.make<TH1F>("Smear50miss","Smear50miss",20,-10.,10.);
+      Smearjetgenjetptdiff = dir2.make<TH1F>("Smearjetgenjetptdiff","Smearjetgenjetptdiff",600,-30.,30.);
+      Smeargenmindr = dir2.make<TH1F>("Smeargenmindr","Smeargenmindr",1000,0.,10.);
+      Smearjetgenjetptratio = dir2.make<TH1F>("Smearjetgenjetptratio","Smearjetgenjetptratio",100,0.,10.);
+      Smearjetgenjetptratioetabin = dir2.make<TH2F>("Smearjetgenjetptratioetabin","Smearjetgenjetptratioetabin",100,0.,10.,100,-5.,5.);
+      for(int i =0;i<netas;i++){
+	for(int j=0;j<npts;j++){
+	  recogenjetptratio[i][j] = dir4.make<TH1F>(("recogenjetptratio_"+etas[i]+"_"+pts[j]).c_str(),("recogenjetptratio_"+etas[i]+"_"+pts[j]).c_str(),300,0.,3.);
+	}
       }
     }
+
+    if(dojerdebug_){
+      //Runmetunccomparisons
+      TFileDirectory const& dir3 = fs_->mkdir("RunMetComparison");
+      icjetrunmetjetptdiff = dir3.make<TH1F>("icjetrunmetjetptdiff","icjetrunmetjetptdiff",600,-30.,30.);
+      icjetrunmetjetptratio = dir3.make<TH1F>("icjetrunmetjetptratio","icjetrunmetjetptratio",10100,0.,10.1);
+      icjetnosmearptratio = dir3.make<TH1F>("icjetnosmearptratio","icjetnosmearptratio",10100,0.,10.1);
+      runmetjetnosmearptratio = dir3.make<TH1F>("runmetjetnosmearptratio","runmetjetnosmearptratio",10100,0.,10.1);
+      runmetjetgenjetptratio = dir3.make<TH1F>("runmetjetgenjetptratio","runmetjetgenjetptratio",10100,0.,10.1);
+      icjetgenjetptratio = dir3.make<TH1F>("icjetgenjetptratio","icjetgenjetptratio",10100,0.,10.1);
+      icjetpt = dir3.make<TH1F>("icjetpt","icjetpt",10000,0.,1000.);
+      runmetjetpt = dir3.make<TH1F>("runmetjetpt","runmetjetpt",10000,0.,1000.);
+      nojerjetpt = dir3.make<TH1F>("nojerjetpt","nojerjetpt",10000,0.,1000.);
+      matchedicjetpt = dir3.make<TH1F>("matchedicjetpt","matchedicjetpt",10000,0.,1000.);
+      matchedrunmetjetpt = dir3.make<TH1F>("matchedrunmetjetpt","matchedrunmetjetpt",10000,0.,1000.);
+      matchednojerjetpt = dir3.make<TH1F>("matchednojerjetpt","matchednojerjetpt",10000,0.,1000.);
+    }
+
     TFile *resin=new TFile("data/MCres/MCresolutions.root","read");
     for(int i=0;i<netas;i++){
       resin->GetObject(("resforeta"+etas[i]).c_str(),res[i]);
       resin->GetObject(("resfuncforeta"+etas[i]).c_str(),resfunc[i]);
       resin->GetObject(("spring10resforeta"+etas[i]).c_str(),spring10resfunc[i]);
+      smearer_.set_resolution(i, dospring10gaus_ ? spring10resfunc[i] : resfunc[i]);
     }
     return 0;
   }
@@ -159,374 +195,300 @@ namespace ic {
     if(is_data_){
       return 0;
     }
-    else{
-      //GET MET AND JET COLLECTIONS
-      std::vector<PFJet *> & vec = event->GetPtrVec<PFJet>(input_label_);//Main jet collection
-      std::vector<GenJet *> & genvec = event->GetPtrVec<GenJet>("genJets");//GenJet collection, note: could make this a parameter but we only have one collection at the moment in the ntuples
-      std::vector<GenParticle*> const& taus = event->GetPtrVec<GenParticle>("genParticlesTaus");//Tau Collection
-      Met *met = event->GetPtr<Met>(met_label_);//MET collection
-      ROOT::Math::PxPyPzEVector  oldmet = ROOT::Math::PxPyPzEVector(met->vector());
-      ROOT::Math::PxPyPzEVector  newmet = oldmet;
-
-      //GET RUNMETUNCS COLLECTIONS FOR COMPARISON
-      std::vector<ic::Candidate *> runmetuncvec;
-      std::vector< std::pair<PFJet*, ic::Candidate*> > jet_runmetjet_pairs;
-      if(dojerdebug_){
-	runmetuncvec = event->GetPtrVec<ic::Candidate>("jetsmearedcentralJets");//Main jet collection
-	for (int i = 0; unsigned(i) < runmetuncvec.size(); ++i) {//loop over the runmetjet collection
-	  runmetjetpt->Fill(runmetuncvec[i]->vector().pt());
-	}
-	//MATCH RUNMETUNCS JETS	
-	jet_runmetjet_pairs = MatchByDR(vec,runmetuncvec,0.5,true,true);
+    //GET MET AND JET COLLECTIONS
+    std::vector<PFJet *> & vec = event->GetPtrVec<PFJet>(input_label_);//Main jet collection
+    std::vector<GenJet *> & genvec = event->GetPtrVec<GenJet>("genJets");//GenJet collection, note: could make this a parameter but we only have one collection at the moment in the ntuples
+    Met *met = event->GetPtr<Met>(met_label_);//MET collection
+    EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
+    ROOT::Math::PxPyPzEVector  oldmet = ROOT::Math::PxPyPzEVector(met->vector());
+
+    //GET RUNMETUNCS COLLECTIONS FOR COMPARISON
+    std::vector<ic::Candidate *> runmetuncvec;
+    std::vector< std::pair<PFJet*, ic::Candidate*> > jet_runmetjet_pairs;
+    if(dojerdebug_){
+      runmetuncvec = event->GetPtrVec<ic::Candidate>("jetsmearedcentralJets");//Main jet collection
+      for (int i = 0; unsigned(i) < runmetuncvec.size(); ++i) {//loop over the runmetjet collection
+	runmetjetpt->Fill(runmetuncvec[i]->vector().pt());
       }
+      //MATCH RUNMETUNCS JETS	
+      jet_runmetjet_pairs = MatchByDR(vec,runmetuncvec,0.5,true,true);
+    }
       
-      //MATCH GEN JETS
-      std::vector< std::pair<PFJet*, GenJet*> > jet_genjet_pairs;
-
-      if(!doaltmatch_)jet_genjet_pairs = MatchByDR(vec,genvec,0.5,true,true);//TWIKI METHOD
-      else{//RUNMETUNCERTAINTIES METHOD
-	std::vector< std::pair<PFJet*,GenJet*> > pairVec = MakePairs(vec,genvec);//Make all possible pairs
-	std::vector< std::pair<PFJet*,GenJet*> > filteredpairVec;
-	for(int g =0;unsigned(g)<pairVec.size();g++){//Filter pairs with too large a dr separation
-	  double dr=sqrt( (pairVec[g].first->eta()-pairVec[g].second->eta())*(pairVec[g].first->eta()-pairVec[g].second->eta()) + (pairVec[g].first->phi()-pairVec[g].second->phi())*(pairVec[g].first->phi()-pairVec[g].second->phi()) );
-	  if(dr<std::min(0.5,0.3+0.1*exp(-0.05*pairVec[g].second->pt()))) filteredpairVec.push_back(pairVec[g]);
+    //MATCH GEN JETS
+    std::vector< std::pair<PFJet*, GenJet*> > jet_genjet_pairs;
+
+    if(!doaltmatch_)jet_genjet_pairs = MatchByDR(vec,genvec,0.5,true,true);//TWIKI METHOD
+    else{//RUNMETUNCERTAINTIES METHOD
+      std::vector< std::pair<PFJet*,GenJet*> > pairVec = MakePairs(vec,genvec);//Make all possible pairs
+      std::vector< std::pair<PFJet*,GenJet*> > filteredpairVec;
+      for(int g =0;unsigned(g)<pairVec.size();g++){//Filter pairs with too large a dr separation
+	double dr=sqrt( (pairVec[g].first->eta()-pairVec[g].second->eta())*(pairVec[g].first->eta()-pairVec[g].second->eta()) + (pairVec[g].first->phi()-pairVec[g].second->phi())*(pairVec[g].first->phi()-pairVec[g].second->phi()) );
+	if(dr<std::min(0.5,0.3+0.1*exp(-0.05*pairVec[g].second->pt()))) filteredpairVec.push_back(pairVec[g]);
+      }
+      std::sort(filteredpairVec.begin(), filteredpairVec.end(), DRCompare<PFJet*,GenJet*>);//sort the pairs by dr
+      //get the vector of unique pairs choosing the pairs with the smallest dr separation
+      std::vector<PFJet*> fVec;
+      std::vector<GenJet*> sVec;
+      std::pair<PFJet*,GenJet*> aPair;
+      BOOST_FOREACH(aPair, pairVec) {
+	bool inFVec = std::count(fVec.begin(),fVec.end(),aPair.first);
+	bool inSVec = std::count(sVec.begin(),sVec.end(),aPair.second);
+	if (!inFVec && !inSVec) {
+	  jet_genjet_pairs.push_back(aPair);
+	  fVec.push_back(aPair.first);
+	  sVec.push_back(aPair.second);
 	}
-	std::sort(filteredpairVec.begin(), filteredpairVec.end(), DRCompare<PFJet*,GenJet*>);//sort the pairs by dr
-	//get the vector of unique pairs choosing the pairs with the smallest dr separation
-	std::vector<PFJet*> fVec;
-	std::vector<GenJet*> sVec;
-	std::pair<PFJet*,GenJet*> aPair;
-        BOOST_FOREACH(aPair, pairVec) {
-          bool inFVec = std::count(fVec.begin(),fVec.end(),aPair.first);
-          bool inSVec = std::count(sVec.begin(),sVec.end(),aPair.second);
-          if (!inFVec && !inSVec) {
-            jet_genjet_pairs.push_back(aPair);
-            fVec.push_back(aPair.first);
-            sVec.push_back(aPair.second);
-          }
-        }
       }
+    }
 
-      //Find closest gen jet to each jet
-      for (int i = 0; unsigned(i) < vec.size(); ++i) {//loop over the jet collection
-	double jeteta=vec[i]->vector().eta();
-	double jetphi=vec[i]->vector().phi();
-	double mindr=999;
-	for(int j = 0;unsigned(j)<genvec.size();j++){
-	  double dr = sqrt((jeteta-genvec[j]->vector().eta())*(jeteta-genvec[j]->vector().eta())+(jetphi-genvec[j]->vector().phi())*(jetphi-genvec[j]->vector().phi()));
-	  if(dr<mindr){
-	    mindr=dr;
-	  }
+    //Fill the jet columns, with the gen jet match of each jet
+    jets_.clear();
+    gen_index_.assign(vec.size(), -1);
+    for (unsigned i = 0; i < vec.size(); ++i) {
+      for(unsigned j = 0;j<jet_genjet_pairs.size();j++){
+	if(jet_genjet_pairs[j].first->id()==vec[i]->id()){
+	  gen_index_[i] = j;
+	  break;
 	}
-	Smeargenmindr->Fill(mindr);
       }
+      ROOT::Math::PxPyPzEVector jet = ROOT::Math::PxPyPzEVector(vec[i]->vector());
+      jets_.px.push_back(jet.px());
+      jets_.py.push_back(jet.py());
+      jets_.pt.push_back(jet.pt());
+      jets_.eta.push_back(jet.eta());
+      jets_.energy.push_back(jet.energy());
+      jets_.uncorrected_energy.push_back(vec[i]->uncorrected_energy());
+      jets_.gen_pt.push_back(gen_index_[i] != -1 ? jet_genjet_pairs[gen_index_[i]].second->pt() : -1.);
+      jets_.gen_energy.push_back(gen_index_[i] != -1 ? jet_genjet_pairs[gen_index_[i]].second->energy() : -1.);
+      jets_.id.push_back(vec[i]->id());
+    }
 
-      //initialise variables for finding highest two pt jets      
-      double oldjet1pt = -1.;
-      double oldjet2pt = -1.;
-      int oldjet1index = -1;
-      int oldjet2index = -1;
-      double newjet1pt = -1.;
-      double newjet2pt = -1.;
-      int newjet1index = -1;
-      int newjet2index = -1;
-      
-      for (int i = 0; unsigned(i) < vec.size(); ++i) {//LOOP OVER JET COLLECTION
-	//Get jet information
-	ROOT::Math::PxPyPzEVector  oldjet = ROOT::Math::PxPyPzEVector(vec[i]->vector());
-	ROOT::Math::PxPyPzEVector  newjet;
-
-	int index = -1;
-	//Check for matches between reco and gen jets
-	for(int j = 0;unsigned(j)<jet_genjet_pairs.size();j++){
-	  if(jet_genjet_pairs[j].first->id()==vec[i]->id()){
-	    index = j;
+    //SMEARING AND JES FOR ALL VARIATIONS
+    smearer_.Run(eventInfo, jets_, oldmet.px(), oldmet.py());
+    std::vector<double> const& scale = smearer_.scale(variation_);
+    std::vector<double> const& smearscale = smearer_.scale(smearer_.jes_base());
+
+    if(dodiagnostics_) FillDiagnostics(genvec);
+    if(dojerdebug_){
+      for (unsigned i = 0; i < vec.size(); ++i) {
+	//Get runmetuncjet matching icjet
+	int runmetindex = -1;
+	for(int j = 0;unsigned(j)<jet_runmetjet_pairs.size();j++){
+	  if(jet_runmetjet_pairs[j].first->id()==vec[i]->id()){
+	    runmetindex = j;
 	    break;
 	  }
 	}
-
-	
-	//MAKE PLOTS FOR RESOLUTION MEASUREMENT
-	if(index!=-1){
-	  int ipt=-1;
-	  int ieta=-1;
-	  double pt=oldjet.pt();
-	  double eta=oldjet.eta();
-
-	  //GET PT BIN
-	  double binedges[70][2];
-	  for(int m=0;m<70;m++){
-	    std::string s=pts[m];
-	    std::string delimiter = "-";
-	    size_t pos = 0;
-	    std::string token;
-	    pos = s.find(delimiter);
-	    token = s.substr(0, pos);
-	    if(token=="inf"){
-	      token="999999";//SET INF BEHAVIOUR                                                                                                
-	    }
-	    binedges[m][0]=atof(token.c_str());
-	    s.erase(0, pos + delimiter.length());
-	    if(s=="inf"){
-	      s="999999";//SET INF BIN BEHAVIOUR
-	    }
-	    binedges[m][1]=atof(s.c_str());
-	  }
-	  for(int m=0;m<70;m++){
-	    if(pt>=binedges[m][0]){
-	      if(pt<binedges[m][1]){
-		ipt=m;
-		break;
-	      }
-	    }
-	  }
-	  if(ipt==-1)std::cout<<"problem with jet pt value"<<std::endl;
-	  
-// 	  if     (pt<20)           ipt=0;
-// 	  else if((20<=pt)&&(pt<40))   ipt=1;
-// 	  else if((40<=pt)&&(pt<60))   ipt=2;
-// 	  else if((60<=pt)&&(pt<80))   ipt=3;
-// 	  else if((80<=pt)&&(pt<100))  ipt=4;
-// 	  else if((100<=pt)&&(pt<120)) ipt=5;
-// 	  else if((120<=pt)&&(pt<140)) ipt=6;
-// 	  else if((140<=pt)&&(pt<160)) ipt=7;
-// 	  else if((160<=pt)&&(pt<180)) ipt=8;
-// 	  else if((180<=pt)&&(pt<200)) ipt=9;
-// 	  else if((200<=pt)&&(pt<250)) ipt=10;
-// 	  else if((250<=pt)&&(pt<300)) ipt=11;
-// 	  else if(300<=pt)         ipt=12;
-// 	  else std::cout<<"problem with jet pt value"<<std::endl;
-
-	  //GET ETA BIN
- 	  if     ((2.3<fabs(eta))&&(fabs(eta)<=5))   ieta=4;
- 	  else if((1.7<fabs(eta))&&(fabs(eta)<=2.3)) ieta=3;
- 	  else if((1.1<fabs(eta))&&(fabs(eta)<=1.7)) ieta=2;
- 	  else if((0.5<fabs(eta))&&(fabs(eta)<=1.1)) ieta=1;
- 	  else if((0.<fabs(eta))&&(fabs(eta)<=0.5))  ieta=0;
-	  else std::cout<<"problem with jet eta value"<<std::endl;
-
-// 	  if     ((4.5<fabs(eta))&&(fabs(eta)<=9.9)) ieta=9;
-// 	  else if((4.0<fabs(eta))&&(fabs(eta)<=4.5)) ieta=8;
-// 	  else if((3.5<fabs(eta))&&(fabs(eta)<=4.0)) ieta=7;
-// 	  else if((3.0<fabs(eta))&&(fabs(eta)<=3.5)) ieta=6;
-// 	  else if((2.5<fabs(eta))&&(fabs(eta)<=3.0)) ieta=5;
-// 	  else if((2.0<fabs(eta))&&(fabs(eta)<=2.5)) ieta=4;
-// 	  else if((1.5<fabs(eta))&&(fabs(eta)<=2.0)) ieta=3;
-// 	  else if((1.0<fabs(eta))&&(fabs(eta)<=1.5)) ieta=2;
-// 	  else if((0.5<fabs(eta))&&(fabs(eta)<=1.0)) ieta=1;
-// 	  else if((0.0<fabs(eta))&&(fabs(eta)<=0.5)) ieta=0;
-	  if(ieta!=-1&&ipt!=-1){
-	    recogenjetptratio[ieta][ipt]->Fill(pt/jet_genjet_pairs[index].second->pt());
+	double oldpt = jets_.pt[i];
+	double newpt = oldpt*smearscale[i];
+	icjetpt->Fill(newpt);
+	nojerjetpt->Fill(oldpt);
+	if(runmetindex!=-1){
+	  double runmetpt = jet_runmetjet_pairs[runmetindex].second->pt();
+	  matchedicjetpt->Fill(newpt);
+	  matchednojerjetpt->Fill(oldpt);
+	  matchedrunmetjetpt->Fill(runmetpt);
+	  if(gen_index_[i]!=-1){
+	    icjetrunmetjetptdiff->Fill(runmetpt-newpt);
+	    icjetrunmetjetptratio->Fill(runmetpt/newpt);
+	    icjetnosmearptratio->Fill(newpt/oldpt);
+	    runmetjetnosmearptratio->Fill(runmetpt/oldpt);
+	    icjetgenjetptratio->Fill(newpt/jets_.gen_pt[i]);
+	    runmetjetgenjetptratio->Fill(runmetpt/jets_.gen_pt[i]);
 	  }
 	}
+	else{
+	  icjetrunmetjetptdiff->Fill(10);
+	  icjetrunmetjetptratio->Fill(0);
+	}
+      }
+    }
 
-	//SMEARING
-	if(dosmear_){
-	  double JERscalefac=1.;//if no match leave jet alone
-	  double JERcencorrfac=1.;
-	  if(!dojersyst_){//doing central value
-	    if(fabs(oldjet.eta())<0.5)JERcencorrfac=1.052;
-	    else if(fabs(oldjet.eta())<1.1)JERcencorrfac=1.057;
-	    else if(fabs(oldjet.eta())<1.7)JERcencorrfac=1.096;
-	    else if(fabs(oldjet.eta())<2.3)JERcencorrfac=1.134;
-	    else if(fabs(oldjet.eta())<5.0)JERcencorrfac=1.288;
-	  }
-	  else if(dojersyst_&&jerbetterorworse_){//doing JERBETTER
-	    if(fabs(oldjet.eta())<0.5)JERcencorrfac=0.990;
-	    else if(fabs(oldjet.eta())<1.1)JERcencorrfac=1.001;
-	    else if(fabs(oldjet.eta())<1.7)JERcencorrfac=1.032;
-	    else if(fabs(oldjet.eta())<2.3)JERcencorrfac=1.042;
-	    else if(fabs(oldjet.eta())<5.0)JERcencorrfac=1.089;
-	  }
-	  else if(dojersyst_&&(!jerbetterorworse_)){//doing JERWORSE
-	    if(fabs(oldjet.eta())<0.5)JERcencorrfac=1.115;
-	    else if(fabs(oldjet.eta())<1.1)JERcencorrfac=1.114;
-	    else if(fabs(oldjet.eta())<1.7)JERcencorrfac=1.161;
-	    else if(fabs(oldjet.eta())<2.3)JERcencorrfac=1.228;
-	    else if(fabs(oldjet.eta())<5.0)JERcencorrfac=1.488;	      
-	  }
-	  if(index!=-1){//if gen jet match calculate correction factor for pt
-	    if(oldjet.pt()>50.) Smear50miss->Fill(-1.);
-	    //calculate 4 vector correction factor
-	    if(!doetsmear_){//do twiki smearing
-	      double ptcorrected = jet_genjet_pairs[index].second->pt()+JERcencorrfac*(oldjet.pt()-jet_genjet_pairs[index].second->pt());
-	      if(ptcorrected<0.)ptcorrected=0.;
-	      JERscalefac = ptcorrected/oldjet.pt();
-	      Smearjetgenjetptdiff->Fill(oldjet.pt()-jet_genjet_pairs[index].second->pt());
-	      Smearjetgenjetptratio->Fill(oldjet.pt()/jet_genjet_pairs[index].second->pt());
-	      Smearjetgenjetptratioetabin->Fill(oldjet.pt()/jet_genjet_pairs[index].second->pt(),oldjet.eta());
-	    }
-	    else{//do runmetuncertainties smearing
-	      double et = oldjet.energy()/cosh(oldjet.eta());
-	      double etraw = vec[i]->uncorrected_energy()/cosh(oldjet.eta());
-	      double etgen = jet_genjet_pairs[index].second->energy()/cosh(oldjet.eta());
-	      double etcorrected=et*(1+(JERcencorrfac-1)*(et-etgen)/std::max(et,etraw));
-	      if(etcorrected<0.)etcorrected=0.;
-	      JERscalefac=etcorrected/et;
-	      Smearjetgenjetptdiff->Fill(et-etgen);
-	      Smearjetgenjetptratio->Fill(et/etgen);
-	      Smearjetgenjetptratioetabin->Fill(et/etgen,oldjet.eta());
-	    }
-	  } 
-	  else{//Jets with no gen match
-	    if(oldjet.pt()>50.){
-	      Smear50miss->Fill(1.);
-	    }
-	    if(dogaus_){//Do Gaussian smearing for JERWORSE
-	      TRandom3 randomno;
-	      int etabin=-1;
-	      if(fabs(oldjet.eta())<0.5)etabin=0;
-	      else if(fabs(oldjet.eta())<1.1)etabin=1;
-	      else if(fabs(oldjet.eta())<1.7)etabin=2;
-	      else if(fabs(oldjet.eta())<2.3)etabin=3;
-	      else if(fabs(oldjet.eta())<5.0)etabin=4;
-	      //std::cout<<"etabin is: "<<etabin<<std::endl;
-	      double mcrespt=oldjet.pt();
-	      if(mcrespt<25.)mcrespt=25.;
-	      double sigmamc=(resfunc[etabin]->Eval(mcrespt)*oldjet.pt());
-	      double spring10sigmamc=(spring10resfunc[etabin]->Eval(mcrespt)*oldjet.pt());
- 	      double gauscorr;
- 	      //std::cout<<"Jet pt and eta are: "<<oldjet.pt()<<" "<<oldjet.eta()<<"Sigma MC is: "<<sigmamc<<" "<<spring10sigmamc<<" Gaus corr is: "<<gauscorr<<std::endl;
-	      if(!dospring10gaus_) gauscorr=randomno.Gaus(0,(sqrt((JERcencorrfac*JERcencorrfac)-1)*sigmamc));
-	      else gauscorr==randomno.Gaus(0,(sqrt((JERcencorrfac*JERcencorrfac)-1)*spring10sigmamc));
-	      double ptcorrected=oldjet.pt()+gauscorr;
-	      JERscalefac=ptcorrected/oldjet.pt();
-	      
-	    }
-	  }
-	  //correct jet 4 vector
-	  newjet = oldjet*JERscalefac;
-	  	  
-	  //correct met
-	  newmet.SetPx(newmet.px()-(newjet.px()-oldjet.px()));
-	  newmet.SetPy(newmet.py()-(newjet.py()-oldjet.py()));
-	  newmet.SetE(sqrt(newmet.px()*newmet.px()+newmet.py()*newmet.py()));  
+    //Extra variations are copies of the jets before they are modified below,
+    //scaled as the jets of the configured variation are
+    for (unsigned v = 0; v < extra_variations_.size(); ++v) {
+      JetSmearer::Variation var = extra_variations_[v];
+      std::vector<double> const& varscale = smearer_.scale(var);
+      std::string name = JetSmearer::Name(var);
+      std::vector<PFJet> varjets(vec.size());
+      for (unsigned i = 0; i < vec.size(); ++i) {
+	varjets[i] = *(vec[i]);
+	if(varscale[i]==1.) continue;
+	ROOT::Math::PxPyPzEVector newjet = ROOT::Math::PxPyPzEVector(vec[i]->vector())*varscale[i];
+	varjets[i].set_vector(ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiE4D<double> >(newjet));
+      }
+      event->Add(input_label_+"_"+name+"Product", varjets);
+      std::vector<PFJet> & varjetsprod = event->Get<std::vector<PFJet> >(input_label_+"_"+name+"Product");
+      std::vector<PFJet *> varjetptrs(varjetsprod.size());
+      for (unsigned i = 0; i < varjetsprod.size(); ++i) varjetptrs[i] = &(varjetsprod[i]);
+      event->Add(input_label_+"_"+name, varjetptrs);
+      ROOT::Math::PxPyPzEVector varmet(smearer_.met_px(var), smearer_.met_py(var), oldmet.pz(), 0.);
+      varmet.SetE(sqrt(varmet.px()*varmet.px()+varmet.py()*varmet.py()));
+      Met varmetcopy = *met;
+      varmetcopy.set_vector(ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiE4D<double> >(varmet));
+      event->Add(met_label_+"_"+name+"Product", varmetcopy);
+      event->Add(met_label_+"_"+name, &(event->Get<Met>(met_label_+"_"+name+"Product")));
+    }
+
+    //Set jets in event to corrected jets
+    for (unsigned i = 0; i < vec.size(); ++i) {
+      if(scale[i]==1.) continue;
+      ROOT::Math::PxPyPzEVector newjet = ROOT::Math::PxPyPzEVector(vec[i]->vector())*scale[i];
+      vec[i]->set_vector(ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiE4D<double> >(newjet));
+    }
+
+    //Set met in event to corrected met
+    if(!vec.empty()&&(dosmear_||dojessyst_)){
+      ROOT::Math::PxPyPzEVector newmet(smearer_.met_px(variation_), smearer_.met_py(variation_), oldmet.pz(), 0.);
+      newmet.SetE(sqrt(newmet.px()*newmet.px()+newmet.py()*newmet.py()));
+      met->set_vector(ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiE4D<double> >(newmet));
+      if(dodiagnostics_) JESmetdiff->Fill(newmet.energy()-oldmet.energy());
+    }
+    else if(dodiagnostics_) JESmetdiff->Fill(0.);
+    return 0;
+  }
+
+  void JetMETModifier::FillDiagnostics(std::vector<GenJet *> const& genvec) {
+    std::vector<double> const& scale = smearer_.scale(variation_);
+    std::vector<double> const& smearscale = smearer_.scale(smearer_.jes_base());
+
+    //initialise variables for finding highest two pt jets      
+    double oldjet1pt = -1.;
+    double oldjet2pt = -1.;
+    int oldjet1index = -1;
+    int oldjet2index = -1;
+    double newjet1pt = -1.;
+    double newjet2pt = -1.;
+    int newjet1index = -1;
+    int newjet2index = -1;
+
+    for (unsigned i = 0; i < jets_.size(); ++i) {
+      double pt = jets_.pt[i];
+      double eta = jets_.eta[i];
+      double phi = atan2(jets_.py[i], jets_.px[i]);
+      int index = gen_index_[i];
+
+      //Find closest gen jet to each jet
+      double mindr=999;
+      for(int j = 0;unsigned(j)<genvec.size();j++){
+	double dr = sqrt((eta-genvec[j]->vector().eta())*(eta-genvec[j]->vector().eta())+(phi-genvec[j]->vector().phi())*(phi-genvec[j]->vector().phi()));
+	if(dr<mindr){
+	  mindr=dr;
 	}
-	else{//If not doing any smearing use normal jet
-	  newjet = oldjet;
+      }
+      Smeargenmindr->Fill(mindr);
+
+      //MAKE PLOTS FOR RESOLUTION MEASUREMENT
+      if(index!=-1){
+	//GET PT BIN
+	int ipt=int(std::upper_bound(pt_edges_.begin(),pt_edges_.end(),pt)-pt_edges_.begin())-1;
+	if(ipt<0||ipt>=int(pt_edges_.size())-1){
+	  ipt=-1;
+	  std::cout<<"problem with jet pt value"<<std::endl;
 	}
-	Smearptdiff->Fill(newjet.pt()-oldjet.pt());
 
-	//Get runmetuncjet matching icjet
-	int runmetindex = -1;
-	if(dojerdebug_){
-	  //Check for matches between ic and runmetunc jets
-	  for(int j = 0;unsigned(j)<jet_runmetjet_pairs.size();j++){
-	    if(jet_runmetjet_pairs[j].first->id()==vec[i]->id()){
-	      runmetindex = j;
-	      break;
-	    }
-	  }
-	  icjetpt->Fill(newjet.pt());
-	  nojerjetpt->Fill(oldjet.pt());
-	  if(runmetindex!=-1){
-	    matchedicjetpt->Fill(newjet.pt());
-	    matchednojerjetpt->Fill(oldjet.pt());
-	    matchedrunmetjetpt->Fill(jet_runmetjet_pairs[runmetindex].second->pt());
-	    if(index!=-1){
-	      icjetrunmetjetptdiff->Fill(jet_runmetjet_pairs[runmetindex].second->pt()-newjet.pt());
-	      icjetrunmetjetptratio->Fill(jet_runmetjet_pairs[runmetindex].second->pt()/newjet.pt());
-	      icjetnosmearptratio->Fill(newjet.pt()/oldjet.pt());
-	      runmetjetnosmearptratio->Fill(jet_runmetjet_pairs[runmetindex].second->pt()/oldjet.pt());
-	      icjetgenjetptratio->Fill(newjet.pt()/jet_genjet_pairs[index].second->pt());
-	      runmetjetgenjetptratio->Fill((jet_runmetjet_pairs[runmetindex].second->pt())/jet_genjet_pairs[index].second->pt());
-	    }
+	//GET ETA BIN
+	int ieta=-1;
+	if     ((2.3<fabs(eta))&&(fabs(eta)<=5))   ieta=4;
+	else if((1.7<fabs(eta))&&(fabs(eta)<=2.3)) ieta=3;
+	else if((1.1<fabs(eta))&&(fabs(eta)<=1.7)) ieta=2;
+	else if((0.5<fabs(eta))&&(fabs(eta)<=1.1)) ieta=1;
+	else if((0.<fabs(eta))&&(fabs(eta)<=0.5))  ieta=0;
+	else std::cout<<"problem with jet eta value"<<std::endl;
+
+	if(ieta!=-1&&ipt!=-1){
+	  recogenjetptratio[ieta][ipt]->Fill(pt/jets_.gen_pt[i]);
+	}
+      }
+
+      //SMEARING
+      if(dosmear_){
+	if(index!=-1){
+	  if(pt>50.) Smear50miss->Fill(-1.);
+	  if(!doetsmear_){
+	    Smearjetgenjetptdiff->Fill(pt-jets_.gen_pt[i]);
+	    Smearjetgenjetptratio->Fill(pt/jets_.gen_pt[i]);
+	    Smearjetgenjetptratioetabin->Fill(pt/jets_.gen_pt[i],eta);
 	  }
 	  else{
-	    icjetrunmetjetptdiff->Fill(10);
-	    icjetrunmetjetptratio->Fill(0);
+	    double et = jets_.energy[i]/cosh(eta);
+	    double etgen = jets_.gen_energy[i]/cosh(eta);
+	    Smearjetgenjetptdiff->Fill(et-etgen);
+	    Smearjetgenjetptratio->Fill(et/etgen);
+	    Smearjetgenjetptratioetabin->Fill(et/etgen,eta);
 	  }
 	}
-	
-	//Get initial jet order
-	if(newjet.pt() > oldjet1pt){
-	  oldjet2index=oldjet1index;
-	  oldjet2pt=oldjet1pt;
-	  oldjet1index=i;
-	  oldjet1pt=newjet.pt();
-	}
-	else if(newjet.pt() > oldjet2pt) {
-	  oldjet2index=i;
-	  oldjet2pt=newjet.pt();
-	}
-	
-	//JES SYSTEMATICS
-	if(!dojessyst_){//Central value
-	  newjet1index=oldjet1index;
-	  newjet2index=oldjet2index;
-	  newjet1pt=oldjet1pt;
-	  newjet2pt=newjet2pt;
+	else if(pt>50.){
+	  Smear50miss->Fill(1.);
 	}
-	//else if((is_data_&&dodatajessyst_)||(!is_data_&&!dodatajessyst_)){//if not central value correct by the JES uncertainty
-	else if(!is_data_){
-	  //Get JES uncertainty
-	  total->setJetPt(newjet.pt());
-	  total->setJetEta(newjet.eta());
-	  double uncert = total->getUncertainty(jesupordown_);
-	  JEScorrfac->Fill(newjet.pt(),uncert); //Fill histogram of uncertainty against pt	
-	  float jesupordownmult;
-	  if(jesupordown_==true) jesupordownmult=1.; //upper uncertainty
-	  else jesupordownmult=-1.; //lower uncertainty
-	  
-	  //Correct jet and met
-	  double deltapx = newjet.px()*jesupordownmult*uncert;
-	  double deltapy = newjet.py()*jesupordownmult*uncert;
-	  newjet=newjet*(1+jesupordownmult*uncert);
-	  newmet.SetPx(newmet.px()-deltapx);
-	  newmet.SetPy(newmet.py()-deltapy);
-	  newmet.SetE(newmet.px()*newmet.px()+newmet.py()*newmet.py());
-	  
-	  JESjetphidiff->Fill(newjet.phi()-oldjet.phi());
-	  JESjetetadiff->Fill(newjet.eta()-oldjet.eta());
-	
-	  //check if order of jets is same
-	  if(newjet.pt() > newjet1pt){
-	    newjet2index=newjet1index;
-	    newjet2pt=newjet1pt;
-	    newjet1index=i;
-	    newjet1pt=newjet.pt();
-	  }
-	  else if(newjet.pt() > newjet2pt) {
-	    newjet2index=i;
-            newjet2pt=newjet.pt();
-	  }  
+      }
+      double smearedpt = pt*smearscale[i];
+      Smearptdiff->Fill(smearedpt-pt);
 
+      //Get initial jet order
+      if(smearedpt > oldjet1pt){
+	oldjet2index=oldjet1index;
+	oldjet2pt=oldjet1pt;
+	oldjet1index=i;
+	oldjet1pt=smearedpt;
+      }
+      else if(smearedpt > oldjet2pt) {
+	oldjet2index=i;
+	oldjet2pt=smearedpt;
+      }
+
+      //JES SYSTEMATICS
+      if(!dojessyst_){//Central value
+	newjet1index=oldjet1index;
+	newjet2index=oldjet2index;
+	newjet1pt=oldjet1pt;
+	newjet2pt=oldjet2pt;
+      }
+      else{
+	double uncert = smearer_.jes_uncertainty(variation_)[i];
+	JEScorrfac->Fill(smearedpt,uncert); //Fill histogram of uncertainty against pt
+	//The jets are only scaled so eta and phi don't change
+	JESjetphidiff->Fill(0.);
+	JESjetetadiff->Fill(0.);
+
+	//check if order of jets is same
+	double newpt = pt*scale[i];
+	if(newpt > newjet1pt){
+	  newjet2index=newjet1index;
+	  newjet2pt=newjet1pt;
+	  newjet1index=i;
+	  newjet1pt=newpt;
 	}
-	//Set jet in event to corrected jet
-	vec[i]->set_vector(ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiE4D<double> >(newjet));
-      }//end of loop over jets
-      
-      //Set met in event to corrected met
-      met->set_vector(ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiE4D<double> >(newmet));
-      
-      JESmetdiff->Fill(newmet.energy()-oldmet.energy());
-      
-      //Check if first two jets have changed
-      if((oldjet1index==-1)||(newjet1index==-1)||(oldjet2index==-1)||(newjet2index==-1)){
-	if(vec.size()>1){
-	  JESisordersame->Fill(-2.);//ERROR there are two or more jets but no second highest pt jet has been found
+	else if(newpt > newjet2pt) {
+	  newjet2index=i;
+	  newjet2pt=newpt;
 	}
       }
-      if(oldjet1index==newjet1index){
-	if(oldjet2index==newjet2index){
-	  JESisordersame->Fill(1.);//Jets are the same
-	  return 0;
-	}
+    }
+
+    //Check if first two jets have changed
+    if((oldjet1index==-1)||(newjet1index==-1)||(oldjet2index==-1)||(newjet2index==-1)){
+      if(jets_.size()>1){
+	JESisordersame->Fill(-2.);//ERROR there are two or more jets but no second highest pt jet has been found
       }
-      if(oldjet1index==newjet2index){
-	if(oldjet2index==newjet1index){
-	  JESisordersame->Fill(-1.);//Jet 1 and 2 have swapped order
-	  //std::cout<<"JETS SWAPPED"<<std::endl;
-	  return 0;
-	}
+    }
+    if(oldjet1index==newjet1index){
+      if(oldjet2index==newjet2index){
+	JESisordersame->Fill(1.);//Jets are the same
+	return;
       }
-      if(oldjet1index!=newjet2index){
-	if(oldjet2index!=newjet1index){
-	  JESisordersame->Fill(2.);//Different jets are the top two after JES correction
-	  return 0;
-	}
+    }
+    if(oldjet1index==newjet2index){
+      if(oldjet2index==newjet1index){
+	JESisordersame->Fill(-1.);//Jet 1 and 2 have swapped order
+	return;
+      }
+    }
+    if(oldjet1index!=newjet2index){
+      if(oldjet2index!=newjet1index){
+	JESisordersame->Fill(2.);//Different jets are the top two after JES correction
+	return;
       }
-      return 0;
     }
   }
 
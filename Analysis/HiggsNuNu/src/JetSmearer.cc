@@ -0,0 +1,150 @@
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsNuNu/interface/JetSmearer.h"
+#include "CondFormats/JetMETObjects/interface/JetCorrectionUncertainty.h"
+#include "TF1.h"
+#include <cmath>
+#include <algorithm>
+
+namespace ic {
+
+  namespace {
+    // Data/MC jet energy resolution ratios for 2012, by |eta| bin
+    double const kJERFactors[3][5] = {
+      {1.052, 1.057, 1.096, 1.134, 1.288},  // central
+      {0.990, 1.001, 1.032, 1.042, 1.089},  // better
+      {1.115, 1.114, 1.161, 1.228, 1.488}   // worse
+    };
+
+    std::string const kNames[JetSmearer::kNVariations] = {
+      "central", "jerbetter", "jerworse", "jesup", "jesdown"
+    };
+  }
+
+  void JetSmearer::Jets::clear() {
+    px.clear();
+    py.clear();
+    pt.clear();
+    eta.clear();
+    energy.clear();
+    uncorrected_energy.clear();
+    gen_pt.clear();
+    gen_energy.clear();
+    id.clear();
+  }
+
+  JetSmearer::JetSmearer() : smear_(false), et_smear_(false), gaus_(false), jes_(NULL),
+                             jes_base_(kCentral) {
+    for (unsigned i = 0; i < 5; ++i) resolution_[i] = NULL;
+    for (unsigned v = 0; v < kNVariations; ++v) {
+      requested_[v] = false;
+      met_px_[v] = 0.;
+      met_py_[v] = 0.;
+    }
+  }
+
+  std::string const& JetSmearer::Name(Variation var) {
+    return kNames[var];
+  }
+
+  bool JetSmearer::FromName(std::string const& name, Variation * var) {
+    for (unsigned v = 0; v < kNVariations; ++v) {
+      if (name == kNames[v]) {
+        *var = Variation(v);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  double JetSmearer::JERFactor(Variation var, int eta_bin) {
+    if (eta_bin < 0) return 1.;
+    unsigned row = (var == kJERBetter) ? 1 : (var == kJERWorse) ? 2 : 0;
+    return kJERFactors[row][eta_bin];
+  }
+
+  int JetSmearer::EtaBin(double eta) {
+    double abs_eta = std::fabs(eta);
+    if (abs_eta < 0.5) return 0;
+    if (abs_eta < 1.1) return 1;
+    if (abs_eta < 1.7) return 2;
+    if (abs_eta < 2.3) return 3;
+    if (abs_eta < 5.0) return 4;
+    return -1;
+  }
+
+  void JetSmearer::set_resolution(int eta_bin, TF1 const* resolution) {
+    resolution_[eta_bin] = resolution;
+  }
+
+  void JetSmearer::Request(Variation var) {
+    requested_[var] = true;
+  }
+
+  double JetSmearer::Smear(Jets const& jets, std::size_t i, int eta_bin, double jer_factor,
+                           double gaus) const {
+    double pt = jets.pt[i];
+    if (jets.gen_pt[i] >= 0.) {
+      if (!et_smear_) {
+        double pt_smeared = jets.gen_pt[i] + jer_factor * (pt - jets.gen_pt[i]);
+        if (pt_smeared < 0.) pt_smeared = 0.;
+        return pt_smeared / pt;
+      }
+      double cosh_eta = std::cosh(jets.eta[i]);
+      double et = jets.energy[i] / cosh_eta;
+      double et_raw = jets.uncorrected_energy[i] / cosh_eta;
+      double et_gen = jets.gen_energy[i] / cosh_eta;
+      double et_smeared = et * (1. + (jer_factor - 1.) * (et - et_gen) / std::max(et, et_raw));
+      if (et_smeared < 0.) et_smeared = 0.;
+      return et_smeared / et;
+    }
+    if (!gaus_ || eta_bin < 0) return 1.;
+    // A resolution ratio below one can't be reached by adding a Gaussian
+    if (jer_factor <= 1.) return 1.;
+    double sigma = resolution_[eta_bin]->Eval(std::max(pt, 25.)) * pt;
+    return (pt + std::sqrt(jer_factor * jer_factor - 1.) * sigma * gaus) / pt;
+  }
+
+  void JetSmearer::Run(EventInfo const* info, Jets const& jets, double met_px, double met_py) {
+    std::size_t n = jets.size();
+    bool do_jes = requested_[kJESUp] || requested_[kJESDown];
+    bool needed[kNVariations];
+    for (unsigned v = 0; v < kNVariations; ++v) {
+      needed[v] = requested_[v] || (do_jes && v == unsigned(jes_base_));
+      if (!needed[v]) continue;
+      scale_[v].resize(n);
+      met_px_[v] = met_px;
+      met_py_[v] = met_py;
+      if (v == kJESUp || v == kJESDown) jes_unc_[v].resize(n);
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+      int eta_bin = EtaBin(jets.eta[i]);
+      // One standard normal number per unmatched jet, shared by the variations
+      double gaus = 0.;
+      if (smear_ && gaus_ && jets.gen_pt[i] < 0. && eta_bin >= 0) {
+        random_.SetStream(info, jets.id[i], "jer");
+        gaus = random_.Gaus(0., 1.);
+      }
+      for (unsigned v = kCentral; v <= kJERWorse; ++v) {
+        if (!needed[v]) continue;
+        scale_[v][i] = smear_ ? Smear(jets, i, eta_bin, JERFactor(Variation(v), eta_bin), gaus) : 1.;
+      }
+      if (do_jes) {
+        double base = scale_[jes_base_][i];
+        for (unsigned v = kJESUp; v <= kJESDown; ++v) {
+          if (!needed[v]) continue;
+          jes_->setJetPt(jets.pt[i] * base);
+          jes_->setJetEta(jets.eta[i]);
+          double uncert = jes_->getUncertainty(v == kJESUp);
+          jes_unc_[v][i] = uncert;
+          scale_[v][i] = base * (v == kJESUp ? 1. + uncert : 1. - uncert);
+        }
+      }
+      for (unsigned v = 0; v < kNVariations; ++v) {
+        if (!needed[v]) continue;
+        met_px_[v] -= (scale_[v][i] - 1.) * jets.px[i];
+        met_py_[v] -= (scale_[v][i] - 1.) * jets.py[i];
+      }
+    }
+  }
+
+}
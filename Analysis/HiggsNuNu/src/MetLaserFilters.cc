@@ -1,5 +1,4 @@
-#include <fstream>
-#include <sstream>
+#include "boost/filesystem.hpp"
 #include "Math/Vector4D.h"
 #include "Math/Vector4Dfwd.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsNuNu/interface/MetLaserFilters.h"
@@ -15,6 +14,7 @@ namespace ic {
     hcal_input_name_ = hcal_input;
     ecal_input_name_ = ecal_input;
     doFilters_=doFilters;
+    cache_dir_ = "";
   }
  
   MetLaserFilters::~MetLaserFilters(){
@@ -29,18 +29,20 @@ namespace ic {
 	      << "-- MetLaserFilters is run with parameters:" << std::endl
 	      << "---- hcal input name : " << hcal_input_name_ << std::endl
 	      << "---- ecal input name : " << ecal_input_name_ << std::endl
-	      << "---- doFilters : " << doFilters_ << std::endl;
+	      << "---- doFilters : " << doFilters_ << std::endl
+	      << "---- cache dir : " << cache_dir_ << std::endl;
 
+    std::size_t n_bad = 0;
     if (doFilters_){
-      badEvts_.clear();
-      //badRuns_.clear();
-      //badEvts_.reserve(515891);
-      if (!extractEvents(hcal_input_name_)) return 1;
-      if (!extractEvents(ecal_input_name_)) return 1;
+      if (!extractEvents(hcal_input_name_, hcal_list_)) return 1;
+      if (!extractEvents(ecal_input_name_, ecal_list_)) return 1;
+      hcal_vetoed_.assign(hcal_list_->size(), false);
+      ecal_vetoed_.assign(ecal_list_->size(), false);
+      n_bad = hcal_list_->size() + ecal_list_->size();
     }
 
 
-    std::cout << "-------- Loaded " << badEvts_.size() << " bad events." << std::endl;
+    std::cout << "-------- Loaded " << n_bad << " bad events." << std::endl;
 
     return 0;
   }
@@ -49,39 +51,58 @@ namespace ic {
 
      EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
 
-     RunLumiEvent lEvt;
-     lEvt.evt = eventInfo->event();
-     lEvt.run = eventInfo->run();
-     lEvt.lumi = eventInfo->lumi_block();
-
-     //bool print = (lEvt.run == 204554) || (lEvt.run == 205311);
-     //if (print) std::cout << "--MetLaserFilters** Processing run " << lEvt.run << ":" << lEvt.lumi << ":" << lEvt.evt << std::endl;
-     std::set<RunLumiEvent>::iterator lIter = badEvts_.find(lEvt);
-     if (lIter != badEvts_.end()) {
-       badEvts_.erase(lIter);
-       //if (print) std::cout << " ----MetLaserFilters** Deleted event " << lEvt.run << ", size of badEvents = " << badEvts_.size() << std::endl;
+     if (!doFilters_) return 0;
+
+     unsigned run = eventInfo->run();
+     unsigned lumi = eventInfo->lumi_block();
+     unsigned long long evt = eventInfo->event();
+
+     // An event in both lists is vetoed once, and then cleared from both
+     std::size_t lHcal = hcal_list_->Find(run, lumi, evt);
+     std::size_t lEcal = ecal_list_->Find(run, lumi, evt);
+     bool lVeto = (lHcal != EventList::npos && !hcal_vetoed_[lHcal]) ||
+                  (lEcal != EventList::npos && !ecal_vetoed_[lEcal]);
+     if (lVeto) {
+       if (lHcal != EventList::npos) hcal_vetoed_[lHcal] = true;
+       if (lEcal != EventList::npos) ecal_vetoed_[lEcal] = true;
        return 1;
      }
      
      return 0;
   }
 
-  bool MetLaserFilters::extractEvents(std::string inputfile){
+  bool MetLaserFilters::extractEvents(std::string inputfile, std::shared_ptr<EventList> & list){
 
-    std::cout << " -- Reading file: " << inputfile << std::endl
-	      << " ---- Size of badEvents before = " << badEvts_.size() << std::endl;
+    std::cout << " -- Reading file: " << inputfile << std::endl;
 
-    std::ifstream lInput;
-    lInput.open(inputfile);
-    if(!lInput.is_open()){
+    if (!boost::filesystem::exists(inputfile)) {
       std::cerr << "Unable to open file: " << inputfile << std::endl;
-      return false; 
+      return false;
+    }
+    std::vector<std::string> inputs(1, inputfile);
+    list.reset(new EventList());
+    // With a cache directory the text list is converted once into a sorted
+    // binary file there, which is rebuilt only when the text file is newer
+    bool cached = false;
+    if (cache_dir_ != "") {
+      std::string binfile = (boost::filesystem::path(cache_dir_) /
+                             (boost::filesystem::path(inputfile).filename().string() + ".bin")).string();
+      bool converted = true;
+      if (!boost::filesystem::exists(binfile) ||
+          boost::filesystem::last_write_time(binfile) < boost::filesystem::last_write_time(inputfile)) {
+        std::cout << " ---- Converting to: " << binfile << std::endl;
+        // Entries are run:lumiBlock:event, shorter strings are ignored
+        converted = EventList::Build(inputs, binfile, EventList::kAll, 6);
+      }
+      cached = converted && list->Open(binfile);
+      if (!cached) std::cout << " ---- Unable to use " << binfile << ", reading " << inputfile << " into memory" << std::endl;
+    }
+    if (!cached && !list->Read(inputs, EventList::kAll, 6)) {
+      std::cerr << "Unable to read file: " << inputfile << std::endl;
+      return false;
     }
-    lInput>>badEvts_;
-
-    std::cout << " ---- Size of badEvents after = " << badEvts_.size() << std::endl;
 
-    lInput.close();
+    std::cout << " ---- Number of bad events = " << list->size() << std::endl;
 
     return true;
   }
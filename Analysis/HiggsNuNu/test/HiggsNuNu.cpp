@@ -93,7 +93,9 @@ int main(int argc, char* argv[]){
 
   string mettype;                 // MET input collection to be used
   string jesuncfile;              // File to get JES uncertainties from
+  string jetmet_variations;       // Comma-separated extra jet/MET variations, e.g. "jesup,jesdown", made in the same pass
   bool doMetFilters;              // apply cleaning MET filters.
+  string laser_cache_dir;         // Directory for binary copies of the laser filter lists, "" to read them into memory
   string filters;
   //unsigned signal_region;       // DeltaPhi cut > 2.7
   double met_cut;                 // MET cut min to apply for signal, QCD or skim
@@ -146,6 +148,7 @@ int main(int argc, char* argv[]){
     ("met_cut_max",         po::value<double>(&met_cut_max)->default_value(14000.))
     ("mjj_cut",             po::value<double>(&mjj_cut)->default_value(1200.))
     ("doMetFilters",        po::value<bool>(&doMetFilters)->default_value(false))
+    ("laser_cache_dir",     po::value<string>(&laser_cache_dir)->default_value(""))
     ("filters",             po::value<string> (&filters)->default_value("HBHENoiseFilter,EcalDeadCellTriggerPrimitiveFilter,eeBadScFilter,trackingFailureFilter,manystripclus53X,toomanystripclus53X,logErrorTooManyClusters,CSCTightHaloFilter"))
     ("dojessyst",           po::value<bool>(&dojessyst)->default_value(false))
     ("dodatajessyst",       po::value<bool>(&dodatajessyst)->default_value(false))
@@ -169,6 +172,7 @@ int main(int argc, char* argv[]){
     ("dogaus",              po::value<bool>(&dogaus)->default_value(false))
     ("dospring10gaus",      po::value<bool>(&dospring10gaus)->default_value(false))
     ("jesuncfile",          po::value<string>(&jesuncfile)->default_value("data/jec/Fall12_V7_MC_Uncertainty_AK5PF.txt"))
+    ("jetmet_variations",   po::value<string>(&jetmet_variations)->default_value(""))
     ("doMCFMstudy",         po::value<bool>(&doMCFMstudy)->default_value(false))
     ("doTopCR",             po::value<bool>(&doTopCR)->default_value(false))
     ("turnoffpuid",         po::value<bool>(&turnoffpuid)->default_value(false));
@@ -178,6 +182,8 @@ int main(int argc, char* argv[]){
 
   vector<string> filtersVec;
   boost::split(filtersVec, filters, boost::is_any_of(","));
+  vector<string> jetmetVariationsVec;
+  if (jetmet_variations != "") boost::split(jetmetVariationsVec, jetmet_variations, boost::is_any_of(","));
 
   // Some options must now be re-configured based on other options
   ic::era era           = String2Era(era_str);
@@ -191,6 +197,7 @@ int main(int argc, char* argv[]){
   std::cout << boost::format(param_fmt) % "do_skim" % do_skim;
   if (do_skim) std::cout << boost::format(param_fmt) % "skim_path" % skim_path;
   std::cout << boost::format(param_fmt) % "dojessyst" % dojessyst;
+  std::cout << boost::format(param_fmt) % "jetmet_variations" % jetmet_variations;
   if (dojessyst) std::cout << boost::format(param_fmt) % "jesupordown" % jesupordown;
   std::cout << boost::format(param_fmt) % "dojersyst" % dojersyst;
   if (dojessyst) std::cout << boost::format(param_fmt) % "jerbettorworse" % jerbetterorworse;
@@ -207,6 +214,7 @@ int main(int argc, char* argv[]){
   std::cout << boost::format(param_fmt) % "met_cut_max" % met_cut_max ;
   std::cout << boost::format(param_fmt) % "mjj_cut" % mjj_cut ;
   std::cout << boost::format(param_fmt) % "doMetFilters" % doMetFilters;
+  std::cout << boost::format(param_fmt) % "laser_cache_dir" % laser_cache_dir;
   std::cout << boost::format(param_fmt) % "filters" % filters;
   std::cout << boost::format(param_fmt) % "dotrgeff" % dotrgeff;
   std::cout << boost::format(param_fmt) % "doidisoeff" % doidisoeff;
@@ -405,6 +413,7 @@ int main(int argc, char* argv[]){
 						    "data/met_laser_filters/AllBadHCALLaser.txt",
 						    "data/met_laser_filters/ecalLaserFilter_MET_Run2012AandB.txt",
 						    doMetFilters);
+  metLaserFilters.set_cache_dir(laser_cache_dir);
 
 
 
@@ -634,6 +643,7 @@ int main(int argc, char* argv[]){
     .set_jerbetterorworse(jerbetterorworse)
     .set_jesuncfile(jesuncfile)
     .set_dojerdebug(dojerdebug)
+    .set_variations(jetmetVariationsVec)
     .set_fs(fs);
   
 
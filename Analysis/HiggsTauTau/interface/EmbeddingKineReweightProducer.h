@@ -3,6 +3,7 @@
 
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
 #include <string>
 #include "TH2D.h"
 
@@ -17,9 +18,9 @@ private:
   CLASS_MEMBER(EmbeddingKineReweightProducer, std::string, file)
   CLASS_MEMBER(EmbeddingKineReweightProducer, ic::channel, channel)
 
-  TH2D genTau2PtVsGenTau1Pt_;
-  TH2D genTau2EtaVsGenTau1Eta_;                                              
-  TH2D genDiTauMassVsGenDiTauPt_;
+  BinnedTable genTau2PtVsGenTau1Pt_;
+  BinnedTable genTau2EtaVsGenTau1Eta_;
+  BinnedTable genDiTauMassVsGenDiTauPt_;
 
   TH2F *electron_id_hist_;
 
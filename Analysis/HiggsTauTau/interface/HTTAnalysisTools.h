@@ -3,6 +3,9 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
+#include <algorithm>
+#include <ctime>
 #include "boost/lexical_cast.hpp"
 #include "boost/algorithm/string.hpp"
 #include "boost/format.hpp"
@@ -11,8 +14,13 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TextElement.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SimpleParamParser.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnRootTools.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CompiledExpression.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
 
+class TTreeFormula;
+class TLeaf;
+class TEntryList;
+
 //! HTTAnalysisTools
 /*!
   A set of classes and functions that can be used to analyse the output of 
@@ -207,6 +215,10 @@ namespace ic {
 
       //! Generate a histogram for a specific samples
       /*! \param variable A string containing the name of a histogram branch
+
+          In this and the other methods taking a selection or category, a
+          token "@name" tests the bit that HTTCategories wrote for its
+          selection or category "name", e.g. "@os_sel && @vbf".
       */
       TH1F GetShape(std::string const& variable,
                               std::string const& sample, 
@@ -330,6 +342,54 @@ namespace ic {
       void SetQCDRatio(double const& ratio);
       inline void SetVerbosity(unsigned const& verbosity) { verbosity_ = verbosity; }
 
+      //! Start recording shape and rate requests instead of evaluating them
+      /*! While booking, #GetShape and #GetRate only register what was asked
+          for and return placeholder results (std::cout is silenced
+          meanwhile). Running the usual methods, e.g. #FillHistoMap, once in
+          this mode collects everything they need. #Run then fills all the
+          booked histograms and rates with a single loop over each tree, and
+          later calls with the same arguments are answered from the results.
+      */
+      void StartBooking();
+      void BookShape(std::string const& variable,
+                     std::string const& sample,
+                     std::string const& selection,
+                     std::string const& category,
+                     std::string const& weight);
+      void BookRate(std::string const& sample,
+                    std::string const& selection,
+                    std::string const& category,
+                    std::string const& weight);
+      //! Ends booking mode and evaluates all booked requests
+      void Run();
+      //! Forget all results filled by #Run
+      void ClearResults();
+      //! Keep the branches read by #Run in memory
+      /*! When enabled, each branch used by a compiled expression is read
+          once per sample into a contiguous array, and later calls to #Run
+          evaluate over these arrays without going back to the file. If the
+          modification time of an input file changes the file is reopened,
+          and the cached columns and results for that sample are dropped.
+      */
+      inline void SetColumnCache(bool const& use) { use_column_cache_ = use; }
+      //! Keep shapes and rates computed from the trees in directory \p dir
+      /*! Each result is stored in its own small binary file, keyed by the
+          input file (path, size and modification time) and the full
+          variable, binning and cut strings. Later requests with the same
+          key, in this or a later job, read the file back instead of the
+          tree. Once the cache holds more than \p max_mb megabytes the least
+          recently used entries are removed (0 means no limit). An empty
+          \p dir disables the cache.
+      */
+      void SetShapeCache(std::string const& dir, unsigned max_mb = 500);
+      //! Maximum number of samples #Run fills at the same time
+      /*! Defaults to one, i.e. no parallel filling, as reading trees from
+          several threads relies on the thread-safety of ROOT I/O. Zero
+          means the number of cores. Samples whose expressions need a
+          TTreeFormula are always filled one after the other.
+      */
+      void SetThreads(unsigned const& threads);
+
     private:
       ic::channel ch_;
       std::string year_;
@@ -346,9 +406,94 @@ namespace ic {
       std::map<std::string, std::string> alias_map_;
       std::map<std::string, std::vector<std::string>> samples_alias_map_;
 
+      struct Booking {
+        std::string key;
+        std::string variable;   // empty for a rate
+        std::string cut;
+        std::string cache_key;  // empty if the shape cache is not used
+        std::string selection;  // the selection alone, for its entry list
+      };
+      bool booking_;
+      std::streambuf * cout_buf_;
+      std::set<std::string> booked_keys_;
+      std::map<std::string, std::vector<Booking>> bookings_;
+      std::map<std::string, TH1F> shape_results_;
+      std::map<std::string, Value> rate_results_;
+      unsigned threads_;
+
+      // Everything #Run needs to fill the booked histograms of one sample
+      struct SampleFill {
+        TTree *tree;
+        std::vector<CompiledExpression> compiled;
+        std::vector<TTreeFormula *> formulas;     // null where compiled
+        std::vector<std::vector<unsigned>> expr_columns;
+        std::vector<TLeaf *> leaves;
+        std::vector<std::vector<double> *> cache; // null without the column cache
+        std::vector<TH1F> hists;
+        std::vector<unsigned> cut_ids;
+        std::vector<int> var_ids;
+        std::vector<bool> valid;
+        bool use_subset;                          // only read the entries in subset
+        std::vector<Long64_t> subset;
+        std::vector<unsigned> record_ids;         // selections to record entry lists for
+        std::vector<std::string> record_keys;
+        std::vector<std::vector<Long64_t>> recorded;
+      };
+      static void FillSample(SampleFill & fill);
+
+      // Entries passing a given cut, keyed by sample + "\n" + cut.  Filled
+      // by #Run as a by-product, or with TTree::Draw by #GetEntryList
+      std::map<std::string, std::vector<Long64_t>> entry_lists_;
+      std::vector<Long64_t> const& GetEntryList(std::string const& sample, std::string const& cut);
+      // Number of times each sample + "\n" + cut has been asked for by
+      // #SetSelectionEntryList without a list being known
+      std::map<std::string, unsigned> entry_list_requests_;
+      //! Restrict the tree of \p sample to the entries passing \p selection
+      /*! Building the list costs a pass over the tree, so a new list is only
+          made when the selection is used a second time. Returns null if
+          the tree is not restricted.
+      */
+      TEntryList * SetSelectionEntryList(std::string const& sample, std::string const& selection);
+      void ClearSelectionEntryList(std::string const& sample, TEntryList * elist);
+
+      struct ColumnCache {
+        std::time_t mtime;
+        std::map<std::string, std::vector<double>> columns;
+      };
+      bool use_column_cache_;
+      std::map<std::string, std::string> tfile_names_;
+      std::map<std::string, ColumnCache> column_cache_;
+      void RefreshColumnCache(std::string const& sample);
+
+      std::string shape_cache_dir_;
+      unsigned shape_cache_max_mb_;
+      std::string ShapeCacheKey(std::string const& sample,
+                                std::string const& variable,
+                                std::string const& cut);
+      std::string ShapeCachePath(std::string const& key) const;
+      bool ReadShapeCache(std::string const& key, TH1F & hist);
+      bool ReadRateCache(std::string const& key, Value & rate);
+      void WriteShapeCache(std::string const& key, TH1F const& hist);
+      void WriteRateCache(std::string const& key, Value const& rate);
+      void PruneShapeCache();
+
+      static std::string ResultKey(std::string const& variable,
+                                   std::string const& sample,
+                                   std::string const& selection,
+                                   std::string const& category,
+                                   std::string const& weight);
+      static bool BuildHistogram(std::string const& variable, std::string & expression, TH1F & hist);
+
       std::string BuildCutString(std::string const& selection,
                                  std::string const& category,
                                  std::string const& weight);
+      // As above, with "@name" tokens replaced by bit tests for \p sample
+      std::string BuildCutString(std::string const& sample,
+                                 std::string const& selection,
+                                 std::string const& category,
+                                 std::string const& weight);
+      std::string ResolveCategoryBits(std::string const& sample, std::string const& cut);
+      std::map<std::string, std::map<std::string, unsigned>> cat_bits_schema_;
       std::string BuildVarString(std::string const& variable);
 
   };
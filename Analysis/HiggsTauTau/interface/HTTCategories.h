@@ -27,6 +27,13 @@ class HTTCategories : public ModuleBase {
 
   std::map<std::string, bool> categories_;
   std::map<std::string, bool> selections_;
+  // Every selection and category gets a fixed bit, in the order they are
+  // initialised, in the cat_bits_<N> branches of the output tree (32 per
+  // branch).  The names, in bit order, are stored in the user info of the
+  // tree as a TNamed called "cat_bits_schema".
+  std::map<std::string, unsigned> bit_index_;
+  std::vector<std::string> bit_names_;
+  std::vector<unsigned> cat_bits_;
   std::map<std::string, MassPlots*> massplots_;
   std::map<std::string, double> yields_;
   std::map<std::string, CoreControlPlots*> controlplots_;
@@ -128,6 +135,8 @@ class HTTCategories : public ModuleBase {
   void SetPassSelection(std::string const& selection);
 
   void Reset();
+  void RegisterBit(std::string const& name);
+  void SetBit(std::string const& name);
 
 
 };
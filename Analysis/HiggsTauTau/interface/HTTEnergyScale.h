@@ -16,6 +16,10 @@ class HTTEnergyScale : public ModuleBase {
   CLASS_MEMBER(HTTEnergyScale, bool , moriond_corrections)
   CLASS_MEMBER(HTTEnergyScale, std::string, input_label)
   CLASS_MEMBER(HTTEnergyScale, double, shift)
+  // If set, taus are not modified in place and a ShiftedView<Tau> is
+  // added to the event with this name instead, which later modules can
+  // read with GetPtrVec<Tau> as a collection of shifted copies
+  CLASS_MEMBER(HTTEnergyScale, std::string, output_label)
 
 
  public:
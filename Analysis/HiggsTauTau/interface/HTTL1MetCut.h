@@ -7,7 +7,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/HistoSet.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
 
-#include "TRandom3.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
 #include <string>
 
 namespace ic {
@@ -16,10 +16,12 @@ class HTTL1MetCut : public ModuleBase {
  private:
   CLASS_MEMBER(HTTL1MetCut, std::string, l1_met_label)
 
-  TRandom3 *rand;
+  CounterRandom *rand;
 
  public:
   HTTL1MetCut(std::string const& name);
+  // A copy gets its own random number generator
+  HTTL1MetCut(HTTL1MetCut const& other);
   virtual ~HTTL1MetCut();
 
   virtual int PreAnalysis();
@@ -6,6 +6,9 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <functional>
+#include <unordered_map>
 #include "TH1F.h"
 #include "TGraphAsymmErrors.h"
 #include "boost/assign/list_of.hpp"
@@ -117,12 +120,44 @@ struct Observation {
 
 class HTTSetup {
 	private:
-		std::vector<Nuisance> params_;
-		std::vector<Process> processes_;
-		std::vector<Observation> obs_;
+		typedef std::unordered_map<std::string, std::vector<unsigned>> RowIndex;
+
+		// The nuisances, processes and observations, shared by a setup and
+		// every view filtered from it.  The hash indices give the rows with
+		// a given nuisance, process or category key and are rebuilt when
+		// rows are added.
+		struct Tables {
+			std::vector<Nuisance> params;
+			std::vector<Process> processes;
+			std::vector<Observation> obs;
+			bool indexed;
+			RowIndex params_by_nuisance;
+			RowIndex params_by_process;
+			RowIndex params_by_key;
+			RowIndex processes_by_process;
+			RowIndex processes_by_key;
+			RowIndex processes_by_match;
+			RowIndex obs_by_key;
+			Tables() : indexed(false) {}
+			void Index();
+		};
+
+		std::shared_ptr<Tables> tables_;
+		// The rows of tables_ in this view, always in increasing order
+		std::vector<unsigned> params_;
+		std::vector<unsigned> processes_;
+		std::vector<unsigned> obs_;
 		std::vector<Pull> pulls_;
 		bool ignore_nuisance_correlations_;
 
+		Tables & Indexed() const;
+		// Take a private copy of the rows in this view before modifying them,
+		// so that filtering keeps the value semantics of a full copy
+		void Detach();
+		// Processes in this view that a nuisance parameter applies to
+		std::vector<unsigned> MatchingProcesses(Nuisance const& param) const;
+		static std::vector<unsigned> Select(std::vector<unsigned> const& view, RowIndex const& index, std::vector<std::string> const& keys);
+
 	public:
 		int ParseDatacard(std::string const& filename, std::string const& channel, int category_id, std::string era, std::string mass);
 		int ParseROOTFile(std::string const& filename, std::string const& channel, std::string era);
@@ -133,7 +168,7 @@ class HTTSetup {
 		HTTSetup();
 		void ApplyPulls(bool use_b_only = false);
 		void WeightSoverB();
-		inline void AddProcess(Process proc) { processes_.push_back(proc); }
+		void AddProcess(Process proc);
 		void VariableRebin(std::vector<double> bins);
 		HTTSetup & PrintAll();
 		HTTSetup process(std::vector<std::string> const& process) const;
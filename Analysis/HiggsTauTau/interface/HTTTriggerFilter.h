@@ -4,6 +4,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TriggerTable.h"
 
 #include <string>
 #include <fstream>
@@ -19,6 +20,8 @@ class HTTTriggerFilter : public ModuleBase {
   CLASS_MEMBER(HTTTriggerFilter, bool, is_data)
   CLASS_MEMBER(HTTTriggerFilter, bool, is_embedded)
 
+  TriggerTable table_;
+
  public:
   HTTTriggerFilter(std::string const& name);
   virtual ~HTTTriggerFilter();
@@ -5,6 +5,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BTagWeight.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
 #include <string>
 
@@ -53,6 +54,11 @@ class HTTWeights : public ModuleBase {
   TH1F *ggh_hist_down_;
   mithep::TH2DAsymErr* MuonFakeRateHist_PtEta;
   mithep::TH2DAsymErr* ElectronFakeRateHist_PtEta;
+  BinnedTable ggh_table_;
+  BinnedTable ggh_table_up_;
+  BinnedTable ggh_table_down_;
+  BinnedTable muon_fake_rate_;
+  BinnedTable electron_fake_rate_;
   BTagWeight btag_weight;
   TF1 *tau_fake_weights_;
 
@@ -0,0 +1,102 @@
+#ifndef ICHiggsTauTau_HiggsTauTau_MSSMGrid_h
+#define ICHiggsTauTau_HiggsTauTau_MSSMGrid_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
+
+class TH2;
+
+namespace ic {
+
+//! In-memory MSSM cross section, BR and mass grids in (mA, tan(beta))
+/*!
+  Holds every TH2 of an mssm_xs_tools input file (h_brtautau_A,
+  h_ggF_xsec_A, h_bbH_xsec_A, ...) as one flat array, with the
+  histograms that share a binning also sharing the bin lookup.  Channels
+  are addressed by the histogram name, resolved once with Channel().
+
+  Without interpolation a query returns exactly what
+  TH2F::GetBinContent(TH2F::FindBin(mA, tanb)) gives in mssm_xs_tools.
+  With set_interpolate(true) the value is interpolated bilinearly
+  between the bin centres, and held constant beyond the outermost
+  centres.
+
+  Load() can keep a binary copy of the grid next to the ROOT file, so
+  later jobs skip the ROOT file entirely.  The copy is only used while
+  the size and modification time of the ROOT file still match.
+*/
+class MSSMGrid {
+ public:
+  MSSMGrid();
+
+  //! Read all TH2 objects of \a root_file, or the binary copy \a cache_file if it is up to date
+  /*! If \a cache_file is given but missing or stale it is (re)written after
+      reading the ROOT file.
+  */
+  void Load(std::string const& root_file, std::string const& cache_file = "");
+  //! Write the grid in binary form. Returns false on failure
+  bool Save(std::string const& cache_file) const;
+  //! Read a grid written by Save, whatever ROOT file it came from. Returns false on failure
+  bool Restore(std::string const& cache_file);
+
+  //! Add a channel with the contents of \a hist. \a name must be new
+  void AddChannel(std::string const& name, TH2 const* hist);
+
+  //! The index of channel \a name for use in Value and Evaluate
+  unsigned Channel(std::string const& name) const;
+  bool HasChannel(std::string const& name) const;
+
+  double Value(unsigned channel, double mA, double tanb) const;
+  inline double Value(std::string const& name, double mA, double tanb) const {
+    return Value(Channel(name), mA, tanb);
+  }
+
+  //! Evaluate \a channels at \a n points
+  /*! \param out Receives channels.size() * n values, all points of the first
+      channel followed by all points of the second and so on
+  */
+  void Evaluate(std::vector<unsigned> const& channels, std::size_t n,
+                double const* mA, double const* tanb, double * out) const;
+
+  inline MSSMGrid & set_interpolate(bool value) { interpolate_ = value; return *this; }
+  inline bool interpolate() const { return interpolate_; }
+  inline std::string const& description() const { return description_; }
+  inline unsigned n_channels() const { return channels_.size(); }
+  inline std::string const& channel_name(unsigned i) const { return channels_[i].name; }
+
+ private:
+  struct Grid {
+    BinnedAxis x;
+    BinnedAxis y;
+    std::vector<double> x_centres;
+    std::vector<double> y_centres;
+  };
+  struct ChannelInfo {
+    std::string name;
+    unsigned grid;
+    std::size_t offset;
+  };
+  // The bins and weights of one query point, shared by all channels on a grid
+  struct Cell {
+    std::size_t bin[4];
+    double weight[4];
+  };
+
+  unsigned FindGrid(BinnedAxis const& x, BinnedAxis const& y);
+  void Locate(Grid const& grid, double mA, double tanb, Cell & cell) const;
+
+  std::vector<Grid> grids_;
+  std::vector<ChannelInfo> channels_;
+  std::vector<double> values_;
+  std::string description_;
+  // Size and modification time of the ROOT file the grid was read from
+  long long source_size_;
+  long long source_mtime_;
+  bool interpolate_;
+};
+
+}
+
+#endif
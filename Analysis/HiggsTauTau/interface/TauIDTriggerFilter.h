@@ -4,6 +4,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TriggerTable.h"
 
 #include <string>
 #include <fstream>
@@ -18,6 +19,8 @@ class TauIDTriggerFilter : public ModuleBase {
   CLASS_MEMBER(TauIDTriggerFilter, std::string, pair_label)
   CLASS_MEMBER(TauIDTriggerFilter, bool, is_data)
 
+  TriggerTable table_;
+
 
  public:
   TauIDTriggerFilter(std::string const& name);
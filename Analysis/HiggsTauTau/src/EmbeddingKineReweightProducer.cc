@@ -27,9 +27,12 @@ namespace ic {
     std::cout << boost::format(param_fmt()) % "genparticle_label" % genparticle_label_;
     std::cout << boost::format(param_fmt()) % "file"              % file_;
     TFile *f = new TFile(file_.c_str());
-    genTau2PtVsGenTau1Pt_ = GetFromTFile<TH2D>(f, "/", "embeddingKineReweight_muon2Pt_vs_muon1Pt");
-    genTau2EtaVsGenTau1Eta_ = GetFromTFile<TH2D>(f, "/", "embeddingKineReweight_muon2Eta_vs_muon1Eta");
-    genDiTauMassVsGenDiTauPt_ = GetFromTFile<TH2D>(f, "/", "embeddingKineReweight_diMuonMass_vs_diMuonPt");
+    TH2D hist = GetFromTFile<TH2D>(f, "/", "embeddingKineReweight_muon2Pt_vs_muon1Pt");
+    genTau2PtVsGenTau1Pt_ = BinnedTable(&hist);
+    hist = GetFromTFile<TH2D>(f, "/", "embeddingKineReweight_muon2Eta_vs_muon1Eta");
+    genTau2EtaVsGenTau1Eta_ = BinnedTable(&hist);
+    hist = GetFromTFile<TH2D>(f, "/", "embeddingKineReweight_diMuonMass_vs_diMuonPt");
+    genDiTauMassVsGenDiTauPt_ = BinnedTable(&hist);
     f->Close();
     delete f;
 
@@ -124,42 +127,20 @@ namespace ic {
         !eventInfo->weight_defined("kin_weight2") ||
         !eventInfo->weight_defined("kin_weight3")) return 0;
 
-    double x,y;
-    int bin_x, bin_y;
-
-    x = taus[0]->pt();
-    y = taus[1]->pt();
-    bin_x = genTau2PtVsGenTau1Pt_.GetXaxis()->FindBin(x);
-    bin_y = genTau2PtVsGenTau1Pt_.GetYaxis()->FindBin(y);
-    if (bin_x <= 1) bin_x = 1;
-    if (bin_y <= 1) bin_y = 1;
-    if (bin_x >= genTau2PtVsGenTau1Pt_.GetXaxis()->GetNbins()) bin_x = genTau2PtVsGenTau1Pt_.GetXaxis()->GetNbins();
-    if (bin_y >= genTau2PtVsGenTau1Pt_.GetYaxis()->GetNbins()) bin_y = genTau2PtVsGenTau1Pt_.GetYaxis()->GetNbins();
-    double new_kin_weight1 = genTau2PtVsGenTau1Pt_.GetBinContent(bin_x, bin_y);
+    // Values outside the histograms take the first or last bin
+    double new_kin_weight1 = genTau2PtVsGenTau1Pt_.GetValue(
+        genTau2PtVsGenTau1Pt_.FindBinClamped(taus[0]->pt(), taus[1]->pt()));
     if (new_kin_weight1 > 10.0) new_kin_weight1 = 10.0;
     eventInfo->set_weight("kin_weight1",new_kin_weight1);
 
-    x = taus[0]->eta();
-    y = taus[1]->eta();
-    bin_x = genTau2EtaVsGenTau1Eta_.GetXaxis()->FindBin(x);
-    bin_y = genTau2EtaVsGenTau1Eta_.GetYaxis()->FindBin(y);
-    if (bin_x <= 1) bin_x = 1;
-    if (bin_y <= 1) bin_y = 1;
-    if (bin_x >= genTau2EtaVsGenTau1Eta_.GetXaxis()->GetNbins()) bin_x = genTau2EtaVsGenTau1Eta_.GetXaxis()->GetNbins();
-    if (bin_y >= genTau2EtaVsGenTau1Eta_.GetYaxis()->GetNbins()) bin_y = genTau2EtaVsGenTau1Eta_.GetYaxis()->GetNbins();
-    double new_kin_weight2 = genTau2EtaVsGenTau1Eta_.GetBinContent(bin_x, bin_y);
+    double new_kin_weight2 = genTau2EtaVsGenTau1Eta_.GetValue(
+        genTau2EtaVsGenTau1Eta_.FindBinClamped(taus[0]->eta(), taus[1]->eta()));
     if (new_kin_weight2 > 10.0) new_kin_weight2 = 10.0;
     eventInfo->set_weight("kin_weight2",new_kin_weight2);
     
-    x = (taus[0]->vector()+taus[1]->vector()).pt();
-    y = (taus[0]->vector()+taus[1]->vector()).M();
-    bin_x = genDiTauMassVsGenDiTauPt_.GetXaxis()->FindBin(x);
-    bin_y = genDiTauMassVsGenDiTauPt_.GetYaxis()->FindBin(y);
-    if (bin_x <= 1) bin_x = 1;
-    if (bin_y <= 1) bin_y = 1;
-    if (bin_x >= genDiTauMassVsGenDiTauPt_.GetXaxis()->GetNbins()) bin_x = genDiTauMassVsGenDiTauPt_.GetXaxis()->GetNbins();
-    if (bin_y >= genDiTauMassVsGenDiTauPt_.GetYaxis()->GetNbins()) bin_y = genDiTauMassVsGenDiTauPt_.GetYaxis()->GetNbins();
-    double new_kin_weight3 = genDiTauMassVsGenDiTauPt_.GetBinContent(bin_x, bin_y);
+    Candidate::Vector ditau = taus[0]->vector()+taus[1]->vector();
+    double new_kin_weight3 = genDiTauMassVsGenDiTauPt_.GetValue(
+        genDiTauMassVsGenDiTauPt_.FindBinClamped(ditau.pt(), ditau.M()));
     if (new_kin_weight3 > 10.0) new_kin_weight3 = 10.0;
     eventInfo->set_weight("kin_weight3",new_kin_weight3);
 
@@ -2,6 +2,11 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <fstream>
+#include <stdint.h>
 #include "boost/lexical_cast.hpp"
 #include "boost/algorithm/string.hpp"
 #include "boost/format.hpp"
@@ -9,20 +14,169 @@
 #include "boost/range/algorithm.hpp"
 #include "boost/range/algorithm_ext.hpp"
 #include "boost/filesystem.hpp"
+#include "boost/functional/hash.hpp"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SimpleParamParser.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnRootTools.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/th1fmorph.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/ThreadPool.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
 #include "TPad.h"
 #include "TROOT.h"
 #include "TEfficiency.h"
 #include "TEntryList.h"
+#include "TTreeFormula.h"
+#include "TLeaf.h"
+#include "TNamed.h"
+#include "TThread.h"
 #include "TMath.h"
 
+namespace {
+  // Shape cache files start with a magic number and the full key, followed
+  // by 'R' and a rate, or 'S' and a histogram: the binning, the bin
+  // contents and sums of squared weights (including under- and overflow),
+  // the number of entries and the statistics from TH1::GetStats
+  const char shape_cache_magic[4] = {'H', 'T', 'T', 'C'};
+
+  void WriteDoubles(std::ostream & out, double const* vals, unsigned n) {
+    out.write(reinterpret_cast<char const*>(vals), n * sizeof(double));
+  }
+
+  bool ReadDoubles(std::istream & in, double * vals, unsigned n) {
+    return bool(in.read(reinterpret_cast<char *>(vals), n * sizeof(double)));
+  }
+
+  bool OpenCacheFile(std::ifstream & in, std::string const& path, std::string const& key, char type) {
+    in.open(path.c_str(), std::ios::binary);
+    if (!in) return false;
+    char magic[4];
+    uint32_t size = 0;
+    if (!in.read(magic, 4) || !std::equal(magic, magic + 4, shape_cache_magic)) return false;
+    if (!in.read(reinterpret_cast<char *>(&size), sizeof(size)) || size != key.size()) return false;
+    std::string stored(size, ' ');
+    char stored_type = 0;
+    if (!in.read(&stored[0], size) || stored != key) return false;
+    return in.read(&stored_type, 1) && stored_type == type;
+  }
+
+  void WriteCacheFile(std::string const& dir, std::string const& path, std::string const& key,
+      char type, std::function<void(std::ostream &)> body) {
+    // Write to a temporary file first so that concurrent jobs never see a
+    // partially written entry
+    boost::filesystem::path tmp = boost::filesystem::unique_path(dir+"/%%%%-%%%%-%%%%-%%%%.tmp");
+    {
+      std::ofstream out(tmp.string().c_str(), std::ios::binary);
+      if (!out) return;
+      uint32_t size = key.size();
+      out.write(shape_cache_magic, 4);
+      out.write(reinterpret_cast<char const*>(&size), sizeof(size));
+      out.write(key.data(), key.size());
+      out.write(&type, 1);
+      body(out);
+      if (!out) {
+        out.close();
+        boost::filesystem::remove(tmp);
+        return;
+      }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmp, path, ec);
+    if (ec) boost::filesystem::remove(tmp, ec);
+  }
+}
+
 namespace ic {
 
+  // Fill the booked histograms of one sample.  This only touches the
+  // sample's own tree, histograms and cached columns, so different samples
+  // can be filled concurrently when no TTreeFormula is involved.
+  void HTTAnalysis::FillSample(SampleFill & fill) {
+    Long64_t entries = fill.tree->GetEntries();
+    // Either every entry is processed, or only those listed in fill.subset
+    Long64_t n_proc = fill.use_subset ? Long64_t(fill.subset.size()) : entries;
+    unsigned n_cols = fill.leaves.size();
+    // With the column cache each branch is read in full the first time it
+    // is needed, and then served from memory
+    std::vector<double const*> cached(n_cols, nullptr);
+    for (unsigned c = 0; c < n_cols; ++c) {
+      if (!fill.cache[c]) continue;
+      std::vector<double> & column = *(fill.cache[c]);
+      if (Long64_t(column.size()) != entries) {
+        column.resize(entries);
+        for (Long64_t entry = 0; entry < entries; ++entry) {
+          fill.leaves[c]->GetBranch()->GetEntry(entry);
+          column[entry] = fill.leaves[c]->GetValue(0);
+        }
+      }
+      cached[c] = column.data();
+    }
+    // Process the tree in batches: the needed branches are read into
+    // columns, then each expression is evaluated over the whole batch
+    const Long64_t batch_size = 4096;
+    unsigned n_exprs = fill.compiled.size();
+    std::vector<std::vector<double>> columns(n_cols);
+    for (unsigned c = 0; c < n_cols; ++c) {
+      if (!cached[c] || fill.use_subset) columns[c].resize(batch_size);
+    }
+    std::vector<std::vector<double>> values(n_exprs, std::vector<double>(batch_size));
+    std::vector<std::vector<double const*>> inputs(n_exprs);
+    for (unsigned e = 0; e < n_exprs; ++e) inputs[e].resize(fill.expr_columns[e].size());
+    fill.recorded.assign(fill.record_ids.size(), std::vector<Long64_t>());
+    std::vector<Long64_t> batch_entries(batch_size);
+    bool use_formulas = std::count(fill.formulas.begin(), fill.formulas.end(), nullptr) != int(n_exprs);
+    for (Long64_t begin = 0; begin < n_proc; begin += batch_size) {
+      Long64_t size = std::min(batch_size, n_proc - begin);
+      for (Long64_t k = 0; k < size; ++k) {
+        Long64_t entry = fill.use_subset ? fill.subset[begin + k] : begin + k;
+        batch_entries[k] = entry;
+        for (unsigned c = 0; c < n_cols; ++c) {
+          if (cached[c]) {
+            if (fill.use_subset) columns[c][k] = cached[c][entry];
+            continue;
+          }
+          fill.leaves[c]->GetBranch()->GetEntry(entry);
+          columns[c][k] = fill.leaves[c]->GetValue(0);
+        }
+        if (!use_formulas) continue;
+        fill.tree->LoadTree(entry);
+        for (unsigned e = 0; e < n_exprs; ++e) {
+          if (!fill.formulas[e]) continue;
+          fill.formulas[e]->GetNdata();
+          values[e][k] = fill.formulas[e]->EvalInstance(0);
+        }
+      }
+      for (unsigned e = 0; e < n_exprs; ++e) {
+        if (!fill.compiled[e].is_valid()) continue;
+        for (unsigned j = 0; j < fill.expr_columns[e].size(); ++j) {
+          unsigned c = fill.expr_columns[e][j];
+          inputs[e][j] = (cached[c] && !fill.use_subset) ? cached[c] + begin : columns[c].data();
+        }
+        fill.compiled[e].Evaluate(inputs[e], size, values[e].data());
+      }
+      for (unsigned i = 0; i < fill.hists.size(); ++i) {
+        if (!fill.valid[i]) continue;
+        double const* w = values[fill.cut_ids[i]].data();
+        double const* x = fill.var_ids[i] >= 0 ? values[fill.var_ids[i]].data() : nullptr;
+        for (Long64_t k = 0; k < size; ++k) {
+          if (w[k] == 0.) continue;
+          fill.hists[i].Fill(x ? x[k] : 0.5, w[k]);
+        }
+      }
+      for (unsigned r = 0; r < fill.record_ids.size(); ++r) {
+        double const* pass = values[fill.record_ids[r]].data();
+        for (Long64_t k = 0; k < size; ++k) {
+          if (pass[k] != 0.) fill.recorded[r].push_back(batch_entries[k]);
+        }
+      }
+    }
+  }
+
   HTTAnalysis::HTTAnalysis(ic::channel ch, std::string year, int verbosity) : ch_(ch), year_(year), verbosity_(verbosity)  {
     lumi_ = 1.;
+    booking_ = false;
+    cout_buf_ = nullptr;
+    use_column_cache_ = false;
+    shape_cache_max_mb_ = 0;
+    threads_ = 1;
     qcd_os_ss_factor_ = 1.06;
     using boost::range::push_back;
     // Define some sensible defaults
@@ -325,6 +479,15 @@ namespace ic {
       }
       tfiles_[label] = tmp_file;
       ttrees_[label] = tmp_tree;
+      tfile_names_[label] = input_filename;
+      // Trees written by HTTCategories carry the names of the category bits
+      TNamed *schema = tmp_tree->GetUserInfo() ? dynamic_cast<TNamed*>(tmp_tree->GetUserInfo()->FindObject("cat_bits_schema")) : nullptr;
+      if (schema) {
+        std::vector<std::string> names;
+        std::string title = schema->GetTitle();
+        boost::split(names, title, boost::is_any_of(" "), boost::token_compress_on);
+        for (unsigned i = 0; i < names.size(); ++i) cat_bits_schema_[label][names[i]] = i;
+      }
     }
     for (auto str : result_summary) std::cout << str;
   }
@@ -697,28 +860,38 @@ namespace ic {
           hmap["qqH"+infix+m+postfix] = qqh_tmp_1;     
         }
       }
+      // No samples at 145 and 155, these are morphed horizontally from the
+      // neighbouring masses.  All targets between the same pair of masses
+      // are done in a single th1fmorph_batch call
+      std::map<std::pair<std::string, std::string>, std::vector<std::string>> targets;
       for (auto const& m : masses) {
-        if (m == "145" || m == "155") { // no samples, will do horizontal morphing
-          double x1, x2, x;
-          std::string s1, s2;
-          if (m == "145") {
-            x = 145; x1 = 140; x2 = 150; s1 = "140"; s2 = "150";
-          }
-          if (m == "155") {
-            x = 155; x1 = 150; x2 = 160; s1 = "150"; s2 = "160";
-          }
-          std::vector<std::string> procs = {"ggH", "qqH"};
-          for (auto p : procs) {
-            double yield = 1.0;
-            double y1 = hmap[p+infix+s1+postfix].second.first;
-            double y2 = hmap[p+infix+s2+postfix].second.first;
+        if (m == "145") targets[std::make_pair("140", "150")].push_back(m);
+        if (m == "155") targets[std::make_pair("150", "160")].push_back(m);
+      }
+      for (auto const& target : targets) {
+        std::string const& s1 = target.first.first;
+        std::string const& s2 = target.first.second;
+        double x1 = boost::lexical_cast<double>(s1);
+        double x2 = boost::lexical_cast<double>(s2);
+        std::vector<std::string> procs = {"ggH", "qqH"};
+        for (auto p : procs) {
+          double y1 = hmap[p+infix+s1+postfix].second.first;
+          double y2 = hmap[p+infix+s2+postfix].second.first;
+          std::vector<double> xs;
+          std::vector<double> yields;
+          for (auto const& m : target.second) {
+            double x = boost::lexical_cast<double>(m);
+            xs.push_back(x);
             if (x2 == x1) {
-              yield =  0.5*(y1+y2);
+              yields.push_back(0.5*(y1+y2));
             } else {
-              yield = y1 + ((y2 - y1)/(x2 - x1))*(x-x1);
+              yields.push_back(y1 + ((y2 - y1)/(x2 - x1))*(x-x1));
             }
-            hmap[p+infix+m+postfix].first = *(th1fmorph("morphed","morphed", &(hmap[p+infix+s1+postfix].first), &(hmap[p+infix+s2+postfix].first), x1, x2, x, yield, 0));
-            hmap[p+infix+m+postfix].second = std::make_pair(yield,0.0);
+          }
+          std::vector<TH1F> morphed = th1fmorph_batch("morphed","morphed", &(hmap[p+infix+s1+postfix].first), &(hmap[p+infix+s2+postfix].first), x1, x2, xs, yields, 0);
+          for (unsigned i = 0; i < target.second.size(); ++i) {
+            hmap[p+infix+target.second[i]+postfix].first = morphed[i];
+            hmap[p+infix+target.second[i]+postfix].second = std::make_pair(yields[i],0.0);
           }
         }
       }
@@ -816,6 +989,44 @@ namespace ic {
     return full_selection;                                      
   }
 
+  std::string HTTAnalysis::BuildCutString(std::string const& sample,
+      std::string const& selection,
+      std::string const& category,
+      std::string const& weight) {
+    return ResolveCategoryBits(sample, BuildCutString(selection, category, weight));
+  }
+
+  std::string HTTAnalysis::ResolveCategoryBits(std::string const& sample, std::string const& cut) {
+    if (cut.find('@') == cut.npos) return cut;
+    auto schema = cat_bits_schema_.find(sample);
+    std::string result;
+    std::size_t pos = 0;
+    while (pos < cut.size()) {
+      if (cut[pos] != '@') {
+        result += cut[pos++];
+        continue;
+      }
+      // Names may contain '-' (e.g. os_con_mt_60-120), so take the longest
+      // registered name that follows the '@'
+      std::size_t end = pos + 1;
+      while (end < cut.size() && (std::isalnum(static_cast<unsigned char>(cut[end])) || cut[end] == '_' || cut[end] == '-')) ++end;
+      std::string name = cut.substr(pos + 1, end - pos - 1);
+      while (schema != cat_bits_schema_.end() && name.size() && !schema->second.count(name)) {
+        std::size_t dash = name.find_last_of('-');
+        name = (dash == name.npos) ? "" : name.substr(0, dash);
+      }
+      if (schema == cat_bits_schema_.end() || name == "") {
+        std::cerr << "[HTTAnalysis::ResolveCategoryBits] Error: " << cut.substr(pos, end - pos)
+          << " is not a category or selection in the cat_bits schema of " << sample << std::endl;
+        exit(1);
+      }
+      unsigned idx = schema->second.find(name)->second;
+      result += (boost::format("((cat_bits_%i>>%i)&1)") % (idx / 32) % (idx % 32)).str();
+      pos += name.size() + 1;
+    }
+    return result;
+  }
+
   std::string HTTAnalysis::BuildVarString(std::string const& variable) {
     std::string full_variable = variable;
     if (full_variable.find_last_of("(") != full_variable.npos 
@@ -833,6 +1044,27 @@ namespace ic {
                                        std::string const& category, 
                                        std::string const& weight) {
     TH1::SetDefaultSumw2(true);
+    if (booking_) {
+      BookShape(variable, sample, selection, category, weight);
+      std::string expression;
+      TH1F result;
+      if (!BuildHistogram(variable, expression, result)) result = TH1F("htemp","htemp", 1, 0., 1.);
+      for (int i = 1; i <= result.GetNbinsX(); ++i) result.SetBinContent(i, 1.);
+      return result;
+    }
+    std::string result_key = ResultKey(variable, sample, selection, category, weight);
+    auto booked = shape_results_.find(result_key);
+    std::string cache_key = ShapeCacheKey(sample, variable, BuildCutString(sample, selection, category, weight));
+    if (booked == shape_results_.end() && cache_key != "") {
+      TH1F cached;
+      if (ReadShapeCache(cache_key, cached)) booked = shape_results_.insert(std::make_pair(result_key, cached)).first;
+    }
+    if (booked != shape_results_.end()) {
+      TH1F result = booked->second;
+      auto rate = GetRate(sample, selection, category, weight);
+      SetNorm(&result, rate.first);
+      return result;
+    }
     std::string full_variable = BuildVarString(variable);
     std::size_t begin_var = full_variable.find("[");
     std::size_t end_var   = full_variable.find("]");
@@ -849,15 +1081,18 @@ namespace ic {
       full_variable.erase(begin_var, full_variable.npos);
       full_variable += ">>htemp";
     }
-    std::string full_selection = BuildCutString(selection, category, weight);
+    std::string full_selection = BuildCutString(sample, selection, category, weight);
     // std::cout << full_selection << std::endl;
     // std::cout << full_variable << std::endl;
+    TEntryList *elist = SetSelectionEntryList(sample, selection);
     TH1::AddDirectory(true);
     ttrees_[sample]->Draw(full_variable.c_str(), full_selection.c_str(), "goff");
     TH1::AddDirectory(false);
+    ClearSelectionEntryList(sample, elist);
     htemp = (TH1F*)gDirectory->Get("htemp");
     TH1F result = (*htemp);
     gDirectory->Delete("htemp;*");
+    if (cache_key != "") WriteShapeCache(cache_key, result);
     auto rate = GetRate(sample, selection, category, weight);
     SetNorm(&result, rate.first);
     return result;
@@ -878,7 +1113,11 @@ namespace ic {
                                        std::string const& selection, 
                                        std::string const& category, 
                                        std::string const& weight) {
-
+    // Fill any shapes that are not known yet in one pass, one sample per thread
+    if (!booking_ && samples.size() > 1) {
+      for (auto const& sample : samples) BookShape(variable, sample, selection, category, weight);
+      if (!bookings_.empty()) Run();
+    }
     TH1F result = GetLumiScaledShape(variable, samples.at(0), selection, category, weight);
     if (samples.size() > 1) {
       for (unsigned i = 1; i < samples.size(); ++i) {
@@ -896,13 +1135,28 @@ namespace ic {
                                       std::string const& weight) {
     if (verbosity_ > 1) std::cout << "--GetRate-- Sample:\"" << sample << "\" Selection:\"" << selection << "\" Category:\"" 
       << category << "\" Weight:\"" << weight << "\"" << std::endl;
-    std::string full_selection = BuildCutString(selection, category, weight);
+    if (booking_) {
+      BookRate(sample, selection, category, weight);
+      return std::make_pair(1.0, 1.0);
+    }
+    auto booked = rate_results_.find(ResultKey("", sample, selection, category, weight));
+    if (booked != rate_results_.end()) return booked->second;
+    std::string full_selection = BuildCutString(sample, selection, category, weight);
+    std::string cache_key = ShapeCacheKey(sample, "", full_selection);
+    Value result;
+    if (cache_key != "" && ReadRateCache(cache_key, result)) {
+      rate_results_[ResultKey("", sample, selection, category, weight)] = result;
+      return result;
+    }
+    TEntryList *elist = SetSelectionEntryList(sample, selection);
     TH1::AddDirectory(true);
     ttrees_[sample]->Draw("0.5>>htemp(1,0,1)", full_selection.c_str(), "goff");
     TH1::AddDirectory(false);
+    ClearSelectionEntryList(sample, elist);
     TH1F *htemp = (TH1F*)gDirectory->Get("htemp");
-    auto result = std::make_pair(Integral(htemp), Error(htemp));
+    result = std::make_pair(Integral(htemp), Error(htemp));
     gDirectory->Delete("htemp;*");
+    if (cache_key != "") WriteRateCache(cache_key, result);
     return result;
   }
 
@@ -920,6 +1174,10 @@ namespace ic {
                                       std::string const& selection, 
                                       std::string const& category, 
                                       std::string const& weight) {
+    if (!booking_ && samples.size() > 1) {
+      for (auto const& sample : samples) BookRate(sample, selection, category, weight);
+      if (!bookings_.empty()) Run();
+    }
     auto result = GetLumiScaledRate(samples.at(0), selection, category, weight);
     double err_sqr = result.second * result.second;
     if (samples.size() > 1) {
@@ -1202,42 +1460,34 @@ namespace ic {
     std::cout << "[HTTAnalysis::KolmogorovTest] Calculating statistic for shapes:" << std::endl;
     std::cout << "[1] " << boost::format("%s,'%s','%s','%s'\n") % sample1 % selection1 % category1 % weight;
     std::cout << "[2] " << boost::format("%s,'%s','%s','%s'\n") % sample2 % selection2 % category2 % weight;
-    std::string full1 = BuildCutString(selection1, category1, weight);
-    std::string full2 = BuildCutString(selection2, category2, weight);
-    TH1::AddDirectory(true);
-    ttrees_[sample1]->Draw(">>elist", full1.c_str(), "entrylist");
-    TEntryList *elist1 = (TEntryList*)gDirectory->Get("elist");
-    TH1::AddDirectory(false);
-    unsigned entries1 = elist1->GetN();
+    std::string full1 = BuildCutString(sample1, selection1, category1, weight);
+    std::string full2 = BuildCutString(sample2, selection2, category2, weight);
+    std::vector<Long64_t> const& elist1 = GetEntryList(sample1, full1);
+    unsigned entries1 = elist1.size();
     double x1;
     double wt1;
     std::vector<std::pair<double,double>> a(entries1,std::make_pair(0.,0.));
     ttrees_[sample1]->SetBranchAddress(variable.c_str(), &x1);
     ttrees_[sample1]->SetBranchAddress(weight.c_str(), &wt1);
     for (unsigned i = 0; i < entries1; ++i) {
-      unsigned entry = elist1->GetEntry(i);
-      ttrees_[sample1]->GetEntry(entry);
+      ttrees_[sample1]->GetEntry(elist1[i]);
       a[i].first = x1;
       a[i].second = wt1;
     }
-    gDirectory->Delete("elist;*");
-    TH1::AddDirectory(true);
-    ttrees_[sample2]->Draw(">>elist", full2.c_str(), "entrylist");
-    TEntryList *elist2 = (TEntryList*)gDirectory->Get("elist");
-    TH1::AddDirectory(false);
-    unsigned entries2 = elist2->GetN();
+    ttrees_[sample1]->ResetBranchAddresses();
+    std::vector<Long64_t> const& elist2 = GetEntryList(sample2, full2);
+    unsigned entries2 = elist2.size();
     double x2;
     double wt2;
     std::vector<std::pair<double,double>> b(entries2,std::make_pair(0.,0.));
     ttrees_[sample2]->SetBranchAddress(variable.c_str(), &x2);
     ttrees_[sample2]->SetBranchAddress(weight.c_str(), &wt2);
     for (unsigned i = 0; i < entries2; ++i) {
-      unsigned entry = elist2->GetEntry(i);
-      ttrees_[sample2]->GetEntry(entry);
+      ttrees_[sample2]->GetEntry(elist2[i]);
       b[i].first = x2;
       b[i].second = wt2;
     }
-    gDirectory->Delete("elist;*");
+    ttrees_[sample2]->ResetBranchAddresses();
     std::sort(a.begin(), a.end(), [](const std::pair<double, double>& first, const std::pair<double, double>& second)
       {
         return first.first < second.first;
@@ -1305,6 +1555,518 @@ namespace ic {
     return prob;
   }
 
+  void HTTAnalysis::StartBooking() {
+    if (booking_) return;
+    if (use_column_cache_) {
+      for (auto const& sample_file : tfile_names_) RefreshColumnCache(sample_file.first);
+    }
+    booking_ = true;
+    // A stream without a buffer discards everything written to it
+    cout_buf_ = std::cout.rdbuf(nullptr);
+  }
+
+  void HTTAnalysis::BookShape(std::string const& variable,
+                              std::string const& sample,
+                              std::string const& selection,
+                              std::string const& category,
+                              std::string const& weight) {
+    if (!ttrees_.count(sample)) return;
+    // GetShape also needs the rate to normalise the histogram
+    BookRate(sample, selection, category, weight);
+    std::string expression;
+    TH1F hist;
+    // Variables without explicit binning are left to TTree::Draw
+    if (!BuildHistogram(variable, expression, hist)) return;
+    std::string key = ResultKey(variable, sample, selection, category, weight);
+    if (booked_keys_.count(key) || shape_results_.count(key)) return;
+    std::string cut = BuildCutString(sample, selection, category, weight);
+    std::string cache_key = ShapeCacheKey(sample, variable, cut);
+    if (cache_key != "" && ReadShapeCache(cache_key, hist)) {
+      shape_results_[key] = hist;
+      return;
+    }
+    booked_keys_.insert(key);
+    bookings_[sample].push_back({key, variable, cut, cache_key, BuildCutString(sample, selection, "", "")});
+  }
+
+  void HTTAnalysis::BookRate(std::string const& sample,
+                             std::string const& selection,
+                             std::string const& category,
+                             std::string const& weight) {
+    if (!ttrees_.count(sample)) return;
+    std::string key = ResultKey("", sample, selection, category, weight);
+    if (booked_keys_.count(key) || rate_results_.count(key)) return;
+    std::string cut = BuildCutString(sample, selection, category, weight);
+    std::string cache_key = ShapeCacheKey(sample, "", cut);
+    Value rate;
+    if (cache_key != "" && ReadRateCache(cache_key, rate)) {
+      rate_results_[key] = rate;
+      return;
+    }
+    booked_keys_.insert(key);
+    bookings_[sample].push_back({key, "", cut, cache_key, BuildCutString(sample, selection, "", "")});
+  }
+
+  void HTTAnalysis::Run() {
+    if (booking_) {
+      std::cout.rdbuf(cout_buf_);
+      booking_ = false;
+    }
+    TH1::SetDefaultSumw2(true);
+    bool add_dir = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(false);
+    // Everything that touches ROOT globals (formulas, histograms, the
+    // column cache maps) is set up here, so that the samples can then be
+    // filled independently
+    std::vector<SampleFill> fills(bookings_.size());
+    unsigned n_fill = 0;
+    for (auto const& sample_bookings : bookings_) {
+      if (use_column_cache_) RefreshColumnCache(sample_bookings.first);
+      SampleFill & fill = fills[n_fill++];
+      TTree *tree = ttrees_[sample_bookings.first];
+      fill.tree = tree;
+      std::vector<Booking> const& bookings = sample_bookings.second;
+      if (verbosity_ > 0) std::cout << "[HTTAnalysis::Run] Filling " << bookings.size()
+        << " booked histograms and rates for " << sample_bookings.first << std::endl;
+      // Identical expressions are only evaluated once.  Each one is compiled
+      // for batch evaluation if possible, otherwise a TTreeFormula is used
+      std::map<std::string, unsigned> expr_ids;
+      std::map<std::string, unsigned> column_ids;
+      auto expr_id = [&](std::string const& expr) -> unsigned {
+        auto it = expr_ids.find(expr);
+        if (it != expr_ids.end()) return it->second;
+        unsigned id = fill.compiled.size();
+        fill.compiled.push_back(CompiledExpression(expr));
+        fill.formulas.push_back(nullptr);
+        fill.expr_columns.push_back(std::vector<unsigned>());
+        CompiledExpression & compiled = fill.compiled[id];
+        // Every variable must be a scalar leaf of the tree, aliases and
+        // arrays are left to TTreeFormula
+        for (auto const& var : compiled.variables()) {
+          if (!compiled.is_valid()) break;
+          auto col = column_ids.find(var);
+          if (col != column_ids.end()) {
+            fill.expr_columns[id].push_back(col->second);
+            continue;
+          }
+          TLeaf *leaf = tree->GetAlias(var.c_str()) ? nullptr : tree->GetLeaf(var.c_str());
+          if (!leaf || leaf->GetLen() != 1 || leaf->GetLeafCount()) {
+            compiled = CompiledExpression();
+            break;
+          }
+          column_ids[var] = fill.leaves.size();
+          fill.expr_columns[id].push_back(fill.leaves.size());
+          fill.leaves.push_back(leaf);
+          fill.cache.push_back(use_column_cache_ ? &column_cache_[sample_bookings.first].columns[var] : nullptr);
+        }
+        if (!compiled.is_valid()) {
+          std::string name = "formula"+boost::lexical_cast<std::string>(id);
+          fill.formulas[id] = new TTreeFormula(name.c_str(), expr.c_str(), tree);
+        }
+        expr_ids[expr] = id;
+        return id;
+      };
+      unsigned n = bookings.size();
+      fill.hists.resize(n);
+      fill.cut_ids.resize(n);
+      fill.var_ids.assign(n, -1);
+      for (unsigned i = 0; i < n; ++i) {
+        fill.cut_ids[i] = expr_id(bookings[i].cut == "" ? "1" : bookings[i].cut);
+        if (bookings[i].variable == "") {
+          fill.hists[i] = TH1F("htemp","htemp", 1, 0., 1.);
+        } else {
+          std::string expression;
+          BuildHistogram(bookings[i].variable, expression, fill.hists[i]);
+          fill.var_ids[i] = expr_id(expression);
+        }
+      }
+      auto expr_valid = [&](unsigned id) {
+        return fill.compiled[id].is_valid() || fill.formulas[id]->GetNdim() != 0;
+      };
+      fill.valid.assign(n, true);
+      for (unsigned i = 0; i < n; ++i) {
+        if (!expr_valid(fill.cut_ids[i]) || (fill.var_ids[i] >= 0 && !expr_valid(fill.var_ids[i]))) {
+          fill.valid[i] = false;
+        }
+      }
+      // If the entry lists of all the booked selections are already known,
+      // only the entries in at least one of them need to be read.
+      // Otherwise the lists are recorded while the whole tree is processed
+      std::set<std::string> selections;
+      bool lists_known = true;
+      for (auto const& booking : bookings) {
+        if (booking.selection == "") lists_known = false;
+        selections.insert(booking.selection);
+      }
+      for (auto const& sel : selections) {
+        if (!entry_lists_.count(sample_bookings.first+"\n"+sel)) lists_known = false;
+      }
+      fill.use_subset = lists_known;
+      for (auto const& sel : selections) {
+        std::string list_key = sample_bookings.first+"\n"+sel;
+        if (lists_known) {
+          std::vector<Long64_t> const& list = entry_lists_[list_key];
+          std::vector<Long64_t> merged;
+          std::set_union(fill.subset.begin(), fill.subset.end(), list.begin(), list.end(), std::back_inserter(merged));
+          fill.subset.swap(merged);
+        } else if (sel != "" && !entry_lists_.count(list_key)) {
+          unsigned id = expr_id(sel);
+          if (!expr_valid(id)) continue;
+          fill.record_ids.push_back(id);
+          fill.record_keys.push_back(list_key);
+        }
+      }
+      unsigned n_formulas = fill.formulas.size() - std::count(fill.formulas.begin(), fill.formulas.end(), nullptr);
+      if (verbosity_ > 0) {
+        std::cout << "[HTTAnalysis::Run] " << (fill.compiled.size() - n_formulas) << " compiled expressions reading "
+          << fill.leaves.size() << " branches, " << n_formulas << " TTreeFormula fallbacks" << std::endl;
+        if (fill.use_subset) std::cout << "[HTTAnalysis::Run] Reading " << fill.subset.size() << " of "
+          << tree->GetEntries() << " entries from cached entry lists" << std::endl;
+      }
+    }
+    // Samples that only need compiled expressions are filled in parallel,
+    // each from its own file and into its own histograms.  TTreeFormula is
+    // not thread-safe, so samples that need it are filled here in turn
+    std::vector<SampleFill *> parallel;
+    for (auto & fill : fills) {
+      if (std::count(fill.formulas.begin(), fill.formulas.end(), nullptr) == int(fill.formulas.size())) {
+        parallel.push_back(&fill);
+      }
+    }
+    unsigned n_threads = std::min(threads_, unsigned(parallel.size()));
+    if (n_threads > 1) {
+      TThread::Initialize();
+      if (verbosity_ > 0) std::cout << "[HTTAnalysis::Run] Filling " << parallel.size()
+        << " samples with " << n_threads << " threads" << std::endl;
+      ThreadPool pool(n_threads);
+      std::vector<std::future<void>> done;
+      for (auto fill : parallel) {
+        done.push_back(pool.Submit<void>(std::function<void()>([fill]() { FillSample(*fill); })));
+      }
+      for (auto & fill : fills) {
+        if (std::find(parallel.begin(), parallel.end(), &fill) == parallel.end()) FillSample(fill);
+      }
+      for (auto & d : done) d.get();
+    } else {
+      for (auto & fill : fills) FillSample(fill);
+    }
+    n_fill = 0;
+    for (auto const& sample_bookings : bookings_) {
+      SampleFill & fill = fills[n_fill++];
+      std::vector<Booking> const& bookings = sample_bookings.second;
+      for (unsigned i = 0; i < bookings.size(); ++i) {
+        if (!fill.valid[i]) continue;
+        TH1F & hist = fill.hists[i];
+        if (bookings[i].variable == "") {
+          rate_results_[bookings[i].key] = std::make_pair(Integral(&hist), Error(&hist));
+          if (bookings[i].cache_key != "") WriteRateCache(bookings[i].cache_key, rate_results_[bookings[i].key]);
+        } else {
+          shape_results_[bookings[i].key] = hist;
+          if (bookings[i].cache_key != "") WriteShapeCache(bookings[i].cache_key, hist);
+        }
+      }
+      for (unsigned r = 0; r < fill.record_keys.size(); ++r) entry_lists_[fill.record_keys[r]].swap(fill.recorded[r]);
+      for (auto f : fill.formulas) if (f) delete f;
+    }
+    TH1::AddDirectory(add_dir);
+    bookings_.clear();
+    booked_keys_.clear();
+    PruneShapeCache();
+  }
+
+  void HTTAnalysis::RefreshColumnCache(std::string const& sample) {
+    auto file_it = tfile_names_.find(sample);
+    if (file_it == tfile_names_.end()) return;
+    std::string const& filename = file_it->second;
+    if (!boost::filesystem::exists(filename)) return;
+    std::time_t mtime = boost::filesystem::last_write_time(filename);
+    auto it = column_cache_.find(sample);
+    if (it == column_cache_.end()) {
+      column_cache_[sample].mtime = mtime;
+      return;
+    }
+    if (it->second.mtime == mtime) return;
+    std::cout << "[HTTAnalysis::RefreshColumnCache] " << filename << " has changed, reloading" << std::endl;
+    it->second.mtime = mtime;
+    it->second.columns.clear();
+    TFile *tmp_file = TFile::Open(filename.c_str());
+    TTree *tmp_tree = tmp_file ? dynamic_cast<TTree*>(tmp_file->Get("ntuple")) : nullptr;
+    if (!tmp_tree) {
+      std::cerr << "[HTTAnalysis::RefreshColumnCache] Warning: Unable to extract TTree from file " << filename << std::endl;
+      return;
+    }
+    tfiles_[sample]->Close();
+    delete tfiles_[sample];
+    tfiles_[sample] = tmp_file;
+    ttrees_[sample] = tmp_tree;
+    // Results and entry lists from the old file are no longer valid
+    for (auto list_it = entry_lists_.begin(); list_it != entry_lists_.end();) {
+      if (list_it->first.compare(0, sample.size() + 1, sample+"\n") == 0) {
+        entry_lists_.erase(list_it++);
+      } else {
+        ++list_it;
+      }
+    }
+    std::string tag = "\n"+sample+"\n";
+    for (auto shape_it = shape_results_.begin(); shape_it != shape_results_.end();) {
+      if (shape_it->first.find(tag) == shape_it->first.find('\n')) {
+        shape_results_.erase(shape_it++);
+      } else {
+        ++shape_it;
+      }
+    }
+    for (auto rate_it = rate_results_.begin(); rate_it != rate_results_.end();) {
+      if (rate_it->first.find(tag) == rate_it->first.find('\n')) {
+        rate_results_.erase(rate_it++);
+      } else {
+        ++rate_it;
+      }
+    }
+  }
+
+  void HTTAnalysis::SetThreads(unsigned const& threads) {
+    threads_ = (threads > 0) ? threads : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  void HTTAnalysis::SetShapeCache(std::string const& dir, unsigned max_mb) {
+    shape_cache_dir_ = dir;
+    shape_cache_max_mb_ = max_mb;
+    if (dir == "") return;
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(dir, ec);
+    if (!boost::filesystem::is_directory(dir)) {
+      std::cout << "[HTTAnalysis::SetShapeCache] Warning: Unable to create " << dir << ", the shape cache is disabled" << std::endl;
+      shape_cache_dir_ = "";
+      return;
+    }
+    PruneShapeCache();
+  }
+
+  std::string HTTAnalysis::ShapeCacheKey(std::string const& sample,
+                                         std::string const& variable,
+                                         std::string const& cut) {
+    if (shape_cache_dir_ == "") return "";
+    auto it = tfile_names_.find(sample);
+    if (it == tfile_names_.end()) return "";
+    boost::system::error_code ec;
+    boost::uintmax_t size = boost::filesystem::file_size(it->second, ec);
+    if (ec) return "";
+    std::time_t mtime = boost::filesystem::last_write_time(it->second, ec);
+    if (ec) return "";
+    std::string path = boost::filesystem::absolute(it->second).string();
+    return path+"\n"+boost::lexical_cast<std::string>(size)+"\n"+boost::lexical_cast<std::string>(mtime)
+      +"\n"+variable+"\n"+cut;
+  }
+
+  std::string HTTAnalysis::ShapeCachePath(std::string const& key) const {
+    return (boost::format("%s/%016x.bin") % shape_cache_dir_ % boost::hash<std::string>()(key)).str();
+  }
+
+  bool HTTAnalysis::ReadShapeCache(std::string const& key, TH1F & hist) {
+    std::string path = ShapeCachePath(key);
+    std::ifstream in;
+    if (!OpenCacheFile(in, path, key, 'S')) return false;
+    int32_t bins = 0;
+    char fixed = 0;
+    if (!in.read(reinterpret_cast<char *>(&bins), sizeof(bins)) || bins <= 0) return false;
+    if (!in.read(&fixed, 1)) return false;
+    std::vector<double> edges(fixed ? 2 : bins + 1);
+    std::vector<double> contents(bins + 2);
+    std::vector<double> sumw2(bins + 2);
+    double entries = 0.;
+    double stats[4];
+    if (!ReadDoubles(in, edges.data(), edges.size())) return false;
+    if (!ReadDoubles(in, contents.data(), contents.size())) return false;
+    if (!ReadDoubles(in, sumw2.data(), sumw2.size())) return false;
+    if (!ReadDoubles(in, &entries, 1) || !ReadDoubles(in, stats, 4)) return false;
+    bool add_dir = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(false);
+    if (fixed) {
+      hist = TH1F("htemp", "htemp", bins, edges[0], edges[1]);
+    } else {
+      hist = TH1F("htemp", "htemp", bins, edges.data());
+    }
+    TH1::AddDirectory(add_dir);
+    for (int i = 0; i < bins + 2; ++i) hist.SetBinContent(i, contents[i]);
+    if (hist.GetSumw2N() == 0) hist.Sumw2();
+    hist.GetSumw2()->Set(bins + 2, sumw2.data());
+    hist.PutStats(stats);
+    hist.SetEntries(entries);
+    // The modification time records when an entry was last used
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    return true;
+  }
+
+  bool HTTAnalysis::ReadRateCache(std::string const& key, Value & rate) {
+    std::string path = ShapeCachePath(key);
+    std::ifstream in;
+    if (!OpenCacheFile(in, path, key, 'R')) return false;
+    double vals[2];
+    if (!ReadDoubles(in, vals, 2)) return false;
+    rate = std::make_pair(vals[0], vals[1]);
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    return true;
+  }
+
+  void HTTAnalysis::WriteShapeCache(std::string const& key, TH1F const& hist) {
+    WriteCacheFile(shape_cache_dir_, ShapeCachePath(key), key, 'S', [&](std::ostream & out) {
+      int32_t bins = hist.GetNbinsX();
+      TAxis const* axis = hist.GetXaxis();
+      char fixed = axis->GetXbins()->GetSize() == 0;
+      out.write(reinterpret_cast<char const*>(&bins), sizeof(bins));
+      out.write(&fixed, 1);
+      if (fixed) {
+        double range[2] = {axis->GetXmin(), axis->GetXmax()};
+        WriteDoubles(out, range, 2);
+      } else {
+        WriteDoubles(out, axis->GetXbins()->GetArray(), bins + 1);
+      }
+      TArrayD const* hist_sumw2 = const_cast<TH1F &>(hist).GetSumw2();
+      std::vector<double> contents(bins + 2);
+      std::vector<double> sumw2(bins + 2);
+      for (int i = 0; i < bins + 2; ++i) {
+        contents[i] = hist.GetBinContent(i);
+        sumw2[i] = hist.GetSumw2N() ? hist_sumw2->At(i) : std::fabs(hist.GetBinContent(i));
+      }
+      WriteDoubles(out, contents.data(), contents.size());
+      WriteDoubles(out, sumw2.data(), sumw2.size());
+      double entries = hist.GetEntries();
+      double stats[4];
+      hist.GetStats(stats);
+      WriteDoubles(out, &entries, 1);
+      WriteDoubles(out, stats, 4);
+    });
+  }
+
+  void HTTAnalysis::WriteRateCache(std::string const& key, Value const& rate) {
+    WriteCacheFile(shape_cache_dir_, ShapeCachePath(key), key, 'R', [&](std::ostream & out) {
+      double vals[2] = {rate.first, rate.second};
+      WriteDoubles(out, vals, 2);
+    });
+  }
+
+  void HTTAnalysis::PruneShapeCache() {
+    if (shape_cache_dir_ == "" || shape_cache_max_mb_ == 0) return;
+    namespace fs = boost::filesystem;
+    std::vector<std::pair<std::time_t, fs::path>> files;
+    boost::uintmax_t total = 0;
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(shape_cache_dir_, ec), end; it != end; it.increment(ec)) {
+      if (ec) break;
+      if (it->path().extension().string() != ".bin" || !fs::is_regular_file(it->status())) continue;
+      total += fs::file_size(it->path(), ec);
+      files.push_back(std::make_pair(fs::last_write_time(it->path(), ec), it->path()));
+    }
+    boost::uintmax_t limit = boost::uintmax_t(shape_cache_max_mb_) * 1024 * 1024;
+    if (total <= limit) return;
+    // Remove the least recently used entries first
+    std::sort(files.begin(), files.end());
+    unsigned removed = 0;
+    for (auto const& file : files) {
+      if (total <= limit) break;
+      boost::uintmax_t size = fs::file_size(file.second, ec);
+      if (fs::remove(file.second, ec)) {
+        total -= size;
+        ++removed;
+      }
+    }
+    if (verbosity_ > 0) std::cout << "[HTTAnalysis::PruneShapeCache] Removed " << removed
+      << " entries from " << shape_cache_dir_ << std::endl;
+  }
+
+  void HTTAnalysis::ClearResults() {
+    shape_results_.clear();
+    rate_results_.clear();
+    entry_lists_.clear();
+    entry_list_requests_.clear();
+  }
+
+  std::vector<Long64_t> const& HTTAnalysis::GetEntryList(std::string const& sample, std::string const& cut) {
+    std::string key = sample+"\n"+cut;
+    auto it = entry_lists_.find(key);
+    if (it != entry_lists_.end()) return it->second;
+    std::vector<Long64_t> & entries = entry_lists_[key];
+    TH1::AddDirectory(true);
+    ttrees_[sample]->Draw(">>elist", cut.c_str(), "entrylist");
+    TEntryList *elist = (TEntryList*)gDirectory->Get("elist");
+    TH1::AddDirectory(false);
+    if (elist) {
+      entries.resize(elist->GetN());
+      for (Long64_t i = 0; i < elist->GetN(); ++i) entries[i] = elist->GetEntry(i);
+    }
+    gDirectory->Delete("elist;*");
+    return entries;
+  }
+
+  TEntryList * HTTAnalysis::SetSelectionEntryList(std::string const& sample, std::string const& selection) {
+    if (selection == "") return nullptr;
+    std::string cut = BuildCutString(sample, selection, "", "");
+    if (!entry_lists_.count(sample+"\n"+cut) && ++entry_list_requests_[sample+"\n"+cut] < 2) return nullptr;
+    std::vector<Long64_t> const& entries = GetEntryList(sample, cut);
+    TTree *tree = ttrees_[sample];
+    TEntryList *elist = new TEntryList("selection_elist", "selection_elist", tree);
+    for (auto entry : entries) elist->Enter(entry);
+    tree->SetEntryList(elist);
+    return elist;
+  }
+
+  void HTTAnalysis::ClearSelectionEntryList(std::string const& sample, TEntryList * elist) {
+    if (!elist) return;
+    ttrees_[sample]->SetEntryList(nullptr);
+    delete elist;
+  }
+
+  std::string HTTAnalysis::ResultKey(std::string const& variable,
+                                     std::string const& sample,
+                                     std::string const& selection,
+                                     std::string const& category,
+                                     std::string const& weight) {
+    return variable+"\n"+sample+"\n"+selection+"\n"+category+"\n"+weight;
+  }
+
+  bool HTTAnalysis::BuildHistogram(std::string const& variable, std::string & expression, TH1F & hist) {
+    bool add_dir = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(false);
+    bool ok = false;
+    std::size_t begin_var = variable.find("[");
+    std::size_t end_var   = variable.find("]");
+    try {
+      if (begin_var != variable.npos && end_var != variable.npos) {
+        std::string binning = variable.substr(begin_var+1, end_var-begin_var-1);
+        std::vector<std::string> string_vec;
+        boost::split(string_vec, binning, boost::is_any_of(","));
+        std::vector<double> bin_vec;
+        for (auto str : string_vec) bin_vec.push_back(boost::lexical_cast<double>(boost::trim_copy(str)));
+        if (bin_vec.size() > 1) {
+          hist = TH1F("htemp","htemp", bin_vec.size()-1, &(bin_vec[0]));
+          expression = variable.substr(0, begin_var);
+          ok = true;
+        }
+      } else {
+        std::size_t begin_bins = variable.find_last_of("(");
+        if (begin_bins != variable.npos && begin_bins > 0 && variable[variable.size()-1] == ')') {
+          std::string binning = variable.substr(begin_bins+1, variable.size()-begin_bins-2);
+          std::vector<std::string> string_vec;
+          boost::split(string_vec, binning, boost::is_any_of(","));
+          if (string_vec.size() == 3) {
+            int nbins = boost::lexical_cast<int>(boost::trim_copy(string_vec[0]));
+            double lo = boost::lexical_cast<double>(boost::trim_copy(string_vec[1]));
+            double hi = boost::lexical_cast<double>(boost::trim_copy(string_vec[2]));
+            expression = variable.substr(0, begin_bins);
+            hist = TH1F("htemp", expression.c_str(), nbins, lo, hi);
+            ok = true;
+          }
+        }
+      }
+    } catch (boost::bad_lexical_cast const&) {
+      ok = false;
+    }
+    TH1::AddDirectory(add_dir);
+    return ok;
+  }
+
 
 
 
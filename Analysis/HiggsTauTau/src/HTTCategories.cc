@@ -6,6 +6,9 @@
 
 #include "TMVA/Reader.h"
 #include "TVector3.h"
+#include "TNamed.h"
+#include "boost/algorithm/string/join.hpp"
+#include "boost/lexical_cast.hpp"
 
 namespace ic {
 
@@ -27,13 +30,26 @@ namespace ic {
 
   void HTTCategories::InitSelection(std::string const& selection) {
     selections_[selection] = false;
+    RegisterBit(selection);
   }
   
   void HTTCategories::InitCategory(std::string const& category) {
     categories_[category] = false;
+    RegisterBit(category);
     InitMassPlots(category);
   }
 
+  void HTTCategories::RegisterBit(std::string const& name) {
+    if (bit_index_.count(name)) return;
+    bit_index_[name] = bit_names_.size();
+    bit_names_.push_back(name);
+  }
+
+  void HTTCategories::SetBit(std::string const& name) {
+    unsigned idx = bit_index_[name];
+    cat_bits_[idx / 32] |= (1u << (idx % 32));
+  }
+
   int HTTCategories::PreAnalysis() {
     std::cout << "-------------------------------------" << std::endl;
     std::cout << "HTTCategories" << std::endl;
@@ -225,6 +241,16 @@ namespace ic {
 
     InitCategory("nobtag");
 
+    cat_bits_.resize((bit_names_.size() + 31) / 32, 0);
+    if (fs_ && write_tree_) {
+      for (unsigned i = 0; i < cat_bits_.size(); ++i) {
+        std::string branch = "cat_bits_"+boost::lexical_cast<std::string>(i);
+        outtree_->Branch(branch.c_str(), &cat_bits_[i], (branch+"/i").c_str());
+      }
+      std::string schema = boost::algorithm::join(bit_names_, " ");
+      outtree_->GetUserInfo()->Add(new TNamed("cat_bits_schema", schema.c_str()));
+    }
+
     return 0;
   }
 
@@ -499,8 +525,6 @@ namespace ic {
     }
 
 
-    if (write_tree_) outtree_->Fill();
-
     // Define which selections this event passes
     if (channel_ == channel::et || channel_ == channel::etmet || channel_ == channel::mt || channel_ == channel::mtmet) {
       if (os_ && mt_1_ < 30.0) {
@@ -707,6 +731,9 @@ namespace ic {
 
     if (!PassesCategory("vbf") && n_bjets_ == 0) SetPassCategory("nobtag");
 
+    // The tree is filled last so that it includes the category bits
+    if (write_tree_) outtree_->Fill();
+
     return 0;
   }
 
@@ -741,12 +768,14 @@ namespace ic {
     for (std::map<std::string, bool>::iterator it = categories_.begin(); it != categories_.end(); ++it) {
       it->second = false;
     }
+    std::fill(cat_bits_.begin(), cat_bits_.end(), 0);
   }
 
   void HTTCategories::SetPassSelection(std::string const& selection) {
     std::map<std::string, bool>::iterator it = selections_.find(selection);
     if (it != selections_.end()) {
       it->second = true;
+      SetBit(selection);
     } else {
       std::cerr << "Error in HTTCategories::SetPassSelection: No selection registered with label " << selection << std::endl;
       throw;
@@ -757,6 +786,7 @@ namespace ic {
     std::map<std::string, bool>::iterator it = categories_.find(category);
     if (it != categories_.end()) {
       it->second = true;
+      SetBit(category);
       FillMassPlots(category);
       FillYields(category);
     } else {
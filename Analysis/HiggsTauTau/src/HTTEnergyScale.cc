@@ -1,11 +1,13 @@
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTEnergyScale.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/ShiftedView.h"
 #include "UserCode/ICHiggsTauTau/interface/Tau.hh"
 
 namespace ic {
 
   HTTEnergyScale::HTTEnergyScale(std::string const& name) : ModuleBase(name), channel_(channel::et), strategy_(strategy::moriond2013) {
     moriond_corrections_ = false;
+    output_label_ = "";
   }
 
   HTTEnergyScale::~HTTEnergyScale() {
@@ -19,12 +21,14 @@ namespace ic {
     std::cout << boost::format(param_fmt()) % "moriond_corrections" % moriond_corrections_;
     std::cout << boost::format(param_fmt()) % "input_label"         % input_label_;
     std::cout << boost::format(param_fmt()) % "shift"               % shift_;
+    std::cout << boost::format(param_fmt()) % "output_label"        % output_label_;
     return 0;
   }
 
   int HTTEnergyScale::Execute(TreeEvent *event) {
     std::vector<Tau *> & taus = event->GetPtrVec<Tau>(input_label_);
     std::map<std::size_t, double> tau_scales;
+    std::vector<double> view_scales;
     for (unsigned i = 0; i < taus.size(); ++i) {
       double central_shift = 1.00;
       if (moriond_corrections_) {
@@ -49,11 +53,21 @@ namespace ic {
         central_shift = 1.00;
       }
       double total_shift = central_shift * shift_;
-      taus[i]->set_pt(taus[i]->pt() * total_shift);
-      taus[i]->set_energy(taus[i]->energy() * total_shift);
       tau_scales[taus[i]->id()] = total_shift;
+      if (output_label_ != "") {
+        view_scales.push_back(total_shift);
+      } else {
+        taus[i]->set_pt(taus[i]->pt() * total_shift);
+        taus[i]->set_energy(taus[i]->energy() * total_shift);
+      }
+    }
+    if (output_label_ != "") {
+      ShiftedView<Tau> view(taus);
+      for (unsigned i = 0; i < view_scales.size(); ++i) view.SetScale(i, view_scales[i]);
+      event->Add(output_label_, view);
+    } else {
+      event->Add("tau_scales", tau_scales);
     }
-    event->Add("tau_scales", tau_scales);
     return 0;
   }
 
@@ -1,15 +1,21 @@
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTL1MetCut.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
+#include "UserCode/ICHiggsTauTau/interface/EventInfo.hh"
 #include "boost/format.hpp"
 
 namespace ic {
 
   HTTL1MetCut::HTTL1MetCut(std::string const& name) : ModuleBase(name) {
     l1_met_label_               = "l1extraMET";
-    rand = new TRandom3(0);
+    rand = new CounterRandom();
 
   }
 
+  HTTL1MetCut::HTTL1MetCut(HTTL1MetCut const& other) : ModuleBase(other) {
+    l1_met_label_               = other.l1_met_label_;
+    rand = new CounterRandom();
+  }
+
   HTTL1MetCut::~HTTL1MetCut() {
     delete rand;
   }
@@ -26,6 +32,7 @@ namespace ic {
     std::vector<Candidate *> & v_l1met = event->GetPtrVec<Candidate>(l1_met_label_);
     Candidate *l1met = v_l1met.at(0);
     double cut = 26;
+    rand->SetStream(event->GetPtr<EventInfo>("eventInfo"), 0, "l1met");
     if (rand->Uniform()<=(1.0-4.848/7.317)) cut=20;
     if (l1met->pt() > cut) {
       return 0;
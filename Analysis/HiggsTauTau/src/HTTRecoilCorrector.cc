@@ -1,5 +1,6 @@
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTRecoilCorrector.h"
 #include "UserCode/ICHiggsTauTau/interface/PFJet.hh"
+#include "UserCode/ICHiggsTauTau/interface/EventInfo.hh"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnPredicates.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnPairs.h"
 
@@ -219,6 +220,8 @@ namespace ic {
     double iScale = 0;
     //iFluc 1, iScale 1
     //iFluc -1, iScale -1
+    EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
+    corrector_->setEvent(eventInfo->run(), eventInfo->lumi_block(), eventInfo->event());
     if (mc_ == mc::summer12_53X) {
       if (strategy_ == strategy::hcp2012) corrector_->CorrectType2(pfmet, pfmetphi, genpt, genphi, lep_pt, lep_phi, U1, U2, iFluc, iScale, njets);
       if (strategy_ == strategy::moriond2013) corrector_->CorrectType1(pfmet, pfmetphi, genpt, genphi, lep_pt, lep_phi, U1, U2, iFluc, iScale, njets);
@@ -5,6 +5,7 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <algorithm>
 #include "Math/QuantFuncMathCore.h"
 #include "TMath.h"
 #include "boost/lexical_cast.hpp"
@@ -138,89 +139,226 @@ namespace ic {
 	CategoryKey Observation::GetKey() const { return CategoryKey(mass, era, channel, category); }
 	CategoryKey Process::GetKey() const { return CategoryKey(mass, era, channel, category); }
 
+	namespace {
+		std::string KeyString(CategoryKey const& key) {
+			return key.mass + "\n" + key.era + "\n" + key.channel + "\n" + key.category;
+		}
+
+		// The fields used to decide which processes a nuisance applies to
+		std::string MatchString(std::string const& era, std::string const& channel, std::string const& category, std::string const& process) {
+			return era + "\n" + channel + "\n" + category + "\n" + process;
+		}
+
+		template <class T, class Pred>
+		std::vector<unsigned> Keep(std::vector<unsigned> const& view, std::vector<T> const& rows, Pred pred) {
+			std::vector<unsigned> result;
+			result.reserve(view.size());
+			for (unsigned i = 0; i < view.size(); ++i) {
+				if (pred(rows[view[i]])) result.push_back(view[i]);
+			}
+			return result;
+		}
+
+		// Sum of bins 1 to n, in the same order as TH1::Integral
+		double SumBins(Float_t const* bins, int n) {
+			double total = 0.;
+			for (int k = 1; k <= n; ++k) total += bins[k];
+			return total;
+		}
+
+		// VerticalMorph on the bin contents of the nominal, up and down
+		// histograms, writing the morphed contents to out[1..n]
+		void MorphBins(Float_t const* nominal, Float_t const* up, Float_t const* down, int n, double shift, std::vector<Float_t> & out) {
+			out.assign(nominal, nominal + n + 2);
+			for (int i = 1; i <= n; ++i) {
+				double high = up[i];
+				double low = down[i];
+				double total = nominal[i];
+				double a = 0.5*(high+low)-total;
+				double b = 0.5*(high-low);
+				if (shift > 1.0) {
+					total += (2.0*a+b)*(shift-1.0)+high-nominal[i];
+				} else if (shift < -1.0) {
+					total += -1.0*(2.0*a-b)*(shift+1.0)+low-nominal[i];
+				} else {
+					total += a*pow(shift,2) + b*shift;
+				}
+				if (total <= 0) total = 1E-9;
+				out[i] = total;
+			}
+		}
+
+		// Clone of hist with the bin contents replaced by bins[1..n]
+		TH1F * CloneWithBins(TH1F const* hist, std::vector<Float_t> const& bins) {
+			TH1F * result = (TH1F*)hist->Clone();
+			for (int k = 1; k + 1 < int(bins.size()); ++k) result->SetBinContent(k, bins[k]);
+			return result;
+		}
+	}
+
+	void HTTSetup::Tables::Index() {
+		params_by_nuisance.clear();
+		params_by_process.clear();
+		params_by_key.clear();
+		processes_by_process.clear();
+		processes_by_key.clear();
+		processes_by_match.clear();
+		obs_by_key.clear();
+		for (unsigned i = 0; i < params.size(); ++i) {
+			params_by_nuisance[params[i].nuisance].push_back(i);
+			params_by_process[params[i].process].push_back(i);
+			params_by_key[KeyString(params[i].GetKey())].push_back(i);
+		}
+		for (unsigned i = 0; i < processes.size(); ++i) {
+			Process const& proc = processes[i];
+			processes_by_process[proc.process].push_back(i);
+			processes_by_key[KeyString(proc.GetKey())].push_back(i);
+			processes_by_match[MatchString(proc.era, proc.channel, proc.category, proc.process)].push_back(i);
+		}
+		for (unsigned i = 0; i < obs.size(); ++i) {
+			obs_by_key[KeyString(obs[i].GetKey())].push_back(i);
+		}
+		indexed = true;
+	}
+
 	HTTSetup::HTTSetup() {
+		tables_ = std::make_shared<Tables>();
 		ignore_nuisance_correlations_ = false;
 	}
 
+	HTTSetup::Tables & HTTSetup::Indexed() const {
+		if (!tables_->indexed) tables_->Index();
+		return *tables_;
+	}
+
+	void HTTSetup::Detach() {
+		if (tables_.unique()) return;
+		std::shared_ptr<Tables> own = std::make_shared<Tables>();
+		for (unsigned i = 0; i < params_.size(); ++i) {
+			own->params.push_back(tables_->params[params_[i]]);
+			params_[i] = i;
+		}
+		for (unsigned i = 0; i < processes_.size(); ++i) {
+			own->processes.push_back(tables_->processes[processes_[i]]);
+			processes_[i] = i;
+		}
+		for (unsigned i = 0; i < obs_.size(); ++i) {
+			own->obs.push_back(tables_->obs[obs_[i]]);
+			obs_[i] = i;
+		}
+		tables_ = own;
+	}
+
+	std::vector<unsigned> HTTSetup::Select(std::vector<unsigned> const& view, RowIndex const& index, std::vector<std::string> const& keys) {
+		std::vector<unsigned> result;
+		for (unsigned i = 0; i < keys.size(); ++i) {
+			auto it = index.find(keys[i]);
+			if (it == index.end()) continue;
+			for (unsigned j = 0; j < it->second.size(); ++j) {
+				if (std::binary_search(view.begin(), view.end(), it->second[j])) result.push_back(it->second[j]);
+			}
+		}
+		if (keys.size() > 1) {
+			std::sort(result.begin(), result.end());
+			result.erase(std::unique(result.begin(), result.end()), result.end());
+		}
+		return result;
+	}
+
+	std::vector<unsigned> HTTSetup::MatchingProcesses(Nuisance const& param) const {
+		return Select(processes_, Indexed().processes_by_match, 
+			std::vector<std::string>(1, MatchString(param.era, param.channel, param.category, param.process)));
+	}
+
+	void HTTSetup::AddProcess(Process proc) {
+		Detach();
+		tables_->processes.push_back(proc);
+		tables_->indexed = false;
+		processes_.push_back(tables_->processes.size() - 1);
+	}
+
 	HTTSetup & HTTSetup::PrintAll() {
 		Observation::PrintHeader(std::cout);
-		for (unsigned i = 0; i < obs_.size(); ++i) std::cout << obs_[i] << std::endl;
+		for (unsigned i = 0; i < obs_.size(); ++i) std::cout << tables_->obs[obs_[i]] << std::endl;
 		Process::PrintHeader(std::cout);
-		for (unsigned i = 0; i < processes_.size(); ++i) std::cout << processes_[i] << std::endl;
+		for (unsigned i = 0; i < processes_.size(); ++i) std::cout << tables_->processes[processes_[i]] << std::endl;
 		Nuisance::PrintHeader(std::cout);
-		for (unsigned i = 0; i < params_.size(); ++i) std::cout << params_[i] << std::endl;
+		for (unsigned i = 0; i < params_.size(); ++i) std::cout << tables_->params[params_[i]] << std::endl;
 		return *this;
 	}
 
 	HTTSetup HTTSetup::process(std::vector<std::string> const& process) const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return std::find(process.begin(), process.end(), val.process) == process.end(); });
-		ic::erase_if(result.processes_, [&] (Process const& proc) { return std::find(process.begin(), process.end(), proc.process) == process.end(); });
+		Tables const& t = Indexed();
+		result.params_ = Select(params_, t.params_by_process, process);
+		result.processes_ = Select(processes_, t.processes_by_process, process);
 		return result;
 	}
 
 	HTTSetup HTTSetup::era(std::vector<std::string> const& process) const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return std::find(process.begin(), process.end(), val.era) == process.end(); });
-		ic::erase_if(result.processes_, [&] (Process const& proc) { return std::find(process.begin(), process.end(), proc.era) == process.end(); });
-		ic::erase_if(result.obs_, [&] (Observation const& proc) { return std::find(process.begin(), process.end(), proc.era) == process.end(); });
+		result.params_ = Keep(params_, tables_->params, [&] (Nuisance const& val) { return std::find(process.begin(), process.end(), val.era) != process.end(); });
+		result.processes_ = Keep(processes_, tables_->processes, [&] (Process const& proc) { return std::find(process.begin(), process.end(), proc.era) != process.end(); });
+		result.obs_ = Keep(obs_, tables_->obs, [&] (Observation const& proc) { return std::find(process.begin(), process.end(), proc.era) != process.end(); });
 		return result;
 	}
 
 	HTTSetup HTTSetup::category_id(std::vector<int> const& id) const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return std::find(id.begin(), id.end(), val.category_id) == id.end(); });
-		ic::erase_if(result.processes_, [&] (Process const& proc) { return std::find(id.begin(), id.end(), proc.category_id) == id.end(); });
-		ic::erase_if(result.obs_, [&] (Observation const& proc) { return std::find(id.begin(), id.end(), proc.category_id) == id.end(); });
+		result.params_ = Keep(params_, tables_->params, [&] (Nuisance const& val) { return std::find(id.begin(), id.end(), val.category_id) != id.end(); });
+		result.processes_ = Keep(processes_, tables_->processes, [&] (Process const& proc) { return std::find(id.begin(), id.end(), proc.category_id) != id.end(); });
+		result.obs_ = Keep(obs_, tables_->obs, [&] (Observation const& proc) { return std::find(id.begin(), id.end(), proc.category_id) != id.end(); });
 		return result;
 	}
 
 
 	HTTSetup HTTSetup::nuisance(std::vector<std::string> const& nuisance) const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return std::find(nuisance.begin(), nuisance.end(), val.nuisance) == nuisance.end(); });
+		result.params_ = Select(params_, Indexed().params_by_nuisance, nuisance);
 		return result;
 	}
 
 	HTTSetup HTTSetup::nuisance_pred(std::function<bool(Nuisance const&)> fn) const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, std::not1(fn));
+		result.params_ = Keep(params_, tables_->params, fn);
 		return result;
 	}
 
 
 	HTTSetup HTTSetup::no_shapes() const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return val.type == "shape"; });
+		result.params_ = Keep(params_, tables_->params, [&] (Nuisance const& val) { return val.type != "shape"; });
 		return result;
 	}
 
 	HTTSetup HTTSetup::signals() const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return val.process_id > 0; });
-		ic::erase_if(result.processes_, [&] (Process const& val) { return val.process_id > 0; });
+		result.params_ = Keep(params_, tables_->params, [&] (Nuisance const& val) { return val.process_id <= 0; });
+		result.processes_ = Keep(processes_, tables_->processes, [&] (Process const& val) { return val.process_id <= 0; });
 		return result;
 	}
 
 	HTTSetup HTTSetup::backgrounds() const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return val.process_id <= 0; });
-		ic::erase_if(result.processes_, [&] (Process const& val) { return val.process_id <= 0; });
+		result.params_ = Keep(params_, tables_->params, [&] (Nuisance const& val) { return val.process_id > 0; });
+		result.processes_ = Keep(processes_, tables_->processes, [&] (Process const& val) { return val.process_id > 0; });
 		return result;
 	}
 
 	HTTSetup HTTSetup::key_match(CategoryKey const & keyval) const {
 		HTTSetup result = *this;
-		ic::erase_if(result.params_, [&] (Nuisance const& val) { return !(val.GetKey() == keyval); });
-		ic::erase_if(result.processes_, [&] (Process const& proc) { return !(proc.GetKey() == keyval); });
-		ic::erase_if(result.obs_, [&] (Observation const& proc) { return !(proc.GetKey() == keyval); });
+		Tables const& t = Indexed();
+		std::vector<std::string> key(1, KeyString(keyval));
+		result.params_ = Select(params_, t.params_by_key, key);
+		result.processes_ = Select(processes_, t.processes_by_key, key);
+		result.obs_ = Select(obs_, t.obs_by_key, key);
 		return result;
 	}
 
 	double HTTSetup::GetRate() {
 		double total = 0.0;
 		for (unsigned i = 0; i < processes_.size(); ++i) {
-			total += processes_[i].rate;
+			total += tables_->processes[processes_[i]].rate;
 		}
 		return total;
 	}
@@ -228,7 +366,7 @@ namespace ic {
 		double HTTSetup::GetObservedRate() {
 		double total = 0.0;
 		for (unsigned i = 0; i < obs_.size(); ++i) {
-			total += obs_[i].rate;
+			total += tables_->obs[obs_[i]].rate;
 		}
 		return total;
 	}
@@ -236,50 +374,47 @@ namespace ic {
 	std::set<std::string> HTTSetup::GetNuisanceSet() {
 		std::set<std::string> result;
 		for (unsigned i = 0; i < params_.size(); ++i) {
-			result.insert(params_[i].nuisance);
+			result.insert(tables_->params[params_[i]].nuisance);
 		}
 		return result;
 	}
 
 
 	double HTTSetup::GetUncertainty() {
-		std::set<std::string> nuisances = this->GetNuisanceSet();
+		// Group the parameters by nuisance, in the order of GetNuisanceSet(),
+		// and only visit the processes each one applies to
+		std::map<std::string, std::vector<unsigned>> nuisances;
+		for (unsigned i = 0; i < params_.size(); ++i) nuisances[tables_->params[params_[i]].nuisance].push_back(params_[i]);
 		std::vector<double> uncert_vec;
 		for (auto & nu : nuisances) {
 			double dx = 0;
-			for (unsigned i = 0; i < params_.size(); ++i) {
-				if (params_[i].nuisance != nu) continue;
-				for (unsigned j = 0; j < processes_.size(); ++j) {
-					if (processes_[j].era 			!= params_[i].era 			||
-							processes_[j].channel 	!= params_[i].channel 	||
-							processes_[j].category 	!= params_[i].category 	||
-							processes_[j].process 	!= params_[i].process) continue;
-
+			for (unsigned i = 0; i < nu.second.size(); ++i) {
+				Nuisance const& param = tables_->params[nu.second[i]];
+				std::vector<unsigned> procs = MatchingProcesses(param);
+				for (unsigned j = 0; j < procs.size(); ++j) {
+					Process const& proc = tables_->processes[procs[j]];
 					if (ignore_nuisance_correlations_) {
-						if (params_[i].type == "lnN") {
-							double dxx = ( (params_[i].value-1.0) * processes_[j].rate );
+						if (param.type == "lnN") {
+							double dxx = ( (param.value-1.0) * proc.rate );
 							dx = sqrt(dx*dx +  dxx*dxx); 
 						}
 					} else {
-						if (params_[i].type == "lnN") dx += ( (params_[i].value-1.0) * processes_[j].rate ); 
+						if (param.type == "lnN") dx += ( (param.value-1.0) * proc.rate ); 
 					} 
-					if (params_[i].type == "shape") {
+					if (param.type == "shape") {
 						// Do we have the shapes?
-						if (!params_[i].shape_up || !params_[i].shape_down) {
-							std::cerr << "Warning in <HTTSetup::GetUncertainty>: Shape uncertainty histograms not loaded for nuisance " << params_[i].nuisance << std::endl;
+						if (!param.shape_up || !param.shape_down) {
+							std::cerr << "Warning in <HTTSetup::GetUncertainty>: Shape uncertainty histograms not loaded for nuisance " << param.nuisance << std::endl;
 							continue;
 						}
 						// The yield uncertainty due to a shape variation could be
 						// asymmetric - we take the mean variation here
-						double y = params_[i].shape->Integral();
-						double y_up = params_[i].shape_up->Integral();
-						double y_down = params_[i].shape_down->Integral();
-						// std::cout << "Var+ = " << y_up-y << std::endl;
-						// std::cout << "Var- = " << y_down-y << std::endl;
+						double y = param.shape->Integral();
+						double y_up = param.shape_up->Integral();
+						double y_down = param.shape_down->Integral();
 						double var = (fabs(y_up-y)+fabs(y-y_down))/2.0;
-						// std::cout << "MeanAbsVar = " << var << std::endl;
-						if ((y_up-y >= 0.)) 	dx += (var/y)*processes_[j].rate; 
-						if ((y_up-y < 0.)) 	dx -= (var/y)*processes_[j].rate; 
+						if ((y_up-y >= 0.)) 	dx += (var/y)*proc.rate; 
+						if ((y_up-y < 0.)) 	dx -= (var/y)*proc.rate; 
 					}
 				}
 			}
@@ -294,78 +429,78 @@ namespace ic {
 	}
 
 	TH1F 	HTTSetup::GetShape() {
-		TH1F shape = *(processes_[0].shape);
+		TH1F shape = *(tables_->processes[processes_[0]].shape);
 		// Don't count shape norm. uncertainty in the total
 		double tot_uncert = this->no_shapes().GetUncertainty() / this->GetRate();
-		for (unsigned i = 1; i < processes_.size(); ++i) shape.Add(processes_[i].shape);
-
-		std::set<std::string> nuisances = this->GetNuisanceSet();
-		std::map<int, std::vector<double>> uncert_map;
+		for (unsigned i = 1; i < processes_.size(); ++i) shape.Add(tables_->processes[processes_[i]].shape);
+
+		std::map<std::string, std::vector<unsigned>> nuisances;
+		for (unsigned i = 0; i < params_.size(); ++i) nuisances[tables_->params[params_[i]].nuisance].push_back(params_[i]);
+		// Per-bin shift from each nuisance and their sum in quadrature, in
+		// arrays indexed by bin number
+		int nbins = shape.GetNbinsX();
+		std::vector<double> sum_sq(nbins + 1, 0.);
+		std::vector<double> dx;
 		for (auto& nu : nuisances) {
-			std::map<int, double> dx;
-			for (unsigned i = 0; i < params_.size(); ++i) {
-				if (params_[i].nuisance != nu) continue;
-				for (unsigned j = 0; j < processes_.size(); ++j) {
-					if (processes_[j].era 			!= params_[i].era 			||
-							processes_[j].channel 	!= params_[i].channel 	||
-							processes_[j].category 	!= params_[i].category 	||
-							processes_[j].process 	!= params_[i].process) continue;
-					if (params_[i].type == "shape") {
-						// Do we have the shapes?
-						if (!params_[i].shape_up || !params_[i].shape_down) {
-							std::cerr << "Warning in <HTTSetup::GetUncertainty>: Shape uncertainty histograms not loaded for nuisance " << params_[i].nuisance << std::endl;
-							continue;
-						}
-						if (params_[i].shape->Integral() == 0.) {
-							std::cerr << "Warning in <HTTSetup::GetUncertainty>: Shape uncertainty defined for empty histogram" << std::endl;
-							continue;
-						}
-						for (int k = 1; k <= params_[i].shape->GetNbinsX(); ++k) {
-							double y = params_[i].shape->GetBinContent(k);
-							double y_up = params_[i].shape_up->GetBinContent(k);
-							double y_down = params_[i].shape_down->GetBinContent(k);
-							double var = (fabs(y_up-y)+fabs(y-y_down))/2.0;
-							if ((y_up-y >= 0.)) 	dx[k] += (var)*processes_[j].shape->Integral()/params_[i].shape->Integral(); 
-							if ((y_up-y < 0.)) 	dx[k] -= (var)*processes_[j].shape->Integral()/params_[i].shape->Integral(); 
-						}
+			dx.assign(nbins + 1, 0.);
+			for (unsigned i = 0; i < nu.second.size(); ++i) {
+				Nuisance const& param = tables_->params[nu.second[i]];
+				if (param.type != "shape") continue;
+				std::vector<unsigned> procs = MatchingProcesses(param);
+				for (unsigned j = 0; j < procs.size(); ++j) {
+					Process const& proc = tables_->processes[procs[j]];
+					// Do we have the shapes?
+					if (!param.shape_up || !param.shape_down) {
+						std::cerr << "Warning in <HTTSetup::GetUncertainty>: Shape uncertainty histograms not loaded for nuisance " << param.nuisance << std::endl;
+						continue;
+					}
+					double param_int = param.shape->Integral();
+					if (param_int == 0.) {
+						std::cerr << "Warning in <HTTSetup::GetUncertainty>: Shape uncertainty defined for empty histogram" << std::endl;
+						continue;
+					}
+					double proc_int = proc.shape->Integral();
+					int n = param.shape->GetNbinsX();
+					if (n + 1 > int(dx.size())) dx.resize(n + 1, 0.);
+					Float_t const* y = param.shape->GetArray();
+					Float_t const* y_up = param.shape_up->GetArray();
+					Float_t const* y_down = param.shape_down->GetArray();
+					for (int k = 1; k <= n; ++k) {
+						double y_k = y[k];
+						double y_up_k = y_up[k];
+						double y_down_k = y_down[k];
+						double var = (fabs(y_up_k-y_k)+fabs(y_k-y_down_k))/2.0;
+						double shift = var*proc_int/param_int;
+						if (y_up_k-y_k >= 0.) dx[k] += shift;
+						if (y_up_k-y_k < 0.) dx[k] -= shift;
 					}
 				}
 			}
-			for (auto it = dx.begin(); it != dx.end(); ++it) uncert_map[it->first].push_back(it->second);
-		}
-		std::map<int, double> result;
-
-		for (int i = 1; i <= shape.GetNbinsX(); ++i) {
-			uncert_map[i].push_back(shape.GetBinContent(i) * tot_uncert);
-		}
-
-		for (auto it = uncert_map.begin(); it != uncert_map.end(); ++it) {
-			double binresult = 0.0;
-			for (unsigned p = 0; p < it->second.size(); ++p) binresult += (it->second.at(p) * it->second.at(p));
-			result[it->first] = sqrt(binresult);
+			for (int k = 1; k <= nbins; ++k) sum_sq[k] += dx[k] * dx[k];
 		}
-		for (int i = 1; i <= shape.GetNbinsX(); ++i) {
-			shape.SetBinError(i, result[i]);
+		for (int i = 1; i <= nbins; ++i) {
+			double tot = shape.GetBinContent(i) * tot_uncert;
+			shape.SetBinError(i, sqrt(sum_sq[i] + tot * tot));
 		}
 
 		return shape;
 	}
 
 	TH1F 	HTTSetup::GetObservedShape() {
-		TH1F shape = *(obs_[0].shape);
-		for (unsigned i = 1; i < obs_.size(); ++i) shape.Add(obs_[i].shape);
+		TH1F shape = *(tables_->obs[obs_[0]].shape);
+		for (unsigned i = 1; i < obs_.size(); ++i) shape.Add(tables_->obs[obs_[i]].shape);
 		return shape;
 	}
 
 	TGraphAsymmErrors HTTSetup::GetObservedShapeErrors() {
-		TGraphAsymmErrors shape = *(obs_[0].errors);
+		TGraphAsymmErrors shape = *(tables_->obs[obs_[0]].errors);
 		for (int k = 0; k < shape.GetN(); ++k) {
 			double x;
 			double y;
 			shape.GetPoint(k, x, y);
 		}
 		for (unsigned i = 1; i < obs_.size(); ++i) {
-			TGraphAsymmErrors const* add = obs_[i].errors;
+			TGraphAsymmErrors const* add = tables_->obs[obs_[i]].errors;
 			for (int k = 0; k < add->GetN(); ++k) {
 				double x1, x2;
 				double y1, y2;
@@ -388,87 +523,88 @@ namespace ic {
 	}
 
 	void HTTSetup::ApplyPulls(bool use_b_only) {
+		Detach();
 		std::map<std::string, Pull> pmap;
 		for (unsigned i = 0; i < pulls_.size(); ++i) pmap[pulls_[i].name] = pulls_[i];
 		
 		for (unsigned i = 0; i < params_.size(); ++i) {
-			auto it = pmap.find(params_[i].nuisance);
+			Nuisance & param = tables_->params[params_[i]];
+			auto it = pmap.find(param.nuisance);
 			if (it == pmap.end()) continue;
+			std::vector<unsigned> procs = MatchingProcesses(param);
 
-			if (params_[i].type == "lnN") {
-				double yield_corr = (params_[i].value - 1.0) * ((use_b_only) ? it->second.bonly : it->second.splusb);
-				// std::cout << params_[i] << ":: Pull(" << it->second.splusb << "," << it->second.splusb_err << ")" << std::endl;
-				for (unsigned j = 0; j < processes_.size(); ++j) {
-					if (processes_[j].era 			!= params_[i].era 			||
-							processes_[j].channel 	!= params_[i].channel 	||
-							processes_[j].category 	!= params_[i].category 	||
-							processes_[j].process 	!= params_[i].process) continue;
-					processes_[j].rate += yield_corr*processes_[j].rate;
+			if (param.type == "lnN") {
+				double yield_corr = (param.value - 1.0) * ((use_b_only) ? it->second.bonly : it->second.splusb);
+				for (unsigned j = 0; j < procs.size(); ++j) {
+					Process & proc = tables_->processes[procs[j]];
+					proc.rate += yield_corr*proc.rate;
 					// Also scale the histogram if it exists
-					if (processes_[j].shape) processes_[j].shape->Scale(1. + yield_corr);
+					if (proc.shape) proc.shape->Scale(1. + yield_corr);
 				}
-				params_[i].value = ((params_[i].value - 1.0) * it->second.bonly_err) + 1.0;				
+				param.value = ((param.value - 1.0) * it->second.bonly_err) + 1.0;				
 			}
 
-			if (params_[i].type == "shape") {
-				for (unsigned j = 0; j < processes_.size(); ++j) {
-					if (processes_[j].era 			!= params_[i].era 			||
-							processes_[j].channel 	!= params_[i].channel 	||
-							processes_[j].category 	!= params_[i].category 	||
-							processes_[j].process 	!= params_[i].process 	||
-							!params_[i].shape || !params_[i].shape_down || !params_[i].shape_up) continue;
-					if (params_[i].shape->Integral() == 0.) {
+			if (param.type == "shape") {
+				std::vector<Float_t> central;
+				std::vector<Float_t> up_bins;
+				std::vector<Float_t> down_bins;
+				for (unsigned j = 0; j < procs.size(); ++j) {
+					Process & proc = tables_->processes[procs[j]];
+					if (!param.shape || !param.shape_down || !param.shape_up) continue;
+					double param_int = param.shape->Integral();
+					if (param_int == 0.) {
 						std::cerr << "Warning in <HTTSetup::ApplyPulls>: Shape uncertainty defined for empty histogram" << std::endl;
 						continue;
-					}					
-					TH1F *central_new = (TH1F*)params_[i].shape->Clone();
-					TH1F *up_new = (TH1F*)params_[i].shape->Clone();
-					TH1F *down_new = (TH1F*)params_[i].shape->Clone();
-
-					// for (unsigned k = 1; k <= central_new->GetNbinsX(); ++k) {
-					// 	double shift = 0.;
-					// 	if (it->second.splusb >= 0) {
-					// 		shift = params_[i].shape_up->GetBinContent(k) - params_[i].shape->GetBinContent(k);
-					// 	} else {
-					// 		shift = params_[i].shape->GetBinContent(k) - params_[i].shape_down->GetBinContent(k);
-					// 	}
-					// 	central_new->SetBinContent(k, params_[i].shape->GetBinContent(k) + it->second.splusb * shift);
-					// 	up_new->SetBinContent(k, params_[i].shape->GetBinContent(k) + (it->second.splusb + 1. * it->second.splusb_err) * shift);
-					// 	down_new->SetBinContent(k, params_[i].shape->GetBinContent(k) + (it->second.splusb - 1. * it->second.splusb_err) * shift);
-					// }
-
-					VerticalMorph(central_new, params_[i].shape_up, params_[i].shape_down, (use_b_only ? it->second.bonly : it->second.splusb));
-					VerticalMorph(up_new, params_[i].shape_up, params_[i].shape_down,   (use_b_only ? (it->second.bonly + it->second.bonly_err) : (it->second.splusb + it->second.splusb_err)));
-					VerticalMorph(down_new, params_[i].shape_up, params_[i].shape_down, (use_b_only ? (it->second.bonly - it->second.bonly_err) : (it->second.splusb - it->second.splusb_err)));
-					
-					// std::cout << "Applying pull for nuisance: " << params_[i] << std::endl;
-					// std::cout << "To Process: " << processes_[j] << std::endl;
-					// std::cout << "New/Old rate ratio from morphing is " << central_new->Integral()/params_[i].shape->Integral() << std::endl;
-					TH1F *transformation = (TH1F*)central_new->Clone();
-					transformation->Add(params_[i].shape, -1); // Do shifted shape - original shape
-
-					// !!!! Official code doesn't seem to do this.
-					transformation->Scale(processes_[j].rate / params_[i].shape->Integral()); // Scale transformation up to current rate
-					
-					processes_[j].shape->Add(transformation);
+					}
+					int n = param.shape->GetNbinsX();
+					if (!proc.shape || proc.shape->GetNbinsX() != n || param.shape_up->GetNbinsX() != n || param.shape_down->GetNbinsX() != n) {
+						std::cerr << "Warning in <HTTSetup::ApplyPulls>: Shape uncertainty histograms do not have the same binning as the process" << std::endl;
+						continue;
+					}
+
+					// Work on the bin arrays directly, including the under- and overflow,
+					// rounding to Float_t where TH1F::Add and TH1F::Scale would
+					Float_t const* nominal = param.shape->GetArray();
+					Float_t const* up = param.shape_up->GetArray();
+					Float_t const* down = param.shape_down->GetArray();
+					double pull = use_b_only ? it->second.bonly : it->second.splusb;
+					double pull_err = use_b_only ? it->second.bonly_err : it->second.splusb_err;
+					MorphBins(nominal, up, down, n, pull, central);
+					MorphBins(nominal, up, down, n, pull + pull_err, up_bins);
+					MorphBins(nominal, up, down, n, pull - pull_err, down_bins);
+
+					// Add the shift of the morphed shape from the original, scaled up to
+					// the current rate.  !!!! Official code doesn't seem to do the scaling.
+					double scale = proc.rate / param_int;
+					Float_t * bins = proc.shape->GetArray();
+					for (int k = 0; k <= n + 1; ++k) {
+						Float_t shift = central[k] - nominal[k];
+						bins[k] += Float_t(scale * shift);
+					}
 					// Scan and fix negative bins
-					for (int k = 1; k <= processes_[j].shape->GetNbinsX(); ++k) {
-						if (processes_[j].shape->GetBinContent(k) < 0.) processes_[j].shape->SetBinContent(k, 0.);
+					for (int k = 1; k <= n; ++k) {
+						if (bins[k] < 0.) bins[k] = 0.;
 					}
 					// Fix the normalisation of the new shape to the expected shift form the template morphing 
 					// But again, this isn't what the offical post-fit code does.  Visually, it just adjusts the bin contents
 					// and leaves it at that.  So change is in rate is absolute not fractional.
-					processes_[j].shape->Scale( processes_[j].rate * (central_new->Integral()/params_[i].shape->Integral()) / processes_[j].shape->Integral() );
-					// processes_[j].shape->Scale( (processes_[j].rate + transformation->Integral()) / processes_[j].shape->Integral() );
-					
-
-					// std::cout << "Current process rate is " << processes_[j].rate << std::endl;
-					processes_[j].rate = processes_[j].shape->Integral();
-					// std::cout << "New process rate is " << processes_[j].rate << std::endl;
-					if (transformation) delete transformation;
-					params_[i].shape = central_new;
-					params_[i].shape_up = up_new;
-					params_[i].shape_down = down_new;
+					double norm = proc.rate * (SumBins(&(central[0]), n)/param_int) / SumBins(bins, n);
+					for (int k = 0; k <= n + 1; ++k) bins[k] = Float_t(norm * bins[k]);
+					// The shift has the errors of the morphed and original shapes added
+					// in quadrature
+					if (proc.shape->GetSumw2N() == n + 2 && param.shape->GetSumw2N() == n + 2) {
+						Double_t * w2 = proc.shape->GetSumw2()->GetArray();
+						Double_t const* shape_w2 = param.shape->GetSumw2()->GetArray();
+						for (int k = 0; k <= n + 1; ++k) {
+							w2[k] = norm * norm * (w2[k] + scale * scale * 2. * shape_w2[k]);
+						}
+					}
+					proc.rate = SumBins(bins, n);
+
+					TH1F *original = param.shape;
+					param.shape = CloneWithBins(original, central);
+					param.shape_up = CloneWithBins(original, up_bins);
+					param.shape_down = CloneWithBins(original, down_bins);
 				}
 			}
 
@@ -476,18 +612,21 @@ namespace ic {
 	}
 
 	void HTTSetup::WeightSoverB() {
+		Detach();
 		// First need to identify the unique set of (mass, era, channel, category) - these will be
 		// reweighted individually. 
 		std::vector<CategoryKey> keys;
+		std::set<std::string> seen;
 		for (unsigned i = 0; i  < processes_.size(); ++i) {
-			CategoryKey a(processes_[i].GetKey());
-			if (std::find(keys.begin(), keys.end(), a) == keys.end()) keys.push_back(a);
+			CategoryKey a(tables_->processes[processes_[i]].GetKey());
+			if (seen.insert(KeyString(a)).second) keys.push_back(a);
 		}
 		for (unsigned i = 0; i < keys.size(); ++i) {
 			std::cout << "Calculating S/B weight for: " << keys[i].channel << " " << keys[i].era << " " << keys[i].category << std::endl;
 
-			TH1F sig_shape = this->key_match(keys[i]).signals().GetShape();
-			TH1F bkg_shape = this->key_match(keys[i]).backgrounds().GetShape();
+			HTTSetup key_setup = this->key_match(keys[i]);
+			TH1F sig_shape = key_setup.signals().GetShape();
+			TH1F bkg_shape = key_setup.backgrounds().GetShape();
 
 			// Find the range from the lowest edge containing 15.9% of the signal
 			double xmin = sig_shape.GetXaxis()->GetXmin();
@@ -516,52 +655,54 @@ namespace ic {
 			double backgr_yield = IntegrateFloatRange(&bkg_shape, lower_limit, upper_limit);			
 			double weight = signal_yield / backgr_yield;
 			std::cout << "S/B: " << weight << std::endl;
-			for (unsigned j = 0; j < obs_.size(); ++j) {
-				if (obs_[j].GetKey() == keys[i]) {
-					obs_[j].rate *= weight;
-					if (obs_[j].shape) obs_[j].shape->Scale(weight);
-					if (obs_[j].errors) {
-						for (int k = 0; k < obs_[j].errors->GetN(); ++k) {
-							double x;
-							double y;
-							obs_[j].errors->GetPoint(k, x, y);
-							obs_[j].errors->SetPoint(k, x, y*weight);
-							double err_y_up = weight * obs_[j].errors->GetErrorYhigh(k);
-							double err_y_dn = weight * obs_[j].errors->GetErrorYlow(k);
-							obs_[j].errors->SetPointEYhigh(k, err_y_up);
-							obs_[j].errors->SetPointEYlow(k, err_y_dn);
+			for (unsigned j = 0; j < key_setup.obs_.size(); ++j) {
+				Observation & obs = tables_->obs[key_setup.obs_[j]];
+				obs.rate *= weight;
+				if (obs.shape) obs.shape->Scale(weight);
+				if (obs.errors) {
+					for (int k = 0; k < obs.errors->GetN(); ++k) {
+						double x;
+						double y;
+						obs.errors->GetPoint(k, x, y);
+						obs.errors->SetPoint(k, x, y*weight);
+						double err_y_up = weight * obs.errors->GetErrorYhigh(k);
+						double err_y_dn = weight * obs.errors->GetErrorYlow(k);
+						obs.errors->SetPointEYhigh(k, err_y_up);
+						obs.errors->SetPointEYlow(k, err_y_dn);
 
-						}
 					}
 				}
 			}
-			for (unsigned j = 0; j < processes_.size(); ++j) {
-				if (processes_[j].GetKey() == keys[i]) {
-					processes_[j].rate *= weight;
-					if (processes_[j].shape) processes_[j].shape->Scale(weight);
-				}
+			for (unsigned j = 0; j < key_setup.processes_.size(); ++j) {
+				Process & proc = tables_->processes[key_setup.processes_[j]];
+				proc.rate *= weight;
+				if (proc.shape) proc.shape->Scale(weight);
 			}
 		}
 	}
 
 	void HTTSetup::VariableRebin(std::vector<double> bins) {
+		Detach();
 		for (unsigned i = 0; i < processes_.size(); ++i) {
-			if (processes_[i].shape) {
-				processes_[i].shape = (TH1F*)processes_[i].shape->Rebin(bins.size()-1,"",&(bins[0]));
+			Process & proc = tables_->processes[processes_[i]];
+			if (proc.shape) {
+				proc.shape = (TH1F*)proc.shape->Rebin(bins.size()-1,"",&(bins[0]));
 			}
 		}
 		for (unsigned i = 0; i < obs_.size(); ++i) {
-			if (obs_[i].shape) {
-				obs_[i].shape = (TH1F*)obs_[i].shape->Rebin(bins.size()-1,"",&(bins[0]));
+			Observation & obs = tables_->obs[obs_[i]];
+			if (obs.shape) {
+				obs.shape = (TH1F*)obs.shape->Rebin(bins.size()-1,"",&(bins[0]));
 				// If we rebin then recreate the errors from scratch
-				if (obs_[i].errors) delete obs_[i].errors;
-				obs_[i].errors = new TGraphAsymmErrors(BuildPoissonErrors(*(obs_[i].shape)));
+				if (obs.errors) delete obs.errors;
+				obs.errors = new TGraphAsymmErrors(BuildPoissonErrors(*(obs.shape)));
 			}
 		}
 		for (unsigned i = 0; i < params_.size(); ++i) {
-			if (params_[i].shape) params_[i].shape = (TH1F*)params_[i].shape->Rebin(bins.size()-1,"",&(bins[0]));
-			if (params_[i].shape_down) params_[i].shape_down = (TH1F*)params_[i].shape_down->Rebin(bins.size()-1,"",&(bins[0]));
-			if (params_[i].shape_up) params_[i].shape_up = (TH1F*)params_[i].shape_up->Rebin(bins.size()-1,"",&(bins[0]));
+			Nuisance & param = tables_->params[params_[i]];
+			if (param.shape) param.shape = (TH1F*)param.shape->Rebin(bins.size()-1,"",&(bins[0]));
+			if (param.shape_down) param.shape_down = (TH1F*)param.shape_down->Rebin(bins.size()-1,"",&(bins[0]));
+			if (param.shape_up) param.shape_up = (TH1F*)param.shape_up->Rebin(bins.size()-1,"",&(bins[0]));
 		}
 	}
 
@@ -635,15 +776,17 @@ namespace ic {
 		TFile *f = new TFile(filename.c_str());
 		if (!f) return 1;
 		f->cd();
+		Detach();
 		for (unsigned i = 0; i < processes_.size(); ++i) {
-			if (processes_[i].channel == channel && processes_[i].era == era) {
-				std::string cat = processes_[i].category;
+			Process & proc = tables_->processes[processes_[i]];
+			if (proc.channel == channel && proc.era == era) {
+				std::string cat = proc.category;
 				if (!gDirectory->cd(("/"+cat).c_str())) {
 					std::cerr << "Warning, category " << cat << " not found in ROOT File" << std::endl;
 					continue;
 				} 
-				std::string name = processes_[i].process;
-				if (processes_[i].process_id <= 0) name += processes_[i].mass;
+				std::string name = proc.process;
+				if (proc.process_id <= 0) name += proc.mass;
 				TH1F* hist = (TH1F*)gDirectory->Get(name.c_str());
 				if (!hist) {
 					std::cerr << "Warning, histogram " << name << " not found in ROOT File" << std::endl;
@@ -651,19 +794,20 @@ namespace ic {
 				} else {
 					hist = (TH1F*)hist->Clone();
 				}
-				processes_[i].shape = hist;
-				processes_[i].rate = hist->Integral();
+				proc.shape = hist;
+				proc.rate = hist->Integral();
 			}
 		}
 
 		for (unsigned i = 0; i < obs_.size(); ++i) {
-			if (obs_[i].channel == channel && obs_[i].era == era) {
-				std::string cat = obs_[i].category;
+			Observation & obs = tables_->obs[obs_[i]];
+			if (obs.channel == channel && obs.era == era) {
+				std::string cat = obs.category;
 				if (!gDirectory->cd(("/"+cat).c_str())) {
 					std::cerr << "Warning, category " << cat << " not found in ROOT File" << std::endl;
 					continue;
 				} 
-				std::string name = obs_[i].process;
+				std::string name = obs.process;
 				TH1F* hist = (TH1F*)gDirectory->Get(name.c_str());
 				if (!hist) {
 					std::cerr << "Warning, histogram " << name << " not found in ROOT File" << std::endl;
@@ -671,32 +815,33 @@ namespace ic {
 				} else {
 					hist = (TH1F*)hist->Clone();
 				}
-				obs_[i].shape = hist;
+				obs.shape = hist;
 				// Create poisson errors
-				obs_[i].errors = new TGraphAsymmErrors(BuildPoissonErrors(*hist));
+				obs.errors = new TGraphAsymmErrors(BuildPoissonErrors(*hist));
 			}
 		}
 
 		for (unsigned i = 0; i < params_.size(); ++i) {
-			if (params_[i].type != "shape") continue;
-			if (params_[i].channel != channel || params_[i].era != era) continue;
+			Nuisance & param = tables_->params[params_[i]];
+			if (param.type != "shape") continue;
+			if (param.channel != channel || param.era != era) continue;
 
-			std::string cat = params_[i].category;
+			std::string cat = param.category;
 			if (!gDirectory->cd(("/"+cat).c_str())) {
 				std::cerr << "Warning, category " << cat << " not found in ROOT File" << std::endl;
 				continue;
 			} 
-			std::string name = params_[i].process;
-			if (params_[i].process_id <= 0) name += params_[i].mass;
-			std::string up_name = name + "_" + params_[i].nuisance + "Up";
-			std::string down_name = name + "_" + params_[i].nuisance + "Down";
+			std::string name = param.process;
+			if (param.process_id <= 0) name += param.mass;
+			std::string up_name = name + "_" + param.nuisance + "Up";
+			std::string down_name = name + "_" + param.nuisance + "Down";
 
 			TH1F* hist = (TH1F*)gDirectory->Get(name.c_str());
 			if (!hist) {
 				std::cerr << "Warning, histogram " << name << " not found in ROOT File" << std::endl;
 				continue;
 			} else {
-				params_[i].shape = (TH1F*)hist->Clone();	
+				param.shape = (TH1F*)hist->Clone();	
 			}
 
 			TH1F* up_hist = (TH1F*)gDirectory->Get(up_name.c_str());
@@ -704,7 +849,7 @@ namespace ic {
 				std::cerr << "Warning, histogram " << up_name << " not found in ROOT File" << std::endl;
 				continue;
 			} else {
-				params_[i].shape_up = (TH1F*)up_hist->Clone();	
+				param.shape_up = (TH1F*)up_hist->Clone();	
 			}
 
 			TH1F* down_hist = (TH1F*)gDirectory->Get(down_name.c_str());
@@ -712,7 +857,7 @@ namespace ic {
 				std::cerr << "Warning, histogram " << down_name << " not found in ROOT File" << std::endl;
 				continue;
 			} else {
-				params_[i].shape_down = (TH1F*)down_hist->Clone();	
+				param.shape_down = (TH1F*)down_hist->Clone();	
 			}
 
 		}
@@ -724,6 +869,9 @@ namespace ic {
 	int HTTSetup::ParseDatacard(const std::string & filename, std::string const& channel, int category_id, std::string era, std::string mass) {
 
 		std::vector<std::string> lines = ParseFileLines(filename);
+		Detach();
+		Tables & t = *tables_;
+		t.indexed = false;
 
 		bool start_nuisance_scan = false;
 		unsigned r = 0;
@@ -756,14 +904,15 @@ namespace ic {
 							words[i-1][0] 	== "bin" && 
 							words[i].size() == words[i-1].size()) {
 					for (unsigned p = 1; p < words[i].size(); ++p) {
-						obs_.push_back(Observation());
-						obs_.back().channel = channel;
-						obs_.back().category_id = category_id;
-						obs_.back().era = era;
-						obs_.back().category = words[i-1][p];
-						obs_.back().process = "data_obs";
-						obs_.back().rate = boost::lexical_cast<double>(words[i][p]);
-						obs_.back().mass = mass;
+						t.obs.push_back(Observation());
+						obs_.push_back(t.obs.size() - 1);
+						t.obs.back().channel = channel;
+						t.obs.back().category_id = category_id;
+						t.obs.back().era = era;
+						t.obs.back().category = words[i-1][p];
+						t.obs.back().process = "data_obs";
+						t.obs.back().rate = boost::lexical_cast<double>(words[i][p]);
+						t.obs.back().mass = mass;
 					}
 				}
 			}
@@ -782,15 +931,16 @@ namespace ic {
 							words[i].size() == words[i-2].size() &&
 							words[i].size() == words[i-3].size()) {
 					for (unsigned p = 1; p < words[i].size(); ++p) {
-						processes_.push_back(Process());
-						processes_.back().channel = channel;
-						processes_.back().category_id = category_id;
-						processes_.back().era = era;
-						processes_.back().category = words[i-3][p];
-						processes_.back().process = words[i-1][p];
-						processes_.back().process_id = boost::lexical_cast<int>(words[i-2][p]);
-						processes_.back().rate = boost::lexical_cast<double>(words[i][p]);
-						processes_.back().mass = mass;
+						t.processes.push_back(Process());
+						processes_.push_back(t.processes.size() - 1);
+						t.processes.back().channel = channel;
+						t.processes.back().category_id = category_id;
+						t.processes.back().era = era;
+						t.processes.back().category = words[i-3][p];
+						t.processes.back().process = words[i-1][p];
+						t.processes.back().process_id = boost::lexical_cast<int>(words[i-2][p]);
+						t.processes.back().rate = boost::lexical_cast<double>(words[i][p]);
+						t.processes.back().mass = mass;
 					}
 					r = i;
 					start_nuisance_scan = true;
@@ -801,17 +951,18 @@ namespace ic {
 				for (unsigned p = 2; p < words[i].size(); ++p) {
 					if (words[i][p] == "-") continue;
 					if (words[i][0].at(0) == '#') continue;
-					params_.push_back(Nuisance());
-					params_.back().channel = channel;
-					params_.back().category_id = category_id;
-					params_.back().category = words[r-3][p-1];
-					params_.back().era = era;
-					params_.back().process = words[r-1][p-1];
-					params_.back().process_id = boost::lexical_cast<int>(words[r-2][p-1]);
-					params_.back().nuisance = words[i][0];
-					params_.back().type = words[i][1];
-					params_.back().value = boost::lexical_cast<double>(words[i][p]);
-					params_.back().mass = mass;
+					t.params.push_back(Nuisance());
+					params_.push_back(t.params.size() - 1);
+					t.params.back().channel = channel;
+					t.params.back().category_id = category_id;
+					t.params.back().category = words[r-3][p-1];
+					t.params.back().era = era;
+					t.params.back().process = words[r-1][p-1];
+					t.params.back().process_id = boost::lexical_cast<int>(words[r-2][p-1]);
+					t.params.back().nuisance = words[i][0];
+					t.params.back().type = words[i][1];
+					t.params.back().value = boost::lexical_cast<double>(words[i][p]);
+					t.params.back().mass = mass;
 				}
 			}
 		}
@@ -819,17 +970,17 @@ namespace ic {
 	}
 
 	bool HTTSetup::HasProcess(std::string const& process) const {
-		for (unsigned i = 0; i < processes_.size(); ++i) {
-			if (processes_[i].process == process) return true;
-		}
-		return false;
+		return !Select(processes_, Indexed().processes_by_process, std::vector<std::string>(1, process)).empty();
 	}
 
 	void HTTSetup::ScaleProcessByEra(std::string const& process, std::string const& era, double scale) {
-		for (unsigned i = 0; i < processes_.size(); ++i) {
-			if (processes_[i].process == process && processes_[i].era == era) {
-				processes_[i].rate *= scale;
-				if (processes_[i].shape) processes_[i].shape->Scale(scale);
+		Detach();
+		std::vector<unsigned> rows = Select(processes_, Indexed().processes_by_process, std::vector<std::string>(1, process));
+		for (unsigned i = 0; i < rows.size(); ++i) {
+			Process & proc = tables_->processes[rows[i]];
+			if (proc.era == era) {
+				proc.rate *= scale;
+				if (proc.shape) proc.shape->Scale(scale);
 			} 
 		}
 	}
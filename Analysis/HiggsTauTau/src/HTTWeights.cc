@@ -91,6 +91,9 @@ namespace ic {
       ggh_hist_ = (TH1F*)gDirectory->Get("Nominal");
       ggh_hist_up_ = (TH1F*)gDirectory->Get("Up");
       ggh_hist_down_ = (TH1F*)gDirectory->Get("Down");
+      ggh_table_ = BinnedTable(ggh_hist_);
+      ggh_table_up_ = BinnedTable(ggh_hist_up_);
+      ggh_table_down_ = BinnedTable(ggh_hist_down_);
       // gDirectory->cd("powheg_weight");
       // ggh_hist_ = (TH1F*)gDirectory->Get(("weight_hqt_fehipro_fit_"+ggh_mass_).c_str());
     }
@@ -108,6 +111,9 @@ namespace ic {
       ggh_hist_ = (TH1F*)gDirectory->Get("Nominal");
       ggh_hist_up_ = (TH1F*)gDirectory->Get("Up");
       ggh_hist_down_ = (TH1F*)gDirectory->Get("Down");
+      ggh_table_ = BinnedTable(ggh_hist_);
+      ggh_table_up_ = BinnedTable(ggh_hist_up_);
+      ggh_table_down_ = BinnedTable(ggh_hist_down_);
     }
 
     if (do_emu_e_fakerates_ || do_emu_m_fakerates_) {
@@ -137,6 +143,8 @@ namespace ic {
       }
       ElectronFakeRateHist_PtEta->SetDirectory(0);
       MuonFakeRateHist_PtEta->SetDirectory(0);
+      electron_fake_rate_ = BinnedTable(ElectronFakeRateHist_PtEta);
+      muon_fake_rate_ = BinnedTable(MuonFakeRateHist_PtEta);
     }
 
     if (do_w_soup_) {
@@ -188,15 +196,15 @@ namespace ic {
       }
       double h_pt = higgs->pt();
       double pt_weight = 1.0;
-      int fbin = ggh_hist_->FindBin(h_pt);
-      if (fbin > 0 && fbin <= ggh_hist_->GetNbinsX()) {
-        pt_weight =  ggh_hist_->GetBinContent(fbin);
+      std::size_t fbin = ggh_table_.FindBin(h_pt);
+      if (ggh_table_.IsInRange(fbin)) {
+        pt_weight =  ggh_table_.GetValue(fbin);
         //std::cout << "pt: " << h_pt << "\tweight: " <<  pt_weight << std::endl;
       }
       eventInfo->set_weight("ggh", pt_weight);
       if (mc_ == mc::summer12_53X || mc_ == mc::fall11_42X) {
-        double weight_up   = ggh_hist_up_->GetBinContent(fbin)   / pt_weight;
-        double weight_down = ggh_hist_down_->GetBinContent(fbin) / pt_weight;
+        double weight_up   = ggh_table_up_.GetValue(fbin)   / pt_weight;
+        double weight_down = ggh_table_down_.GetValue(fbin) / pt_weight;
         event->Add("wt_ggh_pt_up", weight_up);
         event->Add("wt_ggh_pt_down", weight_down);
       }
@@ -272,7 +280,7 @@ namespace ic {
       double inclusive_btag_weight = 1.0;
       BTagWeight::payload set = BTagWeight::payload::ALL2011;
       if (mc_ == mc::summer12_53X) set = BTagWeight::payload::EPS13;
-      std::map<std::size_t, bool> retag_result = btag_weight.ReTag(jets, set, BTagWeight::tagger::CSVM, btag_mode_, bfake_mode_);
+      std::map<std::size_t, bool> retag_result = btag_weight.ReTag(jets, set, BTagWeight::tagger::CSVM, btag_mode_, bfake_mode_, eventInfo);
       event->Add("no_btag_weight", no_btag_weight);
       event->Add("inclusive_btag_weight", inclusive_btag_weight);
       event->Add("retag_result", retag_result);
@@ -1319,9 +1327,7 @@ namespace ic {
       double eleEta = elec->eta();
       if (era_ == era::data_2012_donly || era_ == era::data_2012_moriond
         || era_ == era::data_2012_rereco) eleEta = fabs(eleEta);
-      int eleptbin = ElectronFakeRateHist_PtEta->GetXaxis()->FindFixBin(elefopt);
-      int eleetabin = ElectronFakeRateHist_PtEta->GetYaxis()->FindFixBin(eleEta);    
-      double eleprob = ElectronFakeRateHist_PtEta->GetBinContent(eleptbin,eleetabin);
+      double eleprob = electron_fake_rate_.Value(elefopt, eleEta);
       double elefakerate = eleprob/(1.0 - eleprob);
       //double elefakerate_errlow = ElectronFakeRateHist_PtEta->GetError(elefopt,fabs(elec->eta()),mithep::TH2DAsymErr::kStatErrLow)/pow((1-ElectronFakeRateHist_PtEta->GetError(elefopt,fabs(elec->eta()),mithep::TH2DAsymErr::kStatErrLow)),2);
       //double elefakerate_errhigh = ElectronFakeRateHist_PtEta->GetError(elefopt,fabs(elec->eta()),mithep::TH2DAsymErr::kStatErrHigh)/pow((1-ElectronFakeRateHist_PtEta->GetError(elefopt,fabs(elec->eta()),mithep::TH2DAsymErr::kStatErrHigh)),2);
@@ -1334,9 +1340,7 @@ namespace ic {
       double muEta = muon->eta();
       if (era_ == era::data_2012_donly || era_ == era::data_2012_moriond
         || era_ == era::data_2012_rereco) muEta = fabs(muEta);
-      int muptbin = MuonFakeRateHist_PtEta->GetXaxis()->FindFixBin(mufopt);
-      int muetabin = MuonFakeRateHist_PtEta->GetYaxis()->FindFixBin(muEta);    
-      double muprob = MuonFakeRateHist_PtEta->GetBinContent(muptbin,muetabin);
+      double muprob = muon_fake_rate_.Value(mufopt, muEta);
       double mufakerate = muprob/(1.0 - muprob);
       //double mufakerate_errlow = MuonFakeRateHist_PtEta->GetError(mufopt,fabs(muon->eta()),mithep::TH2DAsymErr::kStatErrLow)/pow((1-MuonFakeRateHist_PtEta->GetError(mufopt,fabs(muon->eta()),mithep::TH2DAsymErr::kStatErrLow)),2);
       //double mufakerate_errhigh = MuonFakeRateHist_PtEta->GetError(mufopt,fabs(muon->eta()),mithep::TH2DAsymErr::kStatErrHigh)/pow((1-MuonFakeRateHist_PtEta->GetError(mufopt,fabs(muon->eta()),mithep::TH2DAsymErr::kStatErrHigh)),2);
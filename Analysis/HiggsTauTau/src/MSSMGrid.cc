@@ -0,0 +1,328 @@
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/MSSMGrid.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/MappedFile.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <stdint.h>
+#include <sys/stat.h>
+#include "TFile.h"
+#include "TKey.h"
+#include "TH2.h"
+#include "TObjString.h"
+
+namespace {
+  // Binary grid files start with the magic number and the size and
+  // modification time of the source ROOT file, followed by the
+  // description, the axes of each grid and then, for each channel, its
+  // name, grid index and bin contents (including under- and overflow).
+  // Everything is written in the native byte order.
+  char const kMagic[8] = {'I', 'C', 'M', 'S', 'S', 'M', 'G', '1'};
+  std::size_t const kBlock = 256;
+
+  template <class T>
+  void WritePod(std::ostream & out, T const& val) {
+    out.write(reinterpret_cast<char const*>(&val), sizeof(T));
+  }
+
+  template <class T>
+  bool ReadPod(std::istream & in, T & val) {
+    return bool(in.read(reinterpret_cast<char *>(&val), sizeof(T)));
+  }
+
+  void WriteString(std::ostream & out, std::string const& str) {
+    WritePod(out, uint32_t(str.size()));
+    out.write(str.data(), str.size());
+  }
+
+  bool ReadString(std::istream & in, std::string & str) {
+    uint32_t size = 0;
+    if (!ReadPod(in, size)) return false;
+    str.assign(size, ' ');
+    return size == 0 || bool(in.read(&str[0], size));
+  }
+
+  void WriteAxis(std::ostream & out, ic::BinnedAxis const& axis) {
+    WritePod(out, uint8_t(axis.uniform()));
+    WritePod(out, uint32_t(axis.nbins()));
+    if (axis.uniform()) {
+      WritePod(out, axis.min());
+      WritePod(out, axis.max());
+    } else {
+      out.write(reinterpret_cast<char const*>(&(axis.edges()[0])), axis.edges().size() * sizeof(double));
+    }
+  }
+
+  bool ReadAxis(std::istream & in, ic::BinnedAxis & axis) {
+    uint8_t uniform = 0;
+    uint32_t nbins = 0;
+    if (!ReadPod(in, uniform) || !ReadPod(in, nbins) || nbins == 0) return false;
+    if (uniform) {
+      double min = 0., max = 0.;
+      if (!ReadPod(in, min) || !ReadPod(in, max)) return false;
+      axis = ic::BinnedAxis(nbins, min, max);
+    } else {
+      std::vector<double> edges(nbins + 1);
+      if (!in.read(reinterpret_cast<char *>(&edges[0]), edges.size() * sizeof(double))) return false;
+      axis = ic::BinnedAxis(edges);
+    }
+    return true;
+  }
+
+  bool SameAxis(ic::BinnedAxis const& a, ic::BinnedAxis const& b) {
+    if (a.nbins() != b.nbins() || a.uniform() != b.uniform()) return false;
+    if (a.uniform()) return a.min() == b.min() && a.max() == b.max();
+    return a.edges() == b.edges();
+  }
+
+  // Bin centres computed the way TAxis::GetBinCenter does
+  std::vector<double> Centres(ic::BinnedAxis const& axis) {
+    std::vector<double> centres(axis.nbins());
+    double width = (axis.max() - axis.min()) / axis.nbins();
+    for (int i = 0; i < axis.nbins(); ++i) {
+      centres[i] = axis.uniform() ? axis.min() + (i + 0.5) * width
+                                  : 0.5 * (axis.edges()[i] + axis.edges()[i + 1]);
+    }
+    return centres;
+  }
+
+  // The two bins whose centres enclose x, and the fraction t of the way
+  // from the first to the second.  Beyond the outermost centres both bins
+  // are the edge bin.
+  inline void Bracket(ic::BinnedAxis const& axis, std::vector<double> const& centres,
+                      double x, int & lo, int & hi, double & t) {
+    int bin = axis.FindBinClamped(x);
+    lo = bin;
+    hi = bin;
+    t = 0.;
+    if (x < centres[bin - 1]) {
+      if (bin > 1) lo = bin - 1;
+    } else if (bin < axis.nbins()) {
+      hi = bin + 1;
+    }
+    if (lo != hi) t = (x - centres[lo - 1]) / (centres[hi - 1] - centres[lo - 1]);
+  }
+}
+
+namespace ic {
+
+  MSSMGrid::MSSMGrid() : source_size_(-1), source_mtime_(-1), interpolate_(false) {
+    ;
+  }
+
+  void MSSMGrid::Load(std::string const& root_file, std::string const& cache_file) {
+    struct stat st;
+    if (stat(root_file.c_str(), &st) != 0) {
+      std::cerr << "Error in <ic::MSSMGrid>: Unable to find " << root_file << ", an exception will be thrown" << std::endl;
+      throw;
+    }
+    if (!cache_file.empty() && Restore(cache_file)
+        && source_size_ == (long long)(st.st_size) && source_mtime_ == (long long)(st.st_mtime)) {
+      return;
+    }
+    grids_.clear();
+    channels_.clear();
+    values_.clear();
+    description_.clear();
+    TFile file(root_file.c_str());
+    if (file.IsZombie()) {
+      std::cerr << "Error in <ic::MSSMGrid>: Unable to open " << root_file << ", an exception will be thrown" << std::endl;
+      throw;
+    }
+    TIter next(file.GetListOfKeys());
+    TKey * key;
+    while ((key = (TKey*)next())) {
+      // The highest cycle of each name comes first, as with TFile::Get
+      if (HasChannel(key->GetName())) continue;
+      TObject * obj = key->ReadObj();
+      if (TH2 * hist = dynamic_cast<TH2 *>(obj)) {
+        AddChannel(key->GetName(), hist);
+      } else if (TObjString * str = dynamic_cast<TObjString *>(obj)) {
+        if (std::string(key->GetName()) == "description") description_ = str->GetString().Data();
+      }
+      delete obj;
+    }
+    file.Close();
+    source_size_ = st.st_size;
+    source_mtime_ = st.st_mtime;
+    if (!cache_file.empty() && !Save(cache_file)) {
+      std::cerr << "Warning in <ic::MSSMGrid>: Unable to write " << cache_file << std::endl;
+    }
+  }
+
+  bool MSSMGrid::Save(std::string const& cache_file) const {
+    // Write to a temporary file first so that concurrent jobs never read a
+    // partially written grid
+    std::string tmp = CreateTempFile(cache_file);
+    if (tmp.empty()) return false;
+    std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(kMagic, 8);
+    WritePod(out, int64_t(source_size_));
+    WritePod(out, int64_t(source_mtime_));
+    WriteString(out, description_);
+    WritePod(out, uint32_t(grids_.size()));
+    for (unsigned i = 0; i < grids_.size(); ++i) {
+      WriteAxis(out, grids_[i].x);
+      WriteAxis(out, grids_[i].y);
+    }
+    WritePod(out, uint32_t(channels_.size()));
+    for (unsigned i = 0; i < channels_.size(); ++i) {
+      WriteString(out, channels_[i].name);
+      WritePod(out, uint32_t(channels_[i].grid));
+    }
+    WritePod(out, uint64_t(values_.size()));
+    if (!values_.empty()) out.write(reinterpret_cast<char const*>(&values_[0]), values_.size() * sizeof(double));
+    out.close();
+    if (!out || std::rename(tmp.c_str(), cache_file.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool MSSMGrid::Restore(std::string const& cache_file) {
+    std::ifstream in(cache_file.c_str(), std::ios::binary);
+    if (!in) return false;
+    char magic[8];
+    if (!in.read(magic, 8) || std::memcmp(magic, kMagic, 8) != 0) return false;
+    int64_t size = 0, mtime = 0;
+    std::string description;
+    uint32_t n_grids = 0, n_channels = 0;
+    uint64_t n_values = 0;
+    if (!ReadPod(in, size) || !ReadPod(in, mtime) || !ReadString(in, description)) return false;
+    if (!ReadPod(in, n_grids)) return false;
+    std::vector<Grid> grids(n_grids);
+    for (unsigned i = 0; i < n_grids; ++i) {
+      if (!ReadAxis(in, grids[i].x) || !ReadAxis(in, grids[i].y)) return false;
+      grids[i].x_centres = Centres(grids[i].x);
+      grids[i].y_centres = Centres(grids[i].y);
+    }
+    if (!ReadPod(in, n_channels)) return false;
+    std::vector<ChannelInfo> channels(n_channels);
+    std::size_t offset = 0;
+    for (unsigned i = 0; i < n_channels; ++i) {
+      uint32_t grid = 0;
+      if (!ReadString(in, channels[i].name) || !ReadPod(in, grid) || grid >= n_grids) return false;
+      channels[i].grid = grid;
+      channels[i].offset = offset;
+      offset += std::size_t(grids[grid].x.nbins() + 2) * (grids[grid].y.nbins() + 2);
+    }
+    if (!ReadPod(in, n_values) || n_values != offset) return false;
+    std::vector<double> values(n_values);
+    if (n_values > 0 && !in.read(reinterpret_cast<char *>(&values[0]), n_values * sizeof(double))) return false;
+    grids_.swap(grids);
+    channels_.swap(channels);
+    values_.swap(values);
+    description_ = description;
+    source_size_ = size;
+    source_mtime_ = mtime;
+    return true;
+  }
+
+  unsigned MSSMGrid::FindGrid(BinnedAxis const& x, BinnedAxis const& y) {
+    for (unsigned i = 0; i < grids_.size(); ++i) {
+      if (SameAxis(grids_[i].x, x) && SameAxis(grids_[i].y, y)) return i;
+    }
+    Grid grid;
+    grid.x = x;
+    grid.y = y;
+    grid.x_centres = Centres(x);
+    grid.y_centres = Centres(y);
+    grids_.push_back(grid);
+    return grids_.size() - 1;
+  }
+
+  void MSSMGrid::AddChannel(std::string const& name, TH2 const* hist) {
+    if (HasChannel(name)) {
+      std::cerr << "Error in <ic::MSSMGrid>: Channel " << name << " already exists, an exception will be thrown" << std::endl;
+      throw;
+    }
+    ChannelInfo channel;
+    channel.name = name;
+    channel.grid = FindGrid(BinnedAxis(hist->GetXaxis()), BinnedAxis(hist->GetYaxis()));
+    channel.offset = values_.size();
+    Grid const& grid = grids_[channel.grid];
+    std::size_t size = std::size_t(grid.x.nbins() + 2) * (grid.y.nbins() + 2);
+    values_.resize(channel.offset + size);
+    for (std::size_t i = 0; i < size; ++i) values_[channel.offset + i] = hist->GetBinContent(i);
+    channels_.push_back(channel);
+  }
+
+  bool MSSMGrid::HasChannel(std::string const& name) const {
+    for (unsigned i = 0; i < channels_.size(); ++i) {
+      if (channels_[i].name == name) return true;
+    }
+    return false;
+  }
+
+  unsigned MSSMGrid::Channel(std::string const& name) const {
+    for (unsigned i = 0; i < channels_.size(); ++i) {
+      if (channels_[i].name == name) return i;
+    }
+    std::cerr << "Error in <ic::MSSMGrid>: Channel " << name << " not found, an exception will be thrown" << std::endl;
+    throw;
+  }
+
+  void MSSMGrid::Locate(Grid const& grid, double mA, double tanb, Cell & cell) const {
+    std::size_t stride = grid.x.nbins() + 2;
+    if (!interpolate_) {
+      cell.bin[0] = grid.x.FindBin(mA) + stride * grid.y.FindBin(tanb);
+      return;
+    }
+    int x_lo, x_hi, y_lo, y_hi;
+    double tx, ty;
+    Bracket(grid.x, grid.x_centres, mA, x_lo, x_hi, tx);
+    Bracket(grid.y, grid.y_centres, tanb, y_lo, y_hi, ty);
+    cell.bin[0] = x_lo + stride * y_lo;
+    cell.bin[1] = x_hi + stride * y_lo;
+    cell.bin[2] = x_lo + stride * y_hi;
+    cell.bin[3] = x_hi + stride * y_hi;
+    cell.weight[0] = (1. - tx) * (1. - ty);
+    cell.weight[1] = tx * (1. - ty);
+    cell.weight[2] = (1. - tx) * ty;
+    cell.weight[3] = tx * ty;
+  }
+
+  double MSSMGrid::Value(unsigned channel, double mA, double tanb) const {
+    ChannelInfo const& info = channels_[channel];
+    double const* vals = &values_[info.offset];
+    Cell cell;
+    Locate(grids_[info.grid], mA, tanb, cell);
+    if (!interpolate_) return vals[cell.bin[0]];
+    return cell.weight[0] * vals[cell.bin[0]] + cell.weight[1] * vals[cell.bin[1]]
+         + cell.weight[2] * vals[cell.bin[2]] + cell.weight[3] * vals[cell.bin[3]];
+  }
+
+  void MSSMGrid::Evaluate(std::vector<unsigned> const& channels, std::size_t n,
+                          double const* mA, double const* tanb, double * out) const {
+    std::vector<Cell> cells(std::min(n, kBlock));
+    std::vector<unsigned> on_grid;
+    for (unsigned g = 0; g < grids_.size(); ++g) {
+      on_grid.clear();
+      for (unsigned k = 0; k < channels.size(); ++k) {
+        if (channels_[channels[k]].grid == g) on_grid.push_back(k);
+      }
+      if (on_grid.empty()) continue;
+      // Locate a block of points once, then read every channel on this grid
+      for (std::size_t start = 0; start < n; start += kBlock) {
+        std::size_t m = std::min(kBlock, n - start);
+        for (std::size_t i = 0; i < m; ++i) Locate(grids_[g], mA[start + i], tanb[start + i], cells[i]);
+        for (unsigned k = 0; k < on_grid.size(); ++k) {
+          double const* vals = &values_[channels_[channels[on_grid[k]]].offset];
+          double * res = out + on_grid[k] * n + start;
+          if (interpolate_) {
+            for (std::size_t i = 0; i < m; ++i) {
+              Cell const& cell = cells[i];
+              res[i] = cell.weight[0] * vals[cell.bin[0]] + cell.weight[1] * vals[cell.bin[1]]
+                     + cell.weight[2] * vals[cell.bin[2]] + cell.weight[3] * vals[cell.bin[3]];
+            }
+          } else {
+            for (std::size_t i = 0; i < m; ++i) res[i] = vals[cells[i].bin[0]];
+          }
+        }
+      }
+    }
+  }
+
+}
@@ -25,6 +25,92 @@ namespace ic {
     std::cout << "MC: " << MC2String(mc_) << std::endl;
     std::cout << "Pair Collection: " << pair_label_ << std::endl;
     std::cout << "Is Data?: " << is_data_ << std::endl;
+
+    // Data paths and filters by run range
+    table_ = TriggerTable();
+    unsigned const last = TriggerTable::kMaxRun;
+    if (channel_ == channel::et) {
+      // 2011 Triggers
+      table_.AddPath(160404, 163869, "HLT_Ele15_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_LooseIsoPFTau15_v")
+            .AddPath(165088, 167913, "HLT_Ele15_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_LooseIsoPFTau20_v")
+            .AddPath(170249, 173198, "HLT_Ele15_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_TightIsoPFTau20_v")
+            .AddPath(173236, 178380, "HLT_Ele18_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_MediumIsoPFTau20_v")
+            .AddPath(178420, 180252, "HLT_Ele20_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_MediumIsoPFTau20_v");
+      table_.AddFilters(0, 160404, 163869, "triggerObjectsEle15LooseTau15",
+          "hltEle15CaloIdVTTrkIdTCaloIsoTTrkIsoTTrackIsolFilter", "hltPFTau15TrackLooseIso");
+      table_.AddFilters(0, 165088, 167913, "triggerObjectsEle15LooseTau20",
+          "hltEle15CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilter", "hltPFTau20TrackLooseIso");
+      table_.AddFilters(0, 170249, 173198, "triggerObjectsEle15TightTau20",
+          "hltEle15CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilter", "hltPFTauTightIso20TrackTightIso");
+      table_.AddFilters(0, 173236, 178380, "triggerObjectsEle18MediumTau20",
+          "hltEle18CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilter", "hltPFTauMediumIso20TrackMediumIso");
+      table_.AddFilters(0, 178420, 180252, "triggerObjectsEle20MediumTau20",
+          "hltEle20CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilterL1SingleEG18orL1SingleEG20", "hltPFTauMediumIso20TrackMediumIso");
+      // 2012 Triggers
+      table_.AddPath(190456, 193751, "HLT_Ele20_CaloIdVT_CaloIsoRhoT_TrkIdT_TrkIsoT_LooseIsoPFTau20_v")
+            .AddPath(193752, last,   "HLT_Ele22_eta2p1_WP90Rho_LooseIsoPFTau20_v");
+      table_.AddFilters(0, 190456, 193751, "triggerObjectsEle20RhoLooseTau20",
+          "hltEle20CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilterL1IsoEG18OrEG20", "hltPFTauIsoEleVertex20");
+      table_.AddFilters(0, 193752, last, "triggerObjectsEle22WP90RhoLooseTau20",
+          "hltEle22WP90RhoTrackIsoFilter", "hltIsoElePFTau20TrackLooseIso");
+    }
+    if (channel_ == channel::mt) {
+      // 2011 Triggers
+      // table_.AddPath(160404, 163869, "HLT_IsoMu12_LooseIsoPFTau10_v")          // 215.634 pb
+      //       .AddPath(165088, 173198, "HLT_IsoMu15_LooseIsoPFTau15_v")          // 1787 pb
+      //       .AddPath(173236, 180252, "HLT_IsoMu15_eta2p1_LooseIsoPFTau20_v");  // 2979 pb
+      // table_.AddFilters(0, 160404, 163869, "triggerObjectsIsoMu12LooseTau10",
+      //     "hltSingleMuIsoL3IsoFiltered12", "hltFilterIsoMu12IsoPFTau10LooseIsolation");
+      // table_.AddFilters(0, 165088, 173198, "triggerObjectsIsoMu15LooseTau15",
+      //     "hltSingleMuIsoL3IsoFiltered15", "hltPFTau15TrackLooseIso");
+      // table_.AddFilters(0, 173236, 180252, "triggerObjectsIsoMu15LooseTau20",
+      //     "hltSingleMuIsoL1s14L3IsoFiltered15eta2p1", "hltPFTau20TrackLooseIso");
+      // 2012 Triggers
+      table_.AddPath(190456, last, "HLT_IsoMu24_eta2p1_v");
+      table_.AddFilters(0, 190456, 193751, "triggerObjectsIsoMu24",
+          "hltL3crIsoL1sMu16Eta2p1L1f0L2f16QL3f24QL3crIsoFiltered10", "");
+      table_.AddFilters(0, 193752, last, "triggerObjectsIsoMu24",
+          "hltL3crIsoL1sMu16Eta2p1L1f0L2f16QL3f24QL3crIsoRhoFiltered0p15", "");
+    }
+    if (channel_ == channel::em) {
+      table_.AddPath(160404, 167913, "HLT_Mu8_Ele17_CaloIdL_v")
+            .AddPath(170249, 180252, "HLT_Mu8_Ele17_CaloIdT_CaloIsoVL_v")
+            .AddPath(190456, last,   "HLT_Mu8_Ele17_CaloIdT_CaloIsoVL_TrkIdVL_TrkIsoVL_v")
+            .AddPath(160404, 167913, "HLT_Mu17_Ele8_CaloIdL_v")
+            .AddPath(170249, 180252, "HLT_Mu17_Ele8_CaloIdT_CaloIsoVL_v")
+            .AddPath(190456, last,   "HLT_Mu17_Ele8_CaloIdT_CaloIsoVL_TrkIdVL_TrkIsoVL_v");
+      // Slot 0 holds the Mu8_Ele17 filters, slot 1 the Mu17_Ele8 ones
+      // 2011 Triggers
+      table_.AddFilters(0, 160404, 167913, "triggerObjectsMu8Ele17IdL",
+          "hltL1NonIsoHLTNonIsoMu8Ele17PixelMatchFilter", "hltL1MuOpenEG5L3Filtered8");
+      table_.AddFilters(0, 170249, 180252, "triggerObjectsMu8Ele17",
+          "hltMu8Ele17CaloIdTCaloIsoVLPixelMatchFilter", "hltL1MuOpenEG5L3Filtered8");
+      // 2012 Triggers
+      table_.AddFilters(0, 190456, 191690, "triggerObjectsMu8Ele17",
+          "hltMu8Ele17CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter", "hltL1MuOpenEG12L3Filtered8");
+      table_.AddFilters(0, 191691, last, "triggerObjectsMu8Ele17",
+          "hltMu8Ele17CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter", "hltL1sL1Mu3p5EG12ORL1MuOpenEG12L3Filtered8");
+      // 2011 Triggers
+      table_.AddFilters(1, 160404, 167913, "triggerObjectsMu17Ele8IdL",
+          "hltL1NonIsoHLTNonIsoMu17Ele8PixelMatchFilter", "hltL1MuOpenEG5L3Filtered17");
+      table_.AddFilters(1, 170249, 180252, "triggerObjectsMu17Ele8",
+          "hltMu17Ele8CaloIdTPixelMatchFilter", "hltL1Mu7EG5L3MuFiltered17");
+      // 2012 Triggers
+      table_.AddFilters(1, 190456, 193751, "triggerObjectsMu17Ele8",
+          "hltMu17Ele8CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter", "hltL1Mu12EG7L3MuFiltered17");
+      table_.AddFilters(1, 193752, last, "triggerObjectsMu17Ele8",
+          "hltMu17Ele8CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter", "hltL1Mu12EG7L3MuFiltered17");
+    }
+    if (channel_ == channel::mtmet) {
+      table_.AddPath(203768, last, "HLT_IsoMu8_eta2p1_LooseIsoPFTau20_L1ETM26_v");
+      table_.AddFilters(0, 203777, last, "triggerObjectsIsoMu8LooseTau20L1ETM26",
+          "hltL3crIsoL1sMu7Eta2p1L1f0L2f7QL3f8QL3crIsoRhoFiltered0p15", "hltIsoMu8PFTau20TrackLooseIso");
+    }
+    if (channel_ == channel::etmet) {
+      table_.AddPath(203768, last, "HLT_Ele13_eta2p1_WP90Rho_LooseIsoPFTau20_L1ETM36_v");
+      table_.AddFilters(0, 203777, last, "triggerObjectsEle13LooseTau20L1ETM36",
+          "hltEle13WP90RhoTrackIsoFilter", "hltIsoEle13PFTau20TrackLooseIso");
+    }
     return 0;
   }
 
@@ -40,178 +126,19 @@ namespace ic {
     if (is_data_) {
       EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
       unsigned run = eventInfo->run();
-      bool path_found = false;
       TriggerPathPtrVec const& triggerPathPtrVec = event->GetPtrVec<TriggerPath>("triggerPaths");
+      unsigned flags = table_.Match(run, triggerPathPtrVec);
+      if (!(flags & TriggerTable::kPath)) return 1;
 
-      for (unsigned i = 0; i < triggerPathPtrVec.size(); ++i) {
-        std::string name = triggerPathPtrVec[i]->name();
-
-        if (channel_ == channel::et) {
-          // 2011 Triggers
-          if (run >= 160404 && run <= 163869 && name.find("HLT_Ele15_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_LooseIsoPFTau15_v") != name.npos) path_found = true;
-          if (run >= 165088 && run <= 167913 && name.find("HLT_Ele15_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_LooseIsoPFTau20_v") != name.npos) path_found = true;
-          if (run >= 170249 && run <= 173198 && name.find("HLT_Ele15_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_TightIsoPFTau20_v") != name.npos) path_found = true;
-          if (run >= 173236 && run <= 178380 && name.find("HLT_Ele18_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_MediumIsoPFTau20_v") != name.npos) path_found = true;
-          if (run >= 178420 && run <= 180252 && name.find("HLT_Ele20_CaloIdVT_CaloIsoT_TrkIdT_TrkIsoT_MediumIsoPFTau20_v") != name.npos) path_found = true;
-          // 2012 Triggers
-          if (run >= 190456 && run <= 193751 && name.find("HLT_Ele20_CaloIdVT_CaloIsoRhoT_TrkIdT_TrkIsoT_LooseIsoPFTau20_v") != name.npos) path_found = true; 
-          if (run >= 193752/* && run <= xxxxx*/ && name.find("HLT_Ele22_eta2p1_WP90Rho_LooseIsoPFTau20_v") != name.npos) path_found = true; 
-        }
-        if (channel_ == channel::mt) {
-          // if (run >= 160404 && run <= 163869 && name.find("HLT_IsoMu12_LooseIsoPFTau10_v") != name.npos) path_found = true;//215.634 pb
-          // if (run >= 165088 && run <= 173198 && name.find("HLT_IsoMu15_LooseIsoPFTau15_v") != name.npos) path_found = true; // 1787 pb
-          // if (run >= 173236 && run <= 180252 && name.find("HLT_IsoMu15_eta2p1_LooseIsoPFTau20_v") != name.npos) path_found = true; //2979 pb
-          //2012 Triggers
-          if (run >= 190456 /* && run <= xxxxx */ && name.find("HLT_IsoMu24_eta2p1_v") != name.npos) path_found = true;          
-        }
-        if (channel_ == channel::em) {
-          // Look for Mu Low trigger first
-          if (run >= 160404 && run <= 167913 && name.find("HLT_Mu8_Ele17_CaloIdL_v") != name.npos) path_found = true;
-          if (run >= 170249 && run <= 180252 && name.find("HLT_Mu8_Ele17_CaloIdT_CaloIsoVL_v") != name.npos) path_found = true;
-          if (run >= 190456/* && run <= xxxxx*/ && name.find("HLT_Mu8_Ele17_CaloIdT_CaloIsoVL_TrkIdVL_TrkIsoVL_v") != name.npos) path_found = true; 
-          if (run >= 160404 && run <= 167913 && name.find("HLT_Mu17_Ele8_CaloIdL_v") != name.npos) path_found = true;
-          if (run >= 170249 && run <= 180252 && name.find("HLT_Mu17_Ele8_CaloIdT_CaloIsoVL_v") != name.npos) path_found = true;
-          if (run >= 190456/* && run <= xxxxx*/ && name.find("HLT_Mu17_Ele8_CaloIdT_CaloIsoVL_TrkIdVL_TrkIsoVL_v") != name.npos) path_found = true; 
-        }
-        if (channel_ == channel::mtmet) {
-          //2012 Triggers
-          if (run >= 203768 /*&& run <= ???*/ && name.find("HLT_IsoMu8_eta2p1_LooseIsoPFTau20_L1ETM26_v") != name.npos) path_found = true;
-        }
-        if (channel_ == channel::etmet) {
-          //2012 Triggers
-          if (run >= 203768 /*&& run <= ???*/ && name.find("HLT_Ele13_eta2p1_WP90Rho_LooseIsoPFTau20_L1ETM36_v") != name.npos) path_found = true;
-        }
-        if (path_found) break;
-      }
-      if (!path_found) return 1;
-
-      if (channel_ == channel::et) {
-        // 2011 Triggers
-        if (run >= 160404 && run <= 163869) {
-          trig_obj_label = "triggerObjectsEle15LooseTau15";
-          leg1_filter = "hltEle15CaloIdVTTrkIdTCaloIsoTTrkIsoTTrackIsolFilter";
-          leg2_filter = "hltPFTau15TrackLooseIso";  
-        }
-        if (run >= 165088 && run <= 167913) {
-          trig_obj_label = "triggerObjectsEle15LooseTau20";
-          leg1_filter = "hltEle15CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilter";
-          leg2_filter = "hltPFTau20TrackLooseIso";  
-        }
-        if (run >= 170249 && run <= 173198) {
-          trig_obj_label = "triggerObjectsEle15TightTau20";
-          leg1_filter = "hltEle15CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilter";
-          leg2_filter = "hltPFTauTightIso20TrackTightIso";  
-        }
-        if (run >= 173236 && run <= 178380) {
-          trig_obj_label = "triggerObjectsEle18MediumTau20";
-          leg1_filter = "hltEle18CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilter";
-          leg2_filter = "hltPFTauMediumIso20TrackMediumIso";  
-        }
-        if (run >= 178420 && run <= 180252) {
-          trig_obj_label = "triggerObjectsEle20MediumTau20";
-          leg1_filter = "hltEle20CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilterL1SingleEG18orL1SingleEG20";
-          leg2_filter = "hltPFTauMediumIso20TrackMediumIso";  
-        }
-        // 2012 Triggers
-        if (run >= 190456 && run <= 193751) {
-          trig_obj_label = "triggerObjectsEle20RhoLooseTau20";
-          leg1_filter = "hltEle20CaloIdVTCaloIsoTTrkIdTTrkIsoTTrackIsoFilterL1IsoEG18OrEG20";
-          leg2_filter = "hltPFTauIsoEleVertex20";
-        }
-        if (run >= 193752/* && run <= xxxxx*/) {
-          trig_obj_label = "triggerObjectsEle22WP90RhoLooseTau20";
-          leg1_filter = "hltEle22WP90RhoTrackIsoFilter";
-          leg2_filter = "hltIsoElePFTau20TrackLooseIso";
-        }
-      }
-      if (channel_ == channel::mt) {
-        // 2011 Triggers
-        // if (run >= 160404 && run <= 163869) {
-        //   trig_obj_label = "triggerObjectsIsoMu12LooseTau10";
-        //   leg1_filter = "hltSingleMuIsoL3IsoFiltered12";
-        //   leg2_filter = "hltFilterIsoMu12IsoPFTau10LooseIsolation";  
-        // }
-        // if (run >= 165088 && run <= 173198) {
-        //   trig_obj_label = "triggerObjectsIsoMu15LooseTau15";
-        //   leg1_filter = "hltSingleMuIsoL3IsoFiltered15";
-        //   leg2_filter = "hltPFTau15TrackLooseIso";  
-        // }
-        // if (run >= 173236 && run <= 180252) {
-        //   trig_obj_label = "triggerObjectsIsoMu15LooseTau20";
-        //   leg1_filter = "hltSingleMuIsoL1s14L3IsoFiltered15eta2p1";
-        //   leg2_filter = "hltPFTau20TrackLooseIso";  
-        // }
-        // 2012 Triggers
-        if (run >= 190456 && run <= 193751) {
-          trig_obj_label = "triggerObjectsIsoMu24";
-          leg1_filter = "hltL3crIsoL1sMu16Eta2p1L1f0L2f16QL3f24QL3crIsoFiltered10";
-          leg2_filter = "";
-        }
-        if (run >= 193752/* && run <= xxxxx*/) {
-          trig_obj_label = "triggerObjectsIsoMu24";
-          leg1_filter = "hltL3crIsoL1sMu16Eta2p1L1f0L2f16QL3f24QL3crIsoRhoFiltered0p15";
-          leg2_filter = "";
-        }
-      }
+      TriggerTable::Filters const& filters = table_.Lookup(0, run, flags);
+      trig_obj_label = filters.objects;
+      leg1_filter = filters.leg1;
+      leg2_filter = filters.leg2;
       if (channel_ == channel::em) {
-        // 2011 Triggers
-        if (run >= 160404 && run <= 167913) {
-          trig_obj_label = "triggerObjectsMu8Ele17IdL";
-          leg1_filter = "hltL1NonIsoHLTNonIsoMu8Ele17PixelMatchFilter";
-          leg2_filter = "hltL1MuOpenEG5L3Filtered8";  
-        }
-        if (run >= 170249 && run <= 180252) {
-          trig_obj_label = "triggerObjectsMu8Ele17";
-          leg1_filter = "hltMu8Ele17CaloIdTCaloIsoVLPixelMatchFilter";
-          leg2_filter = "hltL1MuOpenEG5L3Filtered8";  
-        }
-        // 2012 Triggers
-        if (run >= 190456 && run <= 191690) {
-          trig_obj_label = "triggerObjectsMu8Ele17";
-          leg1_filter = "hltMu8Ele17CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter";
-          leg2_filter = "hltL1MuOpenEG12L3Filtered8";
-        }
-        if (run >= 191691/* && run <= xxxxx*/) {
-          trig_obj_label = "triggerObjectsMu8Ele17";
-          leg1_filter = "hltMu8Ele17CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter";
-          leg2_filter = "hltL1sL1Mu3p5EG12ORL1MuOpenEG12L3Filtered8";
-        }
-        // 2011 Triggers
-        if (run >= 160404 && run <= 167913) {
-          em_alt_trig_obj_label = "triggerObjectsMu17Ele8IdL";
-          em_alt_leg1_filter = "hltL1NonIsoHLTNonIsoMu17Ele8PixelMatchFilter";
-          em_alt_leg2_filter = "hltL1MuOpenEG5L3Filtered17";  
-        }
-        if (run >= 170249 && run <= 180252) {
-          em_alt_trig_obj_label = "triggerObjectsMu17Ele8";
-          em_alt_leg1_filter = "hltMu17Ele8CaloIdTPixelMatchFilter";
-          em_alt_leg2_filter = "hltL1Mu7EG5L3MuFiltered17";  
-        }
-        // 2012 Triggers
-        if (run >= 190456 && run <= 193751) {
-          em_alt_trig_obj_label = "triggerObjectsMu17Ele8";
-          em_alt_leg1_filter = "hltMu17Ele8CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter";
-          em_alt_leg2_filter = "hltL1Mu12EG7L3MuFiltered17";
-        }
-        if (run >= 193752/* && run <= xxxxx*/) {
-          em_alt_trig_obj_label = "triggerObjectsMu17Ele8";
-          em_alt_leg1_filter = "hltMu17Ele8CaloIdTCaloIsoVLTrkIdVLTrkIsoVLTrackIsoFilter";
-          em_alt_leg2_filter = "hltL1Mu12EG7L3MuFiltered17";
-        }
-      }
-      if (channel_ == channel::mtmet) {
-        if (run >= 203777/* && run <= xxxxx*/) {
-          trig_obj_label = "triggerObjectsIsoMu8LooseTau20L1ETM26";
-          leg1_filter = "hltL3crIsoL1sMu7Eta2p1L1f0L2f7QL3f8QL3crIsoRhoFiltered0p15";
-          leg2_filter = "hltIsoMu8PFTau20TrackLooseIso";
-        }
-      }
-      if (channel_ == channel::etmet) {
-        if (run >= 203777/* && run <= xxxxx*/) {
-          trig_obj_label = "triggerObjectsEle13LooseTau20L1ETM36";
-          leg1_filter = "hltEle13WP90RhoTrackIsoFilter";
-          leg2_filter = "hltIsoEle13PFTau20TrackLooseIso";
-        }
+        TriggerTable::Filters const& em_alt_filters = table_.Lookup(1, run, flags);
+        em_alt_trig_obj_label = em_alt_filters.objects;
+        em_alt_leg1_filter = em_alt_filters.leg1;
+        em_alt_leg2_filter = em_alt_filters.leg2;
       }
     } else {
       if (channel_ == channel::et) {
@@ -6,6 +6,7 @@
 #include "boost/bind.hpp"
 #include "boost/function.hpp"
 #include "boost/format.hpp"
+#include "boost/shared_ptr.hpp"
 #include "TSystem.h"
 #include "FWCore/FWLite/interface/AutoLibraryLoader.h"
 #include "PhysicsTools/FWLite/interface/TFileService.h"
@@ -50,6 +51,39 @@ using std::string;
 using std::vector;
 using namespace ic;
 
+// Adds modules to the common sequence of an analysis or, once a variation
+// is set, copies of them to the sequence of that variation, so that the
+// same modules can be reconfigured for the next variation
+class ModuleSequence {
+ public:
+  explicit ModuleSequence(AnalysisBase & analysis) : analysis_(analysis) { ; }
+  void set_variation(std::string const& variation) { variation_ = variation; }
+
+  template <class T>
+  void AddModule(T *module) {
+    if (variation_ == "") {
+      analysis_.AddModule(module);
+    } else {
+      Adopt(new T(*module));
+    }
+  }
+
+  // Adds a module made for the current variation, deleted with the sequence
+  void Adopt(ModuleBase *module) {
+    owned_.push_back(boost::shared_ptr<ModuleBase>(module));
+    if (variation_ == "") {
+      analysis_.AddModule(module);
+    } else {
+      analysis_.AddModule(variation_, module);
+    }
+  }
+
+ private:
+  AnalysisBase & analysis_;
+  std::string variation_;
+  std::vector<boost::shared_ptr<ModuleBase> > owned_;
+};
+
 int main(int argc, char* argv[]){
 
   // Configurable parameters
@@ -71,15 +105,19 @@ int main(int argc, char* argv[]){
   bool is_embedded;               // true = embedded, false = not an embedded sample
   unsigned special_mode;          // 0 = normal processing, > 0 (see below)
   unsigned tau_scale_mode;        // 0 = no shift, 1 = shift down, 2 = shift up
+  bool tau_scale_variations;      // Run the nominal, shift down and shift up selections in one pass
   unsigned btag_mode;             // 0 = no shift, 1 = shift down, 2 = shift up
   unsigned bfake_mode;            // 0 = no shift, 1 = shift down, 2 = shift up
   unsigned jes_mode;              // 0 = no shift, 1 = shift down, 2 = shift up
   unsigned l1met_mode;              // 0 = no shift, 1 = shift down, 2 = shift up
   unsigned mass_scale_mode;       // 0 = no shift, 1 = nominal, but in TSCALE_DOWN, 2 = shift up, 3 = shift up again, in TSCALE_UP
-  unsigned svfit_mode;            // 0 = not run, 1 = generate jobs, 2 = read-in job output
+  unsigned svfit_mode;            // 0 = not run, 1 = generate jobs, 2 = read-in job output, 3 = compute in-process,
+                                  // 4 = fill svfit_cache for a later job in mode 3, using svfit_workers processes
   unsigned new_svfit_mode;        // 0 = not run, 1 = generate jobs, 2 = read-in job output
   string svfit_folder;            // Folder containing svfit jobs & output
   string svfit_override;          // Override the svfit results to use
+  string svfit_cache;             // Persistent cache of svfit results (svfit_mode 3 and 4 only)
+  unsigned svfit_workers;         // Number of processes running the fits in svfit_mode 4
   unsigned ztautau_mode;          // 0 = not run, 1 = select Z->tautau, 2 = select Z->ee and Z->mumu
   unsigned faked_tau_selector;    // 0 = not run, 1 = tau matched to gen. lepton, 2 = tau not matched to lepton
   unsigned hadronic_tau_selector;    // 0 = not run, 1 = tau matched to gen. lepton, 2 = tau not matched to lepton
@@ -128,6 +166,7 @@ int main(int argc, char* argv[]){
       ("is_embedded",         po::value<bool>(&is_embedded)->default_value(false))
       ("special_mode",        po::value<unsigned>(&special_mode)->default_value(0))
       ("tau_scale_mode",      po::value<unsigned>(&tau_scale_mode)->default_value(0))
+      ("tau_scale_variations", po::value<bool>(&tau_scale_variations)->default_value(false))
       ("btag_mode",           po::value<unsigned>(&btag_mode)->default_value(0))
       ("bfake_mode",          po::value<unsigned>(&bfake_mode)->default_value(0))
       ("jes_mode",            po::value<unsigned>(&jes_mode)->default_value(0))
@@ -137,6 +176,8 @@ int main(int argc, char* argv[]){
       ("new_svfit_mode",      po::value<unsigned>(&new_svfit_mode)->default_value(0))
       ("svfit_folder",        po::value<string>(&svfit_folder)->default_value(""))
       ("svfit_override",      po::value<string>(&svfit_override)->default_value(""))
+      ("svfit_cache",         po::value<string>(&svfit_cache)->default_value(""))
+      ("svfit_workers",       po::value<unsigned>(&svfit_workers)->default_value(1))
       ("ztautau_mode",        po::value<unsigned>(&ztautau_mode)->default_value(0))
       ("faked_tau_selector",  po::value<unsigned>(&faked_tau_selector)->default_value(0))
       ("hadronic_tau_selector",  po::value<unsigned>(&hadronic_tau_selector)->default_value(0))
@@ -176,6 +217,10 @@ int main(int argc, char* argv[]){
   if (jes_mode == 2) output_folder += "JES_UP/";
   if (l1met_mode == 1) output_folder += "L1MET_DOWN/";
   if (l1met_mode == 2) output_folder += "L1MET_UP/";
+  if (tau_scale_variations && (tau_scale_mode > 0 || mass_scale_mode > 0 || do_skim || make_sync_ntuple)) {
+    std::cerr << "Error: tau_scale_variations can't be used with tau_scale_mode, mass_scale_mode, do_skim or make_sync_ntuple" << std::endl;
+    return 1;
+  }
   
 
 //  if (era == era::data_2012_moriond && (channel == channel::etmet || channel == channel::mtmet)) {
@@ -198,12 +243,15 @@ int main(int argc, char* argv[]){
   std::cout << boost::format(param_fmt) % "is_embedded" % is_embedded;
   std::cout << boost::format(param_fmt) % "special_mode" % special_mode;
   std::cout << boost::format(param_fmt) % "tau_scale_mode" % tau_scale_mode;
+  std::cout << boost::format(param_fmt) % "tau_scale_variations" % tau_scale_variations;
   std::cout << boost::format(param_fmt) % "mass_scale_mode" % mass_scale_mode;
   std::cout << boost::format(param_fmt) % "svfit_mode" % svfit_mode;
   std::cout << boost::format(param_fmt) % "new_svfit_mode" % new_svfit_mode;
   if (svfit_mode > 0) {
     std::cout << boost::format(param_fmt) % "svfit_folder" % svfit_folder;
     std::cout << boost::format(param_fmt) % "svfit_override" % svfit_override;
+    std::cout << boost::format(param_fmt) % "svfit_cache" % svfit_cache;
+    std::cout << boost::format(param_fmt) % "svfit_workers" % svfit_workers;
   }
   std::cout << boost::format(param_fmt) % "ztautau_mode" % ztautau_mode;
   std::cout << boost::format(param_fmt) % "faked_tau_selector" % faked_tau_selector;
@@ -477,9 +525,13 @@ int main(int argc, char* argv[]){
   // ------------------------------------------------------------------------------------
   // Electron Modules
   // ------------------------------------------------------------------------------------
-  double elec_shift = 1.0;
-  if (tau_scale_mode == 1) elec_shift = 0.99;
-  if (tau_scale_mode == 2) elec_shift = 1.01;
+  // The shift for a tau_scale_mode, also used for each tau_scale_variations sequence
+  auto elec_shift_for = [] (unsigned mode) -> double {
+    if (mode == 1) return 0.99;
+    if (mode == 2) return 1.01;
+    return 1.0;
+  };
+  double elec_shift = elec_shift_for(tau_scale_mode);
   EnergyShifter<Electron> electronEnergyShifter = EnergyShifter<Electron>
   ("ElectronEnergyShifter")
     .set_input_label("electrons")
@@ -652,13 +704,13 @@ int main(int argc, char* argv[]){
 
   TauDzFixer tauDzFixer("TauDzFixer");
 
-  double tau_shift = 1.0;
-  if (tau_scale_mode == 1) tau_shift = 0.97;
-  if (tau_scale_mode == 2) tau_shift = 1.03;
-  if (large_tscale_shift) {
-    if (tau_scale_mode == 1) tau_shift = 0.94;
-    if (tau_scale_mode == 2) tau_shift = 1.06;
-  }
+  // The shift for a tau_scale_mode, also used for each tau_scale_variations sequence
+  auto tau_shift_for = [&] (unsigned mode) -> double {
+    if (mode == 1) return large_tscale_shift ? 0.94 : 0.97;
+    if (mode == 2) return large_tscale_shift ? 1.06 : 1.03;
+    return 1.0;
+  };
+  double tau_shift = tau_shift_for(tau_scale_mode);
   EnergyShifter<Tau> tauEnergyShifter = EnergyShifter<Tau>
   ("TauEnergyShifter")
     .set_input_label("taus")
@@ -947,18 +999,25 @@ int main(int argc, char* argv[]){
   HTTSync httSync("HTTSync","SYNCFILE_" + output_name, channel);
   httSync.set_is_embedded(is_embedded).set_met_label(met_label);
 
-  SVFit svfit("SVFit");
-  svfit
-    .set_outname(output_name)
-    .set_op(svfit_mode)
-    .set_dilepton_label("emtauCandidates")
-    .set_met_label(met_label)
-    .set_channel(channel);
-  svfit.set_fullpath(svfit_folder);
-  svfit.set_split(4000);
-  if (svfit_override != "") {
-    svfit.set_outname(svfit_override);
-  }
+  // SVFit can't be copied, so each tau_scale_variations sequence makes its
+  // own, with the jobs in its folder. The cache is keyed on the inputs and
+  // can be shared.
+  auto make_svfit = [&] (std::string const& folder) -> SVFit * {
+    SVFit *svfit = new SVFit("SVFit");
+    svfit->set_outname(output_name)
+      .set_op(svfit_mode)
+      .set_dilepton_label("emtauCandidates")
+      .set_met_label(met_label)
+      .set_channel(channel);
+    svfit->set_fullpath(folder);
+    svfit->set_split(4000);
+    svfit->set_cache_file(svfit_cache);
+    svfit->set_workers(svfit_workers);
+    if (svfit_override != "") {
+      svfit->set_outname(svfit_override);
+    }
+    return svfit;
+  };
 
   SVFitTest svfitTest("SVFitTest");
   svfitTest
@@ -993,131 +1052,165 @@ int main(int argc, char* argv[]){
   if (!is_data && !do_skim)       analysis.AddModule(&pileupWeight);
   if (ztautau_mode > 0)           analysis.AddModule(&zTauTauFilter);
   if (!is_data && do_mass_filter) analysis.AddModule(&mssmMassFilter);
-  if (tau_scale_mode > 0 && channel != channel::em && !moriond_tau_scale && !do_skim)
-                                  analysis.AddModule(&tauEnergyShifter);
-  if (tau_scale_mode > 0 && channel == channel::em)         
-                                  analysis.AddModule(&electronEnergyShifter);
-  if (moriond_tau_scale && channel != channel::em && (!is_data || is_embedded) && !do_skim)          
-                                  analysis.AddModule(&httEnergyScale);
-  if (to_check.size() > 0)        analysis.AddModule(&httPrint);
-  if (is_embedded)                analysis.AddModule(&embeddedMassFilter);
 
-  if (channel == channel::et || channel == channel::etmet) {
-                                  analysis.AddModule(&selElectronCopyCollection);
-                                  analysis.AddModule(&selElectronFilter);
-    if (!do_skim) {                              
-                                  analysis.AddModule(&vetoElectronCopyCollection);
-                                  analysis.AddModule(&vetoElectronFilter);
-                                  analysis.AddModule(&vetoElectronPairProducer);
-      if (special_mode != 18)     analysis.AddModule(&vetoElectronPairFilter);
-      if (special_mode != 18)     analysis.AddModule(&extraElectronVeto);
-      if (special_mode != 18)     analysis.AddModule(&extraMuonVeto);
+  // With tau_scale_variations the modules from the energy scale shift on
+  // are run for the nominal scale and for the shifts down and up, each as
+  // a variation of the analysis on the events passing the modules above.
+  // The shifted outputs go to TSCALE_DOWN/ and TSCALE_UP/, as they do with
+  // tau_scale_mode.
+  std::vector<std::string> variations(1, "");
+  if (tau_scale_variations) variations = {"NOMINAL", "TSCALE_DOWN", "TSCALE_UP"};
+  ModuleSequence sequence(analysis);
+  for (unsigned var = 0; var < variations.size(); ++var) {
+    sequence.set_variation(variations[var]);
+    unsigned var_scale_mode = tau_scale_mode;
+    std::string var_svfit_folder = svfit_folder;
+    if (tau_scale_variations) {
+      var_scale_mode = var;
+      if (var > 0) var_svfit_folder += variations[var] + "/";
+      fwlite::TFileService *var_fs = fs;
+      if (var > 0) var_fs = analysis.VariationFileService(variations[var], output_folder+output_name);
+      double var_tau_shift = tau_shift_for(var_scale_mode);
+      double var_elec_shift = elec_shift_for(var_scale_mode);
+      tauEnergyShifter.set_shift(var_tau_shift);
+      electronEnergyShifter.set_shift(var_elec_shift);
+      httEnergyScale.set_shift(var_tau_shift);
+      httPairSelector
+        .set_fs(var_fs)
+        .set_scale_met_for_tau((var_scale_mode > 0 || (moriond_tau_scale && (is_embedded || !is_data) )   ))
+        .set_tau_scale(channel == channel::em ? var_elec_shift : var_tau_shift);
+      tauEfficiency.set_fs(var_fs);
+      quarkGluonDiscriminatorStudy.set_fs(var_fs);
+      httCategories.set_fs(var_fs);
+      svfitTest.set_fullpath(var_svfit_folder);
     }
-                                  analysis.AddModule(&tauPtEtaFilter);
-                                  analysis.AddModule(&tauDzFilter);
-  if (do_tau_eff) {
-                                  analysis.AddModule(&tauElRejectFilter);
-                                  analysis.AddModule(&tauMuRejectFilter);
-                                  analysis.AddModule(&tauEfficiency);
-  }
-                                  analysis.AddModule(&tauIsoFilter);
-                                  analysis.AddModule(&tauElRejectFilter);
-                                  analysis.AddModule(&tauMuRejectFilter);
 
-                                  analysis.AddModule(&tauElPairProducer);
-                                  analysis.AddModule(&pairFilter);
-  }
+    if (var_scale_mode > 0 && channel != channel::em && !moriond_tau_scale && !do_skim)
+                                    sequence.AddModule(&tauEnergyShifter);
+    if (var_scale_mode > 0 && channel == channel::em)         
+                                    sequence.AddModule(&electronEnergyShifter);
+    if (moriond_tau_scale && channel != channel::em && (!is_data || is_embedded) && !do_skim)          
+                                    sequence.AddModule(&httEnergyScale);
+    if (to_check.size() > 0)        sequence.AddModule(&httPrint);
+    if (is_embedded)                sequence.AddModule(&embeddedMassFilter);
 
-  if (channel == channel::mt || channel == channel::mtmet) {
-                                  analysis.AddModule(&selMuonCopyCollection);
-                                  analysis.AddModule(&selMuonFilter);
-    if (!do_skim) {                              
-                                  analysis.AddModule(&vetoMuonCopyCollection);
-                                  analysis.AddModule(&vetoMuonFilter);
-                                  analysis.AddModule(&vetoMuonPairProducer);
-                                  analysis.AddModule(&vetoMuonPairFilter);
-                                  analysis.AddModule(&extraElectronVeto);
-                                  analysis.AddModule(&extraMuonVeto);
+    if (channel == channel::et || channel == channel::etmet) {
+                                    sequence.AddModule(&selElectronCopyCollection);
+                                    sequence.AddModule(&selElectronFilter);
+      if (!do_skim) {                              
+                                    sequence.AddModule(&vetoElectronCopyCollection);
+                                    sequence.AddModule(&vetoElectronFilter);
+                                    sequence.AddModule(&vetoElectronPairProducer);
+        if (special_mode != 18)     sequence.AddModule(&vetoElectronPairFilter);
+        if (special_mode != 18)     sequence.AddModule(&extraElectronVeto);
+        if (special_mode != 18)     sequence.AddModule(&extraMuonVeto);
+      }
+                                    sequence.AddModule(&tauPtEtaFilter);
+                                    sequence.AddModule(&tauDzFilter);
+    if (do_tau_eff) {
+                                    sequence.AddModule(&tauElRejectFilter);
+                                    sequence.AddModule(&tauMuRejectFilter);
+                                    sequence.AddModule(&tauEfficiency);
     }
-                                  analysis.AddModule(&tauPtEtaFilter);
-                                  analysis.AddModule(&tauDzFilter);
-  if (do_tau_eff) {
-                                  analysis.AddModule(&tauElRejectFilter);
-                                  analysis.AddModule(&tauMuRejectFilter);
-                                  analysis.AddModule(&tauEfficiency);
-  }
-                                  analysis.AddModule(&tauIsoFilter);
-                                  analysis.AddModule(&tauElRejectFilter);
-                                  analysis.AddModule(&tauMuRejectFilter);
-    
-                                  analysis.AddModule(&tauMuPairProducer);
-                                  analysis.AddModule(&pairFilter);
-  }
+                                    sequence.AddModule(&tauIsoFilter);
+                                    sequence.AddModule(&tauElRejectFilter);
+                                    sequence.AddModule(&tauMuRejectFilter);
 
-  if (channel == channel::em) {
-    if (strategy == strategy::paper2013) {
-                                  analysis.AddModule(&emuExtras);
-    }
-                                  analysis.AddModule(&selElectronCopyCollection);
-                                  analysis.AddModule(&selElectronFilter);
-    if (special_mode != 25) {
-                                  analysis.AddModule(&elecMuonOverlapFilter);
-    }
-                                  analysis.AddModule(&selMuonCopyCollection);
-                                  analysis.AddModule(&selMuonFilter);
-  
-                                  analysis.AddModule(&elMuPairProducer);
-                                  analysis.AddModule(&pairFilter);
-    if (!do_skim) {                              
-                                  analysis.AddModule(&extraElectronVeto);
-                                  analysis.AddModule(&extraMuonVeto);
+                                    sequence.AddModule(&tauElPairProducer);
+                                    sequence.AddModule(&pairFilter);
     }
-  }
 
-  if (!do_skim) {
-    if (!is_embedded)  { // Don't usually want trigger for embedded
-                                  analysis.AddModule(&httTriggerFilter);
-    }
-    if (is_embedded && strategy == strategy::paper2013 && era == era::data_2012_rereco) {
-                                  analysis.AddModule(&httTriggerFilter);
-    }
-    //                            analysis.AddModule(&runStats);
-                                  analysis.AddModule(&httPairSelector);
-    if (jes_mode > 0 && !is_data) analysis.AddModule(&jetEnergyUncertainty);
-    //                            analysis.AddModule(&jetEnergyCorrections);
-                                  analysis.AddModule(&jetIDFilter);
-                                  analysis.AddModule(&filteredJetCopyCollection);
-                                  analysis.AddModule(&jetLeptonOverlapFilter);
-                                  analysis.AddModule(&httRecoilCorrector);
-
-    if (svfit_mode > 0 && !(svfit_override != "" && svfit_mode == 1)) {
-                                  analysis.AddModule(&svfit);
+    if (channel == channel::mt || channel == channel::mtmet) {
+                                    sequence.AddModule(&selMuonCopyCollection);
+                                    sequence.AddModule(&selMuonFilter);
+      if (!do_skim) {                              
+                                    sequence.AddModule(&vetoMuonCopyCollection);
+                                    sequence.AddModule(&vetoMuonFilter);
+                                    sequence.AddModule(&vetoMuonPairProducer);
+                                    sequence.AddModule(&vetoMuonPairFilter);
+                                    sequence.AddModule(&extraElectronVeto);
+                                    sequence.AddModule(&extraMuonVeto);
+      }
+                                    sequence.AddModule(&tauPtEtaFilter);
+                                    sequence.AddModule(&tauDzFilter);
+    if (do_tau_eff) {
+                                    sequence.AddModule(&tauElRejectFilter);
+                                    sequence.AddModule(&tauMuRejectFilter);
+                                    sequence.AddModule(&tauEfficiency);
     }
-    if (!(svfit_override != "" && new_svfit_mode == 1)) {
-                                  analysis.AddModule(&svfitTest);
+                                    sequence.AddModule(&tauIsoFilter);
+                                    sequence.AddModule(&tauElRejectFilter);
+                                    sequence.AddModule(&tauMuRejectFilter);
+    
+                                    sequence.AddModule(&tauMuPairProducer);
+                                    sequence.AddModule(&pairFilter);
     }
-    if (channel == channel::mtmet   // Only apply the L1 MET cut on MC and
-      && (!is_data || is_embedded)  // embedded, when not skimming or generating
-      && !do_skim  && !make_sync_ntuple        // svfit jobs
-      && new_svfit_mode != 1) {
-                                  analysis.AddModule(&httL1MetCut);
-    }  
-                                  analysis.AddModule(&httWeights);
-   if (is_embedded && era == era::data_2012_rereco) {
-                                  analysis.AddModule(&rechitWeights);
-   }
-    if (strategy == strategy::paper2013 && channel == channel::em) {
-                                  analysis.AddModule(&emuMVA);
+
+    if (channel == channel::em) {
+      if (strategy == strategy::paper2013) {
+                                    sequence.AddModule(&emuExtras);
+      }
+                                    sequence.AddModule(&selElectronCopyCollection);
+                                    sequence.AddModule(&selElectronFilter);
+      if (special_mode != 25) {
+                                    sequence.AddModule(&elecMuonOverlapFilter);
+      }
+                                    sequence.AddModule(&selMuonCopyCollection);
+                                    sequence.AddModule(&selMuonFilter);
+  
+                                    sequence.AddModule(&elMuPairProducer);
+                                    sequence.AddModule(&pairFilter);
+      if (!do_skim) {                              
+                                    sequence.AddModule(&extraElectronVeto);
+                                    sequence.AddModule(&extraMuonVeto);
+      }
     }
-    if (quark_gluon_study)        analysis.AddModule(&quarkGluonDiscriminatorStudy);                                 
-    if (make_sync_ntuple)         analysis.AddModule(&httSync);
-    if (!quark_gluon_study)       analysis.AddModule(&httCategories);
-                                  //analysis.AddModule(&btagCheck);
 
-  }
+    if (!do_skim) {
+      if (!is_embedded)  { // Don't usually want trigger for embedded
+                                    sequence.AddModule(&httTriggerFilter);
+      }
+      if (is_embedded && strategy == strategy::paper2013 && era == era::data_2012_rereco) {
+                                    sequence.AddModule(&httTriggerFilter);
+      }
+      //                            sequence.AddModule(&runStats);
+                                    sequence.AddModule(&httPairSelector);
+      if (jes_mode > 0 && !is_data) sequence.AddModule(&jetEnergyUncertainty);
+      //                            sequence.AddModule(&jetEnergyCorrections);
+                                    sequence.AddModule(&jetIDFilter);
+                                    sequence.AddModule(&filteredJetCopyCollection);
+                                    sequence.AddModule(&jetLeptonOverlapFilter);
+                                    sequence.AddModule(&httRecoilCorrector);
+
+      if (svfit_mode > 0 && !(svfit_override != "" && svfit_mode == 1)) {
+                                    sequence.Adopt(make_svfit(var_svfit_folder));
+      }
+      if (!(svfit_override != "" && new_svfit_mode == 1)) {
+                                    sequence.AddModule(&svfitTest);
+      }
+      if (channel == channel::mtmet   // Only apply the L1 MET cut on MC and
+        && (!is_data || is_embedded)  // embedded, when not skimming or generating
+        && !do_skim  && !make_sync_ntuple        // svfit jobs
+        && new_svfit_mode != 1) {
+                                    sequence.AddModule(&httL1MetCut);
+      }  
+                                    sequence.AddModule(&httWeights);
+     if (is_embedded && era == era::data_2012_rereco) {
+                                    sequence.AddModule(&rechitWeights);
+     }
+      if (strategy == strategy::paper2013 && channel == channel::em) {
+                                    sequence.AddModule(&emuMVA);
+      }
+      if (quark_gluon_study)        sequence.AddModule(&quarkGluonDiscriminatorStudy);                                 
+      if (make_sync_ntuple)         sequence.AddModule(&httSync);
+      if (!quark_gluon_study)       sequence.AddModule(&httCategories);
+                                    //sequence.AddModule(&btagCheck);
 
-  if (do_skim) {
-    if (faked_tau_selector > 0)   analysis.AddModule(&httPairSelector);
+    }
+
+    if (do_skim) {
+      if (faked_tau_selector > 0)   sequence.AddModule(&httPairSelector);
+    }
   }
 
 
@@ -57,6 +57,11 @@ int main(int argc, char* argv[]){
 	unsigned scan_bins;
   double qcd_os_ss_factor;
   string w_binned;
+  string shape_cache;                           // Directory for cached shapes and rates, off if empty
+  unsigned shape_cache_max_mb;
+  bool no_cache;                                // Ignore the shape cache and recompute everything
+  bool column_cache;                            // Keep the branches read from the trees in memory between fills
+  unsigned threads;                             // Samples filled in parallel, 0 = number of cores, default 1
 
 	// Program options
   po::options_description preconfig("Pre-Configuration");
@@ -107,7 +112,12 @@ int main(int argc, char* argv[]){
 	  ("auto_titles",   			    po::value<bool>(&auto_titles)->default_value(true))
 	  ("check_ztt_top_frac",      po::value<bool>(&check_ztt_top_frac)->default_value(false))
 	  ("scan_bins",               po::value<unsigned>(&scan_bins)->default_value(0))
-	  ("qcd_os_ss_factor",  	    po::value<double>(&qcd_os_ss_factor)->default_value(1.06));
+	  ("qcd_os_ss_factor",  	    po::value<double>(&qcd_os_ss_factor)->default_value(1.06))
+	  ("shape_cache",             po::value<string>(&shape_cache)->default_value(""))
+	  ("shape_cache_max_mb",      po::value<unsigned>(&shape_cache_max_mb)->default_value(500))
+	  ("no_cache",                po::value<bool>(&no_cache)->default_value(false))
+	  ("column_cache",            po::value<bool>(&column_cache)->default_value(false))
+	  ("threads",                 po::value<unsigned>(&threads)->default_value(1));
 
 
 	HTTPlot plot;
@@ -184,6 +194,9 @@ int main(int argc, char* argv[]){
 	if (is_2012 && check_ztt_top_frac) ana.AddSample("RecHit-TTJets_FullLeptMGDecays");
 	ana.ReadTrees(folder);
 	ana.ParseParamFile(paramfile);
+	if (!no_cache) ana.SetShapeCache(shape_cache, shape_cache_max_mb);
+	ana.SetColumnCache(column_cache);
+	ana.SetThreads(threads);
 
 	HTTAnalysis::HistValueMap hmap;
 
@@ -197,14 +210,23 @@ int main(int argc, char* argv[]){
 	}
 	cat = ana.ResolveAlias(cat);
 
-	ana.FillHistoMap(hmap, method, var, sel, cat, "wt", "");
-	ana.FillSMSignal(hmap, sm_masses, var, sel, cat, "wt", "", "", 1.0);
-	ana.FillHWWSignal(hmap, hww_masses, var, sel, cat, "wt", "_hww", "", 1.0);
-	if (add_sm_background != "") {
-		ana.FillSMSignal(hmap, {add_sm_background}, var, sel, cat, "wt", "_SM", "");
-		ana.FillHWWSignal(hmap, {add_sm_background}, var, sel, cat, "wt", "_hww_SM", "");
-	}
-	ana.FillMSSMSignal(hmap, mssm_masses, var, sel, cat, "wt", "", "", 1.0);
+	auto fill_nominal = [&](HTTAnalysis::HistValueMap & map) {
+		ana.FillHistoMap(map, method, var, sel, cat, "wt", "");
+		ana.FillSMSignal(map, sm_masses, var, sel, cat, "wt", "", "", 1.0);
+		ana.FillHWWSignal(map, hww_masses, var, sel, cat, "wt", "_hww", "", 1.0);
+		if (add_sm_background != "") {
+			ana.FillSMSignal(map, {add_sm_background}, var, sel, cat, "wt", "_SM", "");
+			ana.FillHWWSignal(map, {add_sm_background}, var, sel, cat, "wt", "_hww_SM", "");
+		}
+		ana.FillMSSMSignal(map, mssm_masses, var, sel, cat, "wt", "", "", 1.0);
+	};
+	// Dry run to book every shape and rate the nominal histograms need, so
+	// that each tree is read only once
+	HTTAnalysis::HistValueMap booking_map;
+	ana.StartBooking();
+	fill_nominal(booking_map);
+	ana.Run();
+	fill_nominal(hmap);
 
 
 	// ************************************************************************
@@ -378,6 +400,9 @@ int main(int argc, char* argv[]){
 		ana_syst.AddMSSMSignalSamples(mssm_masses);
 		ana_syst.ReadTrees(folder+syst.first, folder);
 		ana_syst.ParseParamFile(paramfile);
+		if (!no_cache) ana_syst.SetShapeCache(shape_cache, shape_cache_max_mb);
+		ana_syst.SetColumnCache(column_cache);
+		ana_syst.SetThreads(threads);
 		ana_syst.FillHistoMap(hmap, method, var, sel, cat, "wt", "_"+syst.second);
 		ana_syst.FillSMSignal(hmap, sm_masses, var, sel, cat, "wt", "", "_"+syst.second, 1.0);
 		ana_syst.FillHWWSignal(hmap, hww_masses, var, sel, cat, "wt", "_hww", "_"+syst.second, 1.0);
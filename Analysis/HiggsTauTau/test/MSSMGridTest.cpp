@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include "TFile.h"
+#include "TH2F.h"
+#include "TObjString.h"
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/MSSMGrid.h"
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/mssm_xs_tools.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::MSSMGrid;
+
+// Checks MSSMGrid against the mssm_xs_tools Give_* methods it replaces,
+// at the bin edges and outside the grid, the bilinear interpolation and
+// the binary grid file
+
+double Plane(double mA, double tanb, unsigned k) {
+  return 0.5 + 0.01 * (k + 1) * mA + 0.3 * tanb;
+}
+
+int main() {
+  ic::TestChecks check;
+  TH1::AddDirectory(false);
+  // An input file laid out like the Yellow Report ones: mA binning
+  // variable, tan(beta) uniform
+  std::string root_file = "MSSMGridTest.root";
+  std::string cache_file = "MSSMGridTest.grid";
+  std::vector<double> ma_edges;
+  for (double m = 90.; m < 200.; m += 5.) ma_edges.push_back(m);
+  for (double m = 200.; m <= 1000.; m += 20.) ma_edges.push_back(m);
+  char const* names[3] = {"h_brtautau_A", "h_ggF_xsec_A", "h_bbH_xsec_A"};
+  {
+    TFile file(root_file.c_str(), "RECREATE");
+    for (unsigned k = 0; k < 3; ++k) {
+      TH2F hist(names[k], names[k], ma_edges.size() - 1, &ma_edges[0], 60, 0.5, 60.5);
+      for (int i = 0; i <= hist.GetNbinsX() + 1; ++i) {
+        for (int j = 0; j <= hist.GetNbinsY() + 1; ++j) {
+          bool flow = i == 0 || j == 0 || i > hist.GetNbinsX() || j > hist.GetNbinsY();
+          hist.SetBinContent(i, j, flow ? -1. : Plane(hist.GetXaxis()->GetBinCenter(i), hist.GetYaxis()->GetBinCenter(j), k));
+        }
+      }
+      file.cd();
+      hist.Write();
+    }
+    // mssm_xs_tools prints the description when it opens the file
+    TObjString description("MSSMGridTest input");
+    description.Write("description");
+    file.Close();
+  }
+
+  mssm_xs_tools xs_tools;
+  xs_tools.SetInput(root_file.c_str());
+  MSSMGrid grid;
+  grid.Load(root_file);
+  check(grid.n_channels() == 3, "one channel per histogram");
+  check(grid.description() == "MSSMGridTest input", "description");
+
+  // Every mA edge, just below it and beyond the grid, at tan(beta) edges,
+  // centres and beyond the grid.  Give_Xsec_ggFA converts the ggF cross
+  // section to fb, the BR and bbH values are returned as stored
+  std::vector<double> ma;
+  for (unsigned i = 0; i < ma_edges.size(); ++i) {
+    ma.push_back(ma_edges[i]);
+    ma.push_back(ma_edges[i] - 1E-9);
+  }
+  ma.push_back(10.);
+  ma.push_back(2000.);
+  double tanb[] = {0., 0.5, 1., 1.5, 30.2, 60.5, 61., 100.};
+  unsigned n_tanb = sizeof(tanb) / sizeof(tanb[0]);
+  unsigned mismatches = 0;
+  for (unsigned i = 0; i < ma.size(); ++i) {
+    for (unsigned j = 0; j < n_tanb; ++j) {
+      if (grid.Value("h_brtautau_A", ma[i], tanb[j]) != xs_tools.Give_BR_A_tautau(ma[i], tanb[j])) ++mismatches;
+      if (1000. * grid.Value("h_ggF_xsec_A", ma[i], tanb[j]) != xs_tools.Give_Xsec_ggFA(ma[i], tanb[j])) ++mismatches;
+      if (grid.Value("h_bbH_xsec_A", ma[i], tanb[j]) != xs_tools.Give_Xsec_bbA5f(ma[i], tanb[j])) ++mismatches;
+    }
+  }
+  check(mismatches == 0, "same values as mssm_xs_tools");
+
+  // The batch query gives the single point values, channel by channel
+  std::vector<unsigned> channels;
+  for (unsigned k = 0; k < 3; ++k) channels.push_back(grid.Channel(names[k]));
+  std::vector<double> ma_batch(ma.size() * n_tanb);
+  std::vector<double> tanb_batch(ma_batch.size());
+  for (unsigned i = 0; i < ma_batch.size(); ++i) {
+    ma_batch[i] = ma[i / n_tanb];
+    tanb_batch[i] = tanb[i % n_tanb];
+  }
+  std::vector<double> out(3 * ma_batch.size());
+  grid.Evaluate(channels, ma_batch.size(), &ma_batch[0], &tanb_batch[0], &out[0]);
+  mismatches = 0;
+  for (unsigned k = 0; k < 3; ++k) {
+    for (unsigned i = 0; i < ma_batch.size(); ++i) {
+      if (out[k * ma_batch.size() + i] != grid.Value(channels[k], ma_batch[i], tanb_batch[i])) ++mismatches;
+    }
+  }
+  check(mismatches == 0, "Evaluate matches Value");
+  // An empty batch touches none of the arrays
+  grid.Evaluate(channels, 0, nullptr, nullptr, nullptr);
+
+  // Bilinear interpolation reproduces a plane between the bin centres, up
+  // to the float precision of the TH2F contents, and is constant beyond
+  // the outermost centres
+  grid.set_interpolate(true);
+  double inside[][2] = {{92.5, 1.}, {97.3, 1.}, {150., 12.25}, {199.9, 30.}, {200.1, 59.9}, {990., 60.}};
+  for (unsigned i = 0; i < sizeof(inside) / sizeof(inside[0]); ++i) {
+    for (unsigned k = 0; k < 3; ++k) {
+      check(std::fabs(grid.Value(channels[k], inside[i][0], inside[i][1]) - Plane(inside[i][0], inside[i][1], k)) < 1E-4,
+            "interpolation inside the grid");
+    }
+  }
+  check(grid.Value(channels[0], 50., 70.) == grid.Value(channels[0], 92.5, 60.), "interpolation below mA, above tan(beta)");
+  check(grid.Value(channels[0], 2000., 0.) == grid.Value(channels[0], 990., 1.), "interpolation above mA, below tan(beta)");
+  grid.set_interpolate(false);
+
+  // Load writes the binary copy, and a second Load reads it back
+  std::remove(cache_file.c_str());
+  MSSMGrid cached;
+  cached.Load(root_file, cache_file);
+  MSSMGrid restored;
+  check(restored.Restore(cache_file), "binary copy written by Load");
+  restored.Load(root_file, cache_file);
+  mismatches = 0;
+  for (unsigned i = 0; i < ma_batch.size(); ++i) {
+    for (unsigned k = 0; k < 3; ++k) {
+      if (restored.Value(names[k], ma_batch[i], tanb_batch[i]) != grid.Value(channels[k], ma_batch[i], tanb_batch[i])) ++mismatches;
+    }
+  }
+  check(restored.n_channels() == 3 && mismatches == 0, "binary copy round trip");
+
+  // Files that are not grids are rejected, and Save reports a failed write
+  MSSMGrid bad;
+  check(!bad.Restore(root_file), "ROOT file is not a binary grid");
+  check(!bad.Restore("MSSMGridTest.missing"), "missing binary grid");
+  check(!grid.Save("MSSMGridTest.missing/grid"), "Save into a missing directory");
+
+  std::remove(cache_file.c_str());
+  std::remove(root_file.c_str());
+  return check.Summary();
+}
@@ -18,7 +18,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TextElement.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnRootTools.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTStatTools.h"
-#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/mssm_xs_tools.h"
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/MSSMGrid.h"
 
 
 namespace po = boost::program_options;
@@ -219,7 +219,7 @@ int main(int argc, char* argv[]){
     std::cout << "*****************************************************************************" << std::endl;
 
     for (unsigned i = 0; i < v_eras.size(); ++i) {
-      mssm_xs_tools xs_tool;
+      MSSMGrid xs_tool;
       string file;
       if (v_eras[i] == "7TeV") {
         file = "data/scale_factors/out.mhmax_mu200_7_nnlo.tanBeta_gte1.root";
@@ -228,11 +228,11 @@ int main(int argc, char* argv[]){
       } else {
         continue;
       }
-      xs_tool.SetInput(file.c_str());
+      xs_tool.Load(file);
       std::cout << "*****************************************************************************" << std::endl;
-      double br =  xs_tool.Give_BR_A_tautau(d_mass, d_tanb);
-      double xs_ggh = xs_tool.Give_Xsec_ggFA(d_mass, d_tanb) / 1000.;
-      double xs_bbh = xs_tool.Give_Xsec_bbA5f(d_mass, d_tanb) / 1000.;
+      double br =  xs_tool.Value("h_brtautau_A", d_mass, d_tanb);
+      double xs_ggh = xs_tool.Value("h_ggF_xsec_A", d_mass, d_tanb);
+      double xs_bbh = xs_tool.Value("h_bbH_xsec_A", d_mass, d_tanb) / 1000.;
       std::cout << "Era: " << v_eras[i] << " BR: " << br << " XS(ggH): " << xs_ggh << " XS(bbH): " << xs_bbh << std::endl; 
       TH1F ggh_hist = setup.era({v_eras[i]}).process({"ggH"}).GetShape();
       TH1F bbh_hist = setup.era({v_eras[i]}).process({"bbH"}).GetShape();
@@ -9,7 +9,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnRootTools.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SimpleParamParser.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTStatTools.h"
-#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/mssm_xs_tools.h"
+#include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/MSSMGrid.h"
 
 
 namespace po = boost::program_options;
@@ -24,7 +24,7 @@ struct EraInfo {
   SimpleParamParser     param_parser;
   double                lumi;
   map<string, double>   xs;
-  mssm_xs_tools         mssm_xs;
+  MSSMGrid              mssm_xs;
 };
 
 struct ColInfo {
@@ -113,10 +113,13 @@ int main(int argc, char* argv[]) {
     info.param_parser.ParseFile(info.param_file);
     info.lumi = info.param_parser.GetParam<double>("LUMI_DATA_"+channel);
     if (mssm) {
-      if (info.era == "7TeV") info.mssm_xs.SetInput("data/scale_factors/out.mhmax_mu200_7_nnlo.tanBeta_gte1.root");
-      if (info.era == "8TeV") info.mssm_xs.SetInput("data/scale_factors/out.mhmax_mu200_8_nnlo.tanBeta_gte1_FHv274.root");
-      info.xs["ggH"] = info.mssm_xs.Give_BR_A_tautau(d_mass, d_tanb) * (info.mssm_xs.Give_Xsec_ggFA(d_mass, d_tanb) / 1000.);
-      info.xs["bbH"] = info.mssm_xs.Give_BR_A_tautau(d_mass, d_tanb) * (info.mssm_xs.Give_Xsec_bbA5f(d_mass, d_tanb) / 1000.);
+      string file;
+      if (info.era == "7TeV") file = "data/scale_factors/out.mhmax_mu200_7_nnlo.tanBeta_gte1.root";
+      if (info.era == "8TeV") file = "data/scale_factors/out.mhmax_mu200_8_nnlo.tanBeta_gte1_FHv274.root";
+      info.mssm_xs.Load(file);
+      double br = info.mssm_xs.Value("h_brtautau_A", d_mass, d_tanb);
+      info.xs["ggH"] = br * info.mssm_xs.Value("h_ggF_xsec_A", d_mass, d_tanb);
+      info.xs["bbH"] = br * (info.mssm_xs.Value("h_bbH_xsec_A", d_mass, d_tanb) / 1000.);
     } else {
       info.xs["ggH"]  = info.param_parser.GetParam<double>("XS_GluGluToHToTauTau_M-"+signal_mass);
       info.xs["qqH"]  = info.param_parser.GetParam<double>("XS_VBF_HToTauTau_M-"+signal_mass);
@@ -4,6 +4,7 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/FnPredicates.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/ShiftedView.h"
 #include <string>
 #include "boost/bind.hpp"
 
@@ -14,6 +15,10 @@ class EnergyShifter : public ModuleBase {
  private:
   CLASS_MEMBER(EnergyShifter, std::string, input_label)
   CLASS_MEMBER(EnergyShifter, double, shift)
+  // If set, the input collection is left untouched and a ShiftedView<T>
+  // is added to the event with this name instead, which later modules
+  // can read with GetPtrVec<T> as a collection of shifted copies
+  CLASS_MEMBER(EnergyShifter, std::string, output_label)
 
  public:
   EnergyShifter(std::string const& name);
@@ -29,6 +34,7 @@ template <class T>
 EnergyShifter<T>::EnergyShifter(std::string const& name) : ModuleBase(name) {
   input_label_ = "";
   shift_ = 1.0;
+  output_label_ = "";
 }
 
 template <class T>
@@ -42,12 +48,21 @@ int EnergyShifter<T>::PreAnalysis() {
   std::cout << "PreAnalysis Info for EnergyShifter" << std::endl;
   std::cout << "----------------------------------------" << std::endl;
   std::cout << "Input: [" << input_label_ << "] Shift: [" << shift_ << "]" << std::endl;
+  if (output_label_ != "") {
+    std::cout << "Output view: [" << output_label_ << "]" << std::endl;
+  }
   return 0;
 }
 
 template <class T>
 int EnergyShifter<T>::Execute(TreeEvent *event) {
   std::vector<T *> & vec = event->GetPtrVec<T>(input_label_);
+  if (output_label_ != "") {
+    ShiftedView<T> view(vec);
+    for (unsigned i = 0; i < vec.size(); ++i) view.SetScale(i, shift_);
+    event->Add(output_label_, view);
+    return 0;
+  }
   for (unsigned i = 0; i < vec.size(); ++i) {
     vec[i]->set_pt(vec[i]->pt()*shift_);
     vec[i]->set_energy(vec[i]->energy()*shift_);
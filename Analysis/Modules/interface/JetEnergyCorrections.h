@@ -6,7 +6,10 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
 #include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/JetCorrectorTable.h"
 #include <string>
+#include <vector>
+#include <cmath>
 #include "boost/bind.hpp"
 
 namespace ic {
@@ -20,11 +23,24 @@ class JetEnergyCorrections : public ModuleBase {
   CLASS_MEMBER(JetEnergyCorrections, std::string, l2_file)
   CLASS_MEMBER(JetEnergyCorrections, std::string, l3_file)
   CLASS_MEMBER(JetEnergyCorrections, std::string, res_file)
+  // Also run FactorizedJetCorrector and compare it with the table
+  CLASS_MEMBER(JetEnergyCorrections, bool, validate)
   JetCorrectorParameters *ResJetPar; 
   JetCorrectorParameters *L3JetPar;
   JetCorrectorParameters *L2JetPar;
   JetCorrectorParameters *L1JetPar;
   FactorizedJetCorrector *JetCorrector;
+  JetCorrectorTable table_;
+  bool use_table_;
+  // Uncorrected jets and the cumulative factors of each level, level-major
+  std::vector<double> pt_;
+  std::vector<double> eta_;
+  std::vector<double> energy_;
+  std::vector<double> area_;
+  std::vector<float> factors_;
+  unsigned n_validated_;
+  unsigned n_mismatched_;
+  double max_difference_;
 
  public:
   JetEnergyCorrections(std::string const& name);
@@ -40,6 +56,11 @@ template <class T>
 JetEnergyCorrections<T>::JetEnergyCorrections(std::string const& name) : ModuleBase(name) {
   is_data_ = true;
   input_label_ = "pfJetsPFlow";
+  validate_ = false;
+  use_table_ = false;
+  n_validated_ = 0;
+  n_mismatched_ = 0;
+  max_difference_ = 0.;
 }
 
 template <class T>
@@ -67,6 +88,15 @@ int JetEnergyCorrections<T>::PreAnalysis() {
   vPar.push_back(*L3JetPar);
   if (is_data_) vPar.push_back(*ResJetPar);
   JetCorrector = new FactorizedJetCorrector(vPar);
+  table_ = JetCorrectorTable();
+  use_table_ = table_.AddLevel(l1_file_) && table_.AddLevel(l2_file_) && table_.AddLevel(l3_file_)
+      && (!is_data_ || table_.AddLevel(res_file_));
+  if (use_table_) {
+    std::cout << "Evaluating corrections with JetCorrectorTable" << std::endl;
+  } else {
+    std::cout << "Unable to tabulate the corrections, using FactorizedJetCorrector" << std::endl;
+  }
+  if (use_table_ && validate_) std::cout << "Validating against FactorizedJetCorrector" << std::endl;
   return 0;
 }
 
@@ -74,42 +104,68 @@ template <class T>
 int JetEnergyCorrections<T>::Execute(TreeEvent *event) {
   EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
   std::vector<T *> & vec = event->GetPtrVec<T>(input_label_);
+  std::size_t n = vec.size();
+  if (n == 0) return 0;
+  unsigned n_levels = is_data_ ? 4 : 3;
 
-  for (unsigned i = 0; i < vec.size(); ++i) {
-    double uncorr_pt = vec[i]->GetJecFactor("Uncorrected") * vec[i]->pt();
-    double uncorr_energy = vec[i]->GetJecFactor("Uncorrected") * vec[i]->energy();
-    JetCorrector->setJetEta(vec[i]->eta());
-    JetCorrector->setJetPt(uncorr_pt);
-    JetCorrector->setJetA(vec[i]->jet_area());
-    JetCorrector->setRho(eventInfo->jet_rho());
-    // std::cout << "--Jet " << i << ": " << vec[i]->vector() << std::endl;
-    // std::cout << "-L1FastJet: " << vec[i]->GetJecFactor("L1FastJet") << std::endl;
-    // std::cout << "-L2Relative: " << vec[i]->GetJecFactor("L2Relative") << std::endl;
-    // std::cout << "-L3Absolute: " << vec[i]->GetJecFactor("L3Absolute") << std::endl;
-    // if (is_data_) std::cout << "-L2L3Residual: " << vec[i]->GetJecFactor("L2L3Residual") << std::endl;
-    //double full_corr = JetCorrector->getCorrection();
-    std::vector<float> factors = JetCorrector->getSubCorrections();
-    double full_corr = factors.back();
-    double new_pt = uncorr_pt * full_corr;
-    double new_energy = uncorr_energy * full_corr;
+  pt_.resize(n);
+  eta_.resize(n);
+  energy_.resize(n);
+  area_.resize(n);
+  factors_.resize(n_levels * n);
+  for (unsigned i = 0; i < n; ++i) {
+    double uncorr = vec[i]->GetJecFactor("Uncorrected");
+    pt_[i] = uncorr * vec[i]->pt();
+    energy_[i] = uncorr * vec[i]->energy();
+    eta_[i] = vec[i]->eta();
+    area_[i] = vec[i]->jet_area();
+  }
+  if (use_table_) {
+    table_.Evaluate(n, &pt_[0], &eta_[0], &energy_[0], &area_[0], eventInfo->jet_rho(), &factors_[0]);
+  }
+  if (!use_table_ || validate_) {
+    for (unsigned i = 0; i < n; ++i) {
+      JetCorrector->setJetEta(eta_[i]);
+      JetCorrector->setJetPt(pt_[i]);
+      JetCorrector->setJetA(area_[i]);
+      JetCorrector->setRho(eventInfo->jet_rho());
+      std::vector<float> factors = JetCorrector->getSubCorrections();
+      for (unsigned l = 0; l < n_levels; ++l) {
+        if (!use_table_) {
+          factors_[l * n + i] = factors[l];
+          continue;
+        }
+        double diff = std::fabs(factors_[l * n + i] / factors[l] - 1.);
+        if (!(diff <= max_difference_)) max_difference_ = diff;
+        if (!(diff <= 1E-5)) ++n_mismatched_;
+      }
+      if (use_table_) ++n_validated_;
+    }
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    double full_corr = factors_[(n_levels - 1) * n + i];
+    double new_pt = pt_[i] * full_corr;
+    double new_energy = energy_[i] * full_corr;
     vec[i]->set_pt(new_pt);
     vec[i]->set_energy(new_energy);
-    vec[i]->SetJecFactor("L1FastJet", factors[0] / full_corr);
-    vec[i]->SetJecFactor("L2Relative", factors[1] / full_corr);
-    vec[i]->SetJecFactor("L3Absolute", factors[2] / full_corr);
-    if (is_data_) vec[i]->SetJecFactor("L2L3Residual", factors[3] / full_corr);
-    // std::cout << "-Correction: " << full_corr << std::endl;
-    // std::cout << "--Corrected Jet " << i << ": " << vec[i]->vector() << std::endl;
-    // std::cout << "-L1FastJet: " << vec[i]->GetJecFactor("L1FastJet") << std::endl;
-    // std::cout << "-L2Relative: " << vec[i]->GetJecFactor("L2Relative") << std::endl;
-    // std::cout << "-L3Absolute: " << vec[i]->GetJecFactor("L3Absolute") << std::endl;
-    // if (is_data_) std::cout << "-L2L3Residual: " << vec[i]->GetJecFactor("L2L3Residual") << std::endl;
+    vec[i]->SetJecFactor("L1FastJet", factors_[i] / full_corr);
+    vec[i]->SetJecFactor("L2Relative", factors_[n + i] / full_corr);
+    vec[i]->SetJecFactor("L3Absolute", factors_[2 * n + i] / full_corr);
+    if (is_data_) vec[i]->SetJecFactor("L2L3Residual", factors_[3 * n + i] / full_corr);
   }
   return 0;
 }
 
 template <class T>
 int JetEnergyCorrections<T>::PostAnalysis() {
+  if (use_table_ && validate_) {
+    std::cout << "JetCorrectorTable vs FactorizedJetCorrector: " << n_mismatched_ << " factors differ by more than 1E-5 in "
+              << n_validated_ << " jets, largest relative difference " << max_difference_ << std::endl;
+  }
+  if (use_table_) {
+    std::cout << "JetCorrectorTable memo: " << table_.memo_hits() << " hits, " << table_.memo_misses() << " misses" << std::endl;
+  }
   return 0;
 }
 
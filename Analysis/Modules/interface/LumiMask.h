@@ -4,6 +4,10 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
 #include <string>
+#include <map>
+#include <vector>
+#include <utility>
+#include <stdint.h>
 
 namespace ic {
 
@@ -12,13 +16,28 @@ class LumiMask : public ModuleBase {
 
 
  private:
- 	typedef std::map< unsigned, std::set<unsigned> > Json;
- 	typedef std::map< unsigned, std::set<unsigned> >::const_iterator JsonIt;
+  // Certified lumi ranges [first, last] of each run, sorted and merged
+  typedef std::vector< std::pair<unsigned, unsigned> > Ranges;
+  // One bit per lumi section, bit ls of word ls/64
+  typedef std::vector<uint64_t> LumiBits;
+  typedef std::map<unsigned, LumiBits> Json;
+  typedef std::map<unsigned, LumiBits>::const_iterator JsonIt;
+
+  std::map<unsigned, Ranges> input_json;
+  Json accept_json;
+  Json all_json;
+
+  // The previous (run, lumi) and its decision, and the entries of the
+  // current run, so that consecutive events in the same lumi section cost
+  // only a comparison
+  unsigned last_run_;
+  unsigned last_ls_;
+  bool last_accept_;
+  bool have_last_;
+  Ranges const* run_ranges_;
+  LumiBits * run_all_;
+  LumiBits * run_accept_;
 
- 	Json input_json;
- 	Json accept_json;
- 	Json reject_json;
- 	Json all_json;
   CLASS_MEMBER(LumiMask, std::string, input_file)
   CLASS_MEMBER(LumiMask, std::string, produce_output_jsons)
 
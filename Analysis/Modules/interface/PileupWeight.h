@@ -3,6 +3,7 @@
 
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Core/interface/ModuleBase.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
 #include <string>
 #include "TH1F.h"
 
@@ -19,6 +20,7 @@ class PileupWeight : public ModuleBase {
   bool is_valid_;
   //std::vector<double> weights_;
   TH1* weights_;
+  BinnedTable weights_table_;
   MEMBER_NP(TH1*, data)
   MEMBER_NP(TH1*, mc)
   MEMBER_NP(bool, print_weights)
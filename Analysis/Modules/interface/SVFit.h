@@ -6,10 +6,14 @@
 #include "PhysicsTools/FWLite/interface/TFileService.h"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/HistoSet.h"
 #include "UserCode/ICHiggsTauTau/Analysis/HiggsTauTau/interface/HTTConfig.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitCache.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitMassStore.h"
 #include "boost/filesystem.hpp"
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <set>
 
 namespace ic {
 
@@ -17,7 +21,7 @@ class SVFit : public ModuleBase {
  private:
   unsigned mode_;
   boost::filesystem::path total_path_;
-  std::map<std::string, double> mass_map;
+  SVFitMassStore mass_store_;
  
   CLASS_MEMBER(SVFit, ic::channel, channel)
   CLASS_MEMBER(SVFit, int, op)
@@ -26,6 +30,25 @@ class SVFit : public ModuleBase {
   CLASS_MEMBER(SVFit, std::string, fullpath)
   CLASS_MEMBER(SVFit, std::string, met_label)
   CLASS_MEMBER(SVFit, std::string, dilepton_label)
+  // Persistent cache of results, used in op 3 if set
+  CLASS_MEMBER(SVFit, std::string, cache_file)
+  // Merge the cache file into a single sorted block at the end of the job
+  CLASS_MEMBER(SVFit, bool, compact_cache)
+  // Number of processes that run the fits queued in op 4
+  CLASS_MEMBER(SVFit, unsigned, workers)
+
+  SVFitCache * cache_;
+
+  // The inputs of a fit queued in op 4, copied as the branch contents
+  // will be overwritten by the next event
+  struct QueuedFit {
+    SVFitCache::Key key;
+    Candidate lep1;
+    Candidate lep2;
+    Met met;
+  };
+  std::vector<QueuedFit> queue_;
+  std::set<SVFitCache::Key> queued_keys_;
 
   unsigned file_counter;
   unsigned event_counter;
@@ -43,6 +66,10 @@ class SVFit : public ModuleBase {
   virtual int PostAnalysis();
   virtual void PrintInfo();
   void WriteRunScript();
+
+ private:
+  double Fit(Candidate const* lep1, Candidate const* lep2, Met const* met) const;
+  void RunQueue();
 };
 
 }
@@ -5,10 +5,34 @@
 #include "boost/property_tree/json_parser.hpp"
 #include "boost/lexical_cast.hpp"
 #include <fstream>
+#include <algorithm>
+#include <climits>
+
+namespace {
+  void SetBit(std::vector<uint64_t> & bits, unsigned i) {
+    if (i / 64 >= bits.size()) bits.resize(i / 64 + 1, 0);
+    bits[i / 64] |= uint64_t(1) << (i % 64);
+  }
+
+  // The first bit at or after i that is set (or clear if value is false),
+  // or the total number of bits if there is none
+  unsigned FindNext(std::vector<uint64_t> const& bits, unsigned i, bool value) {
+    unsigned n = bits.size() * 64;
+    while (i < n) {
+      uint64_t word = value ? bits[i / 64] : ~bits[i / 64];
+      word &= ~uint64_t(0) << (i % 64);
+      if (word) return (i / 64) * 64 + __builtin_ctzll(word);
+      i = (i / 64 + 1) * 64;
+    }
+    return n;
+  }
+}
 
 namespace ic {
 
-  LumiMask::LumiMask(std::string const& name) : ModuleBase(name) {
+  LumiMask::LumiMask(std::string const& name) : ModuleBase(name),
+    last_run_(0), last_ls_(0), last_accept_(false), have_last_(false),
+    run_ranges_(NULL), run_all_(NULL), run_accept_(NULL) {
     produce_output_jsons_ = "";
   }
 
@@ -44,10 +68,24 @@ namespace ic {
             std::cout << "Something has gone wrong parsing the json file!" << std::endl;
             throw;
           } else {
-            for (unsigned i = range_min; i <= range_max; ++i) input_json[run].insert(i);
+            input_json[run].push_back(std::make_pair(range_min, range_max));
           }
         }
       }
+      // Sort the ranges of each run and merge any that overlap or touch
+      for (std::map<unsigned, Ranges>::iterator r_it = input_json.begin(); r_it != input_json.end(); ++r_it) {
+        Ranges & ranges = r_it->second;
+        std::sort(ranges.begin(), ranges.end());
+        Ranges merged;
+        for (unsigned i = 0; i < ranges.size(); ++i) {
+          if (!merged.empty() && ranges[i].first <= merged.back().second + 1) {
+            merged.back().second = std::max(merged.back().second, ranges[i].second);
+          } else {
+            merged.push_back(ranges[i]);
+          }
+        }
+        ranges.swap(merged);
+      }
     } else {
       std::cout << "No json file specified!" << std::endl;
     }
@@ -61,23 +99,40 @@ namespace ic {
     EventInfo const *eventInfo = event->GetPtr<EventInfo>("eventInfo");
     unsigned run = eventInfo->run();
     unsigned ls = eventInfo->lumi_block();
-    all_json[run].insert(ls);
-    bool accept = false;
-    if (input_json.find(run) != input_json.end()) {
-      if (input_json[run].find(ls) != input_json[run].end()) accept = true;
+    // Events arrive in long sequences from the same lumi section, which has
+    // already been looked up and recorded
+    if (have_last_ && ls == last_ls_ && run == last_run_) return last_accept_ ? 0 : 1;
+    if (!have_last_ || run != last_run_) {
+      std::map<unsigned, Ranges>::const_iterator it = input_json.find(run);
+      run_ranges_ = (it != input_json.end()) ? &(it->second) : NULL;
+      run_all_ = &(all_json[run]);
+      run_accept_ = &(accept_json[run]);
     }
-    if (accept) {
-      accept_json[run].insert(ls);
-      return 0;
-    } else {
-      reject_json[run].insert(ls);
-      return 1;
+    bool accept = false;
+    if (run_ranges_) {
+      Ranges::const_iterator it = std::upper_bound(run_ranges_->begin(), run_ranges_->end(),
+                                                   std::make_pair(ls, unsigned(UINT_MAX)));
+      accept = (it != run_ranges_->begin() && (it - 1)->second >= ls);
     }
-
-    return 0;
+    SetBit(*run_all_, ls);
+    if (accept) SetBit(*run_accept_, ls);
+    last_run_ = run;
+    last_ls_ = ls;
+    last_accept_ = accept;
+    have_last_ = true;
+    return accept ? 0 : 1;
   }
+
   int LumiMask::PostAnalysis() {
     if (produce_output_jsons_ != "") {
+      // A lumi section is rejected if it was seen but not accepted
+      Json reject_json;
+      for (JsonIt r_it = all_json.begin(); r_it != all_json.end(); ++r_it) {
+        LumiBits & reject = reject_json[r_it->first];
+        reject = r_it->second;
+        LumiBits const& accept = accept_json[r_it->first];
+        for (unsigned i = 0; i < accept.size() && i < reject.size(); ++i) reject[i] &= ~accept[i];
+      }
       std::ofstream output;
       output.open((produce_output_jsons_+"_all.json").c_str());
       WriteJson(all_json, output);
@@ -93,41 +148,23 @@ namespace ic {
   }
 
   void LumiMask::WriteJson(Json const& json, std::ofstream & output) {
+    bool first_run = true;
     for (JsonIt r_it = json.begin(); r_it != json.end(); ++r_it) {
-      if (r_it == json.begin()) {
-        output << "{\"";
-      } else {
-        output << " \"";
-      }
-      output << r_it->first << "\": [";
-      std::set<unsigned>::const_iterator it = r_it->second.begin();
-      while (it != r_it->second.end()) {
-        unsigned first_val = *it;
-        unsigned last_val = *it;
-        while (true) {
-          ++it;
-          if (it == r_it->second.end()) break;
-          if (*it == (last_val+1)) {
-            last_val = *it;
-          } else {
-            break;
-          }
-        }
-        output << "[" << first_val << ", " << last_val << "]";
-        if (it != r_it->second.end()) {
-          output << ", ";
-        } else {
-          output << "]";
-        }
-      }
-      JsonIt r_test = r_it;
-      ++r_test;
-      if (r_test == json.end()) {
-        output << "}" << std::endl;
-      } else {
-        output << "," << std::endl;
+      LumiBits const& bits = r_it->second;
+      unsigned n = bits.size() * 64;
+      unsigned first_val = FindNext(bits, 0, true);
+      if (first_val == n) continue;
+      output << (first_run ? "{\"" : ",\n \"") << r_it->first << "\": [";
+      first_run = false;
+      // Each run of consecutive set bits becomes one [first, last] range
+      while (first_val < n) {
+        unsigned end_val = FindNext(bits, first_val, false);
+        output << "[" << first_val << ", " << (end_val - 1) << "]";
+        first_val = FindNext(bits, end_val, true);
+        output << (first_val < n ? ", " : "]");
       }
     }
+    if (!first_run) output << "}" << std::endl;
   }
 
 
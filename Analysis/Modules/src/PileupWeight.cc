@@ -49,6 +49,7 @@ namespace ic {
     mc_->Scale(1./mc_->Integral());
     weights_ = (TH1*)data_->Clone();
     weights_->Divide(mc_);
+    weights_table_ = BinnedTable(weights_);
     for (unsigned i = 0; i < nbins; ++i) {
       if (print_weights_) std::cout << "nInt = [" << weights_->GetBinLowEdge(i+1) << "," << weights_->GetBinLowEdge(i+2) << "[,\tData = " << data_->GetBinContent(i+1) << ",  MC = " << mc_->GetBinContent(i+1) << ",  Weight = " << weights_->GetBinContent(i+1) << std::endl;
     }
@@ -67,10 +68,10 @@ namespace ic {
       return 0;
     }
     //double weight = 0.0;
-    int found_bin = weights_->FindBin(true_int);
+    std::size_t found_bin = weights_table_.FindBin(true_int);
     double weight = 1.0;
-    if (found_bin >= 1 && found_bin <= weights_->GetNbinsX()) {
-      weight = weights_->GetBinContent(found_bin);
+    if (weights_table_.IsInRange(found_bin)) {
+      weight = weights_table_.GetValue(found_bin);
     }
     eventInfo->set_weight(label_, weight);
     return 0;
@@ -2,9 +2,13 @@
 #include "UserCode/ICHiggsTauTau/interface/CompositeCandidate.hh"
 #include "UserCode/ICHiggsTauTau/interface/Met.hh"
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/HistoSet.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitService.h"
 #include "boost/lexical_cast.hpp"
 #include <boost/algorithm/string.hpp>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
 
 #include "boost/filesystem.hpp"
 
@@ -18,7 +22,15 @@ namespace ic {
     op_ = 0;
     // 1: Produce scripts
     // 2: Read mass from .out files
+    // 3: Compute mass in-process
+    // 4: Queue the fits missing from the cache, run them on worker
+    //    processes at the end of the job and add them to the cache,
+    //    for a later job in op 3
     file_counter = 0;
+    cache_ = NULL;
+    cache_file_ = "";
+    compact_cache_ = false;
+    workers_ = 1;
     event_counter = 0;
     split_ = 5000;
     outname_ = "svfit_test";
@@ -26,7 +38,7 @@ namespace ic {
   }
 
   SVFit::~SVFit() {
-    ;
+    if (cache_) delete cache_;
   }
 
   int SVFit::PreAnalysis() {
@@ -40,6 +52,18 @@ namespace ic {
     std::cout << "SVFit Mode: " << op_ << std::endl;
     std::cout << "Dilepton Label: " << dilepton_label_ << std::endl;
     std::cout << "MET Label: " << met_label_ << std::endl;
+    if (op_ == 4 && cache_file_ == "") {
+      std::cerr << "Error in <ic::SVFit>: op 4 needs a cache file, an exception will be thrown" << std::endl;
+      throw;
+    }
+    if (op_ == 3 || op_ == 4) {
+      if (cache_file_ != "") {
+        std::cout << "Cache File: " << cache_file_ << std::endl;
+        cache_ = new SVFitCache(cache_file_);
+      }
+      if (op_ == 4) std::cout << "Workers: " << workers_ << std::endl;
+      return 0;
+    }
 
     std::string sub(".root");
     std::string::size_type foundpos = outname_.find(sub);
@@ -65,26 +89,32 @@ namespace ic {
     if (op_ == 1) outFileSubmit.open((total_path_.string()+"/submit.sh").c_str());
 
     if (op_ == 2) {
+      // The .out files are converted once into a sorted binary file, which
+      // is rebuilt only when any of them is newer
+      std::vector<std::string> out_files;
+      std::time_t newest = 0;
       boost::filesystem::directory_iterator it(total_path_);
       for (; it != boost::filesystem::directory_iterator(); ++it) {
         std::string path = it->path().string();
         if (path.find(".out") != path.npos) {
-          std::cout << "Reading file: " << path << std::endl;
-          std::ifstream file;
-          file.open(path.c_str());
-          if (!file.is_open()) {
-            std::cerr << "Error, file cannot be read!" << std::endl;
-            exit(1);
-          }
-          std::string line = "";
-        while(std::getline(file, line)) {//while loop through lines
-          std::vector<std::string> vec_format;
-          boost::split(vec_format, line, boost::is_any_of(":"));
-          mass_map[vec_format[0]] = boost::lexical_cast<double>(vec_format[1]);
+          out_files.push_back(path);
+          newest = std::max(newest, boost::filesystem::last_write_time(it->path()));
+        }
+      }
+      boost::filesystem::path bin_path = total_path_ / "svfit_masses.bin";
+      if (!boost::filesystem::exists(bin_path) || boost::filesystem::last_write_time(bin_path) < newest) {
+        std::cout << "Converting " << out_files.size() << " .out files to: " << bin_path.string() << std::endl;
+        if (!SVFitMassStore::Build(out_files, bin_path.string())) {
+          std::cerr << "Error, file cannot be read!" << std::endl;
+          exit(1);
         }
       }
+      if (!mass_store_.Open(bin_path.string())) {
+        std::cerr << "Error, SVFit mass file " << bin_path.string() << " cannot be read!" << std::endl;
+        exit(1);
+      }
+      std::cout << "Read " << mass_store_.size() << " SVFit masses from: " << bin_path.string() << std::endl;
     }
-  }
 
   return 0;
 }
@@ -147,18 +177,41 @@ int SVFit::Execute(TreeEvent *event) {
       return 0;
     }
 
+    if (op_ == 3) {
+      SVFitCache::Key key = SVFitCache::MakeKey(mode_, lepton, tau, pfMetMVA);
+      double mass = 0.;
+      if (!cache_ || !cache_->Find(key, mass)) {
+        mass = Fit(lepton, tau, pfMetMVA);
+        if (cache_) cache_->Insert(key, mass);
+      }
+      event->Add("svfitMass", mass);
+      return 0;
+    }
+
+    if (op_ == 4) {
+      // Nothing downstream gets a mass, so the event stops here
+      SVFitCache::Key key = SVFitCache::MakeKey(mode_, lepton, tau, pfMetMVA);
+      double mass = 0.;
+      if (!cache_->Find(key, mass) && queued_keys_.insert(key).second) {
+        QueuedFit fit;
+        fit.key = key;
+        fit.lep1 = *lepton;
+        fit.lep2 = *tau;
+        fit.met = *pfMetMVA;
+        queue_.push_back(fit);
+      }
+      return 1;
+    }
+
     if (op_ == 2) {
       EventInfo const* eventInfo = event->GetPtr<EventInfo>("eventInfo");
       int run = eventInfo->run();
       int evt = eventInfo->event();
-      std::string label = boost::lexical_cast<std::string>(run)+"."+boost::lexical_cast<std::string>(evt);
-      std::map<std::string, double>::const_iterator it = mass_map.find(label);
       double mass = 0;
-      if (it != mass_map.end()) {
-        mass = it->second;
+      if (mass_store_.Find(run, evt, mass)) {
         event->Add("svfitMass", mass);
       } else {
-        std::cout << "Warning, SVFit mass for " << label << " not found!" << std::endl;
+        std::cout << "Warning, SVFit mass for " << run << "." << evt << " not found!" << std::endl;
         event->Add("svfitMass", double(-100.0));
       }
     }
@@ -166,6 +219,14 @@ int SVFit::Execute(TreeEvent *event) {
     return 0;
   }
   int SVFit::PostAnalysis() {
+    if (op_ == 4 && queue_.size() > 0) RunQueue();
+    if (cache_) {
+      std::cout << "SVFit cache hits: " << cache_->hits() << ", misses: " << cache_->misses() << std::endl;
+      cache_->Flush();
+      if (compact_cache_ && !SVFitCache::Compact(cache_file_)) {
+        std::cerr << "Warning in <ic::SVFit>: Unable to compact " << cache_file_ << std::endl;
+      }
+    }
 
     if (outFile.is_open()) {
       outFile.close();
@@ -181,6 +242,55 @@ int SVFit::Execute(TreeEvent *event) {
     ;
   }
 
+  double SVFit::Fit(Candidate const* lep1, Candidate const* lep2, Met const* met) const {
+    return (mode_ == 2) ? SVFitService::SVFitMassLepLep(lep1, lep2, met)
+                        : SVFitService::SVFitMassLepHad(lep1, lep2, met);
+  }
+
+  void SVFit::RunQueue() {
+    // NSVfit can only run one fit at a time in a process (see SVFitService),
+    // so the queue is shared out between forked workers. Each one has its
+    // own copy of the queue and appends its results to the cache file,
+    // which SVFitCache::Flush locks while it writes.
+    unsigned n_workers = std::max(1u, std::min<unsigned>(workers_, queue_.size()));
+    std::cout << "Running " << queue_.size() << " SVFit fits on " << n_workers << " worker processes" << std::endl;
+    std::vector<pid_t> pids;
+    for (unsigned w = 0; w < n_workers; ++w) {
+      std::cout.flush();
+      std::cerr.flush();
+      pid_t pid = fork();
+      if (pid == 0) {
+        SVFitCache cache(cache_file_);
+        for (unsigned i = w; i < queue_.size(); i += n_workers) {
+          cache.Insert(queue_[i].key, Fit(&queue_[i].lep1, &queue_[i].lep2, &queue_[i].met));
+          // Keep what is done if the job is killed
+          if ((i / n_workers) % 100 == 99) cache.Flush();
+        }
+        cache.Flush();
+        _exit(0);
+      }
+      if (pid < 0) {
+        std::cerr << "Warning in <ic::SVFit>: Unable to start worker " << w << ", its fits are run in this process" << std::endl;
+        for (unsigned i = w; i < queue_.size(); i += n_workers) {
+          cache_->Insert(queue_[i].key, Fit(&queue_[i].lep1, &queue_[i].lep2, &queue_[i].met));
+        }
+        continue;
+      }
+      pids.push_back(pid);
+    }
+    unsigned failed = 0;
+    for (unsigned i = 0; i < pids.size(); ++i) {
+      int status = 0;
+      if (waitpid(pids[i], &status, 0) != pids[i] || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ++failed;
+    }
+    if (failed > 0) {
+      std::cerr << "Warning in <ic::SVFit>: " << failed << " of " << n_workers
+                << " workers failed, some fits are missing from " << cache_file_ << std::endl;
+    }
+    queue_.clear();
+    queued_keys_.clear();
+  }
+
   void SVFit::WriteRunScript() {
     std::ofstream runscript;
     std::string name = (total_path_.string()+"/svfit_"+boost::lexical_cast<std::string>(file_counter-1));
@@ -3,12 +3,13 @@
 
 #include <vector>
 #include <string>
+#include <map>
 #include <math.h>
 #include <iostream>
 #include "TF1.h"
 #include "TH1.h"
 #include "UserCode/ICHiggsTauTau/interface/PFJet.hh"
-#include "TRandom3.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
 
 namespace ic {
 
@@ -25,6 +26,25 @@ enum class tagger { SSVHEM, SSVHPT, CSVM };
     float sf;
   };
 
+  //! Probability of exactly 0, 1, 2, ... tagged jets in data and in MC
+  struct TagDistribution {
+    std::vector<double> data;
+    std::vector<double> mc;
+    //! Summed (data, MC) probabilities for between minTags and maxTags tags
+    /*! As in weight(), an event with no jets gives (1, 1) for any window. */
+    std::pair<double,double> window(int minTags, int maxTags) const;
+    //! The data/MC event weight for between minTags and maxTags tags
+    double weight(int minTags, int maxTags) const;
+  };
+
+  //! Fills dist[k] with the probability that exactly k of the jets are tagged
+  /*! Each jet is tagged with probability probs[i].  The distribution is
+      built up one jet at a time, so this is O(n*k) rather than the O(n*2^n)
+      of summing over every tag/no-tag combination.  Only the first
+      max_tags+1 entries are computed.
+  */
+  static void TagCounts(std::vector<double> const& probs, unsigned max_tags, std::vector<double> & dist);
+
   BTagWeight();
   ~BTagWeight();
 
@@ -47,22 +67,45 @@ enum class tagger { SSVHEM, SSVHPT, CSVM };
 
   std::pair<float,float> weight(std::vector<JetInfo> jets, int minTags, int maxTags) const;
 
+  //! The full tag multiplicity distribution, for any number of windows
+  TagDistribution TagMultiplicity(std::vector<JetInfo> const& jets) const;
+
+  //! Tag multiplicity distributions for several scale factor variations
+  /*! \param modes (Btag_mode, Bfake_mode) pairs as passed to SF().  The MC
+      efficiencies and the MC distribution are computed once and shared by
+      all of the returned distributions.
+  */
+  std::vector<TagDistribution> GetTagDistributions(std::vector<PFJet *> const& jets,
+                                                   BTagWeight::payload const& set,
+                                                   BTagWeight::tagger const& algo,
+                                                   std::vector<std::pair<int,int>> const& modes) const;
+
+  //! As GetLouvainWeight, but the whole distribution, for several windows
+  //! from one pass over the jets
+  TagDistribution GetLouvainTagDistribution(std::vector<PFJet *> const& jets, BTagWeight::tagger const& algo) const;
+
   double GetWeight( std::vector<PFJet *> const& jets, 
                     BTagWeight::payload const& set, 
                     BTagWeight::tagger const& algo, 
                     unsigned min, 
                     unsigned max) const;
   
+  //! Promote or demote the tag of each jet to match the data efficiency
+  /*! The random numbers come from the stream of \a info and the jet id,
+      so \a info is required: without it every event would reuse the
+      same numbers.
+  */
   std::map<std::size_t, bool> ReTag(std::vector<PFJet *> const& jets, 
                                     BTagWeight::payload const& set, 
                                     BTagWeight::tagger const& algo,
                                     int Btag_mode,
-                                    int Bfake_mode) const;
+                                    int Bfake_mode,
+                                    EventInfo const* info) const;
 
 private:
 
   TF1 *louvain_eff_;
-  TRandom3  *rand;
+  CounterRandom  *rand;
   TH1F *SFb_error_2012_;
   TH1F *SFb_error_2011_;
   
@@ -0,0 +1,130 @@
+#ifndef ICHiggsTauTau_Utilities_BinnedTable_h
+#define ICHiggsTauTau_Utilities_BinnedTable_h
+
+#include <vector>
+#include <cstddef>
+
+class TAxis;
+class TH1;
+namespace mithep { class TH2DAsymErr; }
+
+namespace ic {
+
+//! The bin edges of one BinnedTable dimension
+/*!
+  FindBin follows TAxis::FindFixBin exactly: 0 for underflow, nbins()+1
+  for overflow.  Uniform axes compute the bin directly; variable axes
+  use a branchless binary search over the edges.
+*/
+class BinnedAxis {
+ public:
+  BinnedAxis();
+  BinnedAxis(unsigned nbins, double min, double max);
+  explicit BinnedAxis(std::vector<double> const& edges);
+  explicit BinnedAxis(TAxis const* axis);
+
+  inline int FindBin(double x) const {
+    if (x < min_) return 0;
+    if (!(x < max_)) return nbins_ + 1;
+    if (uniform_) return 1 + int(nbins_ * (x - min_) / (max_ - min_));
+    double const* base = &edges_[0];
+    unsigned n = nbins_ + 1;
+    while (n > 1) {
+      unsigned half = n / 2;
+      base = (base[half] <= x) ? base + half : base;
+      n -= half;
+    }
+    return 1 + int(base - &edges_[0]);
+  }
+
+  //! FindBin with underflow and overflow moved to the first and last bins
+  inline int FindBinClamped(double x) const {
+    int bin = FindBin(x);
+    return bin < 1 ? 1 : (bin > nbins_ ? nbins_ : bin);
+  }
+
+  inline int nbins() const { return nbins_; }
+  inline bool uniform() const { return uniform_; }
+  inline double min() const { return min_; }
+  inline double max() const { return max_; }
+  inline std::vector<double> const& edges() const { return edges_; }
+
+ private:
+  std::vector<double> edges_;
+  int nbins_;
+  bool uniform_;
+  double min_;
+  double max_;
+};
+
+//! An immutable N-dimensional lookup table of values with up and down errors
+/*!
+  The entries are held in one flat array with the same global bin
+  numbering as TH1::GetBin, including the underflow and overflow bins.
+  The table is filled once, typically from a histogram read out of a ROOT
+  file at PreAnalysis, and after that lookups touch only the axis edges
+  and the entry array.
+*/
+class BinnedTable {
+ public:
+  struct Entry {
+    double value;
+    double err_up;
+    double err_down;
+  };
+
+  BinnedTable();
+  //! Bin contents and (symmetric) bin errors of a TH1, TH2 or TH3
+  explicit BinnedTable(TH1 const* hist);
+  //! Bin contents and the low and high statistical errors
+  explicit BinnedTable(mithep::TH2DAsymErr * hist);
+  //! \a entries must follow TH1::GetBin order, including under/overflow
+  BinnedTable(std::vector<BinnedAxis> const& axes, std::vector<Entry> const& entries);
+
+  inline std::size_t FindBin(double x) const {
+    return axes_[0].FindBin(x);
+  }
+  inline std::size_t FindBin(double x, double y) const {
+    return axes_[0].FindBin(x) + strides_[1] * axes_[1].FindBin(y);
+  }
+  inline std::size_t FindBin(double x, double y, double z) const {
+    return axes_[0].FindBin(x) + strides_[1] * axes_[1].FindBin(y) + strides_[2] * axes_[2].FindBin(z);
+  }
+  //! \a x holds one coordinate per dimension
+  std::size_t FindBin(double const* x) const;
+
+  inline std::size_t FindBinClamped(double x) const {
+    return axes_[0].FindBinClamped(x);
+  }
+  inline std::size_t FindBinClamped(double x, double y) const {
+    return axes_[0].FindBinClamped(x) + strides_[1] * axes_[1].FindBinClamped(y);
+  }
+  inline std::size_t FindBinClamped(double x, double y, double z) const {
+    return axes_[0].FindBinClamped(x) + strides_[1] * axes_[1].FindBinClamped(y) + strides_[2] * axes_[2].FindBinClamped(z);
+  }
+
+  //! True unless \a bin is an underflow or overflow bin in any dimension
+  bool IsInRange(std::size_t bin) const;
+
+  inline Entry const& GetEntry(std::size_t bin) const { return entries_[bin]; }
+  inline double GetValue(std::size_t bin) const { return entries_[bin].value; }
+
+  inline double Value(double x) const { return entries_[FindBin(x)].value; }
+  inline double Value(double x, double y) const { return entries_[FindBin(x, y)].value; }
+  inline double Value(double x, double y, double z) const { return entries_[FindBin(x, y, z)].value; }
+
+  inline unsigned ndim() const { return axes_.size(); }
+  inline BinnedAxis const& axis(unsigned i) const { return axes_[i]; }
+  inline std::size_t size() const { return size_; }
+
+ private:
+  void SetAxes(std::vector<BinnedAxis> const& axes);
+
+  std::vector<BinnedAxis> axes_;
+  std::vector<std::size_t> strides_;
+  std::size_t size_;
+  std::vector<Entry> entries_;
+};
+}
+
+#endif
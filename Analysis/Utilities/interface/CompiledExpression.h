@@ -0,0 +1,91 @@
+#ifndef ICHiggsTauTau_Utilities_CompiledExpression_h
+#define ICHiggsTauTau_Utilities_CompiledExpression_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace ic {
+
+//! An arithmetic/logical expression compiled to a small stack bytecode
+/*!
+  Compile accepts the subset of the TTreeFormula syntax used for selections,
+  categories and weights in flat ntuples: numbers, variable names, the
+  operators ! ^ * / + - << >> < <= > >= == != & && ||, parentheses and the functions
+  abs/fabs, sqrt, exp, log, log10, pow, min, max, sin, cos, along with their
+  TMath:: equivalents (Abs, Sqrt, Exp, Log, Log10, Power, Min, Max, Sin, Cos).
+  As in TFormula, ^ is the power operator and the parameters [0], [1], ...
+  are variables named "[0]", "[1]", ...
+  Everything is evaluated in double precision with TTreeFormula conventions:
+  comparisons and logical operators give 1 or 0, division by zero gives
+  0, and the bitwise operators act on the operands converted to 64-bit
+  unsigned integers.
+
+  Expressions are evaluated over whole batches of entries.  Each
+  instruction runs as a simple loop over the batch, so the compiler can
+  vectorise it and the interpretation cost is paid once per batch, not
+  once per entry.
+
+  Any name that is not a known function is a variable.  variables()
+  gives the order in which the caller must supply the input columns.
+*/
+class CompiledExpression {
+ public:
+  CompiledExpression();
+  explicit CompiledExpression(std::string const& expr);
+
+  //! Returns false, and sets error(), if \a expr uses unsupported syntax
+  bool Compile(std::string const& expr);
+
+  inline bool is_valid() const { return valid_; }
+  inline std::string const& error() const { return error_; }
+  inline std::string const& expression() const { return expr_; }
+  inline std::vector<std::string> const& variables() const { return variables_; }
+
+  //! Evaluate \a n entries
+  /*! \param columns One pointer per entry of variables(), each to \a n values
+      \param out     Receives the \a n results
+  */
+  void Evaluate(std::vector<double const*> const& columns, std::size_t n, double * out) const;
+
+ private:
+  enum class op {
+    constant, variable,
+    neg, lnot, abs, sqrt, exp, log, log10, sin, cos,
+    add, sub, mul, div, lt, le, gt, ge, eq, ne, land, lor, pow, min, max,
+    shl, shr, band
+  };
+  struct Instruction {
+    op code;
+    unsigned arg;
+  };
+
+  std::string expr_;
+  std::string error_;
+  bool valid_;
+  std::vector<Instruction> code_;
+  std::vector<double> constants_;
+  std::vector<std::string> variables_;
+  unsigned max_depth_;
+
+  // Recursive descent parser state
+  std::size_t pos_;
+  void SkipSpace();
+  bool Accept(std::string const& token);
+  bool ParseOr();
+  bool ParseAnd();
+  bool ParseBitAnd();
+  bool ParseEquality();
+  bool ParseRelational();
+  bool ParseShift();
+  bool ParseAdditive();
+  bool ParseMultiplicative();
+  bool ParseUnary();
+  bool ParsePower();
+  bool ParsePrimary();
+  bool Fail(std::string const& msg);
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef ICHiggsTauTau_Utilities_CounterRandom_h
+#define ICHiggsTauTau_Utilities_CounterRandom_h
+
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+#include "TRandom.h"
+
+namespace ic {
+
+class EventInfo;
+
+//! Counter-based random numbers that don't depend on the processing order
+/*!
+  Numbers are generated with the Philox4x32-10 block cipher.  Each
+  stream is fixed by the global seed plus (run, lumi, event, object,
+  purpose), with no state carried between streams.  A module that calls
+  SetStream before its draws for each event and object therefore gets the
+  same numbers whatever the event order, thread count or file splitting.
+  The object is any stable identifier, e.g. Candidate::id(), and the
+  purpose is a short name that keeps different uses independent, e.g.
+  "jer" or "retag".
+
+  Since this is a TRandom, Uniform, Gaus and the other TRandom methods
+  all work from the current stream.
+*/
+class CounterRandom : public TRandom {
+ public:
+  explicit CounterRandom(uint64_t seed = 0x1C0FFEE);
+
+  void SetStream(unsigned run, unsigned lumi, unsigned long long event,
+                 std::size_t object, std::string const& purpose);
+  void SetStream(EventInfo const* info, std::size_t object,
+                 std::string const& purpose);
+
+  //! Changes the global seed and restarts the current stream
+  virtual void SetSeed(UInt_t seed = 0);
+
+  //! Uniform in (0,1)
+  virtual Double_t Rndm(Int_t i = 0);
+  virtual void RndmArray(Int_t n, Float_t *array);
+  virtual void RndmArray(Int_t n, Double_t *array);
+
+  //! Philox4x32-10: encrypts \a ctr in place with \a key
+  static void Philox(uint32_t ctr[4], uint32_t const key[2]);
+
+ private:
+  void Restart();
+
+  uint64_t seed_;
+  unsigned run_;
+  unsigned lumi_;
+  unsigned long long event_;
+  uint64_t object_;
+  uint32_t purpose_;
+  uint32_t key_[2];
+  uint32_t ctr_[4];
+  uint32_t block_[4];
+  unsigned used_;
+};
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef ICHiggsTauTau_Utilities_EventList_h
+#define ICHiggsTauTau_Utilities_EventList_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/MappedFile.h"
+
+namespace ic {
+
+//! A read-only set of (run, lumi, event) keys, e.g. a list of bad events
+/*!
+  Only the fields selected when the list is built take part in the
+  matching: a list of runs ignores the lumi and event numbers, a list of
+  (run, event) pairs ignores the lumi.  The keys are kept sorted and are
+  fronted by a blocked Bloom filter.  A key that is not listed, which is
+  nearly always the case, is rejected after reading one 64-byte block,
+  and only the few that pass go on to a binary search.
+
+  The binary file is memory-mapped, so opening it is immediate and the
+  pages are shared between jobs.  It is laid out as
+    char[8]   "ICEVLST1"
+    uint32_t  fields
+    uint32_t  number of Bloom filter blocks
+    uint64_t  number of records
+    char[40]  padding, so that each filter block is one cache line
+    uint64_t  Bloom filter, 8 words per block
+    Record[]  records sorted by (run, lumi, event), native byte order
+*/
+class EventList {
+ public:
+  enum Field { kRun = 1, kLumi = 2, kEvent = 4, kAll = 7 };
+
+  struct Record {
+    uint32_t run;
+    uint32_t lumi;
+    uint64_t event;
+  };
+
+  static std::size_t const npos = std::size_t(-1);
+
+  EventList();
+
+  //! Convert the text files \a inputs into the binary file \a output
+  /*! The text files hold whitespace-separated keys with the selected
+      fields joined by ':', e.g. "run:lumi:event" for kAll or just "run"
+      for kRun.  Keys shorter than \a min_length characters are skipped.
+      A malformed key gives false, but a negative number, or one too large
+      for its field, is an error that throws.
+  */
+  static bool Build(std::vector<std::string> const& inputs, std::string const& output,
+                    unsigned fields = kAll, unsigned min_length = 0);
+
+  //! Map the binary file at \a path. Returns false if it is missing or invalid
+  bool Open(std::string const& path);
+
+  //! Read the text files \a inputs, as for Build, into memory instead of a file
+  bool Read(std::vector<std::string> const& inputs, unsigned fields = kAll, unsigned min_length = 0);
+
+  //! Use \a records held in memory instead of a file
+  void Assign(std::vector<Record> const& records, unsigned fields);
+
+  //! The position of the key in the sorted list, or npos if it is not listed
+  std::size_t Find(uint32_t run, uint32_t lumi, uint64_t event) const;
+  inline bool Contains(uint32_t run, uint32_t lumi, uint64_t event) const {
+    return Find(run, lumi, event) != npos;
+  }
+
+  inline std::size_t size() const { return n_; }
+  inline unsigned fields() const { return fields_; }
+
+ private:
+  EventList(EventList const&);
+  EventList & operator=(EventList const&);
+
+  static bool Parse(std::vector<std::string> const& inputs, unsigned fields, unsigned min_length,
+                    std::vector<Record> & records);
+  static void Normalise(Record & rec, unsigned fields);
+  static uint64_t Hash(Record const& rec);
+  static void Sort(std::vector<Record> & records);
+  static void FillBloom(std::vector<Record> const& records, std::vector<uint64_t> & bloom);
+
+  MappedFile file_;
+  std::vector<Record> own_records_;
+  std::vector<uint64_t> own_bloom_;
+  Record const* records_;
+  uint64_t const* bloom_;
+  std::size_t n_;
+  uint32_t n_blocks_;
+  unsigned fields_;
+};
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef ICHiggsTauTau_Utilities_JetCorrectorTable_h
+#define ICHiggsTauTau_Utilities_JetCorrectorTable_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CompiledExpression.h"
+
+namespace ic {
+
+//! A chain of jet energy correction levels evaluated for whole collections
+/*!
+  Each level is read from a JetCorrectorParameters text file and applied
+  as FactorizedJetCorrector does: the parameter variables are clamped to
+  the limits of the bin the jet falls in, the bin formula is evaluated,
+  a jet outside every bin is left uncorrected, and the jet pt and energy
+  are scaled by each level before the next one is evaluated.  The inputs
+  are taken as floats, as FactorizedJetCorrector does.
+
+  The formulas are compiled with CompiledExpression, with the bin
+  parameters supplied as columns gathered per jet, so each level is a few
+  loops over the collection.  The bin and parameter variables may be
+  JetEta, JetPt, JetE, JetA and Rho, and only "Correction" levels are
+  supported; AddLevel returns false for anything else.
+
+  Results are memoised on the exact (pt, eta, energy, area, rho) of the
+  uncorrected jet, so re-correcting the same jets, e.g. when a module is
+  run again for each systematic variation, is a hash lookup.  The memo is
+  a direct-mapped cache of memo_size() slots, rounded up to a power of
+  two, in which a new jet replaces whichever one shares its slot.
+*/
+class JetCorrectorTable {
+ public:
+  JetCorrectorTable();
+
+  //! Append the level in the text file \a file.  Levels are applied in
+  //! the order they are added
+  bool AddLevel(std::string const& file);
+
+  //! Correct \a n jets
+  /*! \param pt, eta, energy, area The uncorrected jets
+      \param rho     The event rho
+      \param factors Receives n_levels() * n values: factors[l * n + i] is
+                     the product of the corrections of levels 0 to l for
+                     jet i, as given by FactorizedJetCorrector::getSubCorrections
+  */
+  void Evaluate(std::size_t n, double const* pt, double const* eta, double const* energy,
+                double const* area, double rho, float * factors);
+
+  inline unsigned n_levels() const { return levels_.size(); }
+  inline std::string const& level_name(unsigned i) const { return levels_[i].name; }
+
+  inline std::size_t memo_size() const { return memo_size_; }
+  //! Zero disables the memo
+  void set_memo_size(std::size_t memo_size);
+  inline std::size_t memo_hits() const { return memo_hits_; }
+  inline std::size_t memo_misses() const { return memo_misses_; }
+
+ private:
+  enum Var { kJetEta, kJetPt, kJetE, kJetA, kRho, kNVars };
+
+  struct Level {
+    std::string name;
+    std::vector<unsigned> bin_vars;
+    std::vector<unsigned> par_vars;
+    CompiledExpression formula;
+    // For each formula variable, the parameter variable slot (0-3 for
+    // x, y, z, t) or 4 + the index of the bin parameter
+    std::vector<unsigned> columns;
+    // Bin limits, n_bins * bin_vars.size() each, and the parameter
+    // variable limits followed by the formula parameters of each bin
+    std::vector<float> bin_min;
+    std::vector<float> bin_max;
+    std::vector<float> params;
+    std::vector<unsigned> offsets;
+    std::vector<unsigned> n_params;
+    bool sorted;
+  };
+
+  struct Key {
+    float v[kNVars];
+    bool operator==(Key const& r) const;
+  };
+
+  struct Slot {
+    Key key;
+    bool used;
+  };
+
+  static std::size_t Hash(Key const& key);
+
+  int FindBin(Level const& level, float const* vars) const;
+  void Correct(std::vector<float> * vars, std::size_t n, float * factors);
+
+  std::vector<Level> levels_;
+
+  std::size_t memo_size_;
+  std::size_t memo_hits_;
+  std::size_t memo_misses_;
+  std::vector<Slot> memo_;
+  std::vector<float> memo_factors_;
+
+  // Scratch space, kept between calls
+  std::vector<float> vars_[kNVars];
+  std::vector<std::size_t> todo_;
+  std::vector<Key> todo_keys_;
+  std::vector<float> todo_factors_;
+  std::vector<unsigned> in_bin_;
+  std::vector<int> bins_;
+  std::vector<std::vector<double> > cols_;
+  std::vector<double> result_;
+};
+
+}
+
+#endif
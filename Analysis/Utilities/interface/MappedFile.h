@@ -0,0 +1,48 @@
+#ifndef ICHiggsTauTau_Utilities_MappedFile_h
+#define ICHiggsTauTau_Utilities_MappedFile_h
+
+#include <string>
+#include <cstddef>
+
+namespace ic {
+
+//! A read-only memory mapping of a whole file
+/*!
+  The mapping is shared between all processes that open the same file, so
+  large lookup tables cost neither startup time nor private memory.  If the
+  file does not exist or is empty, data() returns NULL and size() is zero.
+*/
+class MappedFile {
+ public:
+  MappedFile();
+  explicit MappedFile(std::string const& path);
+  ~MappedFile();
+
+  //! Map \a path, replacing any existing mapping. Returns false on failure
+  bool Open(std::string const& path);
+  void Close();
+
+  inline char const* data() const { return data_; }
+  inline std::size_t size() const { return size_; }
+  inline bool is_open() const { return data_ != NULL; }
+
+ private:
+  MappedFile(MappedFile const&);
+  MappedFile & operator=(MappedFile const&);
+
+  char const* data_;
+  std::size_t size_;
+};
+
+//! Create an empty file with a unique name in the directory of \a path
+/*!
+  The files that are later mapped are written to such a file and then
+  renamed over \a path, so that concurrent jobs never see a partially
+  written file.  Returns the name of the new file, or an empty string on
+  failure.
+*/
+std::string CreateTempFile(std::string const& path);
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include <vector>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include "TFile.h"
 #include "TTree.h"
 #include "TCanvas.h"
@@ -12,7 +13,7 @@
 #include "TProfile.h"
 #include "TF1.h"
 #include "TMath.h"
-#include "TRandom1.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
 
 //
 // ** apply phil's recoil corrections **
@@ -29,12 +30,45 @@
 
 //using namespace std;
 
+//
+// A TF1 sampled on a uniform grid over its range [xmin, xmax] and evaluated
+// with four-point cubic interpolation.  The grid is refined until the
+// interpolation agrees with TF1::Eval to within iTolerance (relative to
+// max(|f|,1)) at points between the nodes.  If that can't be done with
+// iMaxPoints nodes, or for x outside the range, Eval falls back to the TF1.
+//
+class TabulatedTF1
+{
+public:
+  TabulatedTF1(TF1 *iFunc, double iTolerance, unsigned iMaxPoints=4097);
+  inline double Eval(double iX) const {
+    if(!(iX >= fXMin && iX <= fXMax)) return fFunc->Eval(iX);
+    double lT = (iX-fXMin)*fInvStep;
+    int lI = int(lT)-1;
+    if(lI < 0) lI = 0;
+    if(lI > int(fY.size())-4) lI = int(fY.size())-4;
+    lT -= lI;
+    double const* lY = &fY[lI];
+    return (-(lT-1.)*(lT-2.)*(lT-3.)*lY[0] + 3.*lT*(lT-2.)*(lT-3.)*lY[1]
+	    -3.*lT*(lT-1.)*(lT-3.)*lY[2] + lT*(lT-1.)*(lT-2.)*lY[3])/6.;
+  }
+  bool   isTabulated() const { return fXMax > fXMin; }
+  unsigned nPoints()   const { return fY.size(); }
+  double maxError()    const { return fMaxError; }
+protected:
+  TF1 *fFunc;
+  double fXMin; double fXMax; double fInvStep;
+  double fMaxError;
+  std::vector<double> fY;
+};
+
 class RecoilCorrector
 {
   
 public:
-  RecoilCorrector(std::string iNameZDat, int iSeed=0xDEADBEEF);
-  RecoilCorrector(std::string iNameZDat1, std::string iPrefix, int iSeed=0xDEADBEEF);
+  // iTolerance is the allowed error on the tabulated fits (see TabulatedTF1), 0 to always use TF1::Eval
+  RecoilCorrector(std::string iNameZDat, int iSeed=0xDEADBEEF, double iTolerance=1E-6);
+  RecoilCorrector(std::string iNameZDat1, std::string iPrefix, int iSeed=0xDEADBEEF, double iTolerance=1E-6);
   void CorrectAll(double &met, double &metphi, double iGenPt, double iGenPhi, double iLepPt, double iLepPhi,double &iU1,double &iU2,double iFluc,double iScale=0,int njet=0);
   void Correct(double &pfmet, double &pfmetphi, double &trkmet, double &trkmetphi, 
 	       double iGenPt, double iGenPhi, double iLepPt, double iLepPhi,double iFluc    ,double iScale=0,int njet=0);
@@ -42,6 +76,8 @@ public:
   void CorrectType2(double &pfmet, double &pfmetphi,double iGenPt,double iGenPhi,double iLepPt,double iLepPhi,double &iU1,double &iU2,double iFluc,double iScale=0,int njet=0);
   void CorrectU1U2(double &pfu1, double &pfu2, double &trku1, double &trku2, 
 		   double iGenPt, double iGenPhi, double iLepPt, double iLepPhi,double iFluc,double iScale=0,int njet=0);
+  // Random numbers for the following corrections are drawn from the stream for this event
+  void setEvent(unsigned iRun, unsigned iLumi, unsigned long long iEvent);
   void addDataFile(std::string iNameDat);
   void addMCFile  (std::string iNameMC);
 protected:
@@ -72,7 +108,7 @@ protected:
 		std::vector<TF1*> &iF1F2U1U2Corr,std::vector<TF1*> &iF1F2U2U1Corr,int iType=2);
 
   void metDistribution(double &iMet,double &iMPhi,double iGenPt,double iGenPhi,
-		       double iLepPt,double iLepPhi,TRandom1 *iRand,
+		       double iLepPt,double iLepPhi,TRandom *iRand,
 		       TF1 *iU1RZFit, 
 		       TF1 *iU1MSZFit, 
 		       TF1 *iU1S1ZFit,
@@ -85,7 +121,7 @@ protected:
 
   void metDistribution(double &iPFMet,double &iPFMPhi,double &iTKMet,double &iTKMPhi,
 		       double iGenPt,double iGenPhi,
-		       double iLepPt,double iLepPhi,TRandom1 *iRand,
+		       double iLepPt,double iLepPhi,TRandom *iRand,
 		       TF1 *iU1RZPFFit,  TF1 *iU1RZTKFit, 
 		       TF1 *iU1MSZPFFit, TF1 *iU1MSZTKFit, 
 		       TF1 *iU1S1ZPFFit, TF1 *iU1S1ZTKFit,
@@ -99,7 +135,7 @@ protected:
 		       double &iU1,double &iU2,double iFluc=0,double iScale=0);
 
   void metDistributionType1(double &iMet,double &iMPhi,double iGenPt,double iGenPhi,
-			    double iLepPt,double iLepPhi,TRandom1 *iRand,
+			    double iLepPt,double iLepPhi,TRandom *iRand,
 			    TF1 *iU1RZDatFit,  TF1 *iU1RZMCFit,
 			    TF1 *iU1MSZDatFit, TF1 *iU1MSZMCFit, 
 			    TF1 *iU2MSZDatFit, TF1 *iU2MSZMCFit,
@@ -127,10 +163,16 @@ protected:
   double correlatedSeed(double iVal, double iCorr1,double iCorr2,double iCorr3,double iSeed0,double iSeed1,double iSeed2,double iSeed3);
   double deCorrelate   (double iVal, double iCorr1,double iCorr2,double iCorr3,double iSeed0,double iSeed1,double iSeed2,double iSeed3);
   TF1*   getFunc(bool iMC, Recoil iType);
+  void   tabulate(std::vector<TF1*> const& iFits);
+  inline double eval(TF1 *iFit,double iX) {
+    std::unordered_map<TF1*,TabulatedTF1>::const_iterator lIt = fTables.find(iFit);
+    return (lIt == fTables.end()) ? iFit->Eval(iX) : lIt->second.Eval(iX);
+  }
   double CorrVal(double iPt,double iVal,Recoil iType);
   //void   Correct(double &met, double &metphi, double lGenPt, double lGenPhi, double lepPt, double lepPhi,double iFluc,int njet);
 
-  TRandom1 *fRandom; 
+  ic::CounterRandom *fRandom; 
+  unsigned fRun; unsigned fLumi; unsigned long long fEvent;
   std::vector<TF1*> fF1U1Fit; std::vector<TF1*> fF1U1RMSSMFit; std::vector<TF1*> fF1U1RMS1Fit; std::vector<TF1*> fF1U1RMS2Fit; 
   std::vector<TF1*> fF1U2Fit; std::vector<TF1*> fF1U2RMSSMFit; std::vector<TF1*> fF1U2RMS1Fit; std::vector<TF1*> fF1U2RMS2Fit; 
   std::vector<TF1*> fF2U1Fit; std::vector<TF1*> fF2U1RMSSMFit; std::vector<TF1*> fF2U1RMS1Fit; std::vector<TF1*> fF2U1RMS2Fit; 
@@ -153,6 +195,8 @@ protected:
   std::vector<TF1*> fM1U1U2Corr;     std::vector<TF1*> fM2U1U2Corr;
   std::vector<TF1*> fM1M2U1Corr;     std::vector<TF1*> fM1M2U2Corr;
   std::vector<TF1*> fM1M2U1U2Corr;   std::vector<TF1*> fM1M2U2U1Corr;
+  double fTolerance;
+  std::unordered_map<TF1*,TabulatedTF1> fTables;
   int fId; int fJet;
 };
 
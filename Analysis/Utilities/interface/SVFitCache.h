@@ -0,0 +1,89 @@
+#ifndef ICHiggsTauTau_Utilities_SVFitCache_h
+#define ICHiggsTauTau_Utilities_SVFitCache_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include "UserCode/ICHiggsTauTau/interface/Candidate.hh"
+#include "UserCode/ICHiggsTauTau/interface/Met.hh"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/MappedFile.h"
+
+namespace ic {
+
+//! A persistent cache of SVFit masses keyed by a hash of the exact inputs
+/*!
+  The key is a 128-bit hash of the bit patterns of everything passed to
+  SVFitService: the fit mode, the two lepton four-vectors, the MET
+  four-vector and the MET covariance matrix, together with the name of
+  the integration, SVFitService::Algorithm(), which differs between
+  releases.  Bookkeeping such as the
+  run and event numbers is deliberately not part of the key, so a result
+  can be reused by any job that sees identical inputs.
+
+  File layout (native byte order):
+    char[8]   "ICSVFIT2"
+    uint64_t  number of records in the sorted block
+    Record[]  sorted block, ordered by (h1, h2), searched in place via mmap
+    Record[]  unsorted tail of records appended by jobs since the last Compact
+
+  Lookups and insertions are thread-safe.  New results are buffered and
+  appended to the file by Flush, which holds an exclusive lock on the file
+  so that several jobs can share one cache.  Compact merges the tail into
+  the sorted block; call it from time to time, when no jobs are running.
+*/
+class SVFitCache {
+ public:
+  struct Key {
+    uint64_t h1;
+    uint64_t h2;
+    bool operator<(Key const& r) const {
+      return h1 != r.h1 ? h1 < r.h1 : h2 < r.h2;
+    }
+  };
+
+  struct Record {
+    Key key;
+    double mass;
+  };
+
+  explicit SVFitCache(std::string const& path);
+  ~SVFitCache();
+
+  //! Hash of the inputs. \a mode is the SVFit module's mode (0,1: lep-had, 2: lep-lep)
+  static Key MakeKey(unsigned mode, Candidate const* lep1, Candidate const* lep2, Met const* met);
+
+  //! Returns true and sets \a mass if \a key is in the cache
+  bool Find(Key const& key, double & mass);
+
+  //! Add a new result; it is written to disk on the next Flush
+  void Insert(Key const& key, double mass);
+
+  //! Append all buffered results to the file
+  void Flush();
+
+  //! Rewrite the file at \a path as a single sorted block without duplicates
+  /*! Returns false, leaving the file untouched, if it doesn't exist or
+      doesn't start with the cache header
+  */
+  static bool Compact(std::string const& path);
+
+  inline unsigned hits() const { return hits_; }
+  inline unsigned misses() const { return misses_; }
+
+ private:
+  std::string path_;
+  MappedFile file_;
+  Record const* sorted_;
+  uint64_t n_sorted_;
+  std::map<Key, double> extra_;
+  std::vector<Record> pending_;
+  std::mutex mutex_;
+  unsigned hits_;
+  unsigned misses_;
+};
+
+}
+
+#endif
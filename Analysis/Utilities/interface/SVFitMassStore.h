@@ -0,0 +1,54 @@
+#ifndef ICHiggsTauTau_Utilities_SVFitMassStore_h
+#define ICHiggsTauTau_Utilities_SVFitMassStore_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/MappedFile.h"
+
+namespace ic {
+
+//! A read-only (run, event) -> SVFit mass lookup backed by a binary file
+/*!
+  The binary file is a header followed by records sorted by (run, event):
+    char[8]   "ICSVMAS1"
+    uint64_t  number of records
+    Record[]  records (native byte order)
+  The file is memory-mapped, so opening it is immediate, and each lookup is
+  a binary search with no string building or allocation.
+
+  Build converts the text output of the SVFit batch jobs, i.e. lines of the
+  form "run.event:mass".  The batch job format has no lumi section, so
+  events are keyed by run and event number only.
+*/
+class SVFitMassStore {
+ public:
+  struct Record {
+    uint64_t run;
+    uint64_t event;
+    double mass;
+  };
+
+  SVFitMassStore();
+  ~SVFitMassStore();
+
+  //! Convert the text files \a inputs into the binary file \a output
+  static bool Build(std::vector<std::string> const& inputs, std::string const& output);
+
+  //! Map the binary file at \a path. Returns false if it is missing or invalid
+  bool Open(std::string const& path);
+
+  //! Returns true and sets \a mass if the event is found
+  bool Find(uint64_t run, uint64_t event, double & mass) const;
+
+  inline uint64_t size() const { return n_; }
+
+ private:
+  MappedFile file_;
+  Record const* records_;
+  uint64_t n_;
+};
+
+}
+
+#endif
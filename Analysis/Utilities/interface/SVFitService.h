@@ -3,6 +3,7 @@
 
 #include <string>
 #include <iostream>
+#include <mutex>
 #include "UserCode/ICHiggsTauTau/interface/Candidate.hh"
 #include "UserCode/ICHiggsTauTau/interface/Met.hh"
 #include "TauAnalysis/CandidateTools/interface/NSVfitStandaloneAlgorithm.h"
@@ -13,6 +14,11 @@ namespace ic {
 
   class SVFitService {
   private:
+    // NSVfitStandaloneAlgorithm passes the likelihood being integrated to
+    // its integrand through a global, so two fits must never run at the
+    // same time in one process. Every fit below holds this lock; to run
+    // fits in parallel use separate processes, as SVFit op 4 does.
+    static std::mutex mutex_;
 
   public:
     SVFitService();
@@ -23,6 +29,9 @@ namespace ic {
     static std::pair<Candidate, double> SVFitCandidateLepHad(Candidate const* lep, Candidate const* had, Met const* met);
     static std::pair<Candidate, double> SVFitCandidateLepLep(Candidate const* lep1, Candidate const* lep2, Met const* met);
 
+    //! The integration the fits use, which depends on the release
+    static char const* Algorithm();
+
   };
 }
 
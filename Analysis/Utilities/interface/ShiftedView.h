@@ -0,0 +1,118 @@
+#ifndef ICHiggsTauTau_Utilities_ShiftedView_h
+#define ICHiggsTauTau_Utilities_ShiftedView_h
+
+#include <vector>
+#include "boost/shared_ptr.hpp"
+
+namespace ic {
+
+//! A copy-on-write view of a collection with per-object energy scale factors
+/*!
+  A ShiftedView wraps a nominal collection of pointers (e.g. as returned by
+  TreeEvent::GetPtrVec) without modifying it.  Scale factors are registered
+  per position in the collection with SetScale.  When an element is
+  accessed, an object with a scale of exactly 1 is returned directly from
+  the nominal collection.  Otherwise a copy of the object is made on first
+  access, its pt and energy are scaled, and the copy is cached for later
+  reads.  Elements are only ever handed out as const, so the nominal
+  objects can't be changed through a view.
+
+  Several views can be built from the same nominal collection and stored in
+  the event under different names, so that nominal and shifted quantities are
+  available side by side.  Copies of a view share the already-materialized
+  objects.
+
+  Consumers that want a whole collection can call Materialize(), or
+  Copies() if they need objects they can change.  TreeEvent::GetPtrVec
+  uses the latter, so a view in the event can be read as a collection.
+*/
+template <class T>
+class ShiftedView {
+ public:
+  ShiftedView() { ; }
+
+  explicit ShiftedView(std::vector<T *> const& nominal)
+      : nominal_(nominal), scales_(nominal.size(), 1.0), copies_(nominal.size()) { ; }
+
+  //! Register a multiplicative pt and energy scale factor for the object at position \a i
+  void SetScale(unsigned i, double scale) {
+    scales_[i] = scale;
+    copies_[i].reset();
+    materialized_.clear();
+  }
+
+  //! The scale factor registered for the object at position \a i, 1.0 by default
+  inline double Scale(unsigned i) const { return scales_[i]; }
+
+  inline std::size_t size() const { return nominal_.size(); }
+  inline bool empty() const { return nominal_.empty(); }
+
+  //! The unshifted object at position \a i
+  inline T const* nominal(unsigned i) const { return nominal_[i]; }
+
+  //! The (possibly shifted) object at position \a i
+  T const* at(unsigned i) const { return Get(i); }
+  T const* operator[](unsigned i) const { return Get(i); }
+
+  //! Returns true if any element has already been copied
+  bool HasCopies() const {
+    for (unsigned i = 0; i < copies_.size(); ++i) if (copies_[i]) return true;
+    return false;
+  }
+
+  //! The whole view as a vector
+  /*!
+    Every shifted object is materialized.  The returned pointers stay valid
+    as long as this view (or a copy of it) exists.
+  */
+  std::vector<T const*> const& Materialize() const {
+    if (materialized_.size() != nominal_.size()) {
+      materialized_.resize(nominal_.size());
+      for (unsigned i = 0; i < nominal_.size(); ++i) materialized_[i] = Get(i);
+    }
+    return materialized_;
+  }
+
+  //! The whole view as a vector of objects that can be changed
+  /*!
+    Unlike Materialize(), every object is copied, also those with a scale
+    of 1, so that changes never reach the nominal collection.  The
+    pointers stay valid as long as this view (or a copy of it) exists and
+    SetScale isn't called.
+  */
+  std::vector<T *> Copies() const {
+    std::vector<T *> result(nominal_.size());
+    for (unsigned i = 0; i < nominal_.size(); ++i) {
+      if (!copies_[i]) {
+        if (scales_[i] == 1.0) {
+          copies_[i].reset(new T(*(nominal_[i])));
+        } else {
+          Get(i);
+        }
+      }
+      result[i] = copies_[i].get();
+    }
+    return result;
+  }
+
+ private:
+  T const* Get(unsigned i) const {
+    double scale = scales_[i];
+    if (scale == 1.0) return nominal_[i];
+    if (!copies_[i]) {
+      copies_[i].reset(new T(*(nominal_[i])));
+      copies_[i]->set_pt(copies_[i]->pt() * scale);
+      copies_[i]->set_energy(copies_[i]->energy() * scale);
+    }
+    return copies_[i].get();
+  }
+
+  std::vector<T *> nominal_;
+  std::vector<double> scales_;
+  mutable std::vector<boost::shared_ptr<T> > copies_;
+  mutable std::vector<T const*> materialized_;
+};
+
+}
+
+#endif
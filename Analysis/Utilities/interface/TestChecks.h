@@ -0,0 +1,40 @@
+#ifndef ICHiggsTauTau_Utilities_TestChecks_h
+#define ICHiggsTauTau_Utilities_TestChecks_h
+
+#include <string>
+
+namespace ic {
+
+//! Counts the failed checks of a test program
+/*!
+  Each failed check is printed with its description when it is made, and
+  Summary() reports the overall result at the end, e.g.
+  \code
+    ic::TestChecks check;
+    check(table.size() == 4, "duplicates merged");
+    return check.Summary();
+  \endcode
+*/
+class TestChecks {
+ public:
+  TestChecks();
+
+  //! Record one check, printing \a what if \a ok is false. Returns \a ok
+  bool operator()(bool ok, std::string const& what);
+
+  //! True if \a a and \a b differ by at most \a tol relative to the
+  //! larger of |a|, |b| and 1
+  static bool Close(double a, double b, double tol);
+
+  inline unsigned failures() const { return failures_; }
+
+  //! Print PASSED or FAILED and return the exit code for main
+  int Summary() const;
+
+ private:
+  unsigned failures_;
+};
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef ICHiggsTauTau_Utilities_ThreadPool_h
+#define ICHiggsTauTau_Utilities_ThreadPool_h
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+
+namespace ic {
+
+//! A fixed-size pool of worker threads
+/*!
+  Tasks are queued with Submit, which returns a std::future for the result.
+  Tasks run in the order they were submitted.  The destructor finishes any
+  queued tasks before joining the workers.
+*/
+class ThreadPool {
+ public:
+  explicit ThreadPool(unsigned n_threads);
+  ~ThreadPool();
+
+  template <class R>
+  std::future<R> Submit(std::function<R()> const& func) {
+    std::shared_ptr<std::packaged_task<R()> > task(
+        new std::packaged_task<R()>(func));
+    std::future<R> result = task->get_future();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      tasks_.push_back([task]() { (*task)(); });
+    }
+    cond_.notify_one();
+    return result;
+  }
+
+  inline unsigned size() const { return workers_.size(); }
+
+ private:
+  ThreadPool(ThreadPool const&);
+  ThreadPool & operator=(ThreadPool const&);
+  void Work();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()> > tasks_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stop_;
+};
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef ICHiggsTauTau_Utilities_TriggerTable_h
+#define ICHiggsTauTau_Utilities_TriggerTable_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstddef>
+#include "UserCode/ICHiggsTauTau/interface/TriggerPath.hh"
+
+namespace ic {
+
+//! Run-dependent trigger path and filter selection
+/*!
+  Configured with two kinds of row, each valid for an inclusive run range:
+    - path rows: a path whose name contains the pattern sets some flag
+      bits, kPath by default
+    - filter rows: the trigger object collection and leg filters to use
+      for a slot, optionally only when some flag bits were set.  When
+      several rows apply the last one added wins, as in a chain of ifs.
+  At a change of run only the rows valid for that run are kept.  Each
+  path name is then matched against them once, the first time its hash
+  id is seen in the run, so the per-event work is a hash lookup per path
+  and an OR of the flags.  The filter choice is cached per run and flag
+  value in the same way.
+*/
+class TriggerTable {
+ public:
+  enum Flag { kPath = 1 };
+
+  static unsigned const kMaxRun = 0xFFFFFFFF;
+
+  struct Filters {
+    std::string objects;
+    std::string leg1;
+    std::string leg2;
+  };
+
+  TriggerTable();
+
+  //! Paths containing \a pattern in runs [run_min, run_max] set \a flags
+  TriggerTable & AddPath(unsigned run_min, unsigned run_max, std::string const& pattern,
+                         unsigned flags = kPath);
+
+  //! Use these filters for \a slot in runs [run_min, run_max] if the
+  //! matched flags include all of \a require
+  TriggerTable & AddFilters(unsigned slot, unsigned run_min, unsigned run_max,
+                            std::string const& objects, std::string const& leg1,
+                            std::string const& leg2, unsigned require = 0);
+
+  //! The OR of the flags set by the event's \a paths
+  unsigned Match(unsigned run, TriggerPathPtrVec const& paths);
+
+  //! The filters for \a slot, empty if no row applies
+  Filters const& Lookup(unsigned slot, unsigned run, unsigned flags);
+
+  inline unsigned n_paths() const { return paths_.size(); }
+  inline unsigned n_filters() const { return filters_.size(); }
+
+ private:
+  struct PathRow {
+    unsigned run_min;
+    unsigned run_max;
+    std::string pattern;
+    unsigned flags;
+  };
+
+  struct FilterRow {
+    unsigned slot;
+    unsigned run_min;
+    unsigned run_max;
+    unsigned require;
+    Filters filters;
+  };
+
+  void SetRun(unsigned run);
+  unsigned Resolve(std::string const& name) const;
+
+  std::vector<PathRow> paths_;
+  std::vector<FilterRow> filters_;
+  Filters empty_;
+
+  // Per-run state
+  bool have_run_;
+  unsigned run_;
+  std::vector<unsigned> active_;
+  std::unordered_map<std::size_t, unsigned> path_flags_;
+  std::map<std::pair<unsigned, unsigned>, int> filter_choice_;
+};
+
+}
+
+#endif
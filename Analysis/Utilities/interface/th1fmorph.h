@@ -1,4 +1,5 @@
 #include "TH1.h"
+#include <vector>
 
 TH1F *th1fmorph(const char *chname, 
                 const char *chtitle,
@@ -70,3 +71,26 @@ TH1D *th1fmorph(const char *chname,
   //   well-tested).
   // *------------------------------------------------------------------------
 
+
+//! Morph the same pair of histograms to several parameter values at once
+/*! Gives the same histograms as calling th1fmorph once for each entry of
+    \a parinterp, with the matching entry of \a morphedhistnorm, but the
+    cdfs of \a hist1 and \a hist2 and the walk along their edges are only
+    worked out once. Each target then just needs the interpolated edge
+    positions and the projection onto the output binning. The returned
+    histograms are not attached to any directory.
+*/
+std::vector<TH1F> th1fmorph_batch(const char *chname,
+                const char *chtitle,
+                TH1F *hist1,TH1F *hist2,
+                Double_t par1,Double_t par2,
+                std::vector<Double_t> const& parinterp,
+                std::vector<Double_t> const& morphedhistnorm,
+                Int_t idebug=0) ;
+std::vector<TH1D> th1fmorph_batch(const char *chname,
+                const char *chtitle,
+                TH1D *hist1,TH1D *hist2,
+                Double_t par1,Double_t par2,
+                std::vector<Double_t> const& parinterp,
+                std::vector<Double_t> const& morphedhistnorm,
+                Int_t idebug=0) ;
@@ -1,5 +1,6 @@
 #include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BTagWeight.h"
 #include <cmath>
+#include <algorithm>
 
 namespace ic {
 
@@ -7,7 +8,7 @@ namespace ic {
 
   BTagWeight::BTagWeight() {
     louvain_eff_ = new TF1("sigmoidTimesL","[0]+([3]+[4]*x)/(1+exp([1]-x*[2]))",20,1000);
-    rand = new TRandom3(0);
+    rand = new CounterRandom();
     static float ptbins_2012[] = {20, 30, 40, 50, 60, 70, 80, 100, 120, 160, 210, 260, 320, 400, 500, 600, 800};
     static float ptbins_2011[] = {20, 30, 40, 50, 60, 70, 80, 100, 120, 160, 210, 260, 320, 400, 500, 670};
     static float SFb_error_2012[] = {
@@ -261,35 +262,76 @@ namespace ic {
     return sf;
   }
 
+  void BTagWeight::TagCounts(std::vector<double> const& probs, unsigned max_tags, std::vector<double> & dist) {
+    unsigned ntags = std::min<unsigned>(max_tags, probs.size());
+    dist.assign(ntags + 1, 0.);
+    dist[0] = 1.;
+    for (unsigned j = 0; j < probs.size(); ++j) {
+      double p = probs[j];
+      double q = 1. - p;
+      // After j jets at most j can be tagged
+      unsigned top = std::min(ntags, j + 1);
+      for (unsigned k = top; k > 0; --k) {
+        dist[k] = dist[k] * q + dist[k-1] * p;
+      }
+      dist[0] *= q;
+    }
+  }
+
+  std::pair<double,double> BTagWeight::TagDistribution::window(int minTags, int maxTags) const {
+    if (mc.size() <= 1) return std::pair<double,double>(1.0, 1.0);
+    double pData = 0.;
+    double pMC = 0.;
+    int lo = std::max(minTags, 0);
+    int hi = std::min(maxTags, int(mc.size()) - 1);
+    for (int k = lo; k <= hi; ++k) {
+      pData += data[k];
+      pMC += mc[k];
+    }
+    return std::pair<double,double>(pData, pMC);
+  }
+
+  double BTagWeight::TagDistribution::weight(int minTags, int maxTags) const {
+    std::pair<double,double> result = window(minTags, maxTags);
+    return result.first / result.second;
+  }
+
   std::pair<float,float> BTagWeight::weight(std::vector<JetInfo> jets, int minTags, int maxTags) const {
     int njets=jets.size();
     if (njets == 0) return (std::pair<float,float>(1.0,1.0));
-    int comb= 1 << njets;
-    float pMC=0;
-    float pData=0;
-    for(int i=0;i < comb; i++) {
-      float mc=1.;
-      float data=1.;
-      int ntagged=0;
-      for(int j=0;j<njets;j++) {
-        bool tagged = ((i >> j) & 0x1) == 1;
-        if(tagged) {
-          ntagged++;
-          mc*=jets[j].eff;
-          data*=jets[j].eff*jets[j].sf;
-        } else {
-          mc*=(1.-jets[j].eff);
-          data*=(1.-jets[j].eff*jets[j].sf);
-        }
-      }     
-      if(ntagged >= minTags && ntagged <= maxTags) {
-        pMC+=mc;
-        pData+=data;
-      }
+    if (maxTags < 0 || minTags > maxTags) return (std::pair<float,float>(0.0,0.0));
+    std::vector<double> p_mc(njets);
+    std::vector<double> p_data(njets);
+    for (int j = 0; j < njets; ++j) {
+      p_mc[j] = jets[j].eff;
+      p_data[j] = jets[j].eff*jets[j].sf;
+    }
+    std::vector<double> mc;
+    std::vector<double> data;
+    TagCounts(p_mc, maxTags, mc);
+    TagCounts(p_data, maxTags, data);
+    double pMC = 0.;
+    double pData = 0.;
+    for (unsigned k = std::max(minTags, 0); k < mc.size(); ++k) {
+      pMC += mc[k];
+      pData += data[k];
     }
     return std::pair<float,float>(pData,pMC);
   }
 
+  BTagWeight::TagDistribution BTagWeight::TagMultiplicity(std::vector<JetInfo> const& jets) const {
+    std::vector<double> p_mc(jets.size());
+    std::vector<double> p_data(jets.size());
+    for (unsigned j = 0; j < jets.size(); ++j) {
+      p_mc[j] = jets[j].eff;
+      p_data[j] = jets[j].eff*jets[j].sf;
+    }
+    TagDistribution dist;
+    TagCounts(p_mc, jets.size(), dist.mc);
+    TagCounts(p_data, jets.size(), dist.data);
+    return dist;
+  }
+
   double BTagWeight::GetWeight( std::vector<PFJet *> const& jets, 
                     BTagWeight::payload const& set, 
                     BTagWeight::tagger const& algo, 
@@ -309,11 +351,16 @@ namespace ic {
                                     BTagWeight::payload const& set, 
                                     BTagWeight::tagger const& algo,
                                     int Btag_mode,
-                                    int Bfake_mode) const {
+                                    int Bfake_mode,
+                                    EventInfo const* info) const {
+    if (!info) {
+      std::cerr << "Error in <ic::BTagWeight>: ReTag needs the EventInfo to seed its random numbers, an exception will be thrown" << std::endl;
+      throw;
+    }
     bool verbose = false;
     std::map<std::size_t, bool> pass_result;
     for (unsigned i = 0; i < jets.size(); ++i) {
-      rand->SetSeed((int)((jets[i]->eta()+5)*100000));
+      rand->SetStream(info, jets[i]->id(), "retag");
       double eff = BEff(set, std::abs(jets[i]->parton_flavour()), algo, jets[i]->pt(), jets[i]->eta());
       double sf = SF(set, std::abs(jets[i]->parton_flavour()), algo, jets[i]->pt(), jets[i]->eta(), Btag_mode, Bfake_mode);
       double demoteProb_btag = 0;
@@ -325,7 +372,7 @@ namespace ic {
       }
       if (verbose) {
         std::cout << "Jet " << i << " " << jets[i]->vector() << "  csv: " << jets[i]->GetBDiscriminator("combinedSecondaryVertexBJetTags") << "  parton flavour: " << jets[i]->parton_flavour() << std::endl;
-        std::cout << "-- random seed: " << ((int)((jets[i]->eta()+5)*100000)) << std::endl;
+        std::cout << "-- random stream: " << jets[i]->id() << std::endl;
         std::cout << "-- efficiency: " << eff << std::endl;
         std::cout << "-- scale factor: " << sf << std::endl;
       }
@@ -366,5 +413,40 @@ namespace ic {
     return result.first / result.second;
   }
 
+  BTagWeight::TagDistribution BTagWeight::GetLouvainTagDistribution(std::vector<PFJet *> const& jets, BTagWeight::tagger const& algo) const {
+    std::vector<BTagWeight::JetInfo> infos;
+    for (unsigned i = 0; i < jets.size(); ++i) {
+      double eff = LouvainBEff(std::abs(jets[i]->parton_flavour()), algo, jets[i]->pt(), jets[i]->eta());
+      double sf = SF(payload::ALL2011, std::abs(jets[i]->parton_flavour()), algo, jets[i]->pt(), jets[i]->eta(), 0, 0);
+      infos.push_back(BTagWeight::JetInfo(eff, sf));
+    }
+    return TagMultiplicity(infos);
+  }
+
+  std::vector<BTagWeight::TagDistribution> BTagWeight::GetTagDistributions(std::vector<PFJet *> const& jets,
+                                                   BTagWeight::payload const& set,
+                                                   BTagWeight::tagger const& algo,
+                                                   std::vector<std::pair<int,int>> const& modes) const {
+    // Efficiencies and scale factors are rounded to float, as in JetInfo, so
+    // that the results agree with GetWeight
+    std::vector<double> p_mc(jets.size());
+    std::vector<double> p_data(jets.size());
+    for (unsigned i = 0; i < jets.size(); ++i) {
+      p_mc[i] = float(BEff(set, std::abs(jets[i]->parton_flavour()), algo, jets[i]->pt(), jets[i]->eta()));
+    }
+    std::vector<double> mc;
+    TagCounts(p_mc, jets.size(), mc);
+    std::vector<TagDistribution> result(modes.size());
+    for (unsigned m = 0; m < modes.size(); ++m) {
+      for (unsigned i = 0; i < jets.size(); ++i) {
+        float sf = SF(set, std::abs(jets[i]->parton_flavour()), algo, jets[i]->pt(), jets[i]->eta(), modes[m].first, modes[m].second);
+        p_data[i] = float(p_mc[i]) * sf;
+      }
+      result[m].mc = mc;
+      TagCounts(p_data, jets.size(), result[m].data);
+    }
+    return result;
+  }
+
 
 }
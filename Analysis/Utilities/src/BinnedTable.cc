@@ -0,0 +1,108 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
+#include <iostream>
+#include "TAxis.h"
+#include "TH1.h"
+#include "UserCode/ICHiggsTauTau/interface/TH2DAsymErr.h"
+
+namespace ic {
+
+  BinnedAxis::BinnedAxis() : nbins_(0), uniform_(true), min_(0.), max_(0.) {
+  }
+
+  BinnedAxis::BinnedAxis(unsigned nbins, double min, double max)
+      : nbins_(nbins), uniform_(true), min_(min), max_(max) {
+    edges_.resize(nbins + 1);
+    for (unsigned i = 0; i <= nbins; ++i) edges_[i] = min + i * (max - min) / nbins;
+  }
+
+  BinnedAxis::BinnedAxis(std::vector<double> const& edges)
+      : edges_(edges), nbins_(edges.size() - 1), uniform_(false) {
+    if (edges.size() < 2) {
+      std::cerr << "Error in <BinnedAxis>: need at least two bin edges, an exception will be thrown" << std::endl;
+      throw;
+    }
+    min_ = edges_.front();
+    max_ = edges_.back();
+  }
+
+  BinnedAxis::BinnedAxis(TAxis const* axis)
+      : nbins_(axis->GetNbins()),
+        uniform_(axis->GetXbins()->GetSize() == 0),
+        min_(axis->GetXmin()),
+        max_(axis->GetXmax()) {
+    edges_.resize(nbins_ + 1);
+    for (int i = 1; i <= nbins_ + 1; ++i) edges_[i - 1] = axis->GetBinLowEdge(i);
+  }
+
+  BinnedTable::BinnedTable() : size_(0) {
+  }
+
+  BinnedTable::BinnedTable(TH1 const* hist) {
+    std::vector<BinnedAxis> axes;
+    axes.push_back(BinnedAxis(hist->GetXaxis()));
+    if (hist->GetDimension() > 1) axes.push_back(BinnedAxis(hist->GetYaxis()));
+    if (hist->GetDimension() > 2) axes.push_back(BinnedAxis(hist->GetZaxis()));
+    SetAxes(axes);
+    entries_.resize(size_);
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+      entries_[i].value = hist->GetBinContent(i);
+      entries_[i].err_up = hist->GetBinError(i);
+      entries_[i].err_down = entries_[i].err_up;
+    }
+  }
+
+  BinnedTable::BinnedTable(mithep::TH2DAsymErr * hist) {
+    std::vector<BinnedAxis> axes;
+    axes.push_back(BinnedAxis(hist->GetXaxis()));
+    axes.push_back(BinnedAxis(hist->GetYaxis()));
+    SetAxes(axes);
+    entries_.resize(size_);
+    for (int j = 0; j <= axes_[1].nbins() + 1; ++j) {
+      for (int i = 0; i <= axes_[0].nbins() + 1; ++i) {
+        Entry & entry = entries_[i + strides_[1] * j];
+        entry.value = hist->GetBinContent(i, j);
+        entry.err_up = hist->GetBinStatErrorHigh(i, j);
+        entry.err_down = hist->GetBinStatErrorLow(i, j);
+      }
+    }
+  }
+
+  BinnedTable::BinnedTable(std::vector<BinnedAxis> const& axes, std::vector<Entry> const& entries) {
+    SetAxes(axes);
+    if (entries.size() != size_) {
+      std::cerr << "Error in <BinnedTable>: expected " << size_ << " entries but got "
+                << entries.size() << ", an exception will be thrown" << std::endl;
+      throw;
+    }
+    entries_ = entries;
+  }
+
+  void BinnedTable::SetAxes(std::vector<BinnedAxis> const& axes) {
+    if (axes.empty()) {
+      std::cerr << "Error in <BinnedTable>: no axes given, an exception will be thrown" << std::endl;
+      throw;
+    }
+    axes_ = axes;
+    strides_.resize(axes_.size());
+    size_ = 1;
+    for (unsigned i = 0; i < axes_.size(); ++i) {
+      strides_[i] = size_;
+      size_ *= axes_[i].nbins() + 2;
+    }
+  }
+
+  std::size_t BinnedTable::FindBin(double const* x) const {
+    std::size_t bin = 0;
+    for (unsigned i = 0; i < axes_.size(); ++i) bin += strides_[i] * axes_[i].FindBin(x[i]);
+    return bin;
+  }
+
+  bool BinnedTable::IsInRange(std::size_t bin) const {
+    for (unsigned i = axes_.size(); i-- > 0;) {
+      int axis_bin = bin / strides_[i];
+      if (axis_bin < 1 || axis_bin > axes_[i].nbins()) return false;
+      bin -= axis_bin * strides_[i];
+    }
+    return true;
+  }
+}
@@ -0,0 +1,382 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CompiledExpression.h"
+#include <cctype>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+
+namespace {
+  template <class F>
+  void UnaryLoop(double const* a, double * d, std::size_t n, F f) {
+    for (std::size_t i = 0; i < n; ++i) d[i] = f(a[i]);
+  }
+
+  template <class F>
+  void BinaryLoop(double const* a, double const* b, double * d, std::size_t n, F f) {
+    for (std::size_t i = 0; i < n; ++i) d[i] = f(a[i], b[i]);
+  }
+
+  struct Function {
+    char const* name;
+    unsigned n_args;
+  };
+}
+
+namespace ic {
+
+  CompiledExpression::CompiledExpression() : valid_(false), max_depth_(0), pos_(0) {
+    ;
+  }
+
+  CompiledExpression::CompiledExpression(std::string const& expr) : valid_(false), max_depth_(0), pos_(0) {
+    Compile(expr);
+  }
+
+  bool CompiledExpression::Compile(std::string const& expr) {
+    expr_ = expr;
+    error_ = "";
+    code_.clear();
+    constants_.clear();
+    variables_.clear();
+    max_depth_ = 0;
+    pos_ = 0;
+    valid_ = ParseOr();
+    SkipSpace();
+    if (valid_ && pos_ != expr_.size()) valid_ = Fail("unexpected character");
+    if (!valid_) {
+      code_.clear();
+      return false;
+    }
+    // Work out the maximum stack depth needed by the program
+    unsigned depth = 0;
+    for (unsigned i = 0; i < code_.size(); ++i) {
+      op c = code_[i].code;
+      if (c == op::constant || c == op::variable) {
+        ++depth;
+      } else if (c >= op::add) {
+        --depth;
+      }
+      max_depth_ = std::max(max_depth_, depth);
+    }
+    return true;
+  }
+
+  bool CompiledExpression::Fail(std::string const& msg) {
+    if (error_ == "") {
+      error_ = msg + " at position " + std::to_string(static_cast<long long>(pos_)) + " in \"" + expr_ + "\"";
+    }
+    return false;
+  }
+
+  void CompiledExpression::SkipSpace() {
+    while (pos_ < expr_.size() && std::isspace(static_cast<unsigned char>(expr_[pos_]))) ++pos_;
+  }
+
+  bool CompiledExpression::Accept(std::string const& token) {
+    SkipSpace();
+    if (expr_.compare(pos_, token.size(), token) != 0) return false;
+    // Don't split a two-character operator, e.g. "<" must not match "<="
+    if (token.size() == 1 && pos_ + 1 < expr_.size()) {
+      char next = expr_[pos_ + 1];
+      if ((token == "<" || token == ">" || token == "!" || token == "=") && next == '=') return false;
+      // ...and "<", ">" or "&" must not match "<<", ">>" or "&&"
+      if ((token == "<" || token == ">" || token == "&") && next == token[0]) return false;
+    }
+    pos_ += token.size();
+    return true;
+  }
+
+  bool CompiledExpression::ParseOr() {
+    if (!ParseAnd()) return false;
+    while (Accept("||")) {
+      if (!ParseAnd()) return false;
+      code_.push_back({op::lor, 0});
+    }
+    return true;
+  }
+
+  bool CompiledExpression::ParseAnd() {
+    if (!ParseBitAnd()) return false;
+    while (Accept("&&")) {
+      if (!ParseBitAnd()) return false;
+      code_.push_back({op::land, 0});
+    }
+    return true;
+  }
+
+  bool CompiledExpression::ParseBitAnd() {
+    if (!ParseEquality()) return false;
+    while (Accept("&")) {
+      if (!ParseEquality()) return false;
+      code_.push_back({op::band, 0});
+    }
+    return true;
+  }
+
+  bool CompiledExpression::ParseEquality() {
+    if (!ParseRelational()) return false;
+    while (true) {
+      op code;
+      if (Accept("==")) {
+        code = op::eq;
+      } else if (Accept("!=")) {
+        code = op::ne;
+      } else {
+        return true;
+      }
+      if (!ParseRelational()) return false;
+      code_.push_back({code, 0});
+    }
+  }
+
+  bool CompiledExpression::ParseRelational() {
+    if (!ParseShift()) return false;
+    while (true) {
+      op code;
+      if (Accept("<=")) {
+        code = op::le;
+      } else if (Accept(">=")) {
+        code = op::ge;
+      } else if (Accept("<")) {
+        code = op::lt;
+      } else if (Accept(">")) {
+        code = op::gt;
+      } else {
+        return true;
+      }
+      if (!ParseShift()) return false;
+      code_.push_back({code, 0});
+    }
+  }
+
+  bool CompiledExpression::ParseShift() {
+    if (!ParseAdditive()) return false;
+    while (true) {
+      op code;
+      if (Accept("<<")) {
+        code = op::shl;
+      } else if (Accept(">>")) {
+        code = op::shr;
+      } else {
+        return true;
+      }
+      if (!ParseAdditive()) return false;
+      code_.push_back({code, 0});
+    }
+  }
+
+  bool CompiledExpression::ParseAdditive() {
+    if (!ParseMultiplicative()) return false;
+    while (true) {
+      op code;
+      if (Accept("+")) {
+        code = op::add;
+      } else if (Accept("-")) {
+        code = op::sub;
+      } else {
+        return true;
+      }
+      if (!ParseMultiplicative()) return false;
+      code_.push_back({code, 0});
+    }
+  }
+
+  bool CompiledExpression::ParseMultiplicative() {
+    if (!ParseUnary()) return false;
+    while (true) {
+      op code;
+      if (Accept("*")) {
+        code = op::mul;
+      } else if (Accept("/")) {
+        code = op::div;
+      } else {
+        return true;
+      }
+      if (!ParseUnary()) return false;
+      code_.push_back({code, 0});
+    }
+  }
+
+  bool CompiledExpression::ParseUnary() {
+    if (Accept("!")) {
+      if (!ParseUnary()) return false;
+      code_.push_back({op::lnot, 0});
+      return true;
+    }
+    if (Accept("-")) {
+      if (!ParseUnary()) return false;
+      code_.push_back({op::neg, 0});
+      return true;
+    }
+    if (Accept("+")) return ParseUnary();
+    return ParsePower();
+  }
+
+  bool CompiledExpression::ParsePower() {
+    if (!ParsePrimary()) return false;
+    if (Accept("^")) {
+      if (!ParseUnary()) return false;
+      code_.push_back({op::pow, 0});
+    }
+    return true;
+  }
+
+  bool CompiledExpression::ParsePrimary() {
+    SkipSpace();
+    if (pos_ >= expr_.size()) return Fail("unexpected end of expression");
+    char c = expr_[pos_];
+    if (c == '(') {
+      ++pos_;
+      if (!ParseOr()) return false;
+      if (!Accept(")")) return Fail("expected ')'");
+      return true;
+    }
+    if (c == '[') {
+      std::size_t end = pos_ + 1;
+      while (end < expr_.size() && std::isdigit(static_cast<unsigned char>(expr_[end]))) ++end;
+      if (end == pos_ + 1 || end == expr_.size() || expr_[end] != ']') return Fail("invalid parameter");
+      std::string name = expr_.substr(pos_, end + 1 - pos_);
+      pos_ = end + 1;
+      unsigned idx = std::find(variables_.begin(), variables_.end(), name) - variables_.begin();
+      if (idx == variables_.size()) variables_.push_back(name);
+      code_.push_back({op::variable, idx});
+      return true;
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+      char const* begin = expr_.c_str() + pos_;
+      char * end = nullptr;
+      double val = std::strtod(begin, &end);
+      if (end == begin) return Fail("invalid number");
+      pos_ += (end - begin);
+      constants_.push_back(val);
+      code_.push_back({op::constant, unsigned(constants_.size() - 1)});
+      return true;
+    }
+    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+      std::size_t begin = pos_;
+      while (pos_ < expr_.size()) {
+        char x = expr_[pos_];
+        if (std::isalnum(static_cast<unsigned char>(x)) || x == '_') {
+          ++pos_;
+        } else if (x == ':' && pos_ + 2 < expr_.size() && expr_[pos_ + 1] == ':') {
+          pos_ += 2;
+        } else {
+          break;
+        }
+      }
+      std::string name = expr_.substr(begin, pos_ - begin);
+      SkipSpace();
+      if (pos_ < expr_.size() && expr_[pos_] == '(') {
+        static const Function functions[] = {
+          {"abs", 1}, {"fabs", 1}, {"TMath::Abs", 1},
+          {"sqrt", 1}, {"TMath::Sqrt", 1},
+          {"exp", 1}, {"TMath::Exp", 1},
+          {"log", 1}, {"TMath::Log", 1},
+          {"log10", 1}, {"TMath::Log10", 1},
+          {"sin", 1}, {"TMath::Sin", 1},
+          {"cos", 1}, {"TMath::Cos", 1},
+          {"pow", 2}, {"TMath::Power", 2},
+          {"min", 2}, {"TMath::Min", 2},
+          {"max", 2}, {"TMath::Max", 2}
+        };
+        static const op codes[] = {
+          op::abs, op::abs, op::abs,
+          op::sqrt, op::sqrt,
+          op::exp, op::exp,
+          op::log, op::log,
+          op::log10, op::log10,
+          op::sin, op::sin,
+          op::cos, op::cos,
+          op::pow, op::pow,
+          op::min, op::min,
+          op::max, op::max
+        };
+        unsigned n_functions = sizeof(functions) / sizeof(Function);
+        unsigned f = 0;
+        while (f < n_functions && name != functions[f].name) ++f;
+        if (f == n_functions) return Fail("unsupported function " + name);
+        ++pos_;
+        for (unsigned a = 0; a < functions[f].n_args; ++a) {
+          if (a > 0 && !Accept(",")) return Fail("expected ','");
+          if (!ParseOr()) return false;
+        }
+        if (!Accept(")")) return Fail("expected ')'");
+        code_.push_back({codes[f], 0});
+        return true;
+      }
+      if (name.find("::") != name.npos) return Fail("unsupported name " + name);
+      unsigned idx = std::find(variables_.begin(), variables_.end(), name) - variables_.begin();
+      if (idx == variables_.size()) variables_.push_back(name);
+      code_.push_back({op::variable, idx});
+      return true;
+    }
+    return Fail("unexpected character");
+  }
+
+  void CompiledExpression::Evaluate(std::vector<double const*> const& columns, std::size_t n, double * out) const {
+    if (!valid_ || n == 0) return;
+    // stack[i] points either to an input column or to the scratch slot i
+    std::vector<double> scratch(max_depth_ * n);
+    std::vector<double const*> stack(max_depth_);
+    unsigned sp = 0;
+    for (unsigned i = 0; i < code_.size(); ++i) {
+      Instruction const& ins = code_[i];
+      if (ins.code == op::constant) {
+        double * d = &scratch[sp * n];
+        std::fill(d, d + n, constants_[ins.arg]);
+        stack[sp++] = d;
+        continue;
+      }
+      if (ins.code == op::variable) {
+        stack[sp++] = columns[ins.arg];
+        continue;
+      }
+      if (ins.code < op::add) {
+        double const* a = stack[sp - 1];
+        double * d = &scratch[(sp - 1) * n];
+        switch (ins.code) {
+          case op::neg:  UnaryLoop(a, d, n, [](double x) { return -x; }); break;
+          case op::lnot: UnaryLoop(a, d, n, [](double x) { return x == 0. ? 1. : 0.; }); break;
+          case op::abs:  UnaryLoop(a, d, n, [](double x) { return std::fabs(x); }); break;
+          case op::sqrt: UnaryLoop(a, d, n, [](double x) { return std::sqrt(x); }); break;
+          case op::exp:  UnaryLoop(a, d, n, [](double x) { return std::exp(x); }); break;
+          case op::log:  UnaryLoop(a, d, n, [](double x) { return std::log(x); }); break;
+          case op::log10: UnaryLoop(a, d, n, [](double x) { return std::log10(x); }); break;
+          case op::sin:  UnaryLoop(a, d, n, [](double x) { return std::sin(x); }); break;
+          case op::cos:  UnaryLoop(a, d, n, [](double x) { return std::cos(x); }); break;
+          default: break;
+        }
+        stack[sp - 1] = d;
+        continue;
+      }
+      double const* a = stack[sp - 2];
+      double const* b = stack[sp - 1];
+      double * d = &scratch[(sp - 2) * n];
+      switch (ins.code) {
+        case op::add:  BinaryLoop(a, b, d, n, [](double x, double y) { return x + y; }); break;
+        case op::sub:  BinaryLoop(a, b, d, n, [](double x, double y) { return x - y; }); break;
+        case op::mul:  BinaryLoop(a, b, d, n, [](double x, double y) { return x * y; }); break;
+        case op::div:  BinaryLoop(a, b, d, n, [](double x, double y) { return y == 0. ? 0. : x / y; }); break;
+        case op::lt:   BinaryLoop(a, b, d, n, [](double x, double y) { return x < y ? 1. : 0.; }); break;
+        case op::le:   BinaryLoop(a, b, d, n, [](double x, double y) { return x <= y ? 1. : 0.; }); break;
+        case op::gt:   BinaryLoop(a, b, d, n, [](double x, double y) { return x > y ? 1. : 0.; }); break;
+        case op::ge:   BinaryLoop(a, b, d, n, [](double x, double y) { return x >= y ? 1. : 0.; }); break;
+        case op::eq:   BinaryLoop(a, b, d, n, [](double x, double y) { return x == y ? 1. : 0.; }); break;
+        case op::ne:   BinaryLoop(a, b, d, n, [](double x, double y) { return x != y ? 1. : 0.; }); break;
+        case op::land: BinaryLoop(a, b, d, n, [](double x, double y) { return (x != 0. && y != 0.) ? 1. : 0.; }); break;
+        case op::lor:  BinaryLoop(a, b, d, n, [](double x, double y) { return (x != 0. || y != 0.) ? 1. : 0.; }); break;
+        case op::pow:  BinaryLoop(a, b, d, n, [](double x, double y) { return std::pow(x, y); }); break;
+        case op::min:  BinaryLoop(a, b, d, n, [](double x, double y) { return x <= y ? x : y; }); break;
+        case op::max:  BinaryLoop(a, b, d, n, [](double x, double y) { return x >= y ? x : y; }); break;
+        case op::shl:  BinaryLoop(a, b, d, n, [](double x, double y) { return double(uint64_t(x) << uint64_t(y)); }); break;
+        case op::shr:  BinaryLoop(a, b, d, n, [](double x, double y) { return double(uint64_t(x) >> uint64_t(y)); }); break;
+        case op::band: BinaryLoop(a, b, d, n, [](double x, double y) { return double(uint64_t(x) & uint64_t(y)); }); break;
+        default: break;
+      }
+      stack[sp - 2] = d;
+      --sp;
+    }
+    std::copy(stack[0], stack[0] + n, out);
+  }
+
+}
@@ -0,0 +1,101 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
+#include "UserCode/ICHiggsTauTau/interface/EventInfo.hh"
+
+namespace ic {
+
+  namespace {
+    inline void MulHiLo(uint32_t a, uint32_t b, uint32_t & hi, uint32_t & lo) {
+      uint64_t p = uint64_t(a) * uint64_t(b);
+      hi = uint32_t(p >> 32);
+      lo = uint32_t(p);
+    }
+
+    // FNV-1a
+    uint32_t HashPurpose(std::string const& purpose) {
+      uint32_t h = 2166136261u;
+      for (unsigned i = 0; i < purpose.size(); ++i) {
+        h ^= uint32_t(static_cast<unsigned char>(purpose[i]));
+        h *= 16777619u;
+      }
+      return h;
+    }
+  }
+
+  CounterRandom::CounterRandom(uint64_t seed) : TRandom(0), seed_(seed) {
+    SetStream(0, 0, 0, 0, "");
+  }
+
+  void CounterRandom::Philox(uint32_t ctr[4], uint32_t const key[2]) {
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+    for (unsigned r = 0; r < 10; ++r) {
+      uint32_t hi0, lo0, hi1, lo1;
+      MulHiLo(0xD2511F53u, ctr[0], hi0, lo0);
+      MulHiLo(0xCD9E8D57u, ctr[2], hi1, lo1);
+      uint32_t c1 = ctr[1];
+      uint32_t c3 = ctr[3];
+      ctr[0] = hi1 ^ c1 ^ k0;
+      ctr[1] = lo1;
+      ctr[2] = hi0 ^ c3 ^ k1;
+      ctr[3] = lo0;
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+  }
+
+  void CounterRandom::SetStream(unsigned run, unsigned lumi, unsigned long long event,
+                                std::size_t object, std::string const& purpose) {
+    run_ = run;
+    lumi_ = lumi;
+    event_ = event;
+    object_ = object;
+    purpose_ = HashPurpose(purpose);
+    Restart();
+  }
+
+  void CounterRandom::Restart() {
+    // First hash the event under the global seed, then use the result to key
+    // the stream for this object and purpose.  Blocks within the stream are
+    // counted in ctr_[3].
+    uint32_t seed_key[2] = {uint32_t(seed_), uint32_t(seed_ >> 32)};
+    uint32_t h[4] = {run_, lumi_, uint32_t(event_), uint32_t(event_ >> 32)};
+    Philox(h, seed_key);
+    key_[0] = h[0] ^ purpose_;
+    key_[1] = h[1];
+    ctr_[0] = uint32_t(object_);
+    ctr_[1] = uint32_t(object_ >> 32);
+    ctr_[2] = h[2];
+    ctr_[3] = 0;
+    used_ = 4;
+  }
+
+  void CounterRandom::SetStream(EventInfo const* info, std::size_t object,
+                                std::string const& purpose) {
+    SetStream(info->run(), info->lumi_block(), info->event(), object, purpose);
+  }
+
+  void CounterRandom::SetSeed(UInt_t seed) {
+    seed_ = seed;
+    fSeed = seed;
+    Restart();
+  }
+
+  Double_t CounterRandom::Rndm(Int_t) {
+    if (used_ == 4) {
+      for (unsigned i = 0; i < 4; ++i) block_[i] = ctr_[i];
+      Philox(block_, key_);
+      ++ctr_[3];
+      used_ = 0;
+    }
+    // Same 32-bit resolution as TRandom3, never exactly 0 or 1
+    return (double(block_[used_++]) + 0.5) * 2.3283064365386963e-10;
+  }
+
+  void CounterRandom::RndmArray(Int_t n, Float_t *array) {
+    for (Int_t i = 0; i < n; ++i) array[i] = Rndm();
+  }
+
+  void CounterRandom::RndmArray(Int_t n, Double_t *array) {
+    for (Int_t i = 0; i < n; ++i) array[i] = Rndm();
+  }
+}
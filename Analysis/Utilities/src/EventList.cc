@@ -0,0 +1,246 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/EventList.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <cerrno>
+
+namespace {
+  char const kMagic[8] = {'I', 'C', 'E', 'V', 'L', 'S', 'T', '1'};
+  std::size_t const kHeaderSize = 64;
+  // Each key sets 7 of the 512 bits in one block, with about 12 bits per key
+  unsigned const kHashes = 7;
+  unsigned const kBitsPerKey = 12;
+
+  inline uint64_t Mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  inline bool RecordLess(ic::EventList::Record const& l, ic::EventList::Record const& r) {
+    if (l.run != r.run) return l.run < r.run;
+    if (l.lumi != r.lumi) return l.lumi < r.lumi;
+    return l.event < r.event;
+  }
+
+  inline bool RecordEqual(ic::EventList::Record const& l, ic::EventList::Record const& r) {
+    return l.run == r.run && l.lumi == r.lumi && l.event == r.event;
+  }
+
+  inline uint64_t const* Block(uint64_t const* bloom, uint32_t n_blocks, uint64_t hash) {
+    return bloom + 8 * ((uint64_t(uint32_t(hash >> 32)) * n_blocks) >> 32);
+  }
+}
+
+namespace ic {
+
+  std::size_t const EventList::npos;
+
+  EventList::EventList() : records_(NULL), bloom_(NULL), n_(0), n_blocks_(0), fields_(kAll) {
+    ;
+  }
+
+  void EventList::Normalise(Record & rec, unsigned fields) {
+    if (!(fields & kRun)) rec.run = 0;
+    if (!(fields & kLumi)) rec.lumi = 0;
+    if (!(fields & kEvent)) rec.event = 0;
+  }
+
+  uint64_t EventList::Hash(Record const& rec) {
+    return Mix(rec.event ^ Mix((uint64_t(rec.run) << 32) | rec.lumi));
+  }
+
+  void EventList::Sort(std::vector<Record> & records) {
+    std::sort(records.begin(), records.end(), RecordLess);
+    records.erase(std::unique(records.begin(), records.end(), RecordEqual), records.end());
+  }
+
+  void EventList::FillBloom(std::vector<Record> const& records, std::vector<uint64_t> & bloom) {
+    uint32_t n_blocks = std::max(std::size_t(1), (records.size() * kBitsPerKey + 511) / 512);
+    bloom.assign(8 * std::size_t(n_blocks), 0);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+      uint64_t hash = Hash(records[i]);
+      uint64_t * block = const_cast<uint64_t *>(Block(&bloom[0], n_blocks, hash));
+      uint64_t bits = Mix(hash);
+      for (unsigned k = 0; k < kHashes; ++k, bits >>= 9) {
+        block[(bits & 511) >> 6] |= uint64_t(1) << (bits & 63);
+      }
+    }
+  }
+
+  bool EventList::Parse(std::vector<std::string> const& inputs, unsigned fields, unsigned min_length,
+                        std::vector<Record> & records) {
+    unsigned n_fields = ((fields & kRun) ? 1 : 0) + ((fields & kLumi) ? 1 : 0) + ((fields & kEvent) ? 1 : 0);
+    records.clear();
+    for (unsigned i = 0; i < inputs.size(); ++i) {
+      std::ifstream file(inputs[i].c_str());
+      if (!file.is_open()) {
+        std::cerr << "Error in <ic::EventList>: Unable to read " << inputs[i] << std::endl;
+        return false;
+      }
+      std::stringstream buffer;
+      buffer << file.rdbuf();
+      std::string const& text = buffer.str();
+      char const* p = text.c_str();
+      char const* end = p + text.size();
+      while (p < end) {
+        while (p < end && std::isspace(*p)) ++p;
+        char const* token = p;
+        while (p < end && !std::isspace(*p)) ++p;
+        if (p == token || unsigned(p - token) < min_length) continue;
+        // Parse up to three ':'-separated numbers
+        uint64_t vals[3] = {0, 0, 0};
+        unsigned n_vals = 0;
+        char const* q = token;
+        bool ok = true;
+        bool in_range = true;
+        while (ok && n_vals < 3) {
+          char * num_end = NULL;
+          // strtoull would accept a sign and wrap a negative value around
+          if (*q == '+') ok = false;
+          if (*q == '-') in_range = false;
+          errno = 0;
+          vals[n_vals++] = strtoull(q, &num_end, 10);
+          if (errno == ERANGE) in_range = false;
+          if (num_end == q) ok = false;
+          q = num_end;
+          if (q == p || *q != ':') break;
+          ++q;
+        }
+        if (!ok || q != p || n_vals != n_fields) {
+          std::cerr << "Error in <ic::EventList>: Unable to parse \"" << std::string(token, p)
+                    << "\" in " << inputs[i] << std::endl;
+          return false;
+        }
+        // Run and lumi numbers are stored in 32 bits
+        unsigned j = 0;
+        if ((fields & kRun) && vals[j++] > 0xFFFFFFFFULL) in_range = false;
+        if ((fields & kLumi) && vals[j++] > 0xFFFFFFFFULL) in_range = false;
+        if (!in_range) {
+          std::cerr << "Error in <ic::EventList>: \"" << std::string(token, p) << "\" in " << inputs[i]
+                    << " is out of range, an exception will be thrown" << std::endl;
+          throw;
+        }
+        Record rec = {0, 0, 0};
+        j = 0;
+        if (fields & kRun) rec.run = vals[j++];
+        if (fields & kLumi) rec.lumi = vals[j++];
+        if (fields & kEvent) rec.event = vals[j++];
+        records.push_back(rec);
+      }
+    }
+    return true;
+  }
+
+  bool EventList::Build(std::vector<std::string> const& inputs, std::string const& output,
+                        unsigned fields, unsigned min_length) {
+    std::vector<Record> records;
+    if (!Parse(inputs, fields, min_length, records)) return false;
+    Sort(records);
+    std::vector<uint64_t> bloom;
+    FillBloom(records, bloom);
+
+    char header[kHeaderSize];
+    std::memset(header, 0, kHeaderSize);
+    uint32_t fields32 = fields;
+    uint32_t n_blocks = bloom.size() / 8;
+    uint64_t n = records.size();
+    std::memcpy(header, kMagic, 8);
+    std::memcpy(header + 8, &fields32, 4);
+    std::memcpy(header + 12, &n_blocks, 4);
+    std::memcpy(header + 16, &n, 8);
+    // Jobs sharing a list may convert it at the same time
+    std::string tmp = CreateTempFile(output);
+    if (tmp.empty()) {
+      std::cerr << "Error in <ic::EventList>: Unable to write " << output << std::endl;
+      return false;
+    }
+    std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(header, kHeaderSize);
+    out.write(reinterpret_cast<char const*>(&bloom[0]), bloom.size() * sizeof(uint64_t));
+    if (n > 0) out.write(reinterpret_cast<char const*>(&records[0]), n * sizeof(Record));
+    out.close();
+    if (!out || std::rename(tmp.c_str(), output.c_str()) != 0) {
+      std::cerr << "Error in <ic::EventList>: Unable to write " << output << std::endl;
+      std::remove(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool EventList::Open(std::string const& path) {
+    records_ = NULL;
+    bloom_ = NULL;
+    n_ = 0;
+    n_blocks_ = 0;
+    own_records_.clear();
+    own_bloom_.clear();
+    if (!file_.Open(path)) return false;
+    uint32_t fields = 0;
+    uint32_t n_blocks = 0;
+    uint64_t n = 0;
+    if (file_.size() < kHeaderSize || std::memcmp(file_.data(), kMagic, 8) != 0) {
+      file_.Close();
+      return false;
+    }
+    std::memcpy(&fields, file_.data() + 8, 4);
+    std::memcpy(&n_blocks, file_.data() + 12, 4);
+    std::memcpy(&n, file_.data() + 16, 8);
+    std::size_t bloom_size = 64 * std::size_t(n_blocks);
+    if (n_blocks == 0 || kHeaderSize + bloom_size + n * sizeof(Record) > file_.size()) {
+      file_.Close();
+      return false;
+    }
+    fields_ = fields;
+    n_blocks_ = n_blocks;
+    bloom_ = reinterpret_cast<uint64_t const*>(file_.data() + kHeaderSize);
+    records_ = reinterpret_cast<Record const*>(file_.data() + kHeaderSize + bloom_size);
+    n_ = n;
+    return true;
+  }
+
+  bool EventList::Read(std::vector<std::string> const& inputs, unsigned fields, unsigned min_length) {
+    std::vector<Record> records;
+    if (!Parse(inputs, fields, min_length, records)) return false;
+    Assign(records, fields);
+    return true;
+  }
+
+  void EventList::Assign(std::vector<Record> const& records, unsigned fields) {
+    file_.Close();
+    fields_ = fields;
+    own_records_ = records;
+    for (std::size_t i = 0; i < own_records_.size(); ++i) Normalise(own_records_[i], fields);
+    Sort(own_records_);
+    FillBloom(own_records_, own_bloom_);
+    n_ = own_records_.size();
+    n_blocks_ = own_bloom_.size() / 8;
+    records_ = n_ ? &own_records_[0] : NULL;
+    bloom_ = &own_bloom_[0];
+  }
+
+  std::size_t EventList::Find(uint32_t run, uint32_t lumi, uint64_t event) const {
+    if (n_ == 0) return npos;
+    Record key = {run, lumi, event};
+    Normalise(key, fields_);
+    uint64_t hash = Hash(key);
+    uint64_t const* block = Block(bloom_, n_blocks_, hash);
+    uint64_t bits = Mix(hash);
+    for (unsigned k = 0; k < kHashes; ++k, bits >>= 9) {
+      if (!(block[(bits & 511) >> 6] & (uint64_t(1) << (bits & 63)))) return npos;
+    }
+    Record const* end = records_ + n_;
+    Record const* rec = std::lower_bound(records_, end, key, RecordLess);
+    if (rec == end || !RecordEqual(*rec, key)) return npos;
+    return rec - records_;
+  }
+
+}
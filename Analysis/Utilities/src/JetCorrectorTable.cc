@@ -0,0 +1,310 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/JetCorrectorTable.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <stdint.h>
+
+namespace {
+  unsigned const kMaxParVars = 4;
+
+  std::vector<std::string> Tokens(std::string const& line) {
+    std::vector<std::string> tokens;
+    std::istringstream in(line);
+    std::string token;
+    while (in >> token) tokens.push_back(token);
+    return tokens;
+  }
+
+  bool ToFloat(std::string const& str, float & val) {
+    char * end = NULL;
+    val = std::strtod(str.c_str(), &end);
+    return end != str.c_str() && *end == '\0';
+  }
+
+  bool ToUnsigned(std::string const& str, unsigned & val) {
+    char * end = NULL;
+    val = std::strtoul(str.c_str(), &end, 10);
+    return end != str.c_str() && *end == '\0';
+  }
+
+  inline uint64_t Mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+}
+
+namespace ic {
+
+  JetCorrectorTable::JetCorrectorTable() : memo_size_(65536), memo_hits_(0), memo_misses_(0) {
+    ;
+  }
+
+  bool JetCorrectorTable::Key::operator==(Key const& r) const {
+    return std::memcmp(v, r.v, sizeof(v)) == 0;
+  }
+
+  std::size_t JetCorrectorTable::Hash(Key const& key) {
+    uint32_t bits[kNVars];
+    std::memcpy(bits, key.v, sizeof(bits));
+    uint64_t h = 0;
+    for (unsigned i = 0; i < kNVars; ++i) h = Mix(h ^ bits[i]);
+    return h;
+  }
+
+  void JetCorrectorTable::set_memo_size(std::size_t memo_size) {
+    memo_size_ = 0;
+    if (memo_size > 0) {
+      memo_size_ = 1;
+      while (memo_size_ < memo_size) memo_size_ *= 2;
+    }
+    memo_.clear();
+    memo_factors_.clear();
+  }
+
+  bool JetCorrectorTable::AddLevel(std::string const& file) {
+    std::ifstream in(file.c_str());
+    if (!in.is_open()) {
+      std::cerr << "Error in <ic::JetCorrectorTable>: Unable to read " << file << std::endl;
+      return false;
+    }
+    char const* var_names[kNVars] = {"JetEta", "JetPt", "JetE", "JetA", "Rho"};
+    Level level;
+    level.sorted = false;
+    bool have_definitions = false;
+    std::string line;
+    while (std::getline(in, line)) {
+      std::vector<std::string> tokens = Tokens(line);
+      if (tokens.empty() || tokens[0][0] == '#') continue;
+      if (!have_definitions) {
+        // {n_bin bin_vars... n_par par_vars... formula type level}
+        std::size_t open = line.find('{');
+        std::size_t close = line.rfind('}');
+        if (open == line.npos || close == line.npos || close < open) {
+          std::cerr << "Error in <ic::JetCorrectorTable>: No definitions line in " << file << std::endl;
+          return false;
+        }
+        tokens = Tokens(line.substr(open + 1, close - open - 1));
+        unsigned n_bin = 0;
+        unsigned n_par = 0;
+        if (tokens.size() < 1 || !ToUnsigned(tokens[0], n_bin) || tokens.size() < n_bin + 2 ||
+            !ToUnsigned(tokens[n_bin + 1], n_par) || tokens.size() < n_bin + n_par + 5 ||
+            n_par > kMaxParVars) {
+          std::cerr << "Error in <ic::JetCorrectorTable>: Invalid definitions line in " << file << std::endl;
+          return false;
+        }
+        for (unsigned i = 0; i < n_bin + n_par; ++i) {
+          std::string const& name = tokens[i < n_bin ? 1 + i : 2 + i];
+          unsigned v = 0;
+          while (v < kNVars && name != var_names[v]) ++v;
+          if (v == kNVars) {
+            std::cerr << "Error in <ic::JetCorrectorTable>: Unsupported variable " << name << " in " << file << std::endl;
+            return false;
+          }
+          (i < n_bin ? level.bin_vars : level.par_vars).push_back(v);
+        }
+        std::string formula;
+        for (unsigned i = n_bin + n_par + 2; i + 2 < tokens.size(); ++i) formula += tokens[i];
+        level.name = tokens.back();
+        if (tokens[tokens.size() - 2] != "Correction") {
+          std::cerr << "Error in <ic::JetCorrectorTable>: Unsupported level type " << tokens[tokens.size() - 2]
+                    << " in " << file << std::endl;
+          return false;
+        }
+        if (!level.formula.Compile(formula)) {
+          std::cerr << "Error in <ic::JetCorrectorTable>: Unable to compile \"" << formula << "\" in "
+                    << file << ": " << level.formula.error() << std::endl;
+          return false;
+        }
+        std::vector<std::string> const& vars = level.formula.variables();
+        for (unsigned i = 0; i < vars.size(); ++i) {
+          // TFormula names the variables x, y, z, t and the parameters [0], [1], ...
+          unsigned col = 0;
+          if (vars[i][0] == '[') {
+            col = kMaxParVars + std::atoi(vars[i].c_str() + 1);
+          } else {
+            char const* xyzt = "xyzt";
+            while (col < kMaxParVars && vars[i] != std::string(1, xyzt[col])) ++col;
+          }
+          if (col < kMaxParVars ? col >= n_par : vars[i][0] != '[') {
+            std::cerr << "Error in <ic::JetCorrectorTable>: Unknown variable " << vars[i] << " in " << file << std::endl;
+            return false;
+          }
+          level.columns.push_back(col);
+        }
+        have_definitions = true;
+        continue;
+      }
+      // bin_min bin_max (per bin variable) n_values values...
+      unsigned n_bin = level.bin_vars.size();
+      unsigned n_values = 0;
+      bool ok = tokens.size() >= 2 * n_bin + 1 && ToUnsigned(tokens[2 * n_bin], n_values) &&
+                tokens.size() == 2 * n_bin + 1 + n_values && n_values >= 2 * level.par_vars.size();
+      float val = 0.;
+      for (unsigned i = 0; ok && i < n_bin; ++i) {
+        ok = ToFloat(tokens[2 * i], val);
+        level.bin_min.push_back(val);
+        ok = ok && ToFloat(tokens[2 * i + 1], val);
+        level.bin_max.push_back(val);
+      }
+      level.offsets.push_back(level.params.size());
+      level.n_params.push_back(n_values);
+      for (unsigned i = 0; ok && i < n_values; ++i) {
+        ok = ToFloat(tokens[2 * n_bin + 1 + i], val);
+        level.params.push_back(val);
+      }
+      if (!ok) {
+        std::cerr << "Error in <ic::JetCorrectorTable>: Invalid record \"" << line << "\" in " << file << std::endl;
+        return false;
+      }
+    }
+    if (!have_definitions || level.offsets.empty()) {
+      std::cerr << "Error in <ic::JetCorrectorTable>: No records in " << file << std::endl;
+      return false;
+    }
+    // One bin variable with ordered, non-overlapping bins can use a binary
+    // search, which finds the same bin as the first-match linear search
+    level.sorted = level.bin_vars.size() == 1;
+    for (unsigned i = 0; level.sorted && i < level.bin_min.size(); ++i) {
+      if (level.bin_max[i] < level.bin_min[i]) level.sorted = false;
+      if (i + 1 < level.bin_min.size() && level.bin_min[i + 1] < level.bin_max[i]) level.sorted = false;
+    }
+    levels_.push_back(level);
+    memo_.clear();
+    memo_factors_.clear();
+    return true;
+  }
+
+  int JetCorrectorTable::FindBin(Level const& level, float const* vals) const {
+    unsigned n_bin = level.bin_vars.size();
+    unsigned n_records = level.offsets.size();
+    if (level.sorted) {
+      float x = vals[0];
+      std::vector<float>::const_iterator it = std::upper_bound(level.bin_min.begin(), level.bin_min.end(), x);
+      if (it == level.bin_min.begin()) return -1;
+      unsigned i = (it - level.bin_min.begin()) - 1;
+      return (x >= level.bin_min[i] && x < level.bin_max[i]) ? int(i) : -1;
+    }
+    for (unsigned i = 0; i < n_records; ++i) {
+      unsigned j = 0;
+      while (j < n_bin && vals[j] >= level.bin_min[i * n_bin + j] && vals[j] < level.bin_max[i * n_bin + j]) ++j;
+      if (j == n_bin) return i;
+    }
+    return -1;
+  }
+
+  void JetCorrectorTable::Correct(std::vector<float> * vars, std::size_t n, float * factors) {
+    for (unsigned l = 0; l < levels_.size(); ++l) {
+      Level const& level = levels_[l];
+      float * out = factors + l * n;
+      // Find the bin of each jet, jets outside every bin are not corrected
+      in_bin_.clear();
+      bins_.clear();
+      float vals[kNVars];
+      for (std::size_t j = 0; j < n; ++j) {
+        out[j] = 1.;
+        for (unsigned b = 0; b < level.bin_vars.size(); ++b) vals[b] = vars[level.bin_vars[b]][j];
+        int bin = FindBin(level, vals);
+        if (bin < 0) continue;
+        in_bin_.push_back(j);
+        bins_.push_back(bin);
+      }
+      // Gather the clamped variables and the bin parameters as columns
+      std::size_t k = in_bin_.size();
+      if (k > 0) {
+        unsigned n_cols = level.columns.size();
+        unsigned n_par = level.par_vars.size();
+        if (cols_.size() < n_cols) cols_.resize(n_cols);
+        std::vector<double const*> ptrs(n_cols);
+        for (unsigned c = 0; c < n_cols; ++c) {
+          std::vector<double> & col = cols_[c];
+          col.resize(k);
+          unsigned src = level.columns[c];
+          if (src < kMaxParVars) {
+            std::vector<float> const& var = vars[level.par_vars[src]];
+            for (std::size_t q = 0; q < k; ++q) {
+              float const* lim = &level.params[level.offsets[bins_[q]] + 2 * src];
+              float x = var[in_bin_[q]];
+              col[q] = (x < lim[0]) ? lim[0] : ((x > lim[1]) ? lim[1] : x);
+            }
+          } else {
+            unsigned idx = 2 * n_par + src - kMaxParVars;
+            for (std::size_t q = 0; q < k; ++q) {
+              col[q] = idx < level.n_params[bins_[q]] ? level.params[level.offsets[bins_[q]] + idx] : 0.;
+            }
+          }
+          ptrs[c] = &col[0];
+        }
+        result_.resize(k);
+        level.formula.Evaluate(ptrs, k, &result_[0]);
+        for (std::size_t q = 0; q < k; ++q) out[in_bin_[q]] = result_[q];
+      }
+      // Scale the jets before the next level
+      std::vector<float> & pt = vars[kJetPt];
+      std::vector<float> & energy = vars[kJetE];
+      float const* prev = l > 0 ? factors + (l - 1) * n : NULL;
+      for (std::size_t j = 0; j < n; ++j) {
+        float scale = out[j];
+        pt[j] *= scale;
+        energy[j] *= scale;
+        if (prev) out[j] = prev[j] * scale;
+      }
+    }
+  }
+
+  void JetCorrectorTable::Evaluate(std::size_t n, double const* pt, double const* eta, double const* energy,
+                                   double const* area, double rho, float * factors) {
+    unsigned n_levels = levels_.size();
+    if (memo_size_ > 0 && memo_.size() != memo_size_) {
+      Slot empty;
+      std::memset(&empty, 0, sizeof(empty));
+      memo_.assign(memo_size_, empty);
+      memo_factors_.assign(memo_size_ * n_levels, 1.);
+    }
+    todo_.clear();
+    todo_keys_.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+      Key key;
+      key.v[kJetEta] = eta[i];
+      key.v[kJetPt] = pt[i];
+      key.v[kJetE] = energy[i];
+      key.v[kJetA] = area[i];
+      key.v[kRho] = rho;
+      if (memo_size_ > 0) {
+        std::size_t slot = Hash(key) & (memo_size_ - 1);
+        if (memo_[slot].used && memo_[slot].key == key) {
+          float const* memo = &memo_factors_[slot * n_levels];
+          for (unsigned l = 0; l < n_levels; ++l) factors[l * n + i] = memo[l];
+          ++memo_hits_;
+          continue;
+        }
+      }
+      ++memo_misses_;
+      todo_.push_back(i);
+      todo_keys_.push_back(key);
+    }
+    std::size_t m = todo_.size();
+    if (m == 0) return;
+    for (unsigned v = 0; v < kNVars; ++v) {
+      vars_[v].resize(m);
+      for (std::size_t j = 0; j < m; ++j) vars_[v][j] = todo_keys_[j].v[v];
+    }
+    todo_factors_.resize(n_levels * m);
+    Correct(vars_, m, &todo_factors_[0]);
+    for (std::size_t j = 0; j < m; ++j) {
+      for (unsigned l = 0; l < n_levels; ++l) factors[l * n + todo_[j]] = todo_factors_[l * m + j];
+      if (memo_size_ == 0) continue;
+      std::size_t slot = Hash(todo_keys_[j]) & (memo_size_ - 1);
+      memo_[slot].key = todo_keys_[j];
+      memo_[slot].used = true;
+      for (unsigned l = 0; l < n_levels; ++l) memo_factors_[slot * n_levels + l] = todo_factors_[l * m + j];
+    }
+  }
+
+}
@@ -0,0 +1,60 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/MappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <vector>
+
+namespace ic {
+
+  MappedFile::MappedFile() : data_(NULL), size_(0) {
+    ;
+  }
+
+  MappedFile::MappedFile(std::string const& path) : data_(NULL), size_(0) {
+    Open(path);
+  }
+
+  MappedFile::~MappedFile() {
+    Close();
+  }
+
+  bool MappedFile::Open(std::string const& path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      return false;
+    }
+    void * addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+    data_ = static_cast<char const*>(addr);
+    size_ = st.st_size;
+    return true;
+  }
+
+  void MappedFile::Close() {
+    if (data_) munmap(const_cast<char *>(data_), size_);
+    data_ = NULL;
+    size_ = 0;
+  }
+
+  std::string CreateTempFile(std::string const& path) {
+    std::string name = path + ".XXXXXX";
+    std::vector<char> buf(name.begin(), name.end());
+    buf.push_back('\0');
+    int fd = mkstemp(&buf[0]);
+    if (fd < 0) return "";
+    // mkstemp only gives the owner access, but the final file should be
+    // readable by other jobs as before
+    fchmod(fd, 0644);
+    close(fd);
+    return std::string(&buf[0]);
+  }
+
+}
@@ -2,6 +2,8 @@
 #include <vector>
 #include <sstream>
 #include <string>
+#include <cmath>
+#include <algorithm>
 #include "TFile.h"
 #include "TTree.h"
 #include "TCanvas.h"
@@ -11,7 +13,7 @@
 #include "TProfile.h"
 #include "TF1.h"
 #include "TMath.h"
-#include "TRandom1.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
 
 //
 // ** apply phil's recoil corrections **
@@ -29,9 +31,40 @@
 //using namespace std;
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
-  RecoilCorrector::RecoilCorrector(std::string iNameZDat,std::string iPrefix, int iSeed) {
+TabulatedTF1::TabulatedTF1(TF1 *iFunc, double iTolerance, unsigned iMaxPoints) :
+  fFunc(iFunc), fXMin(0), fXMax(0), fInvStep(0), fMaxError(0) {
+  double lXMin = iFunc->GetXmin();
+  double lXMax = iFunc->GetXmax();
+  if(iTolerance <= 0 || !(lXMax > lXMin)) return;
+  //Halve the step until the error half-way and a quarter of the way between nodes is small enough
+  for(unsigned lN = 65; lN <= iMaxPoints; lN = 2*lN-1) {
+    double lStep = (lXMax-lXMin)/(lN-1);
+    fY.resize(lN);
+    for(unsigned i0 = 0; i0 < lN; i0++) fY[i0] = iFunc->Eval(lXMin+i0*lStep);
+    fXMin = lXMin; fXMax = lXMax; fInvStep = 1./lStep;
+    fMaxError = 0;
+    for(unsigned i0 = 0; i0 < lN-1; i0++) {
+      for(unsigned i1 = 1; i1 < 4; i1++) {
+	double lX     = lXMin + (i0+0.25*i1)*lStep;
+	double lExact = iFunc->Eval(lX);
+	double lErr   = fabs(Eval(lX)-lExact)/std::max(fabs(lExact),1.);
+	if(lErr != lErr) lErr = HUGE_VAL;
+	fMaxError = std::max(fMaxError,lErr);
+      }
+    }
+    if(fMaxError <= iTolerance) return;
+  }
+  //Not smooth enough to tabulate, always use the TF1
+  fXMax = fXMin;
+  fY.clear();
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------------
+  RecoilCorrector::RecoilCorrector(std::string iNameZDat,std::string iPrefix, int iSeed, double iTolerance) {
 
-  fRandom = new TRandom1(iSeed);
+  fRandom = new ic::CounterRandom(uint32_t(iSeed));
+  fRun = 0; fLumi = 0; fEvent = 0;
+  fTolerance = iTolerance;
 
   // get fits for Z data
   readRecoil(fF1U1Fit,fF1U1RMSSMFit,fF1U1RMS1Fit,fF1U1RMS2Fit,fF1U2Fit,fF1U2RMSSMFit,fF1U2RMS1Fit,fF1U2RMS2Fit,iNameZDat,iPrefix);
@@ -40,9 +73,11 @@
   fId = 0; fJet = 0;
 }
 
-RecoilCorrector::RecoilCorrector(std::string iNameZ, int iSeed) {
+RecoilCorrector::RecoilCorrector(std::string iNameZ, int iSeed, double iTolerance) {
 
-  fRandom = new TRandom1(iSeed);
+  fRandom = new ic::CounterRandom(uint32_t(iSeed));
+  fRun = 0; fLumi = 0; fEvent = 0;
+  fTolerance = iTolerance;
   // get fits for Z data
   readRecoil(fF1U1Fit,fF1U1RMSSMFit,fF1U1RMS1Fit,fF1U1RMS2Fit,fF1U2Fit,fF1U2RMSSMFit,fF1U2RMS1Fit,fF1U2RMS2Fit,iNameZ,"PF");
   readRecoil(fF2U1Fit,fF2U1RMSSMFit,fF2U1RMS1Fit,fF2U1RMS2Fit,fF2U2Fit,fF2U2RMSSMFit,fF2U2RMS1Fit,fF2U2RMS2Fit,iNameZ,"TK");
@@ -51,6 +86,9 @@ RecoilCorrector::RecoilCorrector(std::string iNameZ, int iSeed) {
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
+void RecoilCorrector::setEvent(unsigned iRun, unsigned iLumi, unsigned long long iEvent) {
+  fRun = iRun; fLumi = iLumi; fEvent = iEvent;
+}
 void RecoilCorrector::addDataFile(std::string iNameData) { 
   readRecoil(fD1U1Fit,fD1U1RMSSMFit,fD1U1RMS1Fit,fD1U1RMS2Fit,fD1U2Fit,fD1U2RMSSMFit,fD1U2RMS1Fit,fD1U2RMS2Fit,iNameData,"PF");
   readRecoil(fD2U1Fit,fD2U1RMSSMFit,fD2U1RMS1Fit,fD2U1RMS2Fit,fD2U2Fit,fD2U2RMSSMFit,fD2U2RMS1Fit,fD2U2RMS2Fit,iNameData,"TK");
@@ -66,7 +104,7 @@ void RecoilCorrector::addMCFile  (std::string iNameMC) {
 void RecoilCorrector::CorrectAll(double &met, double &metphi, double lGenPt, double lGenPhi, double lepPt, double lepPhi,double &iU1,double &iU2,double iFluc,double iScale,int njet) {
   fJet = njet; if(njet > 2) fJet = 2;  
   if(fJet >= int(fF1U1Fit.size())) fJet = 0; 
-  fRandom->SetSeed((int)((lGenPhi+4)*100000));
+  fRandom->SetStream(fRun,fLumi,fEvent,(int)((lGenPhi+4)*100000),"recoil");
   metDistribution(met,metphi,lGenPt,lGenPhi,lepPt,lepPhi,fRandom,
 		  fF1U1Fit     [fJet],
 		  fF1U1RMSSMFit[fJet],
@@ -82,7 +120,7 @@ void RecoilCorrector::CorrectAll(double &met, double &metphi, double lGenPt, dou
 void RecoilCorrector::CorrectType1(double &met, double &metphi, double lGenPt, double lGenPhi, double lepPt, double lepPhi,double &iU1,double &iU2,double iFluc,double iScale,int njet) {
   fJet = njet; if(njet > 2) fJet = 2;  
   if(fJet >= int(fF1U1Fit.size())) fJet = 0; 
-  fRandom->SetSeed((int)((lGenPhi+4)*100000));
+  fRandom->SetStream(fRun,fLumi,fEvent,(int)((lGenPhi+4)*100000),"recoil");
   metDistributionType1(met,metphi,lGenPt,lGenPhi,lepPt,lepPhi,fRandom,
 		       fD1U1Fit     [fJet],fM1U1Fit     [fJet],
 		       fD1U1RMSSMFit[fJet],fM1U1RMSSMFit[fJet],
@@ -110,7 +148,7 @@ void RecoilCorrector::Correct(double &pfmet, double &pfmetphi, double &trkmet, d
   double lU1 = 0; double lU2 = 0;
   fJet = njet; if(njet > 2) fJet = 2;  
   if(fJet > int(fF1U1Fit.size())) fJet = 0; 
-  fRandom->SetSeed((int)((lGenPhi+4)*100000));
+  fRandom->SetStream(fRun,fLumi,fEvent,(int)((lGenPhi+4)*100000),"recoil");
   metDistribution(pfmet,pfmetphi,trkmet,trkmetphi,lGenPt,lGenPhi,lepPt,lepPhi,fRandom,
 		  fF1U1Fit     [fJet],fF2U1Fit     [fJet],
 		  fF1U1RMSSMFit[fJet],fF2U1RMSSMFit[fJet],
@@ -150,22 +188,22 @@ void RecoilCorrector::CorrectU1U2(double &iPFU1, double &iPFU2, double &iTKU1, d
 double RecoilCorrector::CorrVal(double iPt, double iVal, Recoil iType) { 
   if(fId == 0 || fId == 1) return iVal;
   switch(iType) {
-  case PFU1   : return iVal*(fD1U1Fit     [fJet]->Eval(iPt)/fM1U1Fit     [fJet]->Eval(iPt));
-  case PFMSU1 : return iVal*(fD1U1RMSSMFit[fJet]->Eval(iPt)/fM1U1RMSSMFit[fJet]->Eval(iPt));
-  case PFS1U1 : return iVal*(fD1U1RMS1Fit [fJet]->Eval(iPt)/fM1U1RMS1Fit [fJet]->Eval(iPt));
-  case PFS2U1 : return iVal*(fD1U1RMS2Fit [fJet]->Eval(iPt)/fM1U1RMS2Fit [fJet]->Eval(iPt));
+  case PFU1   : return iVal*(eval(fD1U1Fit     [fJet],iPt)/eval(fM1U1Fit     [fJet],iPt));
+  case PFMSU1 : return iVal*(eval(fD1U1RMSSMFit[fJet],iPt)/eval(fM1U1RMSSMFit[fJet],iPt));
+  case PFS1U1 : return iVal*(eval(fD1U1RMS1Fit [fJet],iPt)/eval(fM1U1RMS1Fit [fJet],iPt));
+  case PFS2U1 : return iVal*(eval(fD1U1RMS2Fit [fJet],iPt)/eval(fM1U1RMS2Fit [fJet],iPt));
   case PFU2   : return 0;
-  case PFMSU2 : return iVal*(fD1U2RMSSMFit[fJet]->Eval(iPt)/fM1U2RMSSMFit[fJet]->Eval(iPt));
-  case PFS1U2 : return iVal*(fD1U2RMS1Fit [fJet]->Eval(iPt) /fM1U2RMS1Fit[fJet]->Eval(iPt));
-  case PFS2U2 : return iVal*(fD1U2RMS2Fit [fJet]->Eval(iPt) /fM1U2RMS2Fit[fJet]->Eval(iPt));
-  case TKU1   : return iVal*(fD2U1Fit     [fJet]->Eval(iPt)/fM2U1Fit     [fJet]->Eval(iPt));
-  case TKMSU1 : return iVal*(fD2U1RMSSMFit[fJet]->Eval(iPt)/fM2U1RMSSMFit[fJet]->Eval(iPt));
-  case TKS1U1 : return iVal*(fD2U1RMS1Fit [fJet]->Eval(iPt) /fM2U1RMS1Fit[fJet]->Eval(iPt));
-  case TKS2U1 : return iVal*(fD2U1RMS2Fit [fJet]->Eval(iPt) /fM2U1RMS2Fit[fJet]->Eval(iPt));
+  case PFMSU2 : return iVal*(eval(fD1U2RMSSMFit[fJet],iPt)/eval(fM1U2RMSSMFit[fJet],iPt));
+  case PFS1U2 : return iVal*(eval(fD1U2RMS1Fit [fJet],iPt) /eval(fM1U2RMS1Fit[fJet],iPt));
+  case PFS2U2 : return iVal*(eval(fD1U2RMS2Fit [fJet],iPt) /eval(fM1U2RMS2Fit[fJet],iPt));
+  case TKU1   : return iVal*(eval(fD2U1Fit     [fJet],iPt)/eval(fM2U1Fit     [fJet],iPt));
+  case TKMSU1 : return iVal*(eval(fD2U1RMSSMFit[fJet],iPt)/eval(fM2U1RMSSMFit[fJet],iPt));
+  case TKS1U1 : return iVal*(eval(fD2U1RMS1Fit [fJet],iPt) /eval(fM2U1RMS1Fit[fJet],iPt));
+  case TKS2U1 : return iVal*(eval(fD2U1RMS2Fit [fJet],iPt) /eval(fM2U1RMS2Fit[fJet],iPt));
   case TKU2   : return 0;
-  case TKMSU2 : return iVal*(fD2U2RMSSMFit[fJet]->Eval(iPt)/fM2U2RMSSMFit[fJet]->Eval(iPt));
-  case TKS1U2 : return iVal*(fD2U2RMS1Fit [fJet]->Eval(iPt) /fM2U2RMS1Fit[fJet]->Eval(iPt));
-  case TKS2U2 : return iVal*(fD2U2RMS2Fit [fJet]->Eval(iPt) /fM2U2RMS2Fit[fJet]->Eval(iPt));
+  case TKMSU2 : return iVal*(eval(fD2U2RMSSMFit[fJet],iPt)/eval(fM2U2RMSSMFit[fJet],iPt));
+  case TKS1U2 : return iVal*(eval(fD2U2RMS1Fit [fJet],iPt) /eval(fM2U2RMS1Fit[fJet],iPt));
+  case TKS2U2 : return iVal*(eval(fD2U2RMS2Fit [fJet],iPt) /eval(fM2U2RMS2Fit[fJet],iPt));
   }
   return iVal;
 }
@@ -215,6 +253,8 @@ void RecoilCorrector::readRecoil(std::vector<TF1*> &iU1Fit,std::vector<TF1*> &iU
     lNJet++; lSS << iPrefix << "u1Mean_" << lNJet;
   }
   lFile->Close();
+  tabulate(iU1Fit); tabulate(iU1MRMSFit); tabulate(iU1RMS1Fit); tabulate(iU1RMS2Fit);
+  tabulate(iU2Fit); tabulate(iU2MRMSFit); tabulate(iU2RMS1Fit); tabulate(iU2RMS2Fit);
 }
 //-----------------------------------------------------------------------------------------------------------------------------------------
 void RecoilCorrector::readCorr(std::string iName,
@@ -236,10 +276,20 @@ void RecoilCorrector::readCorr(std::string iName,
     lNJet++; lSS   << "PFu1Mean_" << lNJet;
   }
   lFile->Close();
+  tabulate(iF1U1U2Corr);   tabulate(iF2U1U2Corr); tabulate(iF1F2U1Corr); tabulate(iF1F2U2Corr);
+  tabulate(iF1F2U1U2Corr); tabulate(iF1F2U2U1Corr);
+}
+void RecoilCorrector::tabulate(std::vector<TF1*> const& iFits) {
+  if(fTolerance <= 0) return;
+  for(unsigned i0 = 0; i0 < iFits.size(); i0++) {
+    if(iFits[i0] == 0 || fTables.count(iFits[i0])) continue;
+    TabulatedTF1 lTable(iFits[i0],fTolerance);
+    if(lTable.isTabulated()) fTables.insert(std::make_pair(iFits[i0],lTable));
+  }
 }
 //-----------------------------------------------------------------------------------------------------------------------------------------
 void RecoilCorrector::metDistribution(double &iMet,double &iMPhi,double iGenPt,double iGenPhi,
-		                      double iLepPt,double iLepPhi,TRandom1 *iRand,
+		                      double iLepPt,double iLepPhi,TRandom *iRand,
 		                      TF1 *iU1RZDatFit,
 		                      TF1 *iU1MSZDatFit, 
 		                      TF1 *iU1S1ZDatFit,
@@ -251,14 +301,14 @@ void RecoilCorrector::metDistribution(double &iMet,double &iMPhi,double iGenPt,d
 				      double &iU1, double &iU2,
 		                      double iFluc,double iScale) {
   double lRescale  = sqrt((TMath::Pi())/2.);		     
-  double pU1       = CorrVal(iGenPt,iU1RZDatFit->Eval(iGenPt),PFU1); //iU1RZDatFit->Eval(iGenPt);//CorrVal(iGenPt,iU1RZDatFit->Eval(iGenPt),PFU1);
+  double pU1       = CorrVal(iGenPt,eval(iU1RZDatFit,iGenPt),PFU1); //iU1RZDatFit->Eval(iGenPt);//CorrVal(iGenPt,iU1RZDatFit->Eval(iGenPt),PFU1);
   double pU2       = 0; //Right guys are for cumulants => code deleted
-  double pFrac1    = CorrVal(iGenPt,iU1MSZDatFit->Eval(iGenPt),PFMSU1)*lRescale;
-  double pFrac2    = CorrVal(iGenPt,iU2MSZDatFit->Eval(iGenPt),PFMSU2)*lRescale;
-  double pSigma1_1 = CorrVal(iGenPt,iU1S1ZDatFit->Eval(iGenPt),PFS1U1)*lRescale*CorrVal(iGenPt,iU1MSZDatFit->Eval(iGenPt),PFMSU1);
-  double pSigma1_2 = CorrVal(iGenPt,iU1S2ZDatFit->Eval(iGenPt),PFS2U1)*lRescale*CorrVal(iGenPt,iU1MSZDatFit->Eval(iGenPt),PFMSU1);
-  double pSigma2_1 = CorrVal(iGenPt,iU2S1ZDatFit->Eval(iGenPt),PFS1U2)*lRescale*CorrVal(iGenPt,iU2MSZDatFit->Eval(iGenPt),PFS1U2);
-  double pSigma2_2 = CorrVal(iGenPt,iU2S2ZDatFit->Eval(iGenPt),PFS2U2)*lRescale*CorrVal(iGenPt,iU2MSZDatFit->Eval(iGenPt),PFS2U2);
+  double pFrac1    = CorrVal(iGenPt,eval(iU1MSZDatFit,iGenPt),PFMSU1)*lRescale;
+  double pFrac2    = CorrVal(iGenPt,eval(iU2MSZDatFit,iGenPt),PFMSU2)*lRescale;
+  double pSigma1_1 = CorrVal(iGenPt,eval(iU1S1ZDatFit,iGenPt),PFS1U1)*lRescale*CorrVal(iGenPt,eval(iU1MSZDatFit,iGenPt),PFMSU1);
+  double pSigma1_2 = CorrVal(iGenPt,eval(iU1S2ZDatFit,iGenPt),PFS2U1)*lRescale*CorrVal(iGenPt,eval(iU1MSZDatFit,iGenPt),PFMSU1);
+  double pSigma2_1 = CorrVal(iGenPt,eval(iU2S1ZDatFit,iGenPt),PFS1U2)*lRescale*CorrVal(iGenPt,eval(iU2MSZDatFit,iGenPt),PFS1U2);
+  double pSigma2_2 = CorrVal(iGenPt,eval(iU2S2ZDatFit,iGenPt),PFS2U2)*lRescale*CorrVal(iGenPt,eval(iU2MSZDatFit,iGenPt),PFS2U2);
   //double pMU1      = fabs(iU1RZDatFit->GetParameter(1));
   
   //Uncertainty propagation
@@ -293,7 +343,7 @@ void RecoilCorrector::metDistribution(double &iMet,double &iMPhi,double iGenPt,d
   pSigma1_1 = ((pVal0 < pFrac1)*(pSigma1_1)+(pVal0 > pFrac1)*(pSigma1_2)); 
   pSigma2_1 = ((pVal1 < pFrac2)*(pSigma2_1)+(pVal1 > pFrac2)*(pSigma2_2)); 
   
-  double lU1U2   = iU1U2Corr->Eval(iGenPt)*0.5;
+  double lU1U2   = eval(iU1U2Corr,iGenPt)*0.5;
   //cout << "===> " << lU1U2 << " -- " << iGenPt << endl;
   double pVal1_1 = correlatedSeed(pSigma1_1,lU1U2,0.,0.,pCorr1,pCorr2,0.,0.);
   double pVal2_1 = correlatedSeed(pSigma2_1,lU1U2,0.,0.,pCorr2,pCorr1,0.,0.);
@@ -313,7 +363,7 @@ void RecoilCorrector::metDistribution(double &iMet,double &iMPhi,double iGenPt,d
   return;
 }
 void RecoilCorrector::metDistributionType1(double &iMet,double &iMPhi,double iGenPt,double iGenPhi,
-					   double iLepPt,double iLepPhi,TRandom1 *iRand,
+					   double iLepPt,double iLepPhi,TRandom *iRand,
 					   TF1 *iU1RZDatFit,  TF1 *iU1RZMCFit,
 					   TF1 *iU1MSZDatFit, TF1 *iU1MSZMCFit, 
 					   TF1 *iU2MSZDatFit, TF1 *iU2MSZMCFit, 		   		   
@@ -321,12 +371,12 @@ void RecoilCorrector::metDistributionType1(double &iMet,double &iMPhi,double iGe
 					   double &iU1,double &iU2,double iFluc,double iScale) {
   if(iLepPt < 4) return;
   double lRescale  = sqrt((TMath::Pi())/2.);		     
-  double pU1       = iU1RZDatFit->Eval(iGenPt)/iU1RZMCFit->Eval(iGenPt);
+  double pU1       = eval(iU1RZDatFit,iGenPt)/eval(iU1RZMCFit,iGenPt);
   double pU2       = 0; //Right guys are for cumulants => code deleted
-  double pFrac1    = std::max( iU1MSZDatFit->Eval(iGenPt)*iU1MSZDatFit->Eval(iGenPt)
-			  -iU1MSZMCFit->Eval(iGenPt)*iU1MSZMCFit ->Eval(iGenPt),0.);
-  double pFrac2    = std::max( iU2MSZDatFit->Eval(iGenPt)*iU2MSZDatFit->Eval(iGenPt)
-			  -iU2MSZMCFit->Eval(iGenPt)*iU2MSZMCFit ->Eval(iGenPt),0.);
+  double pFrac1    = std::max( eval(iU1MSZDatFit,iGenPt)*eval(iU1MSZDatFit,iGenPt)
+			  -eval(iU1MSZMCFit,iGenPt)*eval(iU1MSZMCFit,iGenPt),0.);
+  double pFrac2    = std::max( eval(iU2MSZDatFit,iGenPt)*eval(iU2MSZDatFit,iGenPt)
+			  -eval(iU2MSZMCFit,iGenPt)*eval(iU2MSZMCFit,iGenPt),0.);
   pFrac1 = sqrt(pFrac1)*lRescale;
   pFrac2 = sqrt(pFrac2)*lRescale;
   
@@ -400,27 +450,27 @@ void RecoilCorrector::metDistributionType2(double &iMet,double &iMPhi,double iGe
 					   TF1 *iU2S2ZDatFit, TF1 *iU2S2ZMCFit,  		   		   
 					   TF1 *iU1U2ZDatCorr,TF1 *iU1U2ZMCCorr,
 					   double &iU1,double &iU2,double iFluc,double iScale) {
-  double pDefU1    = iU1Default->Eval(iGenPt);
+  double pDefU1    = eval(iU1Default,iGenPt);
   double lRescale  = sqrt((TMath::Pi())/2.);		     
-  double pDU1       = iU1RZDatFit ->Eval(iGenPt);
+  double pDU1       = eval(iU1RZDatFit,iGenPt);
   //double pDU2       = 0; sPM
-  double pDFrac1    = iU1MSZDatFit->Eval(iGenPt)*lRescale;
-  double pDSigma1_1 = iU1S1ZDatFit->Eval(iGenPt)*pDFrac1;
-  double pDSigma1_2 = iU1S2ZDatFit->Eval(iGenPt)*pDFrac1;
-  double pDFrac2    = iU2MSZDatFit->Eval(iGenPt)*lRescale;
-  double pDSigma2_1 = iU2S1ZDatFit->Eval(iGenPt)*pDFrac2;
-  double pDSigma2_2 = iU2S2ZDatFit->Eval(iGenPt)*pDFrac2;
+  double pDFrac1    = eval(iU1MSZDatFit,iGenPt)*lRescale;
+  double pDSigma1_1 = eval(iU1S1ZDatFit,iGenPt)*pDFrac1;
+  double pDSigma1_2 = eval(iU1S2ZDatFit,iGenPt)*pDFrac1;
+  double pDFrac2    = eval(iU2MSZDatFit,iGenPt)*lRescale;
+  double pDSigma2_1 = eval(iU2S1ZDatFit,iGenPt)*pDFrac2;
+  double pDSigma2_2 = eval(iU2S2ZDatFit,iGenPt)*pDFrac2;
   //double pDMean1    = pDFrac1;
   //double pDMean2    = pDFrac2;
   
-  double pMU1       = iU1RZMCFit  ->Eval(iGenPt);
+  double pMU1       = eval(iU1RZMCFit,iGenPt);
   double pMU2       = 0; 
-  double pMFrac1    = iU1MSZMCFit ->Eval(iGenPt)*lRescale;
-  double pMSigma1_1 = iU1S1ZMCFit ->Eval(iGenPt)*pMFrac1;
-  double pMSigma1_2 = iU1S2ZMCFit ->Eval(iGenPt)*pMFrac1;
-  double pMFrac2    = iU2MSZMCFit ->Eval(iGenPt)*lRescale;
-  double pMSigma2_1 = iU2S1ZMCFit ->Eval(iGenPt)*pMFrac2;
-  double pMSigma2_2 = iU2S2ZMCFit ->Eval(iGenPt)*pMFrac2;
+  double pMFrac1    = eval(iU1MSZMCFit,iGenPt)*lRescale;
+  double pMSigma1_1 = eval(iU1S1ZMCFit,iGenPt)*pMFrac1;
+  double pMSigma1_2 = eval(iU1S2ZMCFit,iGenPt)*pMFrac1;
+  double pMFrac2    = eval(iU2MSZMCFit,iGenPt)*lRescale;
+  double pMSigma2_1 = eval(iU2S1ZMCFit,iGenPt)*pMFrac2;
+  double pMSigma2_2 = eval(iU2S2ZMCFit,iGenPt)*pMFrac2;
   //double pMMean1    = pMFrac1;
   //double pMMean2    = pMFrac2;
   //Uncertainty propagation
@@ -490,13 +540,13 @@ void RecoilCorrector::metDistributionType2(double &iMet,double &iMPhi,double iGe
   iU2   = pU2;
   return;
   //Not Used Current
-  iU1U2ZMCCorr ->Eval(iGenPt);
-  iU1U2ZDatCorr->Eval(iGenPt);
+  eval(iU1U2ZMCCorr,iGenPt);
+  eval(iU1U2ZDatCorr,iGenPt);
 }
 
 void RecoilCorrector::metDistribution(double &iPFMet,double &iPFMPhi,double &iTKMet,double &iTKMPhi,
 				      double iGenPt,double iGenPhi,
-		                      double iLepPt,double iLepPhi,TRandom1 *iRand,
+		                      double iLepPt,double iLepPhi,TRandom *iRand,
 		                      TF1 *iU1RPFFit,   TF1 *iU1RTKFit,
 		                      TF1 *iU1MSPFFit,  TF1 *iU1MSTKFit, 
 		                      TF1 *iU1S1PFFit,  TF1 *iU1S1TKFit,
@@ -512,25 +562,25 @@ void RecoilCorrector::metDistribution(double &iPFMet,double &iPFMPhi,double &iTK
   //Important constants re-scaling of sigma on left and mean wpt of W resbos on right
   double lRescale  = sqrt((TMath::Pi())/2.); //double lPtMean = 16.3; //==> tuned for W bosons
   ///
-  double pPFU1       = CorrVal(iGenPt,iU1RPFFit->Eval(iGenPt),PFU1);
+  double pPFU1       = CorrVal(iGenPt,eval(iU1RPFFit,iGenPt),PFU1);
   double pPFU2       = 0;
-  double pPFSigma1_1 = CorrVal(iGenPt,iU1S1PFFit->Eval(iGenPt),PFS1U1)*CorrVal(iGenPt,iU1MSPFFit->Eval(iGenPt),PFMSU1)*lRescale;
-  double pPFSigma1_2 = CorrVal(iGenPt,iU1S2PFFit->Eval(iGenPt),PFS2U1)*CorrVal(iGenPt,iU1MSPFFit->Eval(iGenPt),PFMSU1)*lRescale;
-  double pPFFrac1    = CorrVal(iGenPt,iU1MSPFFit->Eval(iGenPt),PFMSU1)                         *lRescale;
-  double pPFSigma2_1 = CorrVal(iGenPt,iU2S1PFFit->Eval(iGenPt),PFS1U2)*CorrVal(iGenPt,iU2MSPFFit->Eval(iGenPt),PFMSU2)*lRescale;
-  double pPFSigma2_2 = CorrVal(iGenPt,iU2S2PFFit->Eval(iGenPt),PFS2U2)*CorrVal(iGenPt,iU2MSPFFit->Eval(iGenPt),PFMSU2)*lRescale;
-  double pPFFrac2    = CorrVal(iGenPt,iU2MSPFFit->Eval(iGenPt),PFMSU2)                         *lRescale;
+  double pPFSigma1_1 = CorrVal(iGenPt,eval(iU1S1PFFit,iGenPt),PFS1U1)*CorrVal(iGenPt,eval(iU1MSPFFit,iGenPt),PFMSU1)*lRescale;
+  double pPFSigma1_2 = CorrVal(iGenPt,eval(iU1S2PFFit,iGenPt),PFS2U1)*CorrVal(iGenPt,eval(iU1MSPFFit,iGenPt),PFMSU1)*lRescale;
+  double pPFFrac1    = CorrVal(iGenPt,eval(iU1MSPFFit,iGenPt),PFMSU1)                         *lRescale;
+  double pPFSigma2_1 = CorrVal(iGenPt,eval(iU2S1PFFit,iGenPt),PFS1U2)*CorrVal(iGenPt,eval(iU2MSPFFit,iGenPt),PFMSU2)*lRescale;
+  double pPFSigma2_2 = CorrVal(iGenPt,eval(iU2S2PFFit,iGenPt),PFS2U2)*CorrVal(iGenPt,eval(iU2MSPFFit,iGenPt),PFMSU2)*lRescale;
+  double pPFFrac2    = CorrVal(iGenPt,eval(iU2MSPFFit,iGenPt),PFMSU2)                         *lRescale;
   if(pPFSigma1_1 > pPFSigma1_2) {double pT = pPFSigma1_2; pPFSigma1_2 = pPFSigma1_1; pPFSigma1_1 = pT;}
   if(pPFSigma2_1 > pPFSigma2_2) {double pT = pPFSigma2_2; pPFSigma2_2 = pPFSigma2_1; pPFSigma2_2 = pT;}
   
-  double pTKU1       = CorrVal(iGenPt,iU1RTKFit->Eval(iGenPt),TKU1);
+  double pTKU1       = CorrVal(iGenPt,eval(iU1RTKFit,iGenPt),TKU1);
   double pTKU2       = 0;
-  double pTKSigma1_1 = CorrVal(iGenPt,iU1S1TKFit->Eval(iGenPt),TKS1U1)*CorrVal(iGenPt,iU1MSTKFit->Eval(iGenPt),TKMSU1)*lRescale;
-  double pTKSigma1_2 = CorrVal(iGenPt,iU1S2TKFit->Eval(iGenPt),TKS2U1)*CorrVal(iGenPt,iU1MSTKFit->Eval(iGenPt),TKMSU1)*lRescale;
-  double pTKFrac1    = CorrVal(iGenPt,iU1MSTKFit->Eval(iGenPt),TKMSU1)                         *lRescale;
-  double pTKSigma2_1 = CorrVal(iGenPt,iU2S1TKFit->Eval(iGenPt),TKS1U2)*CorrVal(iGenPt,iU2MSTKFit->Eval(iGenPt),TKMSU2)*lRescale;
-  double pTKSigma2_2 = CorrVal(iGenPt,iU2S2TKFit->Eval(iGenPt),TKS2U2)*CorrVal(iGenPt,iU2MSTKFit->Eval(iGenPt),TKMSU2)*lRescale;
-  double pTKFrac2    = CorrVal(iGenPt,iU2MSTKFit->Eval(iGenPt),TKMSU2)                         *lRescale;
+  double pTKSigma1_1 = CorrVal(iGenPt,eval(iU1S1TKFit,iGenPt),TKS1U1)*CorrVal(iGenPt,eval(iU1MSTKFit,iGenPt),TKMSU1)*lRescale;
+  double pTKSigma1_2 = CorrVal(iGenPt,eval(iU1S2TKFit,iGenPt),TKS2U1)*CorrVal(iGenPt,eval(iU1MSTKFit,iGenPt),TKMSU1)*lRescale;
+  double pTKFrac1    = CorrVal(iGenPt,eval(iU1MSTKFit,iGenPt),TKMSU1)                         *lRescale;
+  double pTKSigma2_1 = CorrVal(iGenPt,eval(iU2S1TKFit,iGenPt),TKS1U2)*CorrVal(iGenPt,eval(iU2MSTKFit,iGenPt),TKMSU2)*lRescale;
+  double pTKSigma2_2 = CorrVal(iGenPt,eval(iU2S2TKFit,iGenPt),TKS2U2)*CorrVal(iGenPt,eval(iU2MSTKFit,iGenPt),TKMSU2)*lRescale;
+  double pTKFrac2    = CorrVal(iGenPt,eval(iU2MSTKFit,iGenPt),TKMSU2)                         *lRescale;
   if(pTKSigma1_1 > pTKSigma1_2) {double pT = pTKSigma1_2; pTKSigma1_2 = pTKSigma1_1; pTKSigma1_1 = pT;}
   if(pTKSigma2_1 > pTKSigma2_2) {double pT = pTKSigma2_2; pTKSigma2_2 = pTKSigma2_1; pTKSigma2_2 = pT;}
 
@@ -545,8 +595,8 @@ void RecoilCorrector::metDistribution(double &iPFMet,double &iPFMPhi,double &iTK
     double lEU2Frac = getError(iGenPt ,iU2MSPFFit, PFMSU2)*lRescale;
     //cout << "===> " << pPFSigma1_1 << " -- " << iU1S2PFFit->GetParError(0) << " -- " << lEUS1_1 << endl;
     //Modify all the different parameters the choice of signs makes it maximal
-    if(iU1S1PFFit->Eval(iGenPt) > 1) {double pPF = lEUS1_1; lEUS1_1 = lEUS1_2; lEUS1_1 = pPF;}
-    if(iU2S1PFFit->Eval(iGenPt) > 1) {double pPF = lEUS2_1; lEUS2_1 = lEUS2_2; lEUS2_1 = pPF;}
+    if(eval(iU1S1PFFit,iGenPt) > 1) {double pPF = lEUS1_1; lEUS1_1 = lEUS1_2; lEUS1_1 = pPF;}
+    if(eval(iU2S1PFFit,iGenPt) > 1) {double pPF = lEUS2_1; lEUS2_1 = lEUS2_2; lEUS2_1 = pPF;}
 
     pPFU1       = pPFU1       + iScale*lEUR1;              //Recoil
     pPFFrac1    = pPFFrac1    + iFluc*(lEU1Frac);        //Mean RMS 
@@ -563,8 +613,8 @@ void RecoilCorrector::metDistribution(double &iPFMet,double &iPFMPhi,double &iTK
     lEUS2_1  = getError(iGenPt,iU2S1TKFit,TKS1U2);
     lEUS2_2  = getError(iGenPt,iU2S2TKFit,TKS2U2);
     lEU2Frac = getError(iGenPt,iU2MSTKFit,TKMSU2)*lRescale;
-    if(iU1S1TKFit->Eval(iGenPt) > 1) {double pPF = lEUS1_1; lEUS1_1 = lEUS1_2; lEUS1_1 = pPF;}
-    if(iU2S1TKFit->Eval(iGenPt) > 1) {double pPF = lEUS2_1; lEUS2_1 = lEUS2_2; lEUS2_1 = pPF;}
+    if(eval(iU1S1TKFit,iGenPt) > 1) {double pPF = lEUS1_1; lEUS1_1 = lEUS1_2; lEUS1_1 = pPF;}
+    if(eval(iU2S1TKFit,iGenPt) > 1) {double pPF = lEUS2_1; lEUS2_1 = lEUS2_2; lEUS2_1 = pPF;}
     //Modify all the different parameters the choice of signs makes it maximal
     pTKU1       = pTKU1        + iScale*lEUR1;              //Recoil
     pTKFrac1    = pTKFrac1     + iFluc*(lEU1Frac);        //Mean RMS 
@@ -596,12 +646,12 @@ void RecoilCorrector::metDistribution(double &iPFMet,double &iPFMPhi,double &iTK
   double pTKCorr1     = iRand->Gaus(0,1);     double pTKCorr2     = iRand->Gaus(0,1);  
   //double pTKCorrT1    = iRand->Gaus(0,1);     double pTKCorrT2    = iRand->Gaus(0,1);  
 
-  double lPFU1U2  = TMath::Max(iPFU1U2Corr->Eval(iGenPt),0.);//iPFU1U2Corr->Eval(iGenPt) ,0.);
-  double lTKU1U2  = TMath::Max(iTKU1U2Corr->Eval(iGenPt),0.);//iTKU1U2Corr->Eval(iGenPt) ,0.);
-  double lPFTKU1  = iPFTKU1Corr ->Eval(iGenPt); //TMath::Max(iPFTKU1Corr->Eval(iGenPt) ,0.);
-  double lPFTKU2  = iPFTKU2Corr ->Eval(iGenPt);//TMath::Max(iPFTKU2Corr->Eval(iGenPt) ,0.);
-  double lPFTKU1M = iPFTKU1MCorr->Eval(iGenPt);
-  double lPFTKU2M = iPFTKU2MCorr->Eval(iGenPt);
+  double lPFU1U2  = TMath::Max(eval(iPFU1U2Corr,iGenPt),0.);//iPFU1U2Corr->Eval(iGenPt) ,0.);
+  double lTKU1U2  = TMath::Max(eval(iTKU1U2Corr,iGenPt),0.);//iTKU1U2Corr->Eval(iGenPt) ,0.);
+  double lPFTKU1  = eval(iPFTKU1Corr,iGenPt); //TMath::Max(iPFTKU1Corr->Eval(iGenPt) ,0.);
+  double lPFTKU2  = eval(iPFTKU2Corr,iGenPt);//TMath::Max(iPFTKU2Corr->Eval(iGenPt) ,0.);
+  double lPFTKU1M = eval(iPFTKU1MCorr,iGenPt);
+  double lPFTKU2M = eval(iPFTKU2MCorr,iGenPt);
 
   //Needs some more work
   double pScale = 1.; //pPFFrac1 = (pPFFrac1+pPFFrac2)/2.; //pPFFrac2 = pPFFrac1;//+pPFFrac2)/2.;
@@ -679,9 +729,9 @@ double RecoilCorrector::getError(double iVal,TF1 *iFit,Recoil iType) {
   double lEW2  = getError2(iVal,iFit);
   double lEZD2 = getError2(iVal,getFunc(true ,iType));
   double lEZM2 = getError2(iVal,getFunc(false,iType));
-  double lZDat = getFunc(true ,iType)->Eval(iVal);
-  double lZMC  = getFunc(false,iType)->Eval(iVal);
-  double lWMC  = iFit                ->Eval(iVal);
+  double lZDat = eval(getFunc(true ,iType),iVal);
+  double lZMC  = eval(getFunc(false,iType),iVal);
+  double lWMC  = eval(iFit,iVal);
   double lR    = lZDat/lZMC;
   double lER   = lR*lR/lZDat/lZDat*lEZD2 + lR*lR/lZMC/lZMC*lEZM2;
   double lVal  = lR*lR*lEW2 + lWMC*lWMC*lER;
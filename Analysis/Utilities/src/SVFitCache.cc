@@ -0,0 +1,208 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitCache.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitService.h"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+  // Version 1 keys didn't include the integration
+  char const kMagic[8] = {'I', 'C', 'S', 'V', 'F', 'I', 'T', '2'};
+  std::size_t const kHeaderSize = 16;
+
+  // Open path for writing with an exclusive lock, making sure the locked
+  // file is still the one at path (Compact may have replaced it meanwhile)
+  int OpenLocked(std::string const& path, int flags) {
+    while (true) {
+      int fd = open(path.c_str(), flags, 0644);
+      if (fd < 0) return fd;
+      if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return -1;
+      }
+      struct stat st_fd, st_path;
+      if (fstat(fd, &st_fd) == 0 && stat(path.c_str(), &st_path) == 0 &&
+          st_fd.st_ino == st_path.st_ino && st_fd.st_dev == st_path.st_dev) {
+        return fd;
+      }
+      flock(fd, LOCK_UN);
+      close(fd);
+    }
+  }
+
+  bool WriteAll(int fd, void const* buf, std::size_t n) {
+    char const* p = static_cast<char const*>(buf);
+    while (n > 0) {
+      ssize_t w = write(fd, p, n);
+      if (w <= 0) return false;
+      p += w;
+      n -= w;
+    }
+    return true;
+  }
+
+  bool SameKey(ic::SVFitCache::Key const& l, ic::SVFitCache::Key const& r) {
+    return l.h1 == r.h1 && l.h2 == r.h2;
+  }
+
+  bool RecordLess(ic::SVFitCache::Record const& l, ic::SVFitCache::Record const& r) {
+    return l.key < r.key;
+  }
+}
+
+namespace ic {
+
+  SVFitCache::SVFitCache(std::string const& path)
+      : path_(path), sorted_(NULL), n_sorted_(0), hits_(0), misses_(0) {
+    if (!file_.Open(path_)) return;
+    if (file_.size() < kHeaderSize || std::memcmp(file_.data(), kMagic, 8) != 0) {
+      std::cerr << "Warning in <ic::SVFitCache>: " << path_
+                << " is not an SVFit cache file, it will be ignored" << std::endl;
+      file_.Close();
+      return;
+    }
+    uint64_t n_total = (file_.size() - kHeaderSize) / sizeof(Record);
+    std::memcpy(&n_sorted_, file_.data() + 8, sizeof(uint64_t));
+    if (n_sorted_ > n_total) n_sorted_ = n_total;
+    sorted_ = reinterpret_cast<Record const*>(file_.data() + kHeaderSize);
+    for (uint64_t i = n_sorted_; i < n_total; ++i) {
+      extra_[sorted_[i].key] = sorted_[i].mass;
+    }
+  }
+
+  SVFitCache::~SVFitCache() {
+    Flush();
+  }
+
+  SVFitCache::Key SVFitCache::MakeKey(unsigned mode, Candidate const* lep1, Candidate const* lep2, Met const* met) {
+    double in[17] = {
+      double(mode),
+      lep1->pt(), lep1->eta(), lep1->phi(), lep1->energy(),
+      lep2->pt(), lep2->eta(), lep2->phi(), lep2->energy(),
+      met->pt(), met->eta(), met->phi(), met->energy(),
+      met->xx_sig(), met->yx_sig(), met->xy_sig(), met->yy_sig()
+    };
+    // Two FNV-1a hashes with different offset bases, one reading the
+    // bytes forwards and one backwards.  The inputs are followed by the
+    // integration, so that results of the different integrations in
+    // different releases are never mixed up
+    std::string algo = SVFitService::Algorithm();
+    std::vector<unsigned char> bytes(sizeof(in) + algo.size());
+    std::memcpy(&bytes[0], in, sizeof(in));
+    std::memcpy(&bytes[sizeof(in)], algo.data(), algo.size());
+    std::size_t n = bytes.size();
+    Key key;
+    key.h1 = 14695981039346656037ULL;
+    key.h2 = 9650029242287828579ULL;
+    for (std::size_t i = 0; i < n; ++i) {
+      key.h1 = (key.h1 ^ bytes[i]) * 1099511628211ULL;
+      key.h2 = (key.h2 ^ bytes[n - 1 - i]) * 1099511628211ULL;
+    }
+    return key;
+  }
+
+  bool SVFitCache::Find(Key const& key, double & mass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<Key, double>::const_iterator it = extra_.find(key);
+    if (it != extra_.end()) {
+      mass = it->second;
+      ++hits_;
+      return true;
+    }
+    if (n_sorted_ > 0) {
+      Record probe;
+      probe.key = key;
+      Record const* end = sorted_ + n_sorted_;
+      Record const* rec = std::lower_bound(sorted_, end, probe, RecordLess);
+      if (rec != end && SameKey(rec->key, key)) {
+        mass = rec->mass;
+        ++hits_;
+        return true;
+      }
+    }
+    ++misses_;
+    return false;
+  }
+
+  void SVFitCache::Insert(Key const& key, double mass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    extra_[key] = mass;
+    Record rec;
+    rec.key = key;
+    rec.mass = mass;
+    pending_.push_back(rec);
+  }
+
+  void SVFitCache::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) return;
+    int fd = OpenLocked(path_, O_RDWR | O_APPEND | O_CREAT);
+    if (fd < 0) {
+      std::cerr << "Warning in <ic::SVFitCache>: Unable to write to " << path_ << std::endl;
+      return;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok && st.st_size == 0) {
+      uint64_t n_sorted = 0;
+      ok = WriteAll(fd, kMagic, 8) && WriteAll(fd, &n_sorted, sizeof(n_sorted));
+    } else if (ok) {
+      // Don't append to a file of another version or to some other file
+      char header[8];
+      if (pread(fd, header, 8, 0) != 8 || std::memcmp(header, kMagic, 8) != 0) {
+        std::cerr << "Warning in <ic::SVFitCache>: " << path_
+                  << " is not an SVFit cache file, the new results will not be written" << std::endl;
+        pending_.clear();
+        flock(fd, LOCK_UN);
+        close(fd);
+        return;
+      }
+    }
+    if (ok) ok = WriteAll(fd, &(pending_[0]), pending_.size() * sizeof(Record));
+    if (!ok) std::cerr << "Warning in <ic::SVFitCache>: Error writing to " << path_ << std::endl;
+    pending_.clear();
+    flock(fd, LOCK_UN);
+    close(fd);
+  }
+
+  bool SVFitCache::Compact(std::string const& path) {
+    int fd = OpenLocked(path, O_RDONLY);
+    if (fd < 0) return false;
+    // Only ever rewrite files that are SVFit caches
+    char header[kHeaderSize];
+    if (read(fd, header, kHeaderSize) != ssize_t(kHeaderSize) || std::memcmp(header, kMagic, 8) != 0) {
+      std::cerr << "Warning in <ic::SVFitCache>: " << path << " is not an SVFit cache file, it will not be compacted" << std::endl;
+      flock(fd, LOCK_UN);
+      close(fd);
+      return false;
+    }
+    std::vector<Record> records;
+    Record rec;
+    while (read(fd, &rec, sizeof(Record)) == ssize_t(sizeof(Record))) records.push_back(rec);
+    // Later records win, so sort stably and keep the last of each key
+    std::stable_sort(records.begin(), records.end(), RecordLess);
+    std::vector<Record> unique;
+    for (unsigned i = 0; i < records.size(); ++i) {
+      if (!unique.empty() && SameKey(unique.back().key, records[i].key)) {
+        unique.back() = records[i];
+      } else {
+        unique.push_back(records[i]);
+      }
+    }
+    std::string tmp = CreateTempFile(path);
+    int out = tmp.empty() ? -1 : open(tmp.c_str(), O_WRONLY | O_TRUNC);
+    uint64_t n_sorted = unique.size();
+    bool ok = out >= 0 && WriteAll(out, kMagic, 8) && WriteAll(out, &n_sorted, sizeof(n_sorted));
+    if (ok && !unique.empty()) ok = WriteAll(out, &(unique[0]), unique.size() * sizeof(Record));
+    if (out >= 0) close(out);
+    if (ok) ok = rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok && !tmp.empty()) unlink(tmp.c_str());
+    flock(fd, LOCK_UN);
+    close(fd);
+    return ok;
+  }
+
+}
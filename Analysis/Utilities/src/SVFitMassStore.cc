@@ -0,0 +1,115 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitMassStore.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+namespace {
+  char const kMagic[8] = {'I', 'C', 'S', 'V', 'M', 'A', 'S', '1'};
+  std::size_t const kHeaderSize = 16;
+
+  bool RecordLess(ic::SVFitMassStore::Record const& l, ic::SVFitMassStore::Record const& r) {
+    return l.run != r.run ? l.run < r.run : l.event < r.event;
+  }
+}
+
+namespace ic {
+
+  SVFitMassStore::SVFitMassStore() : records_(NULL), n_(0) {
+    ;
+  }
+
+  SVFitMassStore::~SVFitMassStore() {
+    ;
+  }
+
+  bool SVFitMassStore::Build(std::vector<std::string> const& inputs, std::string const& output) {
+    std::vector<Record> records;
+    for (unsigned i = 0; i < inputs.size(); ++i) {
+      std::ifstream file(inputs[i].c_str());
+      if (!file.is_open()) {
+        std::cerr << "Error in <ic::SVFitMassStore>: Unable to read " << inputs[i] << std::endl;
+        return false;
+      }
+      std::string line;
+      while (std::getline(file, line)) {
+        // Expected format is run.event:mass
+        char const* p = line.c_str();
+        char * end = NULL;
+        Record rec;
+        rec.run = strtoull(p, &end, 10);
+        if (end == p || *end != '.') continue;
+        p = end + 1;
+        rec.event = strtoull(p, &end, 10);
+        if (end == p || *end != ':') continue;
+        p = end + 1;
+        rec.mass = strtod(p, &end);
+        if (end == p) continue;
+        records.push_back(rec);
+      }
+    }
+    // Keep the last entry for any duplicated event, as the old map-based
+    // reading did
+    std::stable_sort(records.begin(), records.end(), RecordLess);
+    std::vector<Record> unique;
+    unique.reserve(records.size());
+    for (unsigned i = 0; i < records.size(); ++i) {
+      if (!unique.empty() && !RecordLess(unique.back(), records[i])) {
+        unique.back() = records[i];
+      } else {
+        unique.push_back(records[i]);
+      }
+    }
+    std::string tmp = CreateTempFile(output);
+    if (tmp.empty()) {
+      std::cerr << "Error in <ic::SVFitMassStore>: Unable to write " << output << std::endl;
+      return false;
+    }
+    std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    uint64_t n = unique.size();
+    out.write(kMagic, 8);
+    out.write(reinterpret_cast<char const*>(&n), sizeof(n));
+    if (n > 0) out.write(reinterpret_cast<char const*>(&(unique[0])), n * sizeof(Record));
+    out.close();
+    if (!out || std::rename(tmp.c_str(), output.c_str()) != 0) {
+      std::cerr << "Error in <ic::SVFitMassStore>: Unable to write " << output << std::endl;
+      std::remove(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool SVFitMassStore::Open(std::string const& path) {
+    records_ = NULL;
+    n_ = 0;
+    if (!file_.Open(path)) return false;
+    if (file_.size() < kHeaderSize || std::memcmp(file_.data(), kMagic, 8) != 0) {
+      file_.Close();
+      return false;
+    }
+    uint64_t n = 0;
+    std::memcpy(&n, file_.data() + 8, sizeof(n));
+    if (kHeaderSize + n * sizeof(Record) > file_.size()) {
+      file_.Close();
+      return false;
+    }
+    records_ = reinterpret_cast<Record const*>(file_.data() + kHeaderSize);
+    n_ = n;
+    return true;
+  }
+
+  bool SVFitMassStore::Find(uint64_t run, uint64_t event, double & mass) const {
+    if (n_ == 0) return false;
+    Record probe;
+    probe.run = run;
+    probe.event = event;
+    Record const* end = records_ + n_;
+    Record const* rec = std::lower_bound(records_, end, probe, RecordLess);
+    if (rec == end || rec->run != run || rec->event != event) return false;
+    mass = rec->mass;
+    return true;
+  }
+
+}
@@ -2,6 +2,8 @@
 
 namespace ic {
 
+  std::mutex SVFitService::mutex_;
+
   SVFitService::SVFitService() {
     ;
   }
@@ -10,7 +12,16 @@ namespace ic {
     ;
   }
 
+  char const* SVFitService::Algorithm() {
+    #if defined(__CMSSW_5_3_7__)
+      return "integrateVEGAS";
+    #else
+      return "integrate";
+    #endif
+  }
+
   double SVFitService::SVFitMassLepHad(Candidate const* lep, Candidate const* had, Met const* met) {
+    std::lock_guard<std::mutex> lock(mutex_);
     NSVfitStandalone::Vector met_vec(met->vector().px(), met->vector().py(), met->vector().pz());
     TMatrixD covMET(2, 2);
     covMET(0,0) = met->xx_sig();
@@ -32,6 +43,7 @@ namespace ic {
   }
 
   double SVFitService::SVFitMassLepLep(Candidate const* lep1, Candidate const* lep2, Met const* met) {
+    std::lock_guard<std::mutex> lock(mutex_);
     NSVfitStandalone::Vector met_vec(met->vector().px(), met->vector().py(), met->vector().pz());
     TMatrixD covMET(2, 2);
     covMET(0,0) = met->xx_sig();
@@ -53,6 +65,7 @@ namespace ic {
   }
 
   std::pair<Candidate, double> SVFitService::SVFitCandidateLepHad(Candidate const* lep, Candidate const* had, Met const* met) {
+    std::lock_guard<std::mutex> lock(mutex_);
     NSVfitStandalone::Vector met_vec(met->vector().px(), met->vector().py(), met->vector().pz());
     TMatrixD covMET(2, 2);
     covMET(0,0) = met->xx_sig();
@@ -78,6 +91,7 @@ namespace ic {
   }
 
   std::pair<Candidate, double> SVFitService::SVFitCandidateLepLep(Candidate const* lep1, Candidate const* lep2, Met const* met) {
+    std::lock_guard<std::mutex> lock(mutex_);
     NSVfitStandalone::Vector met_vec(met->vector().px(), met->vector().py(), met->vector().pz());
     TMatrixD covMET(2, 2);
     covMET(0,0) = met->xx_sig();
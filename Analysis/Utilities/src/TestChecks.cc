@@ -0,0 +1,29 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace ic {
+
+  TestChecks::TestChecks() : failures_(0) {
+    ;
+  }
+
+  bool TestChecks::operator()(bool ok, std::string const& what) {
+    if (!ok) {
+      std::cout << "FAILED: " << what << std::endl;
+      ++failures_;
+    }
+    return ok;
+  }
+
+  bool TestChecks::Close(double a, double b, double tol) {
+    return std::fabs(a - b) <= tol * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+  }
+
+  int TestChecks::Summary() const {
+    std::cout << (failures_ ? "FAILED" : "PASSED") << std::endl;
+    return failures_ ? 1 : 0;
+  }
+
+}
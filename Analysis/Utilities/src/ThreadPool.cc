@@ -0,0 +1,35 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/ThreadPool.h"
+
+namespace ic {
+
+  ThreadPool::ThreadPool(unsigned n_threads) : stop_(false) {
+    if (n_threads == 0) n_threads = 1;
+    for (unsigned i = 0; i < n_threads; ++i) {
+      workers_.push_back(std::thread(&ThreadPool::Work, this));
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    for (unsigned i = 0; i < workers_.size(); ++i) workers_[i].join();
+  }
+
+  void ThreadPool::Work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_ && tasks_.empty()) cond_.wait(lock);
+        if (stop_ && tasks_.empty()) return;
+        task = tasks_.front();
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+}
@@ -0,0 +1,89 @@
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TriggerTable.h"
+#include "UserCode/ICHiggsTauTau/interface/city.h"
+
+namespace ic {
+
+  unsigned const TriggerTable::kMaxRun;
+
+  TriggerTable::TriggerTable() : have_run_(false), run_(0) {
+    ;
+  }
+
+  TriggerTable & TriggerTable::AddPath(unsigned run_min, unsigned run_max,
+                                       std::string const& pattern, unsigned flags) {
+    PathRow row = {run_min, run_max, pattern, flags};
+    paths_.push_back(row);
+    have_run_ = false;
+    return *this;
+  }
+
+  TriggerTable & TriggerTable::AddFilters(unsigned slot, unsigned run_min, unsigned run_max,
+                                          std::string const& objects, std::string const& leg1,
+                                          std::string const& leg2, unsigned require) {
+    FilterRow row;
+    row.slot = slot;
+    row.run_min = run_min;
+    row.run_max = run_max;
+    row.require = require;
+    row.filters.objects = objects;
+    row.filters.leg1 = leg1;
+    row.filters.leg2 = leg2;
+    filters_.push_back(row);
+    have_run_ = false;
+    return *this;
+  }
+
+  void TriggerTable::SetRun(unsigned run) {
+    run_ = run;
+    have_run_ = true;
+    active_.clear();
+    for (unsigned i = 0; i < paths_.size(); ++i) {
+      if (run >= paths_[i].run_min && run <= paths_[i].run_max) active_.push_back(i);
+    }
+    path_flags_.clear();
+    filter_choice_.clear();
+  }
+
+  unsigned TriggerTable::Resolve(std::string const& name) const {
+    unsigned flags = 0;
+    for (unsigned i = 0; i < active_.size(); ++i) {
+      PathRow const& row = paths_[active_[i]];
+      if (name.find(row.pattern) != name.npos) flags |= row.flags;
+    }
+    return flags;
+  }
+
+  unsigned TriggerTable::Match(unsigned run, TriggerPathPtrVec const& paths) {
+    if (!have_run_ || run != run_) SetRun(run);
+    if (active_.empty()) return 0;
+    unsigned flags = 0;
+    for (unsigned i = 0; i < paths.size(); ++i) {
+      // Older ntuples may not have the path id filled
+      std::size_t id = paths[i]->id();
+      if (id == 0) id = CityHash64(paths[i]->name());
+      std::unordered_map<std::size_t, unsigned>::const_iterator it = path_flags_.find(id);
+      if (it == path_flags_.end()) {
+        it = path_flags_.insert(std::make_pair(id, Resolve(paths[i]->name()))).first;
+      }
+      flags |= it->second;
+    }
+    return flags;
+  }
+
+  TriggerTable::Filters const& TriggerTable::Lookup(unsigned slot, unsigned run, unsigned flags) {
+    if (!have_run_ || run != run_) SetRun(run);
+    std::pair<unsigned, unsigned> key(slot, flags);
+    std::map<std::pair<unsigned, unsigned>, int>::const_iterator it = filter_choice_.find(key);
+    if (it == filter_choice_.end()) {
+      int choice = -1;
+      for (unsigned i = 0; i < filters_.size(); ++i) {
+        FilterRow const& row = filters_[i];
+        if (row.slot == slot && run >= row.run_min && run <= row.run_max &&
+            (flags & row.require) == row.require) choice = i;
+      }
+      it = filter_choice_.insert(std::make_pair(key, choice)).first;
+    }
+    return it->second < 0 ? empty_ : filters_[it->second].filters;
+  }
+
+}
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <cmath>
 #include <set>
+#include <vector>
 
 using namespace std;
 
@@ -501,3 +502,285 @@ TH1D *th1fmorph(const char *chname,
                 Double_t morphedhistnorm,
                 Int_t idebug)
 { return th1fmorph_<TH1D, Double_t>(chname, chtitle, hist1, hist2, par1, par2, parinterp, morphedhistnorm, idebug); }
+
+
+// Batch version of th1fmorph_.  Nothing up to and including the walk along
+// the two cdfs depends on the weights: the walk only decides which
+// (x1, x2, y) points make up the interpolated cdf, and the weights just
+// combine x1 and x2 into x.  So the points are found once and each target
+// only redoes x = wt1*x1 + wt2*x2 and the projection onto the new binning.
+// The arithmetic is the same as in th1fmorph_, so the results are identical.
+template<typename TH1_t, typename Value_t>
+std::vector<TH1_t> th1fmorph_batch_(const char *chname, 
+                const char *chtitle,
+                TH1_t *hist1,TH1_t *hist2,
+                Double_t par1,Double_t par2,
+                std::vector<Double_t> const& parinterp,
+                std::vector<Double_t> const& morphedhistnorm,
+                Int_t idebug)
+{
+  std::vector<TH1_t> results;
+  if(!hist1) {
+    cout << "ERROR! th1morph says first input histogram doesn't exist." << endl;
+    return results;
+  }
+  if(!hist2) {
+    cout << "ERROR! th1morph says second input histogram doesn't exist." << endl;
+    return results;
+  }
+  if (parinterp.size() != morphedhistnorm.size()) {
+    cout << "ERROR! th1fmorph_batch needs one normalization per parameter value." << endl;
+    return results;
+  }
+  unsigned ntargets = parinterp.size();
+  results.reserve(ntargets);
+
+  TAxis* axis1 = hist1->GetXaxis();
+  Int_t nb1 = axis1->GetNbins();
+  TAxis* axis2 = hist2->GetXaxis();
+  Int_t nb2 = axis2->GetNbins();
+
+  std::set<Double_t> bedgesn_tmp;
+  for(Int_t i = 1; i <= nb1; ++i){
+    bedgesn_tmp.insert(axis1->GetBinLowEdge(i));
+    bedgesn_tmp.insert(axis1->GetBinUpEdge(i));
+  }
+  for(Int_t i = 1; i <= nb2; ++i){
+    bedgesn_tmp.insert(axis2->GetBinLowEdge(i));
+    bedgesn_tmp.insert(axis2->GetBinUpEdge(i));
+  }
+  Int_t nbn = bedgesn_tmp.size() - 1;
+  TArrayD bedgesn(nbn+1);
+  Int_t idx = 0;
+  for (std::set<Double_t>::const_iterator bedge = bedgesn_tmp.begin();
+       bedge != bedgesn_tmp.end(); ++bedge){
+    bedgesn[idx]=(*bedge);
+    ++idx;
+  }
+  Double_t xminn = bedgesn[0];
+  Double_t xmaxn = bedgesn[nbn];
+
+  std::vector<Double_t> wt1(ntargets);
+  std::vector<Double_t> wt2(ntargets);
+  for (unsigned t = 0; t < ntargets; ++t) {
+    if (par2 != par1) {
+      wt1[t] = 1. - (parinterp[t]-par1)/(par2-par1);
+      wt2[t] = 1. + (parinterp[t]-par2)/(par2-par1);
+    }
+    else { 
+      wt1[t] = 0.5;
+      wt2[t] = 0.5;
+    }
+    if (wt1[t] < 0 || wt1[t] > 1. || wt2[t] < 0. || wt2[t] > 1. || fabs(1-(wt1[t]+wt2[t])) 
+        > 1.0e-4) {
+      cout << "Warning! th1fmorph: This is an extrapolation!! Weights are "
+           << wt1[t] << " and " << wt2[t] << " (sum=" << wt1[t]+wt2[t] << ")" << endl;
+    }
+    if (idebug >= 1) cout << "th1morph - Weights: " << wt1[t] << " " << wt2[t] << endl;
+  }
+
+  if (idebug >= 1) cout << "New hist: " << nbn << " " << xminn << " " 
+                        << xmaxn << endl;
+
+  if (hist1->GetSum() <= 0 || hist2->GetSum() <=0 ) {
+    cout << "Warning! th1morph detects an empty input histogram. Empty interpolated histograms returned: " 
+         <<endl << "         " << chname << " - " << chtitle << endl;
+    for (unsigned t = 0; t < ntargets; ++t) {
+      results.push_back(TH1_t(chname,chtitle,nbn,xminn,xmaxn));
+      results.back().SetDirectory(0);
+    }
+    return results;
+  }
+
+  //......Normalized cdfs of the two inputs, as in th1fmorph_.
+
+  Value_t *dist1=hist1->GetArray(); 
+  Value_t *dist2=hist2->GetArray();
+  std::vector<Double_t> sigdis1(1+nb1);
+  std::vector<Double_t> sigdis2(1+nb2);
+  sigdis1[0] = 0; sigdis2[0] = 0;
+  for(Int_t i=1;i<nb1+1;i++) sigdis1[i] = dist1[i];
+  for(Int_t i=1;i<nb2+1;i++) sigdis2[i] = dist2[i];
+
+  Double_t total = 0;
+  for(Int_t i=0;i<nb1+1;i++) total += sigdis1[i];
+  for(Int_t i=1;i<nb1+1;i++) sigdis1[i] = sigdis1[i]/total + sigdis1[i-1];
+  total = 0.;
+  for(Int_t i=0;i<nb2+1;i++) total += sigdis2[i];
+  for(Int_t i=1;i<nb2+1;i++) sigdis2[i] = sigdis2[i]/total + sigdis2[i-1];
+
+  Int_t ix1l = nb1;
+  Int_t ix2l = nb2;
+  while(sigdis1[ix1l-1] >= sigdis1[ix1l]) {
+    ix1l = ix1l - 1;
+  }
+  while(sigdis2[ix2l-1] >= sigdis2[ix2l]) {
+    ix2l = ix2l - 1;
+  }
+  Int_t ix1 = -1;
+  do {
+    ix1 = ix1 + 1;
+  } while(sigdis1[ix1+1] <= sigdis1[0]);
+  Int_t ix2 = -1;
+  do {
+    ix2 = ix2 + 1;
+  } while(sigdis2[ix2+1] <= sigdis2[0]);
+
+  //......Walk along both cdfs, keeping the positions (x1s, x2s) in the two
+  //      inputs of every point (sigdisn) of the interpolated cdf.
+
+  std::vector<Double_t> x1s(2+nb1+nb2, 0.);
+  std::vector<Double_t> x2s(2+nb1+nb2, 0.);
+  std::vector<Double_t> sigdisn(2+nb1+nb2, 0.);
+  Int_t nx3 = 0;
+  Double_t x1,x2,x,y;
+  x1s[nx3] = axis1->GetBinLowEdge(ix1+1); 
+  x2s[nx3] = axis2->GetBinLowEdge(ix2+1); 
+  sigdisn[nx3] = 0;
+
+  Double_t yprev = -1;
+  y = 0;
+  while((ix1 < ix1l) | (ix2 < ix2l)) {
+    Int_t i12type = -1;
+    if ((sigdis1[ix1+1] <= sigdis2[ix2+1] || ix2 == ix2l) && ix1 < ix1l) {
+      ix1 = ix1 + 1;
+      while(sigdis1[ix1+1] <= sigdis1[ix1] && ix1 < ix1l) {
+        ix1 = ix1 + 1;
+      }
+      i12type = 1;
+    } else if (ix2 < ix2l) {
+      ix2 = ix2 + 1;
+      while(sigdis2[ix2+1] <= sigdis2[ix2] && ix2 < ix2l) {
+        ix2 = ix2 + 1;
+      }
+      i12type = 2;
+    }
+    if (i12type == 1) {
+      x1 = axis1->GetBinLowEdge(ix1+1);
+      y = sigdis1[ix1];
+      Double_t x20 = axis2->GetBinLowEdge(ix2+1);
+      Double_t x21 = axis2->GetBinUpEdge(ix2+1);
+      Double_t y20 = sigdis2[ix2];
+      Double_t y21 = sigdis2[ix2+1];
+      if (y21 > y20) {
+        x2 = x20 + (x21-x20)*(y-y20)/(y21-y20);
+      } 
+      else {
+        x2 = x20;
+      }
+    } else {
+      x2 = axis2->GetBinLowEdge(ix2+1);
+      y = sigdis2[ix2];
+      Double_t x10 = axis1->GetBinLowEdge(ix1+1);
+      Double_t x11 = axis1->GetBinUpEdge(ix1+1);
+      Double_t y10 = sigdis1[ix1];
+      Double_t y11 = sigdis1[ix1+1];
+      if (y11 > y10) {
+        x1 = x10 + (x11-x10)*(y-y10)/(y11-y10);
+      } else {
+        x1 = x10;
+      }
+    }
+    if (y > yprev) {
+      nx3 = nx3+1;
+      yprev = y;
+      x1s[nx3] = x1;
+      x2s[nx3] = x2;
+      sigdisn[nx3] = y;
+    }
+  }
+  if (idebug >= 1) cout << "Interpolated cdf has " << nx3+1 << " points" << endl;
+
+  //......The empty bin treatment compares against the width of the hist2
+  //      bin containing each output edge, which is also target-independent.
+
+  std::vector<Double_t> dx2(nbn+1);
+  for (Int_t i = 0; i <= nbn; ++i) {
+    dx2[i] = axis2->GetBinWidth(axis2->FindFixBin(bedgesn[i]));
+  }
+
+  std::vector<Double_t> xdisn(2+nb1+nb2, 0.);
+  std::vector<Double_t> sigdisf(nbn+1);
+  for (unsigned t = 0; t < ntargets; ++t) {
+    Double_t w1 = wt1[t];
+    Double_t w2 = wt2[t];
+    Double_t *xd = &xdisn[0];
+    const Double_t *px1 = &x1s[0];
+    const Double_t *px2 = &x2s[0];
+    for (Int_t i = 0; i <= nx3; ++i) xd[i] = w1*px1[i] + w2*px2[i];
+
+    //......Projection onto the output binning, as in th1fmorph_.
+
+    x = xmaxn;
+    Int_t ix = nbn;
+    while(x >= xd[nx3]) {
+      sigdisf[ix] = sigdisn[nx3];
+      ix = ix-1;
+      x = bedgesn[ix];
+    }
+    Int_t ixl = ix + 1;
+
+    ix = 0;
+    x = bedgesn[ix+1];
+    while(x <= xd[0]) {
+      sigdisf[ix] = sigdisn[0];
+      ix = ix+1;
+      x = bedgesn[ix+1];
+    }
+    Int_t ixf = ix;
+
+    Int_t ix3 = 0;
+    for(ix=ixf;ix<ixl;ix++) {
+      x = bedgesn[ix];
+      if (x < xd[0]) {
+        y = 0;
+      } else if (x > xd[nx3]) {
+        y = 1.;
+      } else {
+        while(xd[ix3+1] <= x && ix3 < 2*nbn) {
+          ix3 = ix3 + 1;
+        }
+        if (xd[ix3+1]-x > 1.1*dx2[ix]) { // Empty bin treatment
+          y = sigdisn[ix3+1];
+        }
+        else if (xd[ix3+1] > xd[ix3]) { // Normal bins
+          y = sigdisn[ix3] + (sigdisn[ix3+1]-sigdisn[ix3])
+            *(x-xd[ix3])/(xd[ix3+1]-xd[ix3]);
+        } else {
+          y = 0;
+          cout << "Warning - th1fmorph: This probably shoudn't happen! " 
+               << endl;
+          cout << "Warning - th1fmorph: Zero slope solving x(y)" << endl;
+        }
+      }
+      sigdisf[ix] = y;
+    }
+
+    results.push_back(TH1_t(chname,chtitle,nbn,bedgesn.GetArray()));
+    TH1_t & morphedhist = results.back();
+    morphedhist.SetDirectory(0);
+    for(ix=nbn-1;ix>-1;ix--) {
+      y = sigdisf[ix+1]-sigdisf[ix];
+      morphedhist.SetBinContent(ix+1,y*morphedhistnorm[t]);
+    }
+  }
+  return results;
+}
+
+std::vector<TH1F> th1fmorph_batch(const char *chname, 
+                const char *chtitle,
+                TH1F *hist1,TH1F *hist2,
+                Double_t par1,Double_t par2,
+                std::vector<Double_t> const& parinterp,
+                std::vector<Double_t> const& morphedhistnorm,
+                Int_t idebug)
+{ return th1fmorph_batch_<TH1F, Float_t>(chname, chtitle, hist1, hist2, par1, par2, parinterp, morphedhistnorm, idebug); }
+
+std::vector<TH1D> th1fmorph_batch(const char *chname, 
+                const char *chtitle,
+                TH1D *hist1,TH1D *hist2,
+                Double_t par1,Double_t par2,
+                std::vector<Double_t> const& parinterp,
+                std::vector<Double_t> const& morphedhistnorm,
+                Int_t idebug)
+{ return th1fmorph_batch_<TH1D, Double_t>(chname, chtitle, hist1, hist2, par1, par2, parinterp, morphedhistnorm, idebug); }
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "UserCode/ICHiggsTauTau/interface/PFJet.hh"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BTagWeight.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::BTagWeight;
+using ic::TestChecks;
+
+// Checks the tag counting in BTagWeight on the cases the weights rely on:
+// events without jets, jets that are always or never tagged, windows that
+// extend beyond the number of jets or are empty, and the truncation of
+// TagCounts at max_tags, and the distributions built from jets
+
+// Sum over every tag/no-tag combination
+std::pair<double,double> BruteForce(std::vector<BTagWeight::JetInfo> const& jets, int minTags, int maxTags) {
+  int njets = jets.size();
+  if (njets == 0) return std::pair<double,double>(1.0, 1.0);
+  double pMC = 0.;
+  double pData = 0.;
+  for (int i = 0; i < (1 << njets); ++i) {
+    double mc = 1.;
+    double data = 1.;
+    int ntagged = 0;
+    for (int j = 0; j < njets; ++j) {
+      if ((i >> j) & 0x1) {
+        ++ntagged;
+        mc *= jets[j].eff;
+        data *= jets[j].eff*jets[j].sf;
+      } else {
+        mc *= (1.-jets[j].eff);
+        data *= (1.-jets[j].eff*jets[j].sf);
+      }
+    }
+    if (ntagged >= minTags && ntagged <= maxTags) {
+      pMC += mc;
+      pData += data;
+    }
+  }
+  return std::pair<double,double>(pData, pMC);
+}
+
+// weight() and TagMultiplicity().window() against the brute force sum
+void CheckWindow(TestChecks & check, BTagWeight const& btag_weight,
+                 std::vector<BTagWeight::JetInfo> const& jets, int lo, int hi, std::string const& what) {
+  std::pair<double,double> expected = BruteForce(jets, lo, hi);
+  std::pair<float,float> single = btag_weight.weight(jets, lo, hi);
+  std::pair<double,double> dist = btag_weight.TagMultiplicity(jets).window(lo, hi);
+  check(TestChecks::Close(single.first, expected.first, 1E-5) &&
+        TestChecks::Close(single.second, expected.second, 1E-5), what + ": weight");
+  check(TestChecks::Close(dist.first, expected.first, 1E-12) &&
+        TestChecks::Close(dist.second, expected.second, 1E-12), what + ": TagMultiplicity");
+}
+
+int main() {
+  TestChecks check;
+  BTagWeight btag_weight;
+
+  // No jets: every window has probability one in data and MC
+  std::vector<BTagWeight::JetInfo> none;
+  CheckWindow(check, btag_weight, none, 0, 0, "no jets, no tags");
+  CheckWindow(check, btag_weight, none, 1, 99, "no jets, at least one tag");
+  check(btag_weight.TagMultiplicity(none).weight(2, 2) == 1., "no jets, weight");
+
+  std::vector<BTagWeight::JetInfo> jets;
+  jets.push_back(BTagWeight::JetInfo(0.7, 0.95));
+  jets.push_back(BTagWeight::JetInfo(0.1, 1.2));
+  jets.push_back(BTagWeight::JetInfo(0.02, 1.1));
+  jets.push_back(BTagWeight::JetInfo(0.55, 0.9));
+  for (int lo = 0; lo <= 4; ++lo) {
+    for (int hi = lo; hi <= 4; ++hi) CheckWindow(check, btag_weight, jets, lo, hi, "four jets");
+  }
+  // Windows beyond the number of jets, and with a negative lower edge
+  CheckWindow(check, btag_weight, jets, 3, 100, "window beyond the number of jets");
+  CheckWindow(check, btag_weight, jets, 5, 100, "window above the number of jets");
+  CheckWindow(check, btag_weight, jets, -1, 1, "negative lower edge");
+  check(TestChecks::Close(btag_weight.TagMultiplicity(jets).weight(0, 100), 1., 1E-12), "full window");
+  // An empty window has no probability
+  std::pair<double,double> empty = btag_weight.TagMultiplicity(jets).window(2, 1);
+  check(empty.first == 0. && empty.second == 0., "empty window");
+
+  // Jets that are always or never tagged
+  std::vector<BTagWeight::JetInfo> certain;
+  certain.push_back(BTagWeight::JetInfo(1.0, 1.0));
+  certain.push_back(BTagWeight::JetInfo(0.0, 1.0));
+  BTagWeight::TagDistribution dist = btag_weight.TagMultiplicity(certain);
+  check(dist.mc.size() == 3 && dist.mc[0] == 0. && dist.mc[1] == 1. && dist.mc[2] == 0.,
+        "one certain tag and one certain non-tag");
+  CheckWindow(check, btag_weight, certain, 1, 1, "certain tags");
+
+  // TagCounts only fills the first max_tags+1 entries, each the probability
+  // of exactly that many tags.  The probabilities are exact as floats, as
+  // JetInfo stores them
+  std::vector<double> probs = {0.25, 0.5, 0.875, 0.125};
+  std::vector<double> counts;
+  BTagWeight::TagCounts(probs, 2, counts);
+  check(counts.size() == 3, "TagCounts truncated at max_tags");
+  std::vector<BTagWeight::JetInfo> prob_jets;
+  for (unsigned j = 0; j < probs.size(); ++j) prob_jets.push_back(BTagWeight::JetInfo(probs[j], 1.0));
+  for (unsigned k = 0; k < counts.size(); ++k) {
+    check(TestChecks::Close(counts[k], BruteForce(prob_jets, k, k).second, 1E-12), "TagCounts entry " + std::string(1, char('0' + k)));
+  }
+  BTagWeight::TagCounts(probs, 10, counts);
+  check(counts.size() == probs.size() + 1, "TagCounts with max_tags above the number of jets");
+  BTagWeight::TagCounts(std::vector<double>(), 2, counts);
+  check(counts.size() == 1 && counts[0] == 1., "TagCounts without jets");
+
+  // GetLouvainTagDistribution gives the same windows as GetLouvainWeight
+  std::vector<ic::PFJet> pfjets(4);
+  std::vector<ic::PFJet *> jet_ptrs;
+  double pts[] = {25., 60., 140., 400.};
+  double etas[] = {0.1, -1.2, 2.1, -0.5};
+  int flavours[] = {5, 4, 1, 21};
+  for (unsigned j = 0; j < pfjets.size(); ++j) {
+    pfjets[j].set_pt(pts[j]);
+    pfjets[j].set_eta(etas[j]);
+    pfjets[j].set_parton_flavour(flavours[j]);
+    jet_ptrs.push_back(&pfjets[j]);
+  }
+  BTagWeight::TagDistribution louvain = btag_weight.GetLouvainTagDistribution(jet_ptrs, BTagWeight::tagger::SSVHEM);
+  check(TestChecks::Close(louvain.weight(1, 1), btag_weight.GetLouvainWeight(jet_ptrs, BTagWeight::tagger::SSVHEM, 1, 1), 1E-5),
+        "GetLouvainTagDistribution, exactly one tag");
+  check(TestChecks::Close(louvain.weight(2, 100), btag_weight.GetLouvainWeight(jet_ptrs, BTagWeight::tagger::SSVHEM, 2, 100), 1E-5),
+        "GetLouvainTagDistribution, at least two tags");
+
+  // GetTagDistributions gives, for each scale factor variation, the same
+  // windows as the brute force sum over the efficiencies and scale factors
+  // of that variation, and for the central one the same as GetWeight
+  std::vector<std::pair<int,int>> modes = {{0, 0}, {1, 0}, {2, 0}, {0, 1}, {0, 2}};
+  std::vector<BTagWeight::TagDistribution> variations =
+    btag_weight.GetTagDistributions(jet_ptrs, BTagWeight::payload::EPS13, BTagWeight::tagger::CSVM, modes);
+  check(variations.size() == modes.size(), "GetTagDistributions, one distribution per variation");
+  for (unsigned m = 0; m < modes.size() && m < variations.size(); ++m) {
+    std::string what = "GetTagDistributions, variation " + std::string(1, char('0' + m));
+    std::vector<BTagWeight::JetInfo> infos;
+    for (unsigned j = 0; j < jet_ptrs.size(); ++j) {
+      unsigned flavour = std::abs(jet_ptrs[j]->parton_flavour());
+      infos.push_back(BTagWeight::JetInfo(
+        btag_weight.BEff(BTagWeight::payload::EPS13, flavour, BTagWeight::tagger::CSVM, jet_ptrs[j]->pt(), jet_ptrs[j]->eta()),
+        btag_weight.SF(BTagWeight::payload::EPS13, flavour, BTagWeight::tagger::CSVM, jet_ptrs[j]->pt(), jet_ptrs[j]->eta(),
+                       modes[m].first, modes[m].second)));
+    }
+    for (int lo = 0; lo <= 4; ++lo) {
+      for (int hi = lo; hi <= 4; ++hi) {
+        std::pair<double,double> expected = BruteForce(infos, lo, hi);
+        std::pair<double,double> got = variations[m].window(lo, hi);
+        check(TestChecks::Close(got.first, expected.first, 1E-12) &&
+              TestChecks::Close(got.second, expected.second, 1E-12), what + ", window " +
+              std::string(1, char('0' + lo)) + "-" + std::string(1, char('0' + hi)));
+      }
+    }
+    // The MC distribution doesn't depend on the variation
+    check(variations[m].mc == variations[0].mc, what + ", shared MC distribution");
+  }
+  check(TestChecks::Close(variations[0].weight(1, 1),
+                          btag_weight.GetWeight(jet_ptrs, BTagWeight::payload::EPS13, BTagWeight::tagger::CSVM, 1, 1), 1E-5),
+        "GetTagDistributions, central variation against GetWeight");
+  check(TestChecks::Close(variations[0].weight(2, 100),
+                          btag_weight.GetWeight(jet_ptrs, BTagWeight::payload::EPS13, BTagWeight::tagger::CSVM, 2, 100), 1E-5),
+        "GetTagDistributions, at least two tags against GetWeight");
+  // The variations must actually move the data distribution
+  check(variations[1].data != variations[0].data && variations[2].data != variations[0].data,
+        "GetTagDistributions, b-tag variations differ from the central one");
+  check(variations[3].data != variations[0].data && variations[4].data != variations[0].data,
+        "GetTagDistributions, mistag variations differ from the central one");
+
+  return check.Summary();
+}
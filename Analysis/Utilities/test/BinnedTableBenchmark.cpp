@@ -0,0 +1,74 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "TH2D.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
+
+using ic::BinnedTable;
+
+// Times BinnedTable::Value against TH2::FindBin + GetBinContent on random
+// points for uniform and variable binning.  The lookups themselves are
+// checked by BinnedTableTest, here only the sums are compared, e.g.
+//   ./bin/BinnedTableBenchmark
+bool Compare(TH2D & hist, std::string const& label, unsigned n) {
+  TRandom3 rng(4357);
+  for (int i = 0; i < (hist.GetNbinsX() + 2) * (hist.GetNbinsY() + 2); ++i) {
+    hist.SetBinContent(i, rng.Uniform(0.5, 1.5));
+    hist.SetBinError(i, rng.Uniform(0.01, 0.1));
+  }
+  BinnedTable table(&hist);
+
+  // Points spread a little beyond the axes to cover under/overflow
+  double xlo = hist.GetXaxis()->GetXmin();
+  double xhi = hist.GetXaxis()->GetXmax();
+  double ylo = hist.GetYaxis()->GetXmin();
+  double yhi = hist.GetYaxis()->GetXmax();
+  std::vector<double> xs(n), ys(n);
+  for (unsigned i = 0; i < n; ++i) {
+    xs[i] = rng.Uniform(xlo - 0.1 * (xhi - xlo), xhi + 0.1 * (xhi - xlo));
+    ys[i] = rng.Uniform(ylo - 0.1 * (yhi - ylo), yhi + 0.1 * (yhi - ylo));
+  }
+
+  TStopwatch timer;
+  double sum_hist = 0.;
+  timer.Start();
+  for (unsigned i = 0; i < n; ++i) sum_hist += hist.GetBinContent(hist.FindBin(xs[i], ys[i]));
+  timer.Stop();
+  double t_hist = timer.RealTime();
+  double sum_table = 0.;
+  timer.Start();
+  for (unsigned i = 0; i < n; ++i) sum_table += table.Value(xs[i], ys[i]);
+  timer.Stop();
+  double t_table = timer.RealTime();
+
+  std::cout << label << ", " << n << " lookups:" << std::endl;
+  std::cout << "  TH2::FindBin + GetBinContent " << t_hist << " s, BinnedTable::Value " << t_table << " s";
+  if (t_table > 0.) std::cout << " (x" << t_hist / t_table << ")";
+  std::cout << std::endl;
+  if (sum_hist != sum_table) {
+    std::cout << "  Sums differ: " << sum_hist << " and " << sum_table << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  unsigned n = 2000000;
+  bool ok = true;
+  TH2D uniform("uniform", "", 50, 0., 200., 24, -2.4, 2.4);
+  ok = Compare(uniform, "uniform 50x24", n) && ok;
+
+  double pt_bins[] = {10, 15, 20, 25, 30, 40, 55, 70, 100, 200, 500};
+  double eta_bins[] = {0, 0.8, 1.2, 1.479, 2.1, 2.5};
+  TH2D variable("variable", "", 10, pt_bins, 5, eta_bins);
+  ok = Compare(variable, "variable 10x5", n) && ok;
+
+  std::vector<double> fine(201);
+  for (unsigned i = 0; i < fine.size(); ++i) fine[i] = 0.5 * i * i;
+  TH2D fine_var("fine_var", "", 200, &fine[0], 200, &fine[0]);
+  ok = Compare(fine_var, "variable 200x200", n) && ok;
+
+  return ok ? 0 : 1;
+}
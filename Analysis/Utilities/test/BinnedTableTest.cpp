@@ -0,0 +1,119 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <limits>
+#include "TH2D.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/BinnedTable.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::BinnedAxis;
+using ic::BinnedTable;
+
+// Checks BinnedTable lookups at the bin edges, outside the axes and for
+// NaN, where they must follow TAxis::FindFixBin, and the global bin
+// numbering against TH2
+
+void CheckAxis(ic::TestChecks & check, BinnedAxis const& axis, std::string const& label) {
+  std::vector<double> const& edges = axis.edges();
+  int n = axis.nbins();
+  // Each lower edge belongs to its own bin, the upper edge of the axis to
+  // the overflow.  Uniform axes compute the bin as TAxis does, which can
+  // round an edge into the bin below, so these are compared with TH2 in
+  // CheckHist instead
+  if (!axis.uniform()) {
+    for (int i = 0; i < n; ++i) check(axis.FindBin(edges[i]) == i + 1, label + ": lower edge of bin");
+  }
+  for (int i = 0; i < n; ++i) check(axis.FindBin(0.5 * (edges[i] + edges[i + 1])) == i + 1, label + ": bin centre");
+  check(axis.FindBin(edges[n]) == n + 1, label + ": upper edge of the axis");
+  check(axis.FindBin(edges[0] - 1E-9) == 0, label + ": just below the axis");
+  check(axis.FindBin(-std::numeric_limits<double>::infinity()) == 0, label + ": -inf");
+  check(axis.FindBin(std::numeric_limits<double>::infinity()) == n + 1, label + ": +inf");
+  check(axis.FindBin(std::numeric_limits<double>::quiet_NaN()) == n + 1, label + ": NaN");
+  check(axis.FindBinClamped(edges[0] - 1.) == 1, label + ": underflow clamped to the first bin");
+  check(axis.FindBinClamped(edges[n] + 1.) == n, label + ": overflow clamped to the last bin");
+}
+
+// Every bin edge, just either side of it, and beyond the axes, against TH2
+void CheckHist(ic::TestChecks & check, TH2D & hist, std::string const& label) {
+  for (int i = 0; i < (hist.GetNbinsX() + 2) * (hist.GetNbinsY() + 2); ++i) {
+    hist.SetBinContent(i, 1. + i);
+    hist.SetBinError(i, 0.1 * i);
+  }
+  BinnedTable table(&hist);
+  check(table.ndim() == 2 && table.size() == std::size_t((hist.GetNbinsX() + 2) * (hist.GetNbinsY() + 2)),
+        label + ": size including under- and overflow");
+  std::vector<double> xs;
+  std::vector<double> ys;
+  for (int i = 1; i <= hist.GetNbinsX() + 1; ++i) {
+    double edge = hist.GetXaxis()->GetBinLowEdge(i);
+    xs.push_back(edge);
+    xs.push_back(edge - 1E-9);
+    xs.push_back(edge + 1E-9);
+  }
+  for (int i = 1; i <= hist.GetNbinsY() + 1; ++i) {
+    double edge = hist.GetYaxis()->GetBinLowEdge(i);
+    ys.push_back(edge);
+    ys.push_back(edge - 1E-9);
+    ys.push_back(edge + 1E-9);
+  }
+  xs.push_back(hist.GetXaxis()->GetXmin() - 100.);
+  ys.push_back(hist.GetYaxis()->GetXmax() + 100.);
+  unsigned mismatches = 0;
+  for (unsigned i = 0; i < xs.size(); ++i) {
+    for (unsigned j = 0; j < ys.size(); ++j) {
+      int bin = hist.FindFixBin(xs[i], ys[j]);
+      std::size_t table_bin = table.FindBin(xs[i], ys[j]);
+      if (std::size_t(bin) != table_bin || table.Value(xs[i], ys[j]) != hist.GetBinContent(bin) ||
+          table.GetEntry(table_bin).err_up != hist.GetBinError(bin) ||
+          table.GetEntry(table_bin).err_down != hist.GetBinError(bin)) {
+        ++mismatches;
+      }
+    }
+  }
+  check(mismatches == 0, label + ": lookups at and around the bin edges");
+  // Under- and overflow in either dimension are out of range
+  check(table.IsInRange(table.FindBin(0.5 * (hist.GetXaxis()->GetXmin() + hist.GetXaxis()->GetXmax()),
+                                      0.5 * (hist.GetYaxis()->GetXmin() + hist.GetYaxis()->GetXmax()))),
+        label + ": centre is in range");
+  check(!table.IsInRange(table.FindBin(hist.GetXaxis()->GetXmin() - 1., hist.GetYaxis()->GetXmin())),
+        label + ": x underflow is out of range");
+  check(!table.IsInRange(table.FindBin(hist.GetXaxis()->GetXmin(), hist.GetYaxis()->GetXmax())),
+        label + ": y overflow is out of range");
+}
+
+int main() {
+  ic::TestChecks check;
+  CheckAxis(check, BinnedAxis(24, -2.4, 2.4), "uniform axis");
+  double pt_bins[] = {10, 15, 20, 25, 30, 40, 55, 70, 100, 200, 500};
+  CheckAxis(check, BinnedAxis(std::vector<double>(pt_bins, pt_bins + 11)), "variable axis");
+  double one_bin[] = {0., 1.};
+  CheckAxis(check, BinnedAxis(std::vector<double>(one_bin, one_bin + 2)), "single bin axis");
+
+  TH2D uniform("uniform", "", 50, 0., 200., 24, -2.4, 2.4);
+  CheckHist(check, uniform, "uniform");
+  double eta_bins[] = {0, 0.8, 1.2, 1.479, 2.1, 2.5};
+  TH2D variable("variable", "", 10, pt_bins, 5, eta_bins);
+  CheckHist(check, variable, "variable");
+
+  // The generic lookup over any number of dimensions agrees with the
+  // fixed ones
+  std::vector<BinnedAxis> axes;
+  axes.push_back(BinnedAxis(2, 0., 2.));
+  axes.push_back(BinnedAxis(std::vector<double>(one_bin, one_bin + 2)));
+  axes.push_back(BinnedAxis(3, -3., 3.));
+  std::vector<BinnedTable::Entry> entries(4 * 3 * 5);
+  for (unsigned i = 0; i < entries.size(); ++i) {
+    entries[i].value = i;
+    entries[i].err_up = 0.;
+    entries[i].err_down = 0.;
+  }
+  BinnedTable table3(axes, entries);
+  double points[][3] = {{0., 0., 0.}, {1.5, 0.5, -2.}, {-1., 2., 3.}, {2., 1., -3.}};
+  for (unsigned i = 0; i < 4; ++i) {
+    check(table3.FindBin(points[i]) == table3.FindBin(points[i][0], points[i][1], points[i][2]),
+          "three dimensional lookup");
+  }
+  check(table3.Value(1.5, 0.5, -2.) == 2 + 4 * 1 + 12 * 1, "three dimensional bin numbering");
+
+  return check.Summary();
+}
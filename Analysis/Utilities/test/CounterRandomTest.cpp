@@ -0,0 +1,87 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CounterRandom.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::CounterRandom;
+
+// Checks CounterRandom against the Philox4x32-10 known-answer values and
+// that a stream doesn't depend on what was drawn before it
+int main() {
+  ic::TestChecks check;
+
+  uint32_t kat_ctr[3][4] = {
+    {0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u},
+    {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+    {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+  uint32_t kat_key[3][2] = {
+    {0x00000000u, 0x00000000u},
+    {0xffffffffu, 0xffffffffu},
+    {0xa4093822u, 0x299f31d0u}};
+  uint32_t kat_out[3][4] = {
+    {0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+    {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu},
+    {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+  for (unsigned i = 0; i < 3; ++i) {
+    CounterRandom::Philox(kat_ctr[i], kat_key[i]);
+    check(std::equal(kat_ctr[i], kat_ctr[i] + 4, kat_out[i]),
+          "Philox4x32-10 known-answer test " + std::string(1, char('0' + i)));
+  }
+
+  // Draw the same streams forwards and in reverse order with different
+  // generators; the numbers must agree
+  unsigned n_events = 200;
+  unsigned n_draws = 7;
+  CounterRandom forward;
+  CounterRandom backward;
+  std::vector<double> first(n_events * 2 * n_draws);
+  for (unsigned i = 0; i < n_events; ++i) {
+    for (unsigned j = 0; j < 2; ++j) {
+      forward.SetStream(1, 1 + i / 50, 1000 + i, 17 * j, "jer");
+      for (unsigned k = 0; k < n_draws; ++k) first[(i * 2 + j) * n_draws + k] = forward.Gaus(0, 1);
+    }
+  }
+  unsigned mismatches = 0;
+  for (unsigned i = n_events; i-- > 0;) {
+    for (unsigned j = 2; j-- > 0;) {
+      backward.SetStream(1, 1 + i / 50, 1000 + i, 17 * j, "jer");
+      for (unsigned k = 0; k < n_draws; ++k) {
+        if (backward.Gaus(0, 1) != first[(i * 2 + j) * n_draws + k]) ++mismatches;
+      }
+    }
+  }
+  check(mismatches == 0, "streams drawn in reverse order");
+
+  // Different purposes and objects must give different numbers
+  CounterRandom rng;
+  rng.SetStream(1, 1, 1000, 0, "jer");
+  double a = rng.Rndm();
+  rng.SetStream(1, 1, 1000, 0, "retag");
+  double b = rng.Rndm();
+  rng.SetStream(1, 1, 1000, 1, "jer");
+  double c = rng.Rndm();
+  check(a != b && a != c && b != c, "different purposes and objects");
+
+  // Crude check of the uniform distribution
+  double sum = 0.;
+  double sum2 = 0.;
+  unsigned n = 1000000;
+  unsigned outside = 0;
+  rng.SetStream(2, 3, 4, 5, "uniform");
+  for (unsigned i = 0; i < n; ++i) {
+    double u = rng.Rndm();
+    if (u <= 0. || u >= 1.) ++outside;
+    sum += u;
+    sum2 += u * u;
+  }
+  double mean = sum / n;
+  double var = sum2 / n - mean * mean;
+  std::cout << "mean " << mean << ", variance " << var << std::endl;
+  check(outside == 0, "uniform numbers in (0,1)");
+  check(std::fabs(mean - 0.5) <= 0.002 && std::fabs(var - 1. / 12.) <= 0.001, "uniform mean and variance");
+
+  return check.Summary();
+}
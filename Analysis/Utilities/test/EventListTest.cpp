@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/EventList.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::EventList;
+
+// Checks EventList on the inputs a bad event list can hold: empty lists,
+// duplicates, short, malformed and out of range entries, the largest run
+// and event numbers, partial field masks, and binary files that are
+// missing, not event lists or truncated
+
+void WriteText(std::string const& path, std::string const& text) {
+  std::ofstream out(path.c_str());
+  out << text;
+}
+
+// Values out of range end the job, so they are parsed in a child process
+bool BuildAborts(std::vector<std::string> const& inputs, std::string const& output) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    EventList::Build(inputs, output);
+    _exit(0);
+  }
+  int status = 0;
+  if (pid < 0 || waitpid(pid, &status, 0) != pid) return false;
+  return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main() {
+  ic::TestChecks check;
+  std::string text = "EventListTest.txt";
+  std::string bin = "EventListTest.bin";
+  std::vector<std::string> inputs(1, text);
+
+  // An empty list matches nothing, from a file or from memory
+  WriteText(text, "");
+  EventList empty;
+  check(EventList::Build(inputs, bin) && empty.Open(bin), "empty list built and opened");
+  check(empty.size() == 0 && !empty.Contains(0, 0, 0), "empty list matches nothing");
+  EventList empty_read;
+  check(empty_read.Read(inputs) && empty_read.size() == 0 && !empty_read.Contains(0, 0, 0), "empty list read");
+
+  // Duplicates are merged, entries shorter than min_length are skipped and
+  // the extreme values are kept exactly.  Rebuilding replaces the old file
+  WriteText(text,
+            "190456:12:1001\n"
+            "  190456:12:1001\t190456:12:1000\n"
+            "1:2:3\n"
+            "0:0:0000\n"
+            "4294967295:4294967295:18446744073709551615\n");
+  EventList list;
+  check(EventList::Build(inputs, bin, EventList::kAll, 6) && list.Open(bin), "list built over an existing file");
+  check(list.size() == 4, "duplicates merged and short entries skipped");
+  check(list.Find(0, 0, 0) == 0 && list.Find(190456, 12, 1000) == 1 && list.Find(190456, 12, 1001) == 2 &&
+        list.Find(4294967295u, 4294967295u, 18446744073709551615ULL) == 3, "sorted positions");
+  check(!list.Contains(1, 2, 3), "short entry not listed");
+  check(!list.Contains(190456, 12, 1002) && !list.Contains(190456, 13, 1001) && !list.Contains(190457, 12, 1001),
+        "neighbours of a listed event");
+  check(!list.Contains(4294967295u, 4294967295u, 18446744073709551614ULL), "neighbour of the largest event");
+
+  // Reading into memory gives the same list
+  EventList read;
+  check(read.Read(inputs, EventList::kAll, 6) && read.size() == list.size(), "list read into memory");
+  check(read.Find(190456, 12, 1001) == list.Find(190456, 12, 1001) && !read.Contains(1, 2, 3),
+        "memory list matches the file");
+
+  // Partial masks ignore the other numbers, whatever they are
+  WriteText(text, "190456:1001\n190457:5\n");
+  EventList run_event;
+  check(EventList::Build(inputs, bin, EventList::kRun | EventList::kEvent) && run_event.Open(bin),
+        "run:event list built");
+  check(run_event.fields() == (EventList::kRun | EventList::kEvent), "field mask stored in the file");
+  check(run_event.Contains(190456, 0, 1001) && run_event.Contains(190456, 4294967295u, 1001),
+        "run:event list ignores the lumi");
+  check(!run_event.Contains(190456, 0, 5), "run:event list keeps the pairs");
+  std::vector<EventList::Record> runs;
+  EventList::Record rec = {190456, 7, 9};
+  runs.push_back(rec);
+  runs.push_back(rec);
+  EventList run_list;
+  run_list.Assign(runs, EventList::kRun);
+  check(run_list.size() == 1 && run_list.Contains(190456, 1, 2) && !run_list.Contains(190457, 7, 9),
+        "run list ignores the lumi and event");
+
+  // Malformed entries and missing inputs are errors, and leave the existing
+  // binary file alone
+  char const* bad[] = {"190456:12\n", "190456:12:1001:4\n", "190456:x:1001\n", "190456::1001\n", "190456:12:1001x\n",
+                       "+190456:12:1001\n"};
+  for (unsigned i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+    WriteText(text, bad[i]);
+    check(!EventList::Build(inputs, bin), std::string("malformed entry ") + bad[i]);
+    check(!EventList().Read(inputs), std::string("malformed entry read ") + bad[i]);
+  }
+  // Negative numbers would wrap around, and run and lumi numbers beyond 32
+  // bits would be truncated, so these end the job
+  char const* out_of_range[] = {"-1:12:1001\n", "190456:-12:1001\n", "190456:12:-1001\n",
+                                "4294967296:12:1001\n", "190456:4294967296:1001\n",
+                                "190456:12:18446744073709551616\n"};
+  for (unsigned i = 0; i < sizeof(out_of_range) / sizeof(out_of_range[0]); ++i) {
+    WriteText(text, out_of_range[i]);
+    check(BuildAborts(inputs, bin), std::string("out of range entry ") + out_of_range[i]);
+  }
+  WriteText(text, "4294967295:4294967295:18446744073709551615\n");
+  check(!BuildAborts(inputs, "EventListTest.range.bin"), "largest values in range");
+  std::remove("EventListTest.range.bin");
+  EventList kept;
+  check(kept.Open(bin) && kept.size() == 2, "failed Build keeps the existing file");
+  std::remove(text.c_str());
+  check(!EventList::Build(inputs, bin) && !EventList().Read(inputs), "missing text file");
+  check(!EventList::Build(std::vector<std::string>(), "EventListTest.missing/list.bin"), "Build into a missing directory");
+
+  // Files that are missing, not event lists, or cut short are not opened
+  EventList bad_list;
+  check(!bad_list.Open("EventListTest.missing") && bad_list.size() == 0, "missing binary file");
+  WriteText(text, "190456:12:1001\n");
+  check(!bad_list.Open(text) && bad_list.size() == 0, "text file is not a binary list");
+  std::vector<char> bytes;
+  {
+    std::ifstream in(bin.c_str(), std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out(bin.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(&bytes[0], bytes.size() - 1);
+  }
+  check(!bad_list.Open(bin) && bad_list.size() == 0 && !bad_list.Contains(190456, 0, 1001), "truncated binary file");
+
+  std::remove(text.c_str());
+  std::remove(bin.c_str());
+  return check.Summary();
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
+#include "TH1F.h"
+#include "TStopwatch.h"
+#include "boost/program_options.hpp"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/CompiledExpression.h"
+
+namespace po = boost::program_options;
+
+// Compares TTree::Draw with batch evaluation of a CompiledExpression for
+// a typical HiggsTauTauPlot4 selection and weight, e.g.
+//   ./bin/ExpressionBenchmark --file=../HiggsTauTau/TauTau_2012/VBF_HToTauTau_M-125_mt_2012.root
+//     --var="m_sv" --sel="os && mt_1<20. && n_jets>=2" --wt="wt"
+int main(int argc, char* argv[]){
+  std::string file;
+  std::string tree_name;
+  std::string var;
+  std::string sel;
+  std::string wt;
+  unsigned bins;
+  double lo;
+  double hi;
+
+  po::options_description config("Configuration");
+  config.add_options()
+    ("file",        po::value<std::string>(&file)->required(), "input file")
+    ("tree",        po::value<std::string>(&tree_name)->default_value("ntuple"), "tree name")
+    ("var",         po::value<std::string>(&var)->default_value("m_sv"), "variable")
+    ("sel",         po::value<std::string>(&sel)->default_value("os && mt_1<20."), "selection")
+    ("wt",          po::value<std::string>(&wt)->default_value("wt"), "weight")
+    ("bins",        po::value<unsigned>(&bins)->default_value(40), "number of bins")
+    ("lo",          po::value<double>(&lo)->default_value(0.), "lower edge")
+    ("hi",          po::value<double>(&hi)->default_value(200.), "upper edge");
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(config).allow_unregistered().run(), vm);
+  po::notify(vm);
+
+  TFile *input = new TFile(file.c_str());
+  TTree *tree = input ? dynamic_cast<TTree *>(input->Get(tree_name.c_str())) : NULL;
+  if (!tree) {
+    std::cerr << "The input tree could not be found" << std::endl;
+    return 1;
+  }
+  TH1::SetDefaultSumw2(true);
+  std::string cut = "("+sel+")*("+wt+")";
+
+  // Reference: TTree::Draw
+  TH1F h_draw("h_draw", "h_draw", bins, lo, hi);
+  TStopwatch draw_timer;
+  tree->Draw((var+">>h_draw").c_str(), cut.c_str(), "goff");
+  draw_timer.Stop();
+
+  // Compiled expressions evaluated in batches
+  TStopwatch compiled_timer;
+  ic::CompiledExpression cut_expr(cut);
+  ic::CompiledExpression var_expr(var);
+  if (!cut_expr.is_valid() || !var_expr.is_valid()) {
+    std::cerr << cut_expr.error() << var_expr.error() << std::endl;
+    return 1;
+  }
+  std::vector<std::string> names = cut_expr.variables();
+  names.insert(names.end(), var_expr.variables().begin(), var_expr.variables().end());
+  std::vector<TLeaf *> leaves;
+  for (auto const& name : names) {
+    TLeaf *leaf = tree->GetLeaf(name.c_str());
+    if (!leaf || leaf->GetLen() != 1) {
+      std::cerr << "Variable " << name << " is not a scalar branch" << std::endl;
+      return 1;
+    }
+    leaves.push_back(leaf);
+  }
+  const Long64_t batch_size = 4096;
+  std::vector<std::vector<double>> columns(leaves.size(), std::vector<double>(batch_size));
+  std::vector<double const*> cut_inputs;
+  std::vector<double const*> var_inputs;
+  for (unsigned i = 0; i < leaves.size(); ++i) {
+    (i < cut_expr.variables().size() ? cut_inputs : var_inputs).push_back(columns[i].data());
+  }
+  std::vector<double> w(batch_size);
+  std::vector<double> x(batch_size);
+  TH1F h_compiled("h_compiled", "h_compiled", bins, lo, hi);
+  double read_time = 0.;
+  TStopwatch read_timer;
+  Long64_t entries = tree->GetEntries();
+  for (Long64_t begin = 0; begin < entries; begin += batch_size) {
+    Long64_t size = std::min(batch_size, entries - begin);
+    read_timer.Start();
+    for (Long64_t k = 0; k < size; ++k) {
+      for (unsigned c = 0; c < leaves.size(); ++c) {
+        leaves[c]->GetBranch()->GetEntry(begin + k);
+        columns[c][k] = leaves[c]->GetValue(0);
+      }
+    }
+    read_timer.Stop();
+    read_time += read_timer.RealTime();
+    cut_expr.Evaluate(cut_inputs, size, w.data());
+    var_expr.Evaluate(var_inputs, size, x.data());
+    for (Long64_t k = 0; k < size; ++k) {
+      if (w[k] != 0.) h_compiled.Fill(x[k], w[k]);
+    }
+  }
+  compiled_timer.Stop();
+
+  double sum_draw = h_draw.Integral(0, bins + 1);
+  double sum_compiled = h_compiled.Integral(0, bins + 1);
+  std::cout << "Entries:            " << entries << std::endl;
+  std::cout << "TTree::Draw:        " << draw_timer.RealTime() << " s, integral " << sum_draw << std::endl;
+  std::cout << "CompiledExpression: " << compiled_timer.RealTime() << " s (" << read_time
+            << " s reading branches), integral " << sum_compiled << std::endl;
+  double max_diff = 0.;
+  for (unsigned i = 0; i <= bins + 1; ++i) {
+    max_diff = std::max(max_diff, std::fabs(h_draw.GetBinContent(i) - h_compiled.GetBinContent(i)));
+  }
+  std::cout << "Largest bin difference: " << max_diff << std::endl;
+  return max_diff == 0. ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include "boost/lexical_cast.hpp"
+#include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
+#include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/JetCorrectorTable.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::JetCorrectorTable;
+
+// Checks JetCorrectorTable against FactorizedJetCorrector at and around
+// the bin edges, in a gap between bins and outside every bin, the clamping
+// of the parameter variables, the memo, and the files AddLevel rejects
+
+void WriteText(std::string const& path, std::string const& text) {
+  std::ofstream out(path.c_str());
+  out << text;
+}
+
+int main() {
+  ic::TestChecks check;
+  // An L1FastJet level with a gap in eta between 0 and 0.5, an L2Relative
+  // level with pt limits, and a residual binned in eta and pt, which is
+  // searched linearly and sees the pt corrected by the previous levels
+  std::vector<std::string> files;
+  files.push_back("JetCorrectorTableTest_L1FastJet.txt");
+  WriteText(files.back(),
+            "{1 JetEta 3 JetPt JetA Rho max(0.0001,1-y*([0]+[1]*(z-[2]))/x) Correction L1FastJet}\n"
+            "-5.191 -3   9 1 3000 0 10 0 50 0.9 0.05 1.5\n"
+            "-3     0    9 1 3000 0 10 0 50 0.6 0.03 1.5\n"
+            "0.5    5.191 9 1 3000 0 10 0 50 0.7 0.04 1.5\n");
+  files.push_back("JetCorrectorTableTest_L2Relative.txt");
+  WriteText(files.back(),
+            "# pt limits 10 to 500\n"
+            "{1 JetEta 1 JetPt [0]+[1]*log10(x) Correction L2Relative}\n"
+            "-5.191 0     4 10 500 1.2 -0.05\n"
+            "0      5.191 4 10 500 1.1 -0.03\n");
+  files.push_back("JetCorrectorTableTest_L2L3Residual.txt");
+  WriteText(files.back(),
+            "{2 JetEta JetPt 1 JetPt [0]+[1]/x Correction L2L3Residual}\n"
+            "-5.191 5.191 0  50   4 0 6500 1.02 0.5\n"
+            "-5.191 5.191 50 6500 4 0 6500 0.99 1\n");
+
+  JetCorrectorTable table;
+  std::vector<JetCorrectorParameters> pars;
+  for (unsigned l = 0; l < files.size(); ++l) {
+    check(table.AddLevel(files[l]), "AddLevel " + files[l]);
+    pars.push_back(JetCorrectorParameters(files[l]));
+  }
+  if (table.n_levels() != files.size()) return check.Summary();
+  check(table.level_name(0) == "L1FastJet" && table.level_name(2) == "L2L3Residual", "level names");
+  FactorizedJetCorrector corrector(pars);
+
+  // Every eta bin edge and just either side of it, the gap, and beyond the
+  // outermost edges, for pt below, at and above the limits and the pt edge
+  // of the residual
+  double etas[] = {-6., -5.191, -5.1909, -3.0001, -3., -1., -1E-6, 0., 0.25, 0.4999, 0.5, 2.,
+                   5.1909, 5.191, 6.};
+  double pts[] = {3., 10., 40., 49.9, 50., 50.1, 120., 500., 2000.};
+  std::vector<double> pt, eta, energy, area;
+  for (unsigned i = 0; i < sizeof(etas) / sizeof(etas[0]); ++i) {
+    for (unsigned j = 0; j < sizeof(pts) / sizeof(pts[0]); ++j) {
+      eta.push_back(etas[i]);
+      pt.push_back(pts[j]);
+      energy.push_back(pts[j] * std::cosh(etas[i]));
+      area.push_back(0.5);
+    }
+  }
+  double rho = 12.;
+  unsigned n = pt.size();
+  std::vector<float> factors(3 * n);
+  table.Evaluate(n, &pt[0], &eta[0], &energy[0], &area[0], rho, &factors[0]);
+  unsigned mismatches = 0;
+  for (unsigned i = 0; i < n; ++i) {
+    corrector.setJetEta(eta[i]);
+    corrector.setJetPt(pt[i]);
+    corrector.setJetE(energy[i]);
+    corrector.setJetA(area[i]);
+    corrector.setRho(rho);
+    std::vector<float> sub = corrector.getSubCorrections();
+    for (unsigned l = 0; l < 3; ++l) {
+      if (!(std::fabs(factors[l * n + i] / sub[l] - 1.) <= 1E-5)) {
+        std::cout << "eta " << eta[i] << ", pt " << pt[i] << ", level " << l << ": " << factors[l * n + i]
+                  << " instead of " << sub[l] << std::endl;
+        ++mismatches;
+      }
+    }
+  }
+  check(mismatches == 0, "same factors as FactorizedJetCorrector");
+
+  // Jets in the gap are not corrected by L1FastJet, and beyond |eta| = 5.191
+  // or for NaN by no level at all
+  for (unsigned i = 0; i < n; ++i) {
+    if (eta[i] >= 0. && eta[i] < 0.5) check(factors[i] == 1.f, "no L1FastJet correction in the gap");
+    if (std::fabs(eta[i]) > 5.191) {
+      check(factors[i] == 1.f && factors[n + i] == 1.f && factors[2 * n + i] == 1.f, "outside every bin");
+    }
+  }
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  double one_pt = 50.;
+  double one_area = 0.5;
+  float nan_factors[3];
+  table.Evaluate(1, &one_pt, &nan, &one_pt, &one_area, rho, nan_factors);
+  check(nan_factors[0] == 1.f && nan_factors[1] == 1.f && nan_factors[2] == 1.f, "NaN eta");
+
+  // In the gap L2Relative sees the uncorrected pt, which is clamped to the
+  // limits of the bin
+  double clamp_pt[] = {500., 2000., 10., 3.};
+  double clamp_eta[] = {0.25, 0.25, 0.25, 0.25};
+  double clamp_area[] = {0.5, 0.5, 0.5, 0.5};
+  float clamp_factors[12];
+  table.Evaluate(4, clamp_pt, clamp_eta, clamp_pt, clamp_area, rho, clamp_factors);
+  check(clamp_factors[4] == clamp_factors[5], "pt clamped to the upper limit");
+  check(clamp_factors[6] == clamp_factors[7], "pt clamped to the lower limit");
+  check(std::fabs(clamp_factors[4] - (1.1 - 0.03 * std::log10(500.))) < 1E-6, "value at the upper limit");
+
+  // Repeated jets come from the memo with the same factors, also when the
+  // memo is too small to hold them or is disabled
+  std::size_t hits = table.memo_hits();
+  std::vector<float> again(3 * n);
+  table.Evaluate(n, &pt[0], &eta[0], &energy[0], &area[0], rho, &again[0]);
+  check(table.memo_hits() - hits == n, "repeated jets found in the memo");
+  check(again == factors, "memo gives the same factors");
+  table.Evaluate(n, &pt[0], &eta[0], &energy[0], &area[0], rho + 1., &again[0]);
+  check(table.memo_hits() - hits == n, "a different rho is not taken from the memo");
+  table.set_memo_size(3);
+  check(table.memo_size() == 4, "memo size rounded up to a power of two");
+  table.set_memo_size(1);
+  table.Evaluate(n, &pt[0], &eta[0], &energy[0], &area[0], rho, &again[0]);
+  table.Evaluate(n, &pt[0], &eta[0], &energy[0], &area[0], rho, &again[0]);
+  check(again == factors, "memo with a single slot");
+  table.set_memo_size(0);
+  hits = table.memo_hits();
+  table.Evaluate(n, &pt[0], &eta[0], &energy[0], &area[0], rho, &again[0]);
+  check(again == factors && table.memo_hits() == hits, "memo disabled");
+
+  // No jets: nothing is read or written
+  table.Evaluate(0, nullptr, nullptr, nullptr, nullptr, rho, nullptr);
+
+  // Files that can't be tabulated are rejected and leave the table as it was
+  std::string bad = "JetCorrectorTableTest_bad.txt";
+  char const* bad_files[] = {
+    "{1 JetEta 1 JetPt [0]*x Resolution L2Relative}\n-5 5 3 10 500 1\n",
+    "{1 JetPhi 1 JetPt [0]*x Correction L2Relative}\n-5 5 3 10 500 1\n",
+    "{1 JetEta 1 JetPt [0]*y Correction L2Relative}\n-5 5 3 10 500 1\n",
+    "{1 JetEta 1 JetPt [0]*x Correction L2Relative}\n-5 5 4 10 500 1\n",
+    "{1 JetEta 1 JetPt [0]*x Correction L2Relative}\n-5 5 1 10\n",
+    "{1 JetEta 1 JetPt [0]*x Correction L2Relative}\n",
+    "-5 5 3 10 500 1\n",
+    ""
+  };
+  for (unsigned i = 0; i < sizeof(bad_files) / sizeof(bad_files[0]); ++i) {
+    WriteText(bad, bad_files[i]);
+    check(!table.AddLevel(bad), "bad file " + boost::lexical_cast<std::string>(i));
+  }
+  std::remove(bad.c_str());
+  check(!table.AddLevel(bad), "missing file");
+  check(table.n_levels() == 3, "rejected files add no level");
+
+  for (unsigned l = 0; l < files.size(); ++l) std::remove(files[l].c_str());
+  return check.Summary();
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "boost/lexical_cast.hpp"
+#include "TH1F.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/th1fmorph.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+// Checks th1fmorph_batch against th1fmorph for the cases that matter to the
+// horizontal signal morphing: targets at and beyond the reference masses,
+// inputs with different binning and empty regions, empty inputs and bad
+// arguments
+
+// Bin-by-bin comparison of th1fmorph_batch with one th1fmorph call per target
+void CompareWithSingle(ic::TestChecks & check, std::string const& label, TH1F * h1, TH1F * h2, double m1, double m2,
+                       std::vector<double> const& masses, std::vector<double> const& norms) {
+  std::vector<TH1F> batch = th1fmorph_batch("morphed", "morphed", h1, h2, m1, m2, masses, norms, 0);
+  check(batch.size() == masses.size(), label + ": one histogram per target");
+  if (batch.size() != masses.size()) return;
+  for (unsigned i = 0; i < masses.size(); ++i) {
+    TH1F * single = th1fmorph("morphed", "morphed", h1, h2, m1, m2, masses[i], norms[i], 0);
+    bool same = batch[i].GetNbinsX() == single->GetNbinsX();
+    for (int j = 0; same && j <= single->GetNbinsX() + 1; ++j) {
+      same = batch[i].GetBinContent(j) == single->GetBinContent(j) &&
+             batch[i].GetBinLowEdge(j) == single->GetBinLowEdge(j);
+    }
+    check(same, label + ": same as th1fmorph at mass " + boost::lexical_cast<std::string>(masses[i]));
+    check(batch[i].GetDirectory() == nullptr, label + ": result not attached to a directory");
+    delete single;
+  }
+}
+
+int main(){
+  ic::TestChecks check;
+  TH1::AddDirectory(false);
+  // Two reference shapes with different binning, an empty region in the
+  // second and content at the outermost bins
+  double edges1[] = {0., 20., 40., 60., 70., 80., 90., 100., 110., 120., 150., 200.};
+  TH1F h1("h1", "h1", 11, edges1);
+  TH1F h2("h2", "h2", 20, 0., 200.);
+  for (int i = 1; i <= h1.GetNbinsX(); ++i) h1.SetBinContent(i, 1. + (i % 4));
+  TH1F h2_full("h2_full", "h2_full", 20, 0., 200.);
+  for (int i = 1; i <= h2.GetNbinsX(); ++i) {
+    h2.SetBinContent(i, (i == 7) ? 0. : 1. + (i % 3));
+    h2_full.SetBinContent(i, 1. + (i % 3));
+  }
+  // Under- and overflow are ignored by the morphing
+  h1.SetBinContent(0, 100.);
+  h2.SetBinContent(21, 100.);
+
+  std::vector<double> masses = {140., 141., 145., 149.5, 150.};
+  std::vector<double> norms = {1., 2., 3., 4., 5.};
+  CompareWithSingle(check, "interpolation", &h1, &h2, 140., 150., masses, norms);
+  CompareWithSingle(check, "extrapolation", &h1, &h2, 140., 150., {130., 160.}, {1., 1.});
+  CompareWithSingle(check, "equal reference masses", &h1, &h2, 145., 145., {145.}, {1.});
+
+  // At the reference masses inputs with the output binning and no empty
+  // bins come back with the requested norm.  With other binning, or empty
+  // bins, the shape is rebuilt from the cumulative distribution and is
+  // only approximate, so the comparison above is all that holds there
+  TH1F h3("h3", "h3", 20, 0., 200.);
+  for (int i = 1; i <= h3.GetNbinsX(); ++i) h3.SetBinContent(i, 1. + (i % 4));
+  std::vector<TH1F> ends = th1fmorph_batch("morphed", "morphed", &h3, &h2_full, 140., 150., {140., 150.}, {2., 3.});
+  if (ends.size() == 2) {
+    check(std::fabs(ends[0].Integral() - 2.) < 1E-5, "norm at the first reference mass");
+    check(std::fabs(ends[1].Integral() - 3.) < 1E-5, "norm at the second reference mass");
+    double diff = 0.;
+    for (int i = 1; i <= h3.GetNbinsX(); ++i) {
+      diff = std::max(diff, std::fabs(ends[0].GetBinContent(i) / 2. - h3.GetBinContent(i) / h3.Integral()));
+      diff = std::max(diff, std::fabs(ends[1].GetBinContent(i) / 3. - h2_full.GetBinContent(i) / h2_full.Integral()));
+    }
+    check(diff < 1E-6, "input shapes at the reference masses");
+  } else {
+    check(false, "one histogram per reference mass");
+  }
+
+  // No targets: nothing to do
+  check(th1fmorph_batch("morphed", "morphed", &h1, &h2, 140., 150., {}, {}).empty(), "no targets");
+
+  // An empty input gives empty histograms, one per target
+  TH1F empty("empty", "empty", 20, 0., 200.);
+  std::vector<TH1F> from_empty = th1fmorph_batch("morphed", "morphed", &h1, &empty, 140., 150., {145., 146.}, {1., 1.});
+  check(from_empty.size() == 2, "one histogram per target with an empty input");
+  for (unsigned i = 0; i < from_empty.size(); ++i) check(from_empty[i].Integral() == 0., "empty result for an empty input");
+
+  // Bad arguments give no histograms
+  check(th1fmorph_batch("morphed", "morphed", &h1, &h2, 140., 150., {145., 146.}, {1.}).empty(),
+        "mismatched numbers of targets and norms");
+  check(th1fmorph_batch("morphed", "morphed", &h1, (TH1F *)nullptr, 140., 150., {145.}, {1.}).empty(),
+        "missing second input");
+
+  return check.Summary();
+}
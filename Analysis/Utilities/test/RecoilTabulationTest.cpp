@@ -0,0 +1,114 @@
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "TF1.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/RecoilCorrector.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+// Checks TabulatedTF1 on fits of the shapes found in the recoil files,
+// none of which cubic interpolation reproduces exactly: the error between
+// the nodes against maxError() and the tolerance, the refinement of the
+// node spacing, the edges of the fit range and just beyond them, and fits
+// that must not be tabulated
+
+bool SameOrBothNaN(double a, double b) {
+  return a == b || (a != a && b != b);
+}
+
+// The largest error of the table, relative as in TabulatedTF1, on a grid
+// much finer than the nodes that avoids the points used in the refinement
+double MeasuredError(TabulatedTF1 const& table, TF1 & func) {
+  double lo = func.GetXmin();
+  double hi = func.GetXmax();
+  unsigned n = 50 * table.nPoints() + 7;
+  double max_err = 0.;
+  for (unsigned i = 0; i <= n; ++i) {
+    double x = lo + (hi - lo) * i / n;
+    double exact = func.Eval(x);
+    max_err = std::max(max_err, std::fabs(table.Eval(x) - exact) / std::max(std::fabs(exact), 1.));
+  }
+  return max_err;
+}
+
+void CheckFit(ic::TestChecks & check, TF1 & func, double tolerance) {
+  std::string name = func.GetName();
+  TabulatedTF1 table(&func, tolerance);
+  check(table.isTabulated(), name + ": tabulated");
+  if (!table.isTabulated()) return;
+  check(table.maxError() > 0. && table.maxError() <= tolerance, name + ": error at construction within the tolerance");
+  // The refinement probes each interval at its quarter points, which can
+  // miss the largest interpolation error by up to ~10% near the range ends
+  check(MeasuredError(table, func) <= 1.5 * table.maxError(), name + ": error between the nodes");
+  check(MeasuredError(table, func) <= 1.5 * tolerance, name + ": error between the nodes within the tolerance");
+
+  // A looser tolerance needs fewer nodes, a tighter one more
+  TabulatedTF1 loose(&func, 1E3 * tolerance);
+  TabulatedTF1 tight(&func, 1E-3 * tolerance);
+  check(loose.isTabulated() && loose.nPoints() < table.nPoints(), name + ": fewer nodes for a looser tolerance");
+  check(tight.isTabulated() && tight.nPoints() > table.nPoints(), name + ": more nodes for a tighter tolerance");
+  check(tight.isTabulated() && MeasuredError(tight, func) <= 1.5E-3 * tolerance, name + ": tighter tolerance met");
+
+  // The ends of the range are nodes, just inside them the table is used,
+  // and just outside them the TF1 itself
+  double lo = func.GetXmin();
+  double hi = func.GetXmax();
+  double eps = 1E-9 * (hi - lo);
+  check(std::fabs(table.Eval(lo) - func.Eval(lo)) <= 1E-12 * std::max(std::fabs(func.Eval(lo)), 1.),
+        name + ": lower edge of the range");
+  check(std::fabs(table.Eval(hi) - func.Eval(hi)) <= 1E-12 * std::max(std::fabs(func.Eval(hi)), 1.),
+        name + ": upper edge of the range");
+  check(std::fabs(table.Eval(lo + eps) - func.Eval(lo + eps)) <= tolerance * std::max(std::fabs(func.Eval(lo + eps)), 1.),
+        name + ": just inside the lower edge");
+  check(std::fabs(table.Eval(hi - eps) - func.Eval(hi - eps)) <= tolerance * std::max(std::fabs(func.Eval(hi - eps)), 1.),
+        name + ": just inside the upper edge");
+  double outside[] = {lo - eps, lo - 20., hi + eps, hi + 20.};
+  for (unsigned i = 0; i < 4; ++i) {
+    check(table.Eval(outside[i]) == func.Eval(outside[i]), name + ": outside the range uses the TF1");
+  }
+  check(SameOrBothNaN(table.Eval(std::numeric_limits<double>::quiet_NaN()),
+                      func.Eval(std::numeric_limits<double>::quiet_NaN())), name + ": NaN uses the TF1");
+}
+
+int main() {
+  ic::TestChecks check;
+  double tolerance = 1E-6;
+
+  // Recoil resolution rising to a plateau, a mean response that saturates
+  // with the boson pt, and the error-function correlation terms
+  TF1 rms("u1RMS1", "[0]+[1]*(1-exp(-x/[2]))", 0., 300.);
+  rms.SetParameters(6.2, 9.5, 45.);
+  CheckFit(check, rms, tolerance);
+  TF1 mean("u1Mean", "([0]+[1]*x)/(1+[2]*x)", 0., 300.);
+  mean.SetParameters(-0.4, -0.9, 0.011);
+  CheckFit(check, mean, tolerance);
+  TF1 corr("u1u2Corr", "[0]*TMath::Erf((x-[1])/[2])+[3]", 0., 300.);
+  corr.SetParameters(0.2, 30., 25., 0.05);
+  CheckFit(check, corr, tolerance);
+
+  // A zero tolerance turns the tabulation off
+  TabulatedTF1 off(&rms, 0.);
+  check(!off.isTabulated() && off.nPoints() == 0, "zero tolerance");
+  check(off.Eval(123.4) == rms.Eval(123.4), "zero tolerance uses the TF1");
+
+  // So does an empty range
+  TF1 point("point", "[0]+[1]*x", 10., 10.);
+  point.SetParameters(1., 2.);
+  check(!TabulatedTF1(&point, tolerance).isTabulated(), "empty range");
+
+  // A steep turn-on that the allowed nodes can't follow to the tolerance
+  TF1 steep("steep", "[0]*TMath::Erf((x-[1])/[2])+[3]", 0., 300.);
+  steep.SetParameters(0.2, 100.3, 0.05, 0.05);
+  TabulatedTF1 steep_table(&steep, tolerance, 257);
+  check(!steep_table.isTabulated(), "steep turn-on with too few nodes");
+  check(steep_table.Eval(100.3) == steep.Eval(100.3), "steep turn-on uses the TF1");
+
+  // A kink can't be interpolated at all
+  TF1 kink("kink", "abs(x-100.3)", 0., 300.);
+  TabulatedTF1 kinked(&kink, tolerance);
+  check(!kinked.isTabulated(), "function with a kink");
+  check(kinked.Eval(100.3) == kink.Eval(100.3), "function with a kink uses the TF1");
+
+  return check.Summary();
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <iterator>
+#include <unistd.h>
+#include "boost/lexical_cast.hpp"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/SVFitCache.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::SVFitCache;
+using ic::TestChecks;
+
+// Checks that results flushed by several caches on one file, one after
+// another, can all be found again, before and after Compact, and that a
+// file that isn't a cache is never written to
+
+SVFitCache::Key MakeKey(uint64_t h1, uint64_t h2) {
+  SVFitCache::Key key = {h1, h2};
+  return key;
+}
+
+bool Has(SVFitCache & cache, uint64_t h1, double expected) {
+  double mass = 0.;
+  return cache.Find(MakeKey(h1, 7), mass) && mass == expected;
+}
+
+int main() {
+  TestChecks check;
+  std::string path = "/tmp/SVFitCacheTest_" + boost::lexical_cast<std::string>(getpid()) + ".bin";
+  std::string other = path + ".txt";
+  std::remove(path.c_str());
+
+  // The first Flush creates the file, later ones append to it, also from
+  // a cache that opened the file before it existed
+  SVFitCache early(path);
+  {
+    SVFitCache first(path);
+    first.Insert(MakeKey(1, 7), 10.);
+    first.Flush();
+    first.Insert(MakeKey(2, 7), 20.);
+    first.Flush();
+  }
+  early.Insert(MakeKey(3, 7), 30.);
+  early.Flush();
+  {
+    SVFitCache second(path);
+    check(Has(second, 1, 10.) && Has(second, 2, 20.) && Has(second, 3, 30.), "results of every Flush found");
+    check(!Has(second, 4, 40.), "missing result");
+    second.Insert(MakeKey(4, 7), 40.);
+  }
+  SVFitCache third(path);
+  check(Has(third, 4, 40.), "result flushed by the destructor");
+
+  // Compact keeps every result
+  check(SVFitCache::Compact(path), "Compact");
+  SVFitCache compacted(path);
+  check(Has(compacted, 1, 10.) && Has(compacted, 2, 20.) && Has(compacted, 3, 30.) && Has(compacted, 4, 40.),
+        "results found after Compact");
+  compacted.Insert(MakeKey(5, 7), 50.);
+  compacted.Flush();
+  SVFitCache appended(path);
+  check(Has(appended, 5, 50.) && Has(appended, 1, 10.), "results appended after Compact");
+
+  // Another file is left alone
+  { std::ofstream f(other.c_str()); f << "not an SVFit cache file\n"; }
+  {
+    SVFitCache wrong(other);
+    wrong.Insert(MakeKey(1, 7), 10.);
+    wrong.Flush();
+  }
+  std::ifstream f(other.c_str());
+  std::string contents((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  check(contents == "not an SVFit cache file\n", "other file not written to");
+  check(!SVFitCache::Compact(other), "other file not compacted");
+
+  std::remove(path.c_str());
+  std::remove(other.c_str());
+  return check.Summary();
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "UserCode/ICHiggsTauTau/Analysis/Core/interface/TreeEvent.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/ShiftedView.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::ShiftedView;
+using ic::TestChecks;
+
+// Checks that a ShiftedView never changes the nominal collection, that
+// Materialize and Copies see the same shifted values, and that a view
+// added to the event can be read back with TreeEvent::GetPtrVec, also
+// after Restore
+
+// The view only needs the pt and energy setters of the objects
+class Object {
+ public:
+  Object(double pt, double energy) : pt_(pt), energy_(energy) { ; }
+  inline double pt() const { return pt_; }
+  inline void set_pt(double const& pt) { pt_ = pt; }
+  inline double energy() const { return energy_; }
+  inline void set_energy(double const& energy) { energy_ = energy; }
+ private:
+  double pt_;
+  double energy_;
+};
+
+int main() {
+  TestChecks check;
+  std::vector<Object> objects;
+  objects.push_back(Object(20., 30.));
+  objects.push_back(Object(40., 50.));
+  objects.push_back(Object(60., 70.));
+  std::vector<Object *> nominal;
+  for (unsigned i = 0; i < objects.size(); ++i) nominal.push_back(&objects[i]);
+
+  // Unshifted objects are handed out from the nominal collection, shifted
+  // ones are copied once
+  ShiftedView<Object> view(nominal);
+  view.SetScale(1, 1.1);
+  check(view[0] == nominal[0] && view[2] == nominal[2], "unshifted objects not copied");
+  check(view[1] != nominal[1] && TestChecks::Close(view[1]->pt(), 44., 1E-12) &&
+        TestChecks::Close(view[1]->energy(), 55., 1E-12), "shifted object");
+  check(view[1] == view.at(1), "shifted object copied once");
+  check(objects[1].pt() == 40. && objects[1].energy() == 50., "nominal object unchanged");
+  std::vector<Object const*> const& all = view.Materialize();
+  check(all.size() == 3 && all[0] == nominal[0] && all[1] == view[1], "Materialize");
+
+  // Copies hands out objects that can be changed without touching the
+  // nominal ones, with the shifted copy shared with the view
+  std::vector<Object *> copies = view.Copies();
+  check(copies.size() == 3 && copies[0] != nominal[0] && copies[2] != nominal[2], "Copies copies every object");
+  check(copies[1] == view[1], "Copies shares the shifted copies");
+  check(copies[0]->pt() == 20. && TestChecks::Close(copies[1]->pt(), 44., 1E-12) && copies[2]->pt() == 60.,
+        "Copies values");
+  copies[0]->set_pt(99.);
+  check(objects[0].pt() == 20. && view[0]->pt() == 20., "changing a copy leaves the nominal object alone");
+  check(view.Copies()[0] == copies[0], "Copies made once");
+
+  // A view in the event reads as a collection of copies, the view itself
+  // staying available next to it
+  ic::TreeEvent event;
+  event.Add("nominal", nominal);
+  ShiftedView<Object> shifted(nominal);
+  for (unsigned i = 0; i < nominal.size(); ++i) shifted.SetScale(i, 0.9);
+  event.Add("shifted", shifted);
+  event.Snapshot();
+  for (unsigned pass = 0; pass < 2; ++pass) {
+    std::string what = pass == 0 ? "event" : "event after Restore";
+    if (pass > 0) event.Restore();
+    std::vector<Object *> & vec = event.GetPtrVec<Object>("shifted");
+    check(vec.size() == 3 && TestChecks::Close(vec[2]->pt(), 54., 1E-12) &&
+          TestChecks::Close(vec[2]->energy(), 63., 1E-12), what + ": view read as a collection");
+    check(event.Exists("shifted:view") && event.GetIf<ShiftedView<Object> >("shifted:view"),
+          what + ": view kept");
+    // Later requests get the same vector, which modules can filter
+    check(&event.GetPtrVec<Object>("shifted") == &vec, what + ": view read once");
+    vec.erase(vec.begin());
+    check(event.GetPtrVec<Object>("shifted").size() == 2, what + ": filtered collection");
+    vec[0]->set_pt(1.);
+    check(event.GetPtrVec<Object>("nominal").size() == 3 && objects[1].pt() == 40. && objects[2].pt() == 60.,
+          what + ": nominal collection unchanged");
+  }
+  check(event.GetIf<ShiftedView<Object> >("nominal") == NULL && event.GetIf<double>("missing") == NULL,
+        "GetIf of another type or a missing product");
+
+  return check.Summary();
+}
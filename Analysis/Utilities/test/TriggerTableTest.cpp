@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "UserCode/ICHiggsTauTau/interface/TriggerPath.hh"
+#include "UserCode/ICHiggsTauTau/interface/city.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TriggerTable.h"
+#include "UserCode/ICHiggsTauTau/Analysis/Utilities/interface/TestChecks.h"
+
+using ic::TriggerTable;
+using ic::TriggerPath;
+using ic::TestChecks;
+
+// Checks the caching in TriggerTable: path flags that are cached per run
+// and per path id and cleared at a change of run, paths without an id
+// that fall back to a hash of the name, and the filter rows, where the
+// last matching row wins
+
+TriggerPath MakePath(std::string const& name, std::size_t id) {
+  TriggerPath path;
+  path.set_name(name);
+  path.set_accept(true);
+  path.set_prescale(1);
+  path.set_id(id);
+  return path;
+}
+
+unsigned MatchOne(TriggerTable & table, unsigned run, TriggerPath & path) {
+  ic::TriggerPathPtrVec paths(1, &path);
+  return table.Match(run, paths);
+}
+
+bool SameFilters(TriggerTable::Filters const& filters, std::string const& objects) {
+  return filters.objects == objects && filters.leg1 == objects + "_leg1" && filters.leg2 == objects + "_leg2";
+}
+
+int main() {
+  TestChecks check;
+  unsigned const kEle = 2;
+  unsigned const kTau = 4;
+
+  TriggerTable table;
+  table.AddPath(100, 199, "HLT_IsoMu17")
+       .AddPath(200, TriggerTable::kMaxRun, "HLT_Ele22", TriggerTable::kPath | kEle)
+       .AddPath(150, 250, "LooseIsoPFTau", kTau);
+
+  // Each path matches the rows of its run only
+  TriggerPath mu = MakePath("HLT_IsoMu17_eta2p1_LooseIsoPFTau20_v4", 11);
+  TriggerPath ele = MakePath("HLT_Ele22_CaloIdVT_v2", 12);
+  check(MatchOne(table, 120, mu) == TriggerTable::kPath, "muon path, first run range");
+  check(MatchOne(table, 120, ele) == 0, "electron path, first run range");
+  check(MatchOne(table, 160, mu) == (TriggerTable::kPath | kTau), "muon path, overlapping rows");
+  check(MatchOne(table, 220, mu) == kTau, "muon path, second run range");
+  check(MatchOne(table, 220, ele) == (TriggerTable::kPath | kEle), "electron path, second run range");
+  check(MatchOne(table, 99, mu) == 0 && MatchOne(table, 99, ele) == 0, "run before every row");
+  ic::TriggerPathPtrVec both;
+  both.push_back(&mu);
+  both.push_back(&ele);
+  check(table.Match(220, both) == (TriggerTable::kPath | kEle | kTau), "flags of several paths are ORed");
+  check(table.Match(220, ic::TriggerPathPtrVec()) == 0, "no paths");
+
+  // Within a run the flags are cached by id, so a path that reuses an id
+  // gets the flags of the first name seen with it
+  TriggerPath renamed = MakePath("HLT_Ele22_CaloIdVT_v2", 11);
+  check(MatchOne(table, 120, mu) == TriggerTable::kPath, "muon path cached");
+  check(MatchOne(table, 120, renamed) == TriggerTable::kPath, "flags cached by id within a run");
+  // A change of run clears the cache, also when returning to the same run
+  check(MatchOne(table, 220, renamed) == (TriggerTable::kPath | kEle), "cache cleared at a change of run");
+  check(MatchOne(table, 120, renamed) == 0, "cache cleared on returning to a run");
+  check(MatchOne(table, 120, mu) == 0, "first name seen with an id after the change of run");
+  check(MatchOne(table, 121, mu) == TriggerTable::kPath, "cache cleared again at the next run");
+
+  // Rows added after matching apply from the next call, in the same run
+  table.AddPath(100, 199, "HLT_Ele22", kEle);
+  check(MatchOne(table, 121, ele) == kEle, "row added within a run");
+
+  // Paths without an id fall back to a hash of the name: different names
+  // don't share a cache entry, and a path with the id of that hash does
+  TriggerPath no_id_mu = MakePath("HLT_IsoMu17_eta2p1_LooseIsoPFTau20_v4", 0);
+  TriggerPath no_id_ele = MakePath("HLT_Ele22_CaloIdVT_v2", 0);
+  check(MatchOne(table, 300, no_id_mu) == 0, "no id, muon path");
+  check(MatchOne(table, 300, no_id_ele) == (TriggerTable::kPath | kEle), "no id, electron path");
+  TriggerPath hashed = MakePath("HLT_Ele22_CaloIdVT_v3", CityHash64(no_id_mu.name()));
+  check(MatchOne(table, 300, hashed) == 0, "id equal to the hash of a name shares its entry");
+  ic::TriggerPathPtrVec no_ids;
+  no_ids.push_back(&no_id_mu);
+  no_ids.push_back(&no_id_ele);
+  check(table.Match(160, no_ids) == (TriggerTable::kPath | kEle | kTau), "no id, several paths");
+
+  // A table without rows for the run matches nothing
+  TriggerTable empty;
+  check(MatchOne(empty, 120, mu) == 0 && empty.n_paths() == 0, "table without path rows");
+
+  // Filters: the last matching row wins, whatever the order of the run
+  // ranges, and rows requiring flags only apply when they are all set
+  TriggerTable filters;
+  filters.AddFilters(0, 0, TriggerTable::kMaxRun, "all", "all_leg1", "all_leg2")
+         .AddFilters(0, 100, 199, "early", "early_leg1", "early_leg2")
+         .AddFilters(0, 150, 160, "narrow", "narrow_leg1", "narrow_leg2")
+         .AddFilters(0, 100, 299, "wide", "wide_leg1", "wide_leg2", kEle)
+         .AddFilters(0, 100, 299, "tau_ele", "tau_ele_leg1", "tau_ele_leg2", kEle | kTau)
+         .AddFilters(1, 100, 199, "other", "other_leg1", "other_leg2");
+  check(filters.n_filters() == 6, "filter rows added");
+  check(SameFilters(filters.Lookup(0, 50, 0), "all"), "only the catch-all row");
+  check(SameFilters(filters.Lookup(0, 120, 0), "early"), "later row wins");
+  check(SameFilters(filters.Lookup(0, 155, 0), "narrow"), "narrower later row wins");
+  check(SameFilters(filters.Lookup(0, 155, kEle), "wide"), "later row with its required flag wins");
+  check(SameFilters(filters.Lookup(0, 155, kTau), "narrow"), "row skipped without its required flag");
+  check(SameFilters(filters.Lookup(0, 155, kEle | kTau), "tau_ele"), "row with all of its required flags");
+  check(SameFilters(filters.Lookup(0, 155, kEle | kTau | TriggerTable::kPath), "tau_ele"), "extra flags don't matter");
+  check(SameFilters(filters.Lookup(0, 250, kTau), "all"), "required flags not all set");
+  check(SameFilters(filters.Lookup(1, 120, 0), "other"), "slot rows kept apart");
+  check(filters.Lookup(1, 250, 0).objects.empty() && filters.Lookup(2, 120, 0).objects.empty(),
+        "no row for the slot and run");
+  // The choice is cached per slot and flags, and redone at a change of run
+  check(SameFilters(filters.Lookup(0, 155, 0), "narrow") && SameFilters(filters.Lookup(0, 155, kEle), "wide"),
+        "cached choices per flag value");
+  check(SameFilters(filters.Lookup(0, 170, 0), "early"), "choice redone at a change of run");
+  check(SameFilters(filters.Lookup(0, 155, 0), "narrow"), "choice redone on returning to a run");
+  filters.AddFilters(0, 0, TriggerTable::kMaxRun, "last", "last_leg1", "last_leg2");
+  check(SameFilters(filters.Lookup(0, 155, kEle | kTau), "last"), "row added within a run wins");
+
+  return check.Summary();
+}